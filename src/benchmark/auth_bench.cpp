@@ -0,0 +1,368 @@
+//=============================================================================//
+//
+// Purpose: online authentication token benchmark; verifies signed tokens with
+//          the public key parsed on every verification like before, with the
+//          key parsed once per thread, and with the parsed key on a pool of
+//          worker threads, and reports the verifications per second
+//
+//=============================================================================//
+#include "tier0/fasttimer.h"
+#include "jwt/include/decode.h"
+#include "jwt/include/encode.h"
+#include "jwt/include/version.h"
+#include "mbedtls/include/mbedtls/ctr_drbg.h"
+#include "mbedtls/include/mbedtls/entropy.h"
+#include "mbedtls/include/mbedtls/pk.h"
+#include "mbedtls/include/mbedtls/rsa.h"
+#include "mbedtls/include/mbedtls/sha256.h"
+#include "benchmark.h"
+
+// Matches ONLINE_AUTH_WORKER_COUNT in the server.
+#define AUTHBENCH_WORKER_COUNT 2
+
+// Matches the size of the master server signing key.
+#define AUTHBENCH_KEY_BITS 2048
+
+#define AUTHBENCH_SESSION_DATA "1000123456789-r5player-127.0.0.1"
+
+//-----------------------------------------------------------------------------
+// Keys and token shared by all verifications
+//-----------------------------------------------------------------------------
+struct AuthBenchContext_s
+{
+	std::string privateKey;
+	std::string publicKey;
+	std::string token;
+	std::string tamperedToken;
+};
+
+//-----------------------------------------------------------------------------
+// Public key parsed once per thread, as in the server.
+//-----------------------------------------------------------------------------
+class CAuthBenchKey
+{
+public:
+	CAuthBenchKey()
+		: m_pszPublicKey(nullptr)
+		, m_bValid(false)
+	{
+		mbedtls_pk_init(&m_Context);
+	}
+	~CAuthBenchKey()
+	{
+		mbedtls_pk_free(&m_Context);
+	}
+
+	mbedtls_pk_context* Get(const std::string& publicKey)
+	{
+		if (m_pszPublicKey != publicKey.c_str())
+		{
+			mbedtls_pk_free(&m_Context);
+			mbedtls_pk_init(&m_Context);
+
+			m_bValid = mbedtls_pk_parse_public_key(&m_Context,
+				(const unsigned char*)publicKey.c_str(), publicKey.size() + 1) == 0;
+			m_pszPublicKey = publicKey.c_str();
+		}
+
+		return m_bValid ? &m_Context : nullptr;
+	}
+
+private:
+	mbedtls_pk_context m_Context;
+	const char* m_pszPublicKey;
+	bool m_bValid;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the public key parsed for the calling thread
+//-----------------------------------------------------------------------------
+static mbedtls_pk_context* AuthBench_GetKey(const AuthBenchContext_s& ctx)
+{
+	static thread_local CAuthBenchKey s_Key;
+	return s_Key.Get(ctx.publicKey);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: generates a signing key pair in PEM format
+// Input  : &ctx -
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+static bool AuthBench_CreateKeys(AuthBenchContext_s& ctx)
+{
+	mbedtls_entropy_context entropy;
+	mbedtls_ctr_drbg_context drbg;
+	mbedtls_pk_context pk;
+
+	mbedtls_entropy_init(&entropy);
+	mbedtls_ctr_drbg_init(&drbg);
+	mbedtls_pk_init(&pk);
+
+	const char personalization[] = "auth_bench";
+	unsigned char pemBuf[4096];
+
+	bool bSuccess = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy,
+		(const unsigned char*)personalization, sizeof(personalization) - 1) == 0 &&
+		mbedtls_pk_setup(&pk, mbedtls_pk_info_from_type(MBEDTLS_PK_RSA)) == 0 &&
+		mbedtls_rsa_gen_key(mbedtls_pk_rsa(pk), mbedtls_ctr_drbg_random, &drbg, AUTHBENCH_KEY_BITS, 65537) == 0;
+
+	if (bSuccess && mbedtls_pk_write_key_pem(&pk, pemBuf, sizeof(pemBuf)) == 0)
+		ctx.privateKey = (const char*)pemBuf;
+	else
+		bSuccess = false;
+
+	if (bSuccess && mbedtls_pk_write_pubkey_pem(&pk, pemBuf, sizeof(pemBuf)) == 0)
+		ctx.publicKey = (const char*)pemBuf;
+	else
+		bSuccess = false;
+
+	mbedtls_pk_free(&pk);
+	mbedtls_ctr_drbg_free(&drbg);
+	mbedtls_entropy_free(&entropy);
+
+	return bSuccess;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: signs a token carrying the session id of the session data, like the
+//          master server does
+// Input  : &ctx -
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+static bool AuthBench_CreateToken(AuthBenchContext_s& ctx)
+{
+	uint8_t sessionHash[32];
+
+	if (mbedtls_sha256((const uint8_t*)AUTHBENCH_SESSION_DATA, sizeof(AUTHBENCH_SESSION_DATA) - 1, sessionHash, 0) != 0)
+		return false;
+
+	char sessionId[sizeof(sessionHash) * 2 + 1];
+
+	for (size_t i = 0; i < sizeof(sessionHash); i++)
+		snprintf(&sessionId[i * 2], 3, "%02x", sessionHash[i]);
+
+	struct l8w8jwt_claim claim;
+	memset(&claim, 0, sizeof(claim));
+
+	claim.key = (char*)"sessionId";
+	claim.value = sessionId;
+	claim.type = L8W8JWT_CLAIM_TYPE_STRING;
+
+	char* pszToken = nullptr;
+	size_t tokenLen = 0;
+
+	struct l8w8jwt_encoding_params params;
+	l8w8jwt_encoding_params_init(&params);
+
+	params.alg = L8W8JWT_ALG_RS256;
+
+	params.iat = time(nullptr);
+	params.exp = params.iat + 3600;
+
+	params.additional_payload_claims = &claim;
+	params.additional_payload_claims_count = 1;
+
+	params.secret_key = (unsigned char*)ctx.privateKey.c_str();
+	params.secret_key_length = ctx.privateKey.size() + 1;
+
+	params.out = &pszToken;
+	params.out_length = &tokenLen;
+
+	if (l8w8jwt_encode(&params) != L8W8JWT_SUCCESS)
+		return false;
+
+	ctx.token.assign(pszToken, tokenLen);
+	l8w8jwt_free(pszToken);
+
+	// Flip a bit in the middle of the signature.
+	ctx.tamperedToken = ctx.token;
+	char& sigChar = ctx.tamperedToken[ctx.tamperedToken.rfind('.') + 8];
+
+	sigChar = sigChar == 'A' ? 'B' : 'A';
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: verifies a token like the server does
+// Input  : &ctx -
+//			&token -
+//			*pKey - parsed public key, or NULL to parse it from the PEM string
+// Output : true if authorized, false otherwise
+//-----------------------------------------------------------------------------
+static bool AuthBench_Verify(const AuthBenchContext_s& ctx, const std::string& token, mbedtls_pk_context* const pKey)
+{
+	l8w8jwt_claim* claims = nullptr;
+	size_t numClaims = 0;
+
+	struct l8w8jwt_decoding_params params;
+	l8w8jwt_decoding_params_init(&params);
+
+	params.alg = L8W8JWT_ALG_RS256;
+
+	params.jwt = (char*)token.c_str();
+	params.jwt_length = token.length();
+
+	params.verification_key = (unsigned char*)ctx.publicKey.c_str();
+	params.verification_key_length = ctx.publicKey.size() + 1;
+	params.verification_pk = pKey;
+
+	params.validate_exp = 1;
+	params.validate_iat = 1;
+
+	enum l8w8jwt_validation_result validation_result;
+
+	if (l8w8jwt_decode(&params, &validation_result, &claims, &numClaims) != L8W8JWT_SUCCESS ||
+		validation_result != L8W8JWT_VALID)
+	{
+		if (claims)
+			l8w8jwt_free_claims(claims, numClaims);
+
+		return false;
+	}
+
+	bool bAuthorized = false;
+	l8w8jwt_claim* const sessionClaim = l8w8jwt_get_claim(claims, numClaims, "sessionId", 9);
+
+	if (sessionClaim)
+	{
+		uint8_t sessionHash[32];
+		V_hextobinary(sessionClaim->value, strlen(sessionClaim->value), sessionHash, sizeof(sessionHash));
+
+		uint8_t oobHash[32];
+
+		bAuthorized = mbedtls_sha256((const uint8_t*)AUTHBENCH_SESSION_DATA,
+			sizeof(AUTHBENCH_SESSION_DATA) - 1, oobHash, 0) == 0 &&
+			memcmp(oobHash, sessionHash, sizeof(sessionHash)) == 0;
+	}
+
+	l8w8jwt_free_claims(claims, numClaims);
+	return bAuthorized;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: verifies the token the given number of times on the calling thread
+// Input  : &ctx -
+//			numVerifications -
+//			bCachedKey - whether to use the parsed key of this thread
+//			&duration -
+// Output : true if all verifications succeeded, false otherwise
+//-----------------------------------------------------------------------------
+static bool AuthBench_RunInline(const AuthBenchContext_s& ctx, const int numVerifications,
+	const bool bCachedKey, CCycleCount& duration)
+{
+	bool bSuccess = true;
+
+	CFastTimer timer;
+	timer.Start();
+
+	for (int i = 0; i < numVerifications; i++)
+	{
+		if (!AuthBench_Verify(ctx, ctx.token, bCachedKey ? AuthBench_GetKey(ctx) : nullptr))
+			bSuccess = false;
+	}
+
+	timer.End();
+	duration += timer.GetDuration();
+
+	return bSuccess;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: verifies the token the given number of times, spread over the
+//          worker threads; the wall clock time is measured
+// Input  : &ctx -
+//			numVerifications -
+//			&duration -
+// Output : true if all verifications succeeded, false otherwise
+//-----------------------------------------------------------------------------
+static bool AuthBench_RunWorkers(const AuthBenchContext_s& ctx, const int numVerifications, CCycleCount& duration)
+{
+	std::atomic<bool> bSuccess(true);
+	std::vector<std::thread> workers;
+
+	CFastTimer timer;
+	timer.Start();
+
+	for (int t = 0; t < AUTHBENCH_WORKER_COUNT; t++)
+	{
+		const int begin = numVerifications * t / AUTHBENCH_WORKER_COUNT;
+		const int end = numVerifications * (t + 1) / AUTHBENCH_WORKER_COUNT;
+
+		workers.emplace_back([&, begin, end]()
+			{
+				CCycleCount workerTime;
+
+				if (!AuthBench_RunInline(ctx, end - begin, true, workerTime))
+					bSuccess = false;
+			});
+	}
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	timer.End();
+	duration += timer.GetDuration();
+
+	return bSuccess;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	const int numVerifications = Benchmark_GetArgInt(argc, argv, 1, 2000);
+
+	AuthBenchContext_s ctx;
+
+	if (!AuthBench_CreateKeys(ctx) || !AuthBench_CreateToken(ctx))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "Failed to create the signing key and token!\n");
+		Benchmark_Shutdown();
+
+		return EXIT_FAILURE;
+	}
+
+	// Both paths have to accept the token and reject the tampered one before
+	// any numbers are reported.
+	if (!AuthBench_Verify(ctx, ctx.token, nullptr) || !AuthBench_Verify(ctx, ctx.token, AuthBench_GetKey(ctx)) ||
+		AuthBench_Verify(ctx, ctx.tamperedToken, nullptr) || AuthBench_Verify(ctx, ctx.tamperedToken, AuthBench_GetKey(ctx)))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "Token verification results differ from the expected results!\n");
+		Benchmark_Shutdown();
+
+		return EXIT_FAILURE;
+	}
+
+	Msg(eDLL_T::SERVER, "Verifying '%d' tokens signed with a '%d' bit key\n", numVerifications, AUTHBENCH_KEY_BITS);
+
+	CCycleCount parseTime, cachedTime, workerTime;
+
+	if (!AuthBench_RunInline(ctx, numVerifications, false, parseTime) ||
+		!AuthBench_RunInline(ctx, numVerifications, true, cachedTime) ||
+		!AuthBench_RunWorkers(ctx, numVerifications, workerTime))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "Token verification failed!\n");
+		Benchmark_Shutdown();
+
+		return EXIT_FAILURE;
+	}
+
+	char szName[64];
+
+	Benchmark_Report("Key parsed per verification", parseTime, numVerifications, "verification");
+	Benchmark_Report("Key parsed once", cachedTime, numVerifications, "verification");
+
+	snprintf(szName, sizeof(szName), "Key parsed once, %d workers", AUTHBENCH_WORKER_COUNT);
+	Benchmark_Report(szName, workerTime, numVerifications, "verification");
+
+	Benchmark_ReportSpeedup("Key parsed once speedup", parseTime, cachedTime);
+
+	snprintf(szName, sizeof(szName), "Key parsed once, %d workers speedup", AUTHBENCH_WORKER_COUNT);
+	Benchmark_ReportSpeedup(szName, parseTime, workerTime);
+
+	Benchmark_Shutdown();
+	return EXIT_SUCCESS;
+}
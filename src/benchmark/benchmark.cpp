@@ -0,0 +1,84 @@
+//=============================================================================//
+//
+// Purpose: shared setup and reporting for the standalone benchmarks
+//
+//=============================================================================//
+#include "core/logdef.h"
+#include "core/logger.h"
+#include "tier0/cpu.h"
+#include "windows/console.h"
+#include "benchmark.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: init
+//-----------------------------------------------------------------------------
+void Benchmark_Init(void)
+{
+	CheckSystemCPUForSSE2();
+
+	// Init time.
+	Plat_FloatTime();
+
+	g_CoreMsgVCallback = EngineLoggerSink;
+
+	Console_ColorInit();
+	SpdLog_Init(true);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: shutdown
+//-----------------------------------------------------------------------------
+void Benchmark_Shutdown(void)
+{
+	// Must be done to flush all buffers.
+	SpdLog_Shutdown();
+	Console_Shutdown();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets an optional integer argument from the command line
+// Input  : argc - 
+//			*argv[] - 
+//			index - 
+//			defaultValue - 
+// Output : the argument value, or defaultValue if it wasn't passed
+//-----------------------------------------------------------------------------
+int Benchmark_GetArgInt(const int argc, char* argv[], const int index, const int defaultValue)
+{
+	if (index >= argc)
+		return defaultValue;
+
+	const int value = atoi(argv[index]);
+	return value > 0 ? value : defaultValue;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reports the time taken to process the given number of items
+// Input  : *pszName - 
+//			&duration - 
+//			numItems - 
+//			*pszUnit - 
+//-----------------------------------------------------------------------------
+void Benchmark_Report(const char* const pszName, const CCycleCount& duration, const uint64_t numItems, const char* const pszUnit)
+{
+	const double cycles = (double)duration.GetLongCycles();
+	const double seconds = duration.GetSeconds();
+
+	Msg(eDLL_T::COMMON, "%-40s: %10.3f ms; %10.3f cycles/%s; %14.1f %ss/s\n", pszName,
+		seconds * 1000.0, numItems ? cycles / (double)numItems : 0.0, pszUnit,
+		seconds > 0.0 ? (double)numItems / seconds : 0.0, pszUnit);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reports how much faster the new implementation is
+// Input  : *pszName - 
+//			&oldDuration - 
+//			&newDuration - 
+//-----------------------------------------------------------------------------
+void Benchmark_ReportSpeedup(const char* const pszName, const CCycleCount& oldDuration, const CCycleCount& newDuration)
+{
+	const uint64_t newCycles = newDuration.GetLongCycles();
+
+	Msg(eDLL_T::COMMON, "%-40s: %10.3fx\n", pszName,
+		newCycles ? (double)oldDuration.GetLongCycles() / (double)newCycles : 0.0);
+}
@@ -0,0 +1,18 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include "tier0/fasttimer.h"
+
+//-----------------------------------------------------------------------------
+// Shared setup and reporting for the standalone benchmarks; every benchmark
+// measures the old and new implementation within the same process, and
+// checks that both produce the same results before reporting any numbers.
+//-----------------------------------------------------------------------------
+void Benchmark_Init(void);
+void Benchmark_Shutdown(void);
+
+int Benchmark_GetArgInt(const int argc, char* argv[], const int index, const int defaultValue);
+
+void Benchmark_Report(const char* const pszName, const CCycleCount& duration, const uint64_t numItems, const char* const pszUnit);
+void Benchmark_ReportSpeedup(const char* const pszName, const CCycleCount& oldDuration, const CCycleCount& newDuration);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,34 @@
+//=============================================================================//
+//
+// Purpose: reference copy of the CRC-32, as it was before it got the slicing
+//          and folding paths; the hash benchmark compares the output and
+//          speed of the current CRC-32 against this one
+//
+//=============================================================================//
+#include "crc32_ref.h"
+
+// Karl Malbrain's compact CRC-32, with pre and post conditioning. 
+// See "A compact CCITT crc16 and crc32 C implementation that balances processor cache usage against speed": 
+// http://www.geocities.com/malbrain/
+static const uint32_t s_crc32Ref[16] =
+{
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+uint32_t CRC32Ref_Update(uint32_t crc, const uint8_t* ptr, size_t buf_len)
+{
+	if (!ptr)
+	{
+		return NULL;
+	}
+
+	crc = ~crc;
+	while (buf_len--)
+	{
+		uint8_t b = *ptr++;
+		crc = (crc >> 4) ^ s_crc32Ref[(crc & 0xF) ^ (b & 0xF)];
+		crc = (crc >> 4) ^ s_crc32Ref[(crc & 0xF) ^ (b >> 4)];
+	}
+	return ~crc;
+}
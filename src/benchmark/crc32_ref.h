@@ -0,0 +1,6 @@
+#ifndef BENCHMARK_CRC32_REF_H
+#define BENCHMARK_CRC32_REF_H
+
+extern uint32_t CRC32Ref_Update(uint32_t crc, const uint8_t* ptr, size_t buf_len);
+
+#endif // BENCHMARK_CRC32_REF_H
@@ -0,0 +1,309 @@
+//=============================================================================//
+//
+// Purpose: hashing benchmark; checks that the slicing and folding paths of the
+//          CRC-32 produce the same results as the reference CRC-32, and reports
+//          the cycles spent per byte by the CRC-32, Adler-32, SHA-1 and the
+//          generic hashes across buffer sizes
+//
+//=============================================================================//
+#include <random>
+#include "tier0/cpu.h"
+#include "tier0/fasttimer.h"
+#include "tier1/generichash.h"
+#include "mathlib/adler32.h"
+#include "mathlib/crc32.h"
+#include "mathlib/sha1.h"
+#include "benchmark.h"
+#include "crc32_ref.h"
+
+// largest length verified byte by byte, larger buffers are verified at a few
+// lengths around each size benchmarked
+#define HASHBENCH_VERIFY_MAX_LENGTH 1024
+#define HASHBENCH_VERIFY_ALIGNMENTS 16
+
+// the folding path requires a multiple of 16 bytes and at least 64
+#define HASHBENCH_PCLMUL_MIN_LENGTH 64
+
+static const size_t s_HashBenchSizes[] =
+{
+	64, 1024, 16 * 1024, 256 * 1024, 4 * 1024 * 1024
+};
+
+// keeps the compiler from dropping the hashing
+static volatile uint64_t s_HashBenchSink;
+
+typedef uint64_t (*HashBenchFn_t)(const uint8_t* const pData, const size_t nSize);
+
+static uint64_t HashBench_CRC32Ref(const uint8_t* const pData, const size_t nSize)
+{
+	return CRC32Ref_Update(0, pData, nSize);
+}
+
+static uint64_t HashBench_CRC32(const uint8_t* const pData, const size_t nSize)
+{
+	return crc32::update(0, pData, nSize);
+}
+
+static uint64_t HashBench_CRC32Slice16(const uint8_t* const pData, const size_t nSize)
+{
+	return ~crc32::update_slice16(~0u, pData, nSize);
+}
+
+// only valid on sizes the folding path takes, which all benchmarked sizes are
+static uint64_t HashBench_CRC32PCLMUL(const uint8_t* const pData, const size_t nSize)
+{
+	return ~crc32::update_pclmul(~0u, pData, nSize);
+}
+
+static uint64_t HashBench_Adler32(const uint8_t* const pData, const size_t nSize)
+{
+	return adler32::update(1, pData, nSize);
+}
+
+static uint64_t HashBench_HashBlock(const uint8_t* const pData, const size_t nSize)
+{
+	return HashBlock(pData, static_cast<unsigned>(nSize));
+}
+
+static uint64_t HashBench_MurmurHash2(const uint8_t* const pData, const size_t nSize)
+{
+	return MurmurHash2(pData, static_cast<int>(nSize), 0);
+}
+
+static uint64_t HashBench_MurmurHash64(const uint8_t* const pData, const size_t nSize)
+{
+	return MurmurHash64(pData, static_cast<int>(nSize), 0);
+}
+
+struct HashBenchFn_s
+{
+	const char* pszName;
+	HashBenchFn_t hashFn;
+};
+
+// hashes that are only measured, the CRC-32 is measured on each path apart
+static const HashBenchFn_s s_HashBenchFns[] =
+{
+	{ "adler32", HashBench_Adler32 },
+	{ "HashBlock", HashBench_HashBlock },
+	{ "MurmurHash2", HashBench_MurmurHash2 },
+	{ "MurmurHash64", HashBench_MurmurHash64 },
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: verifies a single CRC-32 computation on all paths
+// Input  : nSeed -
+//			*pData -
+//			nSize -
+//			bPCLMUL - whether the folding path can be used
+// Output : true if all paths match the reference, false otherwise
+//-----------------------------------------------------------------------------
+static bool HashBench_VerifyCRC32(const uint32_t nSeed, const uint8_t* const pData, const size_t nSize, const bool bPCLMUL)
+{
+	const uint32_t nExpected = CRC32Ref_Update(nSeed, pData, nSize);
+
+	const uint32_t nCurrent = crc32::update(nSeed, pData, nSize);
+	const uint32_t nSlice16 = ~crc32::update_slice16(~nSeed, pData, nSize);
+
+	if (nCurrent != nExpected || nSlice16 != nExpected)
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "CRC-32 mismatch for '%zu' bytes at '%p' with seed '%08X': expected '%08X', update '%08X', slicing '%08X'\n",
+			nSize, pData, nSeed, nExpected, nCurrent, nSlice16);
+
+		return false;
+	}
+
+	if (bPCLMUL && nSize >= HASHBENCH_PCLMUL_MIN_LENGTH && (nSize % 16) == 0)
+	{
+		const uint32_t nFolded = ~crc32::update_pclmul(~nSeed, pData, nSize);
+
+		if (nFolded != nExpected)
+		{
+			Error(eDLL_T::COMMON, NO_ERROR, "CRC-32 mismatch for '%zu' bytes at '%p' with seed '%08X': expected '%08X', folding '%08X'\n",
+				nSize, pData, nSeed, nExpected, nFolded);
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: verifies the CRC-32 paths over all small lengths and alignments,
+//          and around each benchmarked size
+// Input  : *pBuffer - at least the largest benchmarked size plus slack
+//			bPCLMUL -
+//			&rng -
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+static bool HashBench_VerifyCRC32Paths(const uint8_t* const pBuffer, const bool bPCLMUL, std::mt19937& rng)
+{
+	if (CRC32Ref_Update(0, NULL, 16) != crc32::update(0, NULL, 16))
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "CRC-32 of a NULL buffer differs from the reference\n");
+		return false;
+	}
+
+	for (size_t nAlign = 0; nAlign < HASHBENCH_VERIFY_ALIGNMENTS; nAlign++)
+	{
+		for (size_t nSize = 0; nSize <= HASHBENCH_VERIFY_MAX_LENGTH; nSize++)
+		{
+			if (!HashBench_VerifyCRC32(rng(), pBuffer + nAlign, nSize, bPCLMUL))
+				return false;
+		}
+	}
+
+	for (const size_t nBaseSize : s_HashBenchSizes)
+	{
+		for (size_t nSize = nBaseSize - 17; nSize <= nBaseSize + 17; nSize++)
+		{
+			const size_t nAlign = rng() % HASHBENCH_VERIFY_ALIGNMENTS;
+
+			if (!HashBench_VerifyCRC32(rng(), pBuffer + nAlign, nSize, bPCLMUL))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: hashes the buffer repeatedly
+// Input  : hashFn -
+//			*pData -
+//			nSize -
+//			nIterations -
+// Output : time spent hashing
+//-----------------------------------------------------------------------------
+static CCycleCount HashBench_Run(const HashBenchFn_t hashFn, const uint8_t* const pData, const size_t nSize, const size_t nIterations)
+{
+	uint64_t nSink = 0;
+
+	CFastTimer timer;
+	timer.Start();
+
+	for (size_t i = 0; i < nIterations; i++)
+		nSink += hashFn(pData, nSize);
+
+	timer.End();
+	s_HashBenchSink = nSink;
+
+	return timer.GetDuration();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: SHA-1 only takes strings, so the string is created up front and
+//          isn't part of the measurements
+// Input  : &data -
+//			nIterations -
+// Output : time spent hashing
+//-----------------------------------------------------------------------------
+static CCycleCount HashBench_RunSHA1(const std::string& data, const size_t nIterations)
+{
+	uint64_t nSink = 0;
+
+	CFastTimer timer;
+	timer.Start();
+
+	for (size_t i = 0; i < nIterations; i++)
+	{
+		SHA1 checksum;
+		checksum.update(data);
+
+		nSink += checksum.final().size();
+	}
+
+	timer.End();
+	s_HashBenchSink = nSink;
+
+	return timer.GetDuration();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	// Amount of data hashed per function and buffer size.
+	const int nTotalMB = Benchmark_GetArgInt(argc, argv, 1, 256);
+
+	if (nTotalMB <= 0)
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "Usage: hash_bench [totalMB]\n");
+
+		Benchmark_Shutdown();
+		return EXIT_FAILURE;
+	}
+
+	const CPUInformation& pi = GetCPUInformation();
+	const bool bPCLMUL = pi.m_bPCLMUL && pi.m_bSSE41;
+
+	const size_t nMaxSize = s_HashBenchSizes[V_ARRAYSIZE(s_HashBenchSizes) - 1];
+	const size_t nBufferSize = nMaxSize + 64;
+
+	std::unique_ptr<uint8_t[]> pBuffer(new uint8_t[nBufferSize]);
+	std::mt19937 rng(1337);
+
+	for (size_t i = 0; i < nBufferSize; i++)
+		pBuffer[i] = static_cast<uint8_t>(rng());
+
+	if (!bPCLMUL)
+		Warning(eDLL_T::COMMON, "CPU lacks PCLMULQDQ or SSE4.1; the CRC-32 folding path is not verified or measured\n");
+
+	if (!HashBench_VerifyCRC32Paths(pBuffer.get(), bPCLMUL, rng))
+	{
+		Benchmark_Shutdown();
+		return EXIT_FAILURE;
+	}
+
+	Msg(eDLL_T::COMMON, "CRC-32 paths match the reference\n");
+
+	const uint64_t nTotalBytes = uint64_t(nTotalMB) * 1024 * 1024;
+
+	for (const size_t nSize : s_HashBenchSizes)
+	{
+		const size_t nIterations = Max<size_t>(size_t(nTotalBytes / nSize), 1);
+		const uint64_t nBytes = uint64_t(nIterations) * nSize;
+
+		char szName[64];
+
+		const CCycleCount refTime = HashBench_Run(HashBench_CRC32Ref, pBuffer.get(), nSize, nIterations);
+		const CCycleCount sliceTime = HashBench_Run(HashBench_CRC32Slice16, pBuffer.get(), nSize, nIterations);
+		const CCycleCount crcTime = HashBench_Run(HashBench_CRC32, pBuffer.get(), nSize, nIterations);
+
+		snprintf(szName, sizeof(szName), "%zu bytes, crc32 reference", nSize);
+		Benchmark_Report(szName, refTime, nBytes, "byte");
+
+		snprintf(szName, sizeof(szName), "%zu bytes, crc32 slicing", nSize);
+		Benchmark_Report(szName, sliceTime, nBytes, "byte");
+
+		if (bPCLMUL)
+		{
+			snprintf(szName, sizeof(szName), "%zu bytes, crc32 folding", nSize);
+			Benchmark_Report(szName, HashBench_Run(HashBench_CRC32PCLMUL, pBuffer.get(), nSize, nIterations), nBytes, "byte");
+		}
+
+		snprintf(szName, sizeof(szName), "%zu bytes, crc32", nSize);
+		Benchmark_Report(szName, crcTime, nBytes, "byte");
+
+		snprintf(szName, sizeof(szName), "%zu bytes, crc32 speedup", nSize);
+		Benchmark_ReportSpeedup(szName, refTime, crcTime);
+
+		for (const HashBenchFn_s& hash : s_HashBenchFns)
+		{
+			snprintf(szName, sizeof(szName), "%zu bytes, %s", nSize, hash.pszName);
+			Benchmark_Report(szName, HashBench_Run(hash.hashFn, pBuffer.get(), nSize, nIterations), nBytes, "byte");
+		}
+
+		const std::string data(reinterpret_cast<const char*>(pBuffer.get()), nSize);
+
+		snprintf(szName, sizeof(szName), "%zu bytes, sha1", nSize);
+		Benchmark_Report(szName, HashBench_RunSHA1(data, nIterations), nBytes, "byte");
+	}
+
+	Benchmark_Shutdown();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+//=============================================================================//
+//
+// Purpose: logger contention benchmark; logs from a growing number of threads
+//          at once, with records written on the calling thread under the log
+//          mutex, and handed to the log writer thread, and reports the cycles
+//          each logging call costs its caller
+//
+//=============================================================================//
+#include "tier0/fasttimer.h"
+#include "core/logdef.h"
+#include "core/logger.h"
+#include "benchmark.h"
+
+//-----------------------------------------------------------------------------
+// Purpose: logs from all threads at once
+// Input  : numThreads -
+//			numMessages - number of messages per thread
+//			&duration - time spent in the logging calls, summed over all threads
+//-----------------------------------------------------------------------------
+static void LoggerBench_Run(const int numThreads, const int numMessages, CCycleCount& duration)
+{
+	std::vector<CCycleCount> threadDurations(numThreads);
+	std::vector<std::thread> threads;
+
+	std::atomic<int> numReady(0);
+
+	for (int t = 0; t < numThreads; t++)
+	{
+		threads.emplace_back([&, t]()
+			{
+				// Start logging at the same time, so the calls contend.
+				numReady++;
+
+				while (numReady < numThreads)
+					std::this_thread::yield();
+
+				CFastTimer timer;
+				timer.Start();
+
+				for (int i = 0; i < numMessages; i++)
+				{
+					CoreMsg(LogType_t::LOG_INFO, LogLevel_t::LEVEL_DISK_ONLY, eDLL_T::COMMON, NO_ERROR,
+						"logger_bench", "Thread '%d' logged message '%d' of '%d'\n", t, i, numMessages);
+				}
+
+				timer.End();
+				threadDurations[t] = timer.GetDuration();
+			});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	for (const CCycleCount& threadDuration : threadDurations)
+		duration += threadDuration;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	const int maxThreads = Benchmark_GetArgInt(argc, argv, 1, Max(int(std::thread::hardware_concurrency()), 1));
+	const int numMessages = Benchmark_GetArgInt(argc, argv, 2, 20000);
+
+	// Records are only written to this file, so the terminal doesn't take
+	// part in the measurements.
+	SpdLog_InstallSupplementalLogger("logger_bench", "logger_bench.log");
+
+	Msg(eDLL_T::COMMON, "Logging '%d' messages per thread with up to '%d' threads\n", numMessages, maxThreads);
+
+	for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		const uint64_t totalMessages = uint64_t(numThreads) * numMessages;
+
+		// Written on the calling thread under the log mutex.
+		EngineLoggerSink_StopWriter();
+
+		CCycleCount directTime;
+		LoggerBench_Run(numThreads, numMessages, directTime);
+
+		// Handed to the log writer thread, the time it takes to write the
+		// remaining records after the callers are done is measured apart.
+		EngineLoggerSink_StartWriter();
+
+		CCycleCount writerTime;
+		LoggerBench_Run(numThreads, numMessages, writerTime);
+
+		CFastTimer drainTimer;
+		drainTimer.Start();
+
+		EngineLoggerSink_StopWriter();
+
+		drainTimer.End();
+		EngineLoggerSink_StartWriter();
+
+		char szName[64];
+
+		snprintf(szName, sizeof(szName), "%d thread(s), calling thread", numThreads);
+		Benchmark_Report(szName, directTime, totalMessages, "call");
+
+		snprintf(szName, sizeof(szName), "%d thread(s), writer thread", numThreads);
+		Benchmark_Report(szName, writerTime, totalMessages, "call");
+
+		snprintf(szName, sizeof(szName), "%d thread(s), writer drain", numThreads);
+		Benchmark_Report(szName, drainTimer.GetDuration(), totalMessages, "call");
+
+		snprintf(szName, sizeof(szName), "%d thread(s) speedup", numThreads);
+		Benchmark_ReportSpeedup(szName, directTime, writerTime);
+	}
+
+	Benchmark_Shutdown();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,233 @@
+//=============================================================================//
+//
+// Purpose: RTech pak decoder benchmark; decodes a pak with the reference and
+//          the current decoder, checks that both produce the same data and
+//          reports the cycles spent per decoded byte
+//
+//=============================================================================//
+#include "tier0/binstream.h"
+#include "tier0/fasttimer.h"
+#include "rtech/ipakfile.h"
+#include "rtech/pak/pakdecode.h"
+#include "benchmark.h"
+#include "pakdecode_ref.h"
+
+// the decoders read and write up to a qword past the end of the data, and the
+// literal copies read up to 16 bytes past the end of the input
+#define PAKBENCH_BUFFER_SLACK 64
+
+typedef bool (*PakStreamDecodeFn_t)(PakDecoder_s* const decoder, const size_t inLen, const size_t outLen);
+
+//-----------------------------------------------------------------------------
+// Purpose: runs the current decoder
+//-----------------------------------------------------------------------------
+static bool PakBench_CurrentDecode(PakDecoder_s* const decoder, const size_t inLen, const size_t outLen)
+{
+	return Pak_StreamToBufferDecode(decoder, inLen, outLen, PakDecodeMode_e::MODE_RTECH);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decodes the whole pak into a flat output buffer
+// Input  : decodeFn -
+//			*inBuf -
+//			*outBuf -
+//			&duration -
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+static bool PakBench_DecodeBuffer(const PakStreamDecodeFn_t decodeFn, const uint8_t* const inBuf,
+	uint8_t* const outBuf, CCycleCount& duration)
+{
+	const PakFileHeader_s* const header = reinterpret_cast<const PakFileHeader_s*>(inBuf);
+
+	CFastTimer timer;
+	timer.Start();
+
+	PakDecoder_s decoder{};
+	Pak_InitDecoder(&decoder, inBuf, outBuf, UINT64_MAX, UINT64_MAX, header->compressedSize,
+		NULL, sizeof(PakFileHeader_s), PakDecodeMode_e::MODE_RTECH);
+
+	const bool decoded = decodeFn(&decoder, header->compressedSize, header->decompressedSize);
+
+	timer.End();
+	duration += timer.GetDuration();
+
+	return decoded;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: decodes the pak through the output ring buffer like the runtime
+//          does; decoded data is copied out to a flat buffer so it can be
+//          compared, only the time spent in the decoder is measured
+// Input  : decodeFn -
+//			*inBuf -
+//			*ringBuf -
+//			*outBuf -
+//			&duration -
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+static bool PakBench_DecodeRing(const PakStreamDecodeFn_t decodeFn, const uint8_t* const inBuf,
+	uint8_t* const ringBuf, uint8_t* const outBuf, CCycleCount& duration)
+{
+	const PakFileHeader_s* const header = reinterpret_cast<const PakFileHeader_s*>(inBuf);
+
+	PakDecoder_s decoder{};
+	Pak_InitDecoder(&decoder, inBuf, ringBuf, UINT64_MAX, PAK_DECODE_OUT_RING_BUFFER_MASK,
+		header->compressedSize, NULL, sizeof(PakFileHeader_s), PakDecodeMode_e::MODE_RTECH);
+
+	size_t flushedBytePos = sizeof(PakFileHeader_s);
+	bool decoded = false;
+
+	while (!decoded)
+	{
+		const size_t inBytePos = decoder.inBufBytePos;
+
+		CFastTimer timer;
+		timer.Start();
+
+		decoded = decodeFn(&decoder, header->compressedSize, flushedBytePos + PAK_DECODE_OUT_RING_BUFFER_SIZE);
+
+		timer.End();
+		duration += timer.GetDuration();
+
+		const size_t outBytePos = decoder.outBufBytePos;
+
+		if (!decoded && outBytePos == flushedBytePos && decoder.inBufBytePos == inBytePos)
+			return false; // Stalled.
+
+		if (outBytePos > header->decompressedSize)
+			return false;
+
+		while (flushedBytePos != outBytePos)
+		{
+			const size_t bufIndex = flushedBytePos & PAK_DECODE_OUT_RING_BUFFER_MASK;
+			const size_t frameLen = Min(outBytePos - flushedBytePos, PAK_DECODE_OUT_RING_BUFFER_SIZE - bufIndex);
+
+			memcpy(&outBuf[flushedBytePos], &ringBuf[bufIndex], frameLen);
+			flushedBytePos += frameLen;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: compares the data decoded by both decoders
+// Input  : *pszMode -
+//			*refBuf -
+//			*curBuf -
+//			decompressedSize -
+// Output : true if equal, false otherwise
+//-----------------------------------------------------------------------------
+static bool PakBench_CompareOutput(const char* const pszMode, const uint8_t* const refBuf,
+	const uint8_t* const curBuf, const size_t decompressedSize)
+{
+	for (size_t i = sizeof(PakFileHeader_s); i < decompressedSize; i++)
+	{
+		if (refBuf[i] != curBuf[i])
+		{
+			Error(eDLL_T::RTECH, NO_ERROR, "%s: decoded data differs at offset '%zu'!\n", pszMode, i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	if (argc < 2)
+	{
+		Warning(eDLL_T::RTECH, "Usage: pakdecode_bench <pakFile> [<iterations>]\n");
+		Benchmark_Shutdown();
+
+		return EXIT_FAILURE;
+	}
+
+	const char* const pakFile = argv[1];
+	const int iterations = Benchmark_GetArgInt(argc, argv, 2, 10);
+
+	CIOStream pakStream;
+
+	if (!pakStream.Open(pakFile, CIOStream::Mode_e::Read))
+	{
+		Error(eDLL_T::RTECH, NO_ERROR, "Failed to open pak file '%s'!\n", pakFile);
+		Benchmark_Shutdown();
+
+		return EXIT_FAILURE;
+	}
+
+	const size_t fileSize = (size_t)pakStream.GetSize();
+
+	std::unique_ptr<uint8_t[]> inBuf(new uint8_t[fileSize + PAKBENCH_BUFFER_SLACK]());
+	pakStream.Read(inBuf.get(), fileSize);
+
+	const PakFileHeader_s* const header = reinterpret_cast<const PakFileHeader_s*>(inBuf.get());
+
+	if (fileSize < sizeof(PakFileHeader_s) || header->magic != PAK_HEADER_MAGIC ||
+		header->GetCompressionMode() != PakDecodeMode_e::MODE_RTECH || header->compressedSize > fileSize)
+	{
+		Error(eDLL_T::RTECH, NO_ERROR, "Pak file '%s' isn't encoded with the RTech decoder!\n", pakFile);
+		Benchmark_Shutdown();
+
+		return EXIT_FAILURE;
+	}
+
+	const size_t decompressedSize = header->decompressedSize;
+
+	std::unique_ptr<uint8_t[]> refBuf(new uint8_t[decompressedSize + PAKBENCH_BUFFER_SLACK]());
+	std::unique_ptr<uint8_t[]> curBuf(new uint8_t[decompressedSize + PAKBENCH_BUFFER_SLACK]());
+	std::unique_ptr<uint8_t[]> ringBuf(new uint8_t[PAK_DECODE_OUT_RING_BUFFER_SIZE + PAKBENCH_BUFFER_SLACK]());
+
+	Msg(eDLL_T::RTECH, "Decoding '%s' ('%zu' to '%zu' bytes) '%d' times\n",
+		pakFile, (size_t)header->compressedSize, decompressedSize, iterations);
+
+	CCycleCount refBufTime, curBufTime;
+	CCycleCount refRingTime, curRingTime;
+
+	bool failed = false;
+
+	for (int i = 0; i < iterations && !failed; i++)
+	{
+		if (!PakBench_DecodeBuffer(PakRef_StreamToBufferDecode, inBuf.get(), refBuf.get(), refBufTime) ||
+			!PakBench_DecodeBuffer(PakBench_CurrentDecode, inBuf.get(), curBuf.get(), curBufTime))
+		{
+			Error(eDLL_T::RTECH, NO_ERROR, "Buffered decode failed!\n");
+			failed = true;
+		}
+		else if (!PakBench_CompareOutput("Buffered", refBuf.get(), curBuf.get(), decompressedSize))
+			failed = true;
+
+		if (failed)
+			break;
+
+		if (!PakBench_DecodeRing(PakRef_StreamToBufferDecode, inBuf.get(), ringBuf.get(), refBuf.get(), refRingTime) ||
+			!PakBench_DecodeRing(PakBench_CurrentDecode, inBuf.get(), ringBuf.get(), curBuf.get(), curRingTime))
+		{
+			Error(eDLL_T::RTECH, NO_ERROR, "Ring buffered decode failed!\n");
+			failed = true;
+		}
+		else if (!PakBench_CompareOutput("Ring buffered", refBuf.get(), curBuf.get(), decompressedSize))
+			failed = true;
+	}
+
+	if (!failed)
+	{
+		const uint64_t totalBytes = uint64_t(decompressedSize - sizeof(PakFileHeader_s)) * iterations;
+
+		Benchmark_Report("Buffered (reference)", refBufTime, totalBytes, "byte");
+		Benchmark_Report("Buffered (current)", curBufTime, totalBytes, "byte");
+		Benchmark_ReportSpeedup("Buffered speedup", refBufTime, curBufTime);
+
+		Benchmark_Report("Ring buffered (reference)", refRingTime, totalBytes, "byte");
+		Benchmark_Report("Ring buffered (current)", curRingTime, totalBytes, "byte");
+		Benchmark_ReportSpeedup("Ring buffered speedup", refRingTime, curRingTime);
+	}
+
+	Benchmark_Shutdown();
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,488 @@
+//=============================================================================//
+//
+// Purpose: reference copy of the RTech pak decoder, as it was before the copies
+//          got vectorized; the pak decode benchmark compares the output and
+//          speed of the current decoder against this one
+//
+//=============================================================================//
+#include "rtech/ipakfile.h"
+#include "pakdecode_ref.h"
+
+//-----------------------------------------------------------------------------
+// lookup table for default pak decoder
+//-----------------------------------------------------------------------------
+static const unsigned char /*141313180*/ s_defaultDecoderLUT[] =
+{
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF9, 0x04, 0xFD, 0xFC, 0x07, 0x04, 0x05, 0xFF, 0xF4,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF6, 0x04, 0xFD, 0xFC, 0xFB, 0x04, 0x06, 0xFF, 0x0B,
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF8, 0x04, 0xFD, 0xFC, 0x0C, 0x04, 0x05, 0xFF, 0xF7,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF5, 0x04, 0xFD, 0xFC, 0xFA, 0x04, 0x06, 0xFF, 0xF3,
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF9, 0x04, 0xFD, 0xFC, 0x07, 0x04, 0x05, 0xFF, 0xF4,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF6, 0x04, 0xFD, 0xFC, 0xFB, 0x04, 0x06, 0xFF, 0x0E,
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF8, 0x04, 0xFD, 0xFC, 0x0C, 0x04, 0x05, 0xFF, 0x09,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF5, 0x04, 0xFD, 0xFC, 0xFA, 0x04, 0x06, 0xFF, 0xF1,
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF9, 0x04, 0xFD, 0xFC, 0x07, 0x04, 0x05, 0xFF, 0xF4,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF6, 0x04, 0xFD, 0xFC, 0xFB, 0x04, 0x06, 0xFF, 0x0D,
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF8, 0x04, 0xFD, 0xFC, 0x0C, 0x04, 0x05, 0xFF, 0xF7,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF5, 0x04, 0xFD, 0xFC, 0xFA, 0x04, 0x06, 0xFF, 0xF2,
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF9, 0x04, 0xFD, 0xFC, 0x07, 0x04, 0x05, 0xFF, 0xF4,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF6, 0x04, 0xFD, 0xFC, 0xFB, 0x04, 0x06, 0xFF, 0x0F,
+	0x04, 0xFE, 0xFC, 0x08, 0x04, 0xEF, 0x11, 0xF8, 0x04, 0xFD, 0xFC, 0x0C, 0x04, 0x05, 0xFF, 0x0A,
+	0x04, 0xFE, 0xFC, 0x10, 0x04, 0xEF, 0x11, 0xF5, 0x04, 0xFD, 0xFC, 0xFA, 0x04, 0x06, 0xFF, 0xF0,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x11,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0C,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x09,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0E,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x11,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0B,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0A,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x10,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x11,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0C,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x09,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0F,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x11,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0D,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x07, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x0A,
+	0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0x08, 0x04, 0x05, 0x04, 0x06, 0x04, 0x05, 0x04, 0xFF,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x06,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x07,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x06,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x06,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x07,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x06,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x02, 0x04, 0x03, 0x05, 0x02, 0x04, 0x04, 0x06, 0x02, 0x04, 0x03, 0x06, 0x02, 0x05, 0x04, 0x08,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x06,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x07,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x07,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x08,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x06,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x08,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x07,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x08,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x06,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x07,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x07,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x08,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x06,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x08,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x07,
+	0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x01, 0x08,
+	0x00, 0x08, 0x00, 0x04, 0x00, 0x08, 0x00, 0x06, 0x00, 0x08, 0x00, 0x01, 0x00, 0x08, 0x00, 0x0B,
+	0x00, 0x08, 0x00, 0x0C, 0x00, 0x08, 0x00, 0x09, 0x00, 0x08, 0x00, 0x03, 0x00, 0x08, 0x00, 0x0E,
+	0x00, 0x08, 0x00, 0x04, 0x00, 0x08, 0x00, 0x07, 0x00, 0x08, 0x00, 0x02, 0x00, 0x08, 0x00, 0x0D,
+	0x00, 0x08, 0x00, 0x0C, 0x00, 0x08, 0x00, 0x0A, 0x00, 0x08, 0x00, 0x05, 0x00, 0x08, 0x00, 0x0F,
+	0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06,
+	0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06,
+	0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06,
+	0x01, 0x02, 0x01, 0x05, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06, 0x01, 0x02, 0x01, 0x06,
+	0x4A, 0x00, 0x00, 0x00, 0x6A, 0x00, 0x00, 0x00, 0x8A, 0x00, 0x00, 0x00, 0xAA, 0x00, 0x00, 0x00,
+	0xCA, 0x00, 0x00, 0x00, 0xEA, 0x00, 0x00, 0x00, 0x0A, 0x01, 0x00, 0x00, 0x2A, 0x01, 0x00, 0x00,
+	0x4A, 0x01, 0x00, 0x00, 0x6A, 0x01, 0x00, 0x00, 0x8A, 0x01, 0x00, 0x00, 0xAA, 0x01, 0x00, 0x00,
+	0xAA, 0x03, 0x00, 0x00, 0xAA, 0x05, 0x00, 0x00, 0xAA, 0x25, 0x00, 0x00, 0xAA, 0x25, 0x02, 0x00,
+	0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x09, 0x09, 0x0D, 0x11, 0x15,
+	0x00, 0x00, 0x02, 0x04, 0x06, 0x08, 0x0A, 0x2A, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x05, 0x05,
+	0x11, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0xBF,
+	0xA8, 0xAA, 0x2A, 0xBE, 0xA8, 0xAA, 0x2A, 0xBE, 0xA8, 0xAA, 0x2A, 0xBE, 0xA8, 0xAA, 0x2A, 0xBE,
+	0xD2, 0x85, 0x08, 0x3C, 0xD2, 0x85, 0x08, 0x3C, 0xD2, 0x85, 0x08, 0x3C, 0xD2, 0x85, 0x08, 0x3C,
+	0x83, 0xF9, 0x22, 0x3F, 0x83, 0xF9, 0x22, 0x3F, 0x83, 0xF9, 0x22, 0x3F, 0x83, 0xF9, 0x22, 0x3F,
+	0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+	0x00, 0x10, 0xC9, 0x3F, 0x00, 0x10, 0xC9, 0x3F, 0x00, 0x10, 0xC9, 0x3F, 0x00, 0x10, 0xC9, 0x3F,
+	0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x3F,
+	0x02, 0x61, 0x4D, 0xB9, 0x02, 0x61, 0x4D, 0xB9, 0x02, 0x61, 0x4D, 0xB9, 0x02, 0x61, 0x4D, 0xB9,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+	0xC2, 0x14, 0xCF, 0x37, 0xC2, 0x14, 0xCF, 0x37, 0xC2, 0x14, 0xCF, 0x37, 0xC2, 0x14, 0xCF, 0x37,
+	0x9E, 0x4B, 0x6F, 0xB0, 0x9E, 0x4B, 0x6F, 0xB0, 0x9E, 0x4B, 0x6F, 0xB0, 0x9E, 0x4B, 0x6F, 0xB0,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x00, 0x03, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
+	0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xF1, 0x1D, 0xC1, 0xF6, 0x7F, 0x00, 0x00,
+	0x22, 0x0B, 0xB6, 0xBA, 0x22, 0x0B, 0xB6, 0xBA, 0x22, 0x0B, 0xB6, 0xBA, 0x22, 0x0B, 0xB6, 0xBA,
+	0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x3F,
+	0x02, 0x61, 0x4D, 0xB9, 0x02, 0x61, 0x4D, 0xB9, 0x02, 0x61, 0x4D, 0xB9, 0x02, 0x61, 0x4D, 0xB9,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+	0xC2, 0x14, 0xCF, 0x37, 0xC2, 0x14, 0xCF, 0x37, 0xC2, 0x14, 0xCF, 0x37, 0xC2, 0x14, 0xCF, 0x37,
+	0x9E, 0x4B, 0x6F, 0xB0, 0x9E, 0x4B, 0x6F, 0xB0, 0x9E, 0x4B, 0x6F, 0xB0, 0x9E, 0x4B, 0x6F, 0xB0,
+	0x22, 0x0B, 0xB6, 0xBA, 0x22, 0x0B, 0xB6, 0xBA, 0x22, 0x0B, 0xB6, 0xBA, 0x22, 0x0B, 0xB6, 0xBA,
+	0x00, 0x70, 0x95, 0xB6, 0x00, 0x70, 0x95, 0xB6, 0x00, 0x70, 0x95, 0xB6, 0x00, 0x70, 0x95, 0xB6,
+	0xA9, 0xAA, 0x2A, 0x3D, 0xA9, 0xAA, 0x2A, 0x3D, 0xA9, 0xAA, 0x2A, 0x3D, 0xA9, 0xAA, 0x2A, 0x3D,
+	0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x80, 0x3F,
+	0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0xBF,
+	0xA8, 0xAA, 0x2A, 0xBE, 0xA8, 0xAA, 0x2A, 0xBE, 0xA8, 0xAA, 0x2A, 0xBE, 0xA8, 0xAA, 0x2A, 0xBE,
+	0xD2, 0x85, 0x08, 0x3C, 0xD2, 0x85, 0x08, 0x3C, 0xD2, 0x85, 0x08, 0x3C, 0xD2, 0x85, 0x08, 0x3C,
+	0x83, 0xF9, 0x22, 0x3F, 0x83, 0xF9, 0x22, 0x3F, 0x83, 0xF9, 0x22, 0x3F, 0x83, 0xF9, 0x22, 0x3F,
+	0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+	0x00, 0x10, 0xC9, 0x3F, 0x00, 0x10, 0xC9, 0x3F, 0x00, 0x10, 0xC9, 0x3F, 0x00, 0x10, 0xC9, 0x3F,
+	0x4C, 0x39, 0x56, 0x75, 0x42, 0x52, 0x65, 0x75, 0x70, 0x35, 0x31, 0x77, 0x4C, 0x51, 0x64, 0x61,
+};
+
+//-----------------------------------------------------------------------------
+// checks if we have enough output buffer room to decode the data stream
+//-----------------------------------------------------------------------------
+static bool PakRef_HasEnoughDecodeBufferAvailable(PakDecoder_s* const decoder, const size_t outLen)
+{
+	const uint64_t bytesWritten = (decoder->outBufBytePos & ~decoder->outputInvMask);
+	return (outLen >= decoder->outputInvMask + (bytesWritten +1) || outLen >= decoder->decompSize);
+}
+
+//-----------------------------------------------------------------------------
+// checks if we have enough source data streamed to decode the next block
+//-----------------------------------------------------------------------------
+static bool PakRef_HasEnoughStreamedDataForDecode(PakDecoder_s* const decoder, const size_t inLen)
+{
+	return (inLen >= decoder->bufferSizeNeeded);
+}
+
+//-----------------------------------------------------------------------------
+// decodes the RTech data stream up to available buffer or data
+//-----------------------------------------------------------------------------
+static bool PakRef_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLen, const size_t outLen)
+{
+	bool result; // al
+	uint64_t outBufBytePos; // r15
+	uint8_t* outputBuf; // r11
+	uint32_t currentBit; // ebp
+	uint64_t currentByte; // rsi
+	uint64_t inBufBytePos; // rdi
+	size_t qword70; // r12
+	const uint8_t* inputBuf; // r13
+	uint32_t dword6C; // ecx
+	uint64_t v13; // rsi
+	unsigned __int64 i; // rax
+	unsigned __int64 v15; // r8
+	__int64 v16; // r9
+	int v17; // ecx
+	unsigned __int64 v18; // rax
+	uint64_t v19; // rsi
+	__int64 v20; // r14
+	int v21; // ecx
+	unsigned __int64 v22; // r11
+	int v23; // edx
+	uint64_t outputMask; // rax
+	int v25; // r8d
+	unsigned int v26; // r13d
+	uint64_t v27; // r10
+	uint8_t* v28; // rax
+	uint8_t* v29; // r10
+	size_t decompSize; // r9
+	uint64_t inputInvMask; // r10
+	uint64_t headerOffset; // r8
+	uint64_t v33; // rax
+	uint64_t v34; // rax
+	uint64_t v35; // rax
+	size_t v36; // rcx
+	__int64 v37; // rdx
+	size_t v38; // r14
+	size_t v39; // r11
+	uint64_t v40; // cl
+	uint64_t v41; // rsi
+	__int64 v42; // rcx
+	uint64_t v43; // r8
+	int v44; // r11d
+	unsigned __int8 v45; // r9
+	uint64_t v46; // rcx
+	uint64_t v47; // rcx
+	__int64 v48; // r9
+	__int64 m; // r8
+	__int64 v50; // r9d
+	__int64 v51; // r8
+	__int64 v52; // rdx
+	__int64 k; // r8
+	signed __int64 v54; // r10
+	__int64 v55; // rdx
+	unsigned int v56; // r14d
+	const uint8_t* v57; // rdx
+	uint8_t* v58; // r8
+	uint64_t v59; // al
+	uint64_t v60; // rsi
+	__int64 v61; // rax
+	uint64_t v62; // r9
+	int v63; // r10d
+	unsigned __int8 v64; // cl
+	uint64_t v65; // rax
+	unsigned int v66; // r14d
+	unsigned int j; // ecx
+	__int64 v68; // rax
+	uint64_t v69; // rcx
+	uint8_t* v70; // [rsp+0h] [rbp-58h]
+	uint32_t v71; // [rsp+60h] [rbp+8h]
+	const uint8_t* v74; // [rsp+78h] [rbp+20h]
+
+	outBufBytePos = decoder->outBufBytePos;
+
+	outputBuf = decoder->outputBuf;
+	currentBit = decoder->currentBit;
+	currentByte = decoder->currentByte;
+	inBufBytePos = decoder->inBufBytePos;
+	qword70 = decoder->qword70;
+	inputBuf = decoder->inputBuf;
+
+	if (decoder->compressedStreamSize < qword70)
+		qword70 = decoder->compressedStreamSize;
+
+	dword6C = decoder->dword6C;
+	v74 = inputBuf;
+	v70 = outputBuf;
+	v71 = dword6C;
+	if (!currentBit)
+		goto LABEL_11;
+
+	v13 = (*(_QWORD*)&inputBuf[inBufBytePos & decoder->inputMask] << (64 - (unsigned __int8)currentBit)) | currentByte;
+	for (i = currentBit; ; i = currentBit)
+	{
+		currentBit &= 7u;
+		inBufBytePos += i >> 3;
+		dword6C = v71;
+		currentByte = (0xFFFFFFFFFFFFFFFFui64 >> currentBit) & v13;
+	LABEL_11:
+		v15 = (unsigned __int64)dword6C << 8;
+		v16 = dword6C;
+		v17 = s_defaultDecoderLUT[(unsigned __int8)currentByte + 512 + v15];
+		v18 = (unsigned __int8)currentByte + v15;
+		currentBit += v17;
+		v19 = currentByte >> v17;
+		v20 = (unsigned int)(char)s_defaultDecoderLUT[v18];
+		if ((s_defaultDecoderLUT[v18] & 0x80u) != 0)
+		{
+			v56 = -(int)v20;
+			v57 = &inputBuf[inBufBytePos & decoder->inputMask];
+			v71 = 1;
+			v58 = &outputBuf[outBufBytePos & decoder->outputMask];
+			if (v56 == s_defaultDecoderLUT[v16 + 1248])
+			{
+				if ((~inBufBytePos & decoder->inputInvMask) < 0xF || (decoder->outputInvMask & ~outBufBytePos) < 0xF || decoder->decompSize - outBufBytePos < 0x10)
+					v56 = 1;
+				v59 = v19;
+				v60 = v19 >> 3;
+				v61 = v59 & 7;
+				v62 = v60;
+				if (v61)
+				{
+					v63 = s_defaultDecoderLUT[v61 + 1232];
+					v64 = s_defaultDecoderLUT[v61 + 1240];
+				}
+				else
+				{
+					v62 = v60 >> 4;
+					v65 = v60 & 0xF;
+					currentBit += 4;
+					v63 = *(_DWORD*)&s_defaultDecoderLUT[4 * v65 + 1152];
+					v64 = s_defaultDecoderLUT[v65 + 1216];
+				}
+				currentBit += v64 + 3;
+				v19 = v62 >> v64;
+				v66 = v63 + (v62 & ((1 << v64) - 1)) + v56;
+				for (j = v66 >> 3; j; --j)
+				{
+					v68 = *(_QWORD*)v57;
+					v57 += 8;
+					*(_QWORD*)v58 = v68;
+					v58 += 8;
+				}
+				if ((v66 & 4) != 0)
+				{
+					*(_DWORD*)v58 = *(_DWORD*)v57;
+					v58 += 4;
+					v57 += 4;
+				}
+				if ((v66 & 2) != 0)
+				{
+					*(_WORD*)v58 = *(_WORD*)v57;
+					v58 += 2;
+					v57 += 2;
+				}
+				if ((v66 & 1) != 0)
+					*v58 = *v57;
+				inBufBytePos += v66;
+				outBufBytePos += v66;
+			}
+			else
+			{
+				*(_QWORD*)v58 = *(_QWORD*)v57;
+				*((_QWORD*)v58 + 1) = *((_QWORD*)v57 + 1);
+				inBufBytePos += v56;
+				outBufBytePos += v56;
+			}
+		}
+		else
+		{
+			v21 = v19 & 0xF;
+			v71 = 0;
+			v22 = ((unsigned __int64)(unsigned int)v19 >> (((unsigned int)(v21 - 31) >> 3) & 6)) & 0x3F;
+			v23 = 1 << (v21 + ((v19 >> 4) & ((24 * (((unsigned int)(v21 - 31) >> 3) & 2)) >> 4)));
+			currentBit += (((unsigned int)(v21 - 31) >> 3) & 6) + s_defaultDecoderLUT[v22 + 1088] + v21 + ((v19 >> 4) & ((24 * (((unsigned int)(v21 - 31) >> 3) & 2)) >> 4));
+			outputMask = decoder->outputMask;
+			v25 = 16 * (v23 + ((v23 - 1) & (v19 >> ((((unsigned int)(v21 - 31) >> 3) & 6) + s_defaultDecoderLUT[v22 + 1088]))));
+			v19 >>= (((unsigned int)(v21 - 31) >> 3) & 6) + s_defaultDecoderLUT[v22 + 1088] + v21 + ((v19 >> 4) & ((24 * (((unsigned int)(v21 - 31) >> 3) & 2)) >> 4));
+			v26 = v25 + s_defaultDecoderLUT[v22 + 1024] - 16;
+			v27 = outputMask & (outBufBytePos - v26);
+			v28 = &v70[outBufBytePos & outputMask];
+			v29 = &v70[v27];
+			if ((_DWORD)v20 == 17)
+			{
+				v40 = v19;
+				v41 = v19 >> 3;
+				v42 = v40 & 7;
+				v43 = v41;
+				if (v42)
+				{
+					v44 = s_defaultDecoderLUT[v42 + 1232];
+					v45 = s_defaultDecoderLUT[v42 + 1240];
+				}
+				else
+				{
+					currentBit += 4;
+					v46 = v41 & 0xF;
+					v43 = v41 >> 4;
+					v44 = *(_DWORD*)&s_defaultDecoderLUT[4 * v46 + 1152];
+					v45 = s_defaultDecoderLUT[v46 + 1216];
+					if (v74 && currentBit + v45 >= 61)
+					{
+						v47 = inBufBytePos++ & decoder->inputMask;
+						v43 |= (unsigned __int64)v74[v47] << (61 - (unsigned __int8)currentBit);
+						currentBit -= 8;
+					}
+				}
+				currentBit += v45 + 3;
+				v19 = v43 >> v45;
+				v48 = ((unsigned int)v43 & ((1 << v45) - 1)) + v44 + 17;
+				outBufBytePos += v48;
+				if (v26 < 8)
+				{
+					v50 = v48 - 13;
+					outBufBytePos -= 13i64;
+					if (v26 == 1)
+					{
+						v51 = *v29;
+						//++dword_14D40B2BC;
+						v52 = 0i64;
+						for (k = 0x101010101010101i64 * v51; (unsigned int)v52 < v50; v52 = (unsigned int)(v52 + 8))
+							*(_QWORD*)&v28[v52] = k;
+					}
+					else
+					{
+						//++dword_14D40B2B8;
+						if (v50)
+						{
+							v54 = v29 - v28;
+							v55 = v50;
+							do
+							{
+								*v28 = v28[v54];
+								++v28;
+								--v55;
+							} while (v55);
+						}
+					}
+				}
+				else
+				{
+					//++dword_14D40B2AC;
+					for (m = 0i64; (unsigned int)m < (unsigned int)v48; m = (unsigned int)(m + 8))
+						*(_QWORD*)&v28[m] = *(_QWORD*)&v29[m];
+				}
+			}
+			else
+			{
+				outBufBytePos += v20;
+				*(_QWORD*)v28 = *(_QWORD*)v29;
+				*((_QWORD*)v28 + 1) = *((_QWORD*)v29 + 1);
+			}
+			inputBuf = v74;
+		}
+		if (inBufBytePos >= qword70)
+			break;
+	LABEL_29:
+		outputBuf = v70;
+		v13 = (*(_QWORD*)&inputBuf[inBufBytePos & decoder->inputMask] << (64 - (unsigned __int8)currentBit)) | v19;
+	}
+	if (outBufBytePos != decoder->decompressedStreamSize)
+		goto LABEL_25;
+	decompSize = decoder->decompSize;
+	if (outBufBytePos == decompSize)
+	{
+		result = true;
+		goto LABEL_69;
+	}
+	inputInvMask = decoder->inputInvMask;
+	headerOffset = decoder->headerOffset;
+	v33 = inputInvMask & -(__int64)inBufBytePos;
+	v19 >>= 1;
+	++currentBit;
+	if (headerOffset > v33)
+	{
+		inBufBytePos += v33;
+		v34 = decoder->qword70;
+		if (inBufBytePos > v34)
+			decoder->qword70 = inputInvMask + v34 + 1;
+	}
+	v35 = inBufBytePos & decoder->inputMask;
+	inBufBytePos += headerOffset;
+	v36 = outBufBytePos + decoder->outputInvMask + 1;
+	v37 = *(_QWORD*)&inputBuf[v35] & ((1i64 << (8 * (unsigned __int8)headerOffset)) - 1);
+	v38 = v37 + decoder->bufferSizeNeeded;
+	v39 = v37 + decoder->compressedStreamSize;
+	decoder->bufferSizeNeeded = v38;
+	decoder->compressedStreamSize = v39;
+	if (v36 >= decompSize)
+	{
+		v36 = decompSize;
+		decoder->compressedStreamSize = headerOffset + v39;
+	}
+	decoder->decompressedStreamSize = v36;
+	if (inLen >= v38 && outLen >= v36)
+	{
+	LABEL_25:
+		qword70 = decoder->qword70;
+		if (inBufBytePos >= qword70)
+		{
+			inBufBytePos = ~decoder->inputInvMask & (inBufBytePos + 7);
+			qword70 += decoder->inputInvMask + 1;
+			decoder->qword70 = qword70;
+		}
+		if (decoder->compressedStreamSize < qword70)
+			qword70 = decoder->compressedStreamSize;
+		goto LABEL_29;
+	}
+	v69 = decoder->qword70;
+	if (inBufBytePos >= v69)
+	{
+		inBufBytePos = ~inputInvMask & (inBufBytePos + 7);
+		decoder->qword70 = v69 + inputInvMask + 1;
+	}
+	decoder->dword6C = v71;
+	result = false;
+	decoder->currentByte = v19;
+	decoder->currentBit = currentBit;
+LABEL_69:
+	decoder->outBufBytePos = outBufBytePos;
+	decoder->inBufBytePos = inBufBytePos;
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// decodes streamed input pak data, same as Pak_StreamToBufferDecode
+//-----------------------------------------------------------------------------
+bool PakRef_StreamToBufferDecode(PakDecoder_s* const decoder, const size_t inLen, const size_t outLen)
+{
+	if (!PakRef_HasEnoughStreamedDataForDecode(decoder, inLen))
+		return false;
+
+	if (!PakRef_HasEnoughDecodeBufferAvailable(decoder, outLen))
+		return false;
+
+	return PakRef_RTechStreamDecode(decoder, inLen, outLen);
+}
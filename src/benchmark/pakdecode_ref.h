@@ -0,0 +1,7 @@
+#ifndef BENCHMARK_PAKDECODE_REF_H
+#define BENCHMARK_PAKDECODE_REF_H
+#include "rtech/ipakfile.h"
+
+extern bool PakRef_StreamToBufferDecode(PakDecoder_s* const decoder, const size_t inLen, const size_t outLen);
+
+#endif // BENCHMARK_PAKDECODE_REF_H
@@ -0,0 +1,220 @@
+//=============================================================================//
+//
+// Purpose: parallel_for benchmark; runs loops of various sizes, and loops
+//          nested in loops, on the reference parallel_for that spawns threads
+//          per call and on the current one backed by the thread pool, checks
+//          that both produce the same results and reports the cycles per call
+//
+//=============================================================================//
+#include "tier0/fasttimer.h"
+#include "mathlib/parallel_for.h"
+#include "benchmark.h"
+#include "parallel_for_ref.h"
+
+// rounds of mixing per element, small enough that the overhead of each call
+// shows up on the smaller loops
+#define PARALLELBENCH_WORK_ROUNDS 16
+
+// upper bound on the calls per loop size, the reference spawns a thread per
+// hardware thread on every call
+#define PARALLELBENCH_MAX_CALLS 1000
+
+// rows of the outer loop in the nested benchmark
+#define PARALLELBENCH_NESTED_ROWS 16
+
+static const unsigned s_ParallelBenchSizes[] =
+{
+	256, 4096, 65536, 1024 * 1024
+};
+
+typedef void (*ParallelForFn_t)(unsigned nb_elements, std::function<void (int start, int end)> functor);
+
+static void ParallelBench_PoolFor(unsigned nb_elements, std::function<void (int start, int end)> functor)
+{
+	parallel_for(nb_elements, functor);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: the work done per element
+// Input  : nIndex -
+// Output : mixed value
+//-----------------------------------------------------------------------------
+static uint32_t ParallelBench_Work(const uint32_t nIndex)
+{
+	uint32_t nValue = nIndex + 1;
+
+	for (int i = 0; i < PARALLELBENCH_WORK_ROUNDS; i++)
+	{
+		nValue ^= nValue << 13;
+		nValue ^= nValue >> 17;
+		nValue ^= nValue << 5;
+	}
+
+	return nValue;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs a loop repeatedly
+// Input  : forFn -
+//			&results - receives the value of each element
+//			nCalls -
+// Output : time spent in the calls
+//-----------------------------------------------------------------------------
+static CCycleCount ParallelBench_RunFlat(const ParallelForFn_t forFn, vector<uint32_t>& results, const size_t nCalls)
+{
+	CFastTimer timer;
+	timer.Start();
+
+	for (size_t i = 0; i < nCalls; i++)
+	{
+		forFn(static_cast<unsigned>(results.size()), [&](int start, int end)
+			{
+				for (int j = start; j < end; j++)
+					results[j] = ParallelBench_Work(j);
+			});
+	}
+
+	timer.End();
+	return timer.GetDuration();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs a loop over rows with a loop over columns in each row
+// Input  : forFn -
+//			&results - receives the value of each element, row by row
+//			nColumns -
+//			nCalls -
+// Output : time spent in the calls
+//-----------------------------------------------------------------------------
+static CCycleCount ParallelBench_RunNested(const ParallelForFn_t forFn, vector<uint32_t>& results,
+	const unsigned nColumns, const size_t nCalls)
+{
+	CFastTimer timer;
+	timer.Start();
+
+	for (size_t i = 0; i < nCalls; i++)
+	{
+		forFn(PARALLELBENCH_NESTED_ROWS, [&](int rowStart, int rowEnd)
+			{
+				for (int row = rowStart; row < rowEnd; row++)
+				{
+					forFn(nColumns, [&, row](int start, int end)
+						{
+							for (int j = start; j < end; j++)
+							{
+								const uint32_t nIndex = row * nColumns + j;
+								results[nIndex] = ParallelBench_Work(nIndex);
+							}
+						});
+				}
+			});
+	}
+
+	timer.End();
+	return timer.GetDuration();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks the results against the work done serially
+// Input  : &results -
+//			*pszName -
+// Output : true if all elements match, false otherwise
+//-----------------------------------------------------------------------------
+static bool ParallelBench_Verify(const vector<uint32_t>& results, const char* const pszName)
+{
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const uint32_t nExpected = ParallelBench_Work(static_cast<uint32_t>(i));
+
+		if (results[i] != nExpected)
+		{
+			Error(eDLL_T::COMMON, NO_ERROR, "%s: element '%zu' is '%08X', expected '%08X'\n",
+				pszName, i, results[i], nExpected);
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	// Elements processed per loop size, spread over the calls.
+	const int nTotalElements = Benchmark_GetArgInt(argc, argv, 1, 16 * 1024 * 1024);
+	const int nNestedColumns = Benchmark_GetArgInt(argc, argv, 2, 4096);
+
+	if (nTotalElements <= 0 || nNestedColumns <= 0)
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "Usage: parallel_bench [totalElements] [nestedColumns]\n");
+
+		Benchmark_Shutdown();
+		return EXIT_FAILURE;
+	}
+
+	Msg(eDLL_T::COMMON, "Running on '%u' hardware threads, the pool runs on '%u' including the caller\n",
+		std::thread::hardware_concurrency(), parallel_thread_count());
+
+	char szName[64];
+
+	for (const unsigned nSize : s_ParallelBenchSizes)
+	{
+		const size_t nCalls = Clamp<size_t>(size_t(nTotalElements) / nSize, 1, PARALLELBENCH_MAX_CALLS);
+
+		vector<uint32_t> refResults(nSize, 0);
+		vector<uint32_t> poolResults(nSize, 0);
+
+		const CCycleCount refTime = ParallelBench_RunFlat(ParallelForRef, refResults, nCalls);
+		const CCycleCount poolTime = ParallelBench_RunFlat(ParallelBench_PoolFor, poolResults, nCalls);
+
+		if (!ParallelBench_Verify(refResults, "spawn per call") ||
+			!ParallelBench_Verify(poolResults, "pool"))
+		{
+			Benchmark_Shutdown();
+			return EXIT_FAILURE;
+		}
+
+		snprintf(szName, sizeof(szName), "%u elements, spawn per call", nSize);
+		Benchmark_Report(szName, refTime, nCalls, "call");
+
+		snprintf(szName, sizeof(szName), "%u elements, pool", nSize);
+		Benchmark_Report(szName, poolTime, nCalls, "call");
+
+		snprintf(szName, sizeof(szName), "%u elements speedup", nSize);
+		Benchmark_ReportSpeedup(szName, refTime, poolTime);
+	}
+
+	// Nested loops spawn a thread per hardware thread for every row on the
+	// reference, so fewer calls are made.
+	const unsigned nNestedSize = PARALLELBENCH_NESTED_ROWS * unsigned(nNestedColumns);
+	const size_t nNestedCalls = Clamp<size_t>(size_t(nTotalElements) / nNestedSize, 1, PARALLELBENCH_MAX_CALLS / PARALLELBENCH_NESTED_ROWS);
+
+	vector<uint32_t> refResults(nNestedSize, 0);
+	vector<uint32_t> poolResults(nNestedSize, 0);
+
+	const CCycleCount refTime = ParallelBench_RunNested(ParallelForRef, refResults, nNestedColumns, nNestedCalls);
+	const CCycleCount poolTime = ParallelBench_RunNested(ParallelBench_PoolFor, poolResults, nNestedColumns, nNestedCalls);
+
+	if (!ParallelBench_Verify(refResults, "nested spawn per call") ||
+		!ParallelBench_Verify(poolResults, "nested pool"))
+	{
+		Benchmark_Shutdown();
+		return EXIT_FAILURE;
+	}
+
+	snprintf(szName, sizeof(szName), "%d x %d nested, spawn per call", PARALLELBENCH_NESTED_ROWS, nNestedColumns);
+	Benchmark_Report(szName, refTime, nNestedCalls, "call");
+
+	snprintf(szName, sizeof(szName), "%d x %d nested, pool", PARALLELBENCH_NESTED_ROWS, nNestedColumns);
+	Benchmark_Report(szName, poolTime, nNestedCalls, "call");
+
+	Benchmark_ReportSpeedup("nested speedup", refTime, poolTime);
+
+	Benchmark_Shutdown();
+	return EXIT_SUCCESS;
+}
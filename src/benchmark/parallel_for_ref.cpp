@@ -0,0 +1,37 @@
+//=============================================================================//
+//
+// Purpose: reference copy of parallel_for, as it was before it got the thread
+//          pool; it creates and joins a thread per hardware thread on every
+//          call, the parallel benchmark compares the pool against this one
+//
+//=============================================================================//
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "parallel_for_ref.h"
+
+void ParallelForRef(unsigned nb_elements, std::function<void (int start, int end)> functor)
+{
+    // -------
+    unsigned nb_threads_hint = std::thread::hardware_concurrency();
+    unsigned nb_threads = nb_threads_hint == 0 ? 8 : (nb_threads_hint);
+
+    unsigned batch_size = nb_elements / nb_threads;
+    unsigned batch_remainder = nb_elements % nb_threads;
+
+    std::vector< std::thread > my_threads(nb_threads);
+
+    // Multithread execution
+    for(unsigned i = 0; i < nb_threads; ++i)
+    {
+        int start = i * batch_size;
+        my_threads[i] = std::thread(functor, start, start+batch_size);
+    }
+
+    // Deform the elements left
+    int start = nb_threads * batch_size;
+    functor( start, start+batch_remainder);
+
+    // Wait for the other thread to finish their task
+    std::for_each(my_threads.begin(), my_threads.end(), std::mem_fn(&std::thread::join));
+}
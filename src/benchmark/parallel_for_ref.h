@@ -0,0 +1,7 @@
+#ifndef BENCHMARK_PARALLEL_FOR_REF_H
+#define BENCHMARK_PARALLEL_FOR_REF_H
+#include <functional>
+
+extern void ParallelForRef(unsigned nb_elements, std::function<void (int start, int end)> functor);
+
+#endif // BENCHMARK_PARALLEL_FOR_REF_H
@@ -0,0 +1,193 @@
+//=============================================================================//
+//
+// Purpose: pattern scanner benchmark; finds a set of byte patterns in a large
+//          synthetic code section one pattern at a time, and all at once in a
+//          single pass, checks that both find the same first occurrences and
+//          reports the cycles spent per pattern
+//
+//=============================================================================//
+#include <random>
+#include "tier0/fasttimer.h"
+#include "tier0/sigcache.h"
+#include "benchmark.h"
+
+// the scanners read up to 16 bytes past the last position they test
+#define PATTERNBENCH_BUFFER_SLACK 64
+
+#define PATTERNBENCH_MIN_LENGTH 8
+#define PATTERNBENCH_MAX_LENGTH 48
+
+// percentage of bytes in a pattern that are wildcards, and percentage of
+// patterns that don't occur in the section at all
+#define PATTERNBENCH_WILDCARD_CHANCE 15
+#define PATTERNBENCH_MISSING_CHANCE 5
+
+//-----------------------------------------------------------------------------
+// Purpose: fills the buffer with bytes skewed towards the ones that are common
+//          in x64 code, so anchoring on rare bytes matters like it does in the
+//          game's code section
+// Input  : *pBuffer -
+//			nSize -
+//			&rng -
+//-----------------------------------------------------------------------------
+static void PatternBench_FillCode(uint8_t* const pBuffer, const size_t nSize, std::mt19937& rng)
+{
+	static const uint8_t s_CommonBytes[] =
+	{
+		0x00, 0x48, 0x8B, 0x89, 0x8D, 0x83, 0x4C, 0x24, 0x44, 0xFF,
+		0xE8, 0x0F, 0x85, 0x84, 0xC0, 0x33, 0xC3, 0xCC, 0x41, 0x20
+	};
+
+	for (size_t i = 0; i < nSize; i++)
+	{
+		const uint32_t nRandom = rng();
+
+		pBuffer[i] = (nRandom & 1)
+			? s_CommonBytes[(nRandom >> 1) % V_ARRAYSIZE(s_CommonBytes)]
+			: static_cast<uint8_t>(nRandom >> 8);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: creates a pattern string from the section, e.g. "48 8B ?? 89"; the
+//          first byte is never a wildcard as the single pattern scanner keys
+//          on it, like all patterns in the SDK do
+// Input  : *pBuffer -
+//			nSize -
+//			&rng -
+// Output : pattern string
+//-----------------------------------------------------------------------------
+static string PatternBench_CreatePattern(const uint8_t* const pBuffer, const size_t nSize, std::mt19937& rng)
+{
+	const size_t nLength = PATTERNBENCH_MIN_LENGTH + (rng() % (PATTERNBENCH_MAX_LENGTH - PATTERNBENCH_MIN_LENGTH + 1));
+	const bool bMissing = (rng() % 100) < PATTERNBENCH_MISSING_CHANCE;
+
+	// Stay clear of the end, the single pattern scanner doesn't test the
+	// last position in the section.
+	const size_t nOffset = rng() % (nSize - PATTERNBENCH_MAX_LENGTH - PATTERNBENCH_BUFFER_SLACK);
+
+	string pattern;
+	pattern.reserve(nLength * 3);
+
+	for (size_t i = 0; i < nLength; i++)
+	{
+		if (i)
+			pattern += ' ';
+
+		if (i && (rng() % 100) < PATTERNBENCH_WILDCARD_CHANCE)
+		{
+			pattern += "??";
+			continue;
+		}
+
+		// Missing patterns are made of random bytes, the odds of them
+		// occurring in the section are negligible.
+		const uint8_t nByte = bMissing ? static_cast<uint8_t>(rng()) : pBuffer[nOffset + i];
+
+		char szByte[3];
+		snprintf(szByte, sizeof(szByte), "%02X", nByte);
+
+		pattern += szByte;
+	}
+
+	return pattern;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	const int nSectionMB = Benchmark_GetArgInt(argc, argv, 1, 100);
+	const int nPatterns = Benchmark_GetArgInt(argc, argv, 2, 1000);
+
+	if (nSectionMB <= 0 || nPatterns <= 0)
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "Usage: pattern_bench [sectionMB] [numPatterns]\n");
+
+		Benchmark_Shutdown();
+		return EXIT_FAILURE;
+	}
+
+	// Results should come from the scanners, not the cache.
+	g_SigCache.SetDisabled(true);
+
+	// The scanners require a module with a code section, the synthetic
+	// section is passed to them explicitly.
+	const CModule module(reinterpret_cast<QWORD>(GetModuleHandleA(NULL)));
+
+	const size_t nSize = size_t(nSectionMB) * 1024 * 1024;
+	std::unique_ptr<uint8_t[]> pBuffer(new uint8_t[nSize + PATTERNBENCH_BUFFER_SLACK]);
+
+	memset(pBuffer.get() + nSize, 0, PATTERNBENCH_BUFFER_SLACK);
+
+	std::mt19937 rng(1337);
+	PatternBench_FillCode(pBuffer.get(), nSize, rng);
+
+	const CModule::ModuleSections_t section(reinterpret_cast<QWORD>(pBuffer.get()), nSize);
+
+	vector<string> patterns(nPatterns);
+	vector<const char*> patternPtrs(nPatterns);
+
+	for (int i = 0; i < nPatterns; i++)
+	{
+		patterns[i] = PatternBench_CreatePattern(pBuffer.get(), nSize, rng);
+		patternPtrs[i] = patterns[i].c_str();
+	}
+
+	Msg(eDLL_T::COMMON, "Scanning '%d' patterns in a '%d' MB section\n", nPatterns, nSectionMB);
+
+	vector<CMemory> singleResults(nPatterns);
+	vector<CMemory> batchResults(nPatterns);
+
+	CFastTimer singleTimer;
+	singleTimer.Start();
+
+	for (int i = 0; i < nPatterns; i++)
+		singleResults[i] = module.FindPatternSIMD(patternPtrs[i], &section);
+
+	singleTimer.End();
+
+	CFastTimer batchTimer;
+	batchTimer.Start();
+
+	const size_t nFound = module.FindPatternsSIMD(patternPtrs.data(), patternPtrs.size(), batchResults.data(), &section);
+
+	batchTimer.End();
+
+	size_t nExpected = 0;
+
+	for (int i = 0; i < nPatterns; i++)
+	{
+		if (singleResults[i])
+			nExpected++;
+
+		if (singleResults[i].GetPtr() != batchResults[i].GetPtr())
+		{
+			Error(eDLL_T::COMMON, NO_ERROR, "Pattern '%s' found at '%p' by the single pattern scanner, but at '%p' by the batch scanner\n",
+				patternPtrs[i], (void*)singleResults[i].GetPtr(), (void*)batchResults[i].GetPtr());
+
+			Benchmark_Shutdown();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (nFound != nExpected)
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "Batch scanner reported '%zu' patterns found, but '%zu' were\n", nFound, nExpected);
+
+		Benchmark_Shutdown();
+		return EXIT_FAILURE;
+	}
+
+	Msg(eDLL_T::COMMON, "Found '%zu' of '%d' patterns\n", nFound, nPatterns);
+
+	Benchmark_Report("single pattern", singleTimer.GetDuration(), nPatterns, "pattern");
+	Benchmark_Report("batch", batchTimer.GetDuration(), nPatterns, "pattern");
+	Benchmark_ReportSpeedup("batch speedup", singleTimer.GetDuration(), batchTimer.GetDuration());
+
+	Benchmark_Shutdown();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,383 @@
+//=============================================================================//
+//
+// Purpose: RCON frame parser fuzzer and benchmark; feeds randomly split and
+//          corrupted streams to the frame parser, checks that it delivers
+//          exactly the frames that were sent, and compares its throughput
+//          against the previous byte-wise parser
+//
+//=============================================================================//
+#include <random>
+#include "tier0/fasttimer.h"
+#include "engine/shared/base_rcon.h"
+#include "benchmark.h"
+
+// Frames larger than this are rejected while not authenticated.
+#define RCONBENCH_UNAUTHORIZED_MAX_LEN 4096
+
+//-----------------------------------------------------------------------------
+// Frame parser that records everything the connection receives.
+//-----------------------------------------------------------------------------
+class CRConBenchConsole : public CNetConBase
+{
+public:
+	CRConBenchConsole(const bool bRecordMessages)
+		: m_bRecordMessages(bRecordMessages)
+		, m_bDisconnected(false)
+		, m_nMessageCount(0)
+		, m_nMessageBytes(0)
+		, m_nMessageHash(0)
+	{
+	}
+
+	virtual void Disconnect(const char* szReason = nullptr)
+	{
+		m_bDisconnected = true;
+		m_DisconnectReason = szReason ? szReason : "";
+	}
+
+	virtual bool ProcessMessage(const char* pMsgBuf, int nMsgLen)
+	{
+		if (m_bRecordMessages)
+			m_Messages.emplace_back(pMsgBuf, size_t(nMsgLen));
+
+		m_nMessageCount++;
+		m_nMessageBytes += nMsgLen;
+
+		// Touch the data like a real consumer would, so delivering frames in
+		// place isn't measured against copies that are never read.
+		if (nMsgLen > 0)
+			m_nMessageHash = (m_nMessageHash * 31) ^ uint8_t(pMsgBuf[0]) ^ uint8_t(pMsgBuf[nMsgLen - 1]);
+
+		return true;
+	}
+
+	bool m_bRecordMessages;
+	bool m_bDisconnected;
+	std::string m_DisconnectReason;
+	std::vector<std::string> m_Messages;
+
+	uint64_t m_nMessageCount;
+	uint64_t m_nMessageBytes;
+	uint64_t m_nMessageHash;
+};
+
+//-----------------------------------------------------------------------------
+// The frame parser prior to bulk framing, used as baseline.
+//-----------------------------------------------------------------------------
+class CRConBenchRefConsole : public CRConBenchConsole
+{
+public:
+	CRConBenchRefConsole()
+		: CRConBenchConsole(false)
+	{
+	}
+
+	virtual bool ProcessBuffer(CConnectedNetConsoleData& data, const char* pRecvBuf, int nRecvLen, const int nMaxLen)
+	{
+		bool bSuccess = true;
+
+		while (nRecvLen > 0)
+		{
+			if (data.m_nPayloadLen)
+			{
+				if (data.m_nPayloadRead < data.m_nPayloadLen)
+				{
+					data.m_RecvBuffer[data.m_nPayloadRead++] = *pRecvBuf;
+
+					pRecvBuf++;
+					nRecvLen--;
+				}
+				if (data.m_nPayloadRead == data.m_nPayloadLen)
+				{
+					if (!ProcessMessage(
+						reinterpret_cast<const char*>(data.m_RecvBuffer.data()), data.m_nPayloadLen)
+						&& bSuccess)
+					{
+						bSuccess = false;
+					}
+
+					data.m_nPayloadLen = 0;
+					data.m_nPayloadRead = 0;
+				}
+			}
+			else if (data.m_nPayloadRead < sizeof(int)) // Read size field.
+			{
+				data.m_RecvBuffer[data.m_nPayloadRead++] = *pRecvBuf;
+
+				pRecvBuf++;
+				nRecvLen--;
+			}
+			else // Build prefix.
+			{
+				data.m_nPayloadLen = int(ntohl(*reinterpret_cast<u_long*>(&data.m_RecvBuffer[0])));
+				data.m_nPayloadRead = 0;
+
+				if (!data.m_bAuthorized && nMaxLen > -1)
+				{
+					if (data.m_nPayloadLen > nMaxLen)
+					{
+						Disconnect("overflow"); // Sending large messages while not authenticated.
+						return false;
+					}
+				}
+
+				if (data.m_nPayloadLen < 0 ||
+					data.m_nPayloadLen > data.m_RecvBuffer.max_size())
+				{
+					Disconnect("desync"); // Out of sync (irrecoverable).
+					return false;
+				}
+				else
+				{
+					data.m_RecvBuffer.resize(data.m_nPayloadLen);
+				}
+			}
+		}
+
+		return bSuccess;
+	}
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: appends a length-prefixed frame to the stream
+// Input  : &stream -
+//			nLen - value of the length prefix
+//			*pData -
+//			nDataLen -
+//-----------------------------------------------------------------------------
+static void RConBench_AppendFrame(std::string& stream, const u_long nLen, const char* const pData, const size_t nDataLen)
+{
+	const u_long nNetLen = htonl(nLen);
+
+	stream.append(reinterpret_cast<const char*>(&nNetLen), sizeof(nNetLen));
+	stream.append(pData, nDataLen);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: feeds the stream to the parser in randomly sized chunks, like it
+//			would arrive from the socket
+// Input  : &console -
+//			&data -
+//			&stream -
+//			nMaxLen -
+//			&rng -
+//-----------------------------------------------------------------------------
+static void RConBench_FeedRandom(CRConBenchConsole& console, CConnectedNetConsoleData& data,
+	const std::string& stream, const int nMaxLen, std::mt19937& rng)
+{
+	size_t nOffset = 0;
+
+	while (nOffset < stream.size() && !console.m_bDisconnected)
+	{
+		// Mostly tiny chunks to split the length prefixes, sometimes whole
+		// receive buffers.
+		const int nMaxChunk = (rng() & 3) ? 16 : RCON_RECV_CHUNK_SIZE;
+		const size_t nChunkLen = Min(size_t(1 + rng() % nMaxChunk), stream.size() - nOffset);
+
+		console.ProcessBuffer(data, &stream[nOffset], int(nChunkLen), nMaxLen);
+		nOffset += nChunkLen;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs a single fuzz case
+// Input  : nSeed -
+// Output : true if the parser delivered the expected frames, false otherwise
+//-----------------------------------------------------------------------------
+static bool RConBench_FuzzCase(const uint32_t nSeed)
+{
+	std::mt19937 rng(nSeed);
+
+	const bool bAuthorized = (rng() & 1) != 0;
+	const int nMaxLen = bAuthorized ? SOCKET_ERROR : RCONBENCH_UNAUTHORIZED_MAX_LEN;
+
+	const int nFrameCount = int(rng() % 64);
+	const int nCorruptFrame = (rng() & 15) ? -1 : int(rng() % (nFrameCount + 1));
+
+	std::vector<std::string> expectedMessages;
+	const char* pExpectedReason = nullptr;
+
+	std::string stream;
+
+	for (int i = 0; i <= nFrameCount; i++)
+	{
+		if (i == nCorruptFrame)
+		{
+			// Either a negative length, or one that exceeds the limit for
+			// connections that aren't authenticated yet.
+			if (bAuthorized || (rng() & 1))
+			{
+				RConBench_AppendFrame(stream, u_long(0x80000000 | rng()), "", 0);
+				pExpectedReason = "desync";
+			}
+			else
+			{
+				RConBench_AppendFrame(stream, u_long(RCONBENCH_UNAUTHORIZED_MAX_LEN + 1 + rng() % 1024), "", 0);
+				pExpectedReason = "overflow";
+			}
+
+			// Anything after it must not be delivered.
+			stream.append(size_t(1 + rng() % 64), 'x');
+			break;
+		}
+
+		if (i == nFrameCount)
+			break;
+
+		size_t nFrameLen;
+
+		switch (rng() % 4)
+		{
+		case 0: nFrameLen = 0; break;
+		case 1: nFrameLen = rng() % 16; break;
+		case 2: nFrameLen = rng() % RCONBENCH_UNAUTHORIZED_MAX_LEN; break;
+		default: nFrameLen = bAuthorized ? rng() % (3 * RCON_RECV_CHUNK_SIZE) : RCONBENCH_UNAUTHORIZED_MAX_LEN; break;
+		}
+
+		std::string payload(nFrameLen, '\0');
+
+		for (char& c : payload)
+			c = char(rng());
+
+		RConBench_AppendFrame(stream, u_long(nFrameLen), payload.data(), payload.size());
+
+		// Empty frames are not delivered.
+		if (nFrameLen)
+			expectedMessages.push_back(std::move(payload));
+	}
+
+	CRConBenchConsole console(true);
+	CConnectedNetConsoleData data;
+
+	data.m_bAuthorized = bAuthorized;
+
+	RConBench_FeedRandom(console, data, stream, nMaxLen, rng);
+
+	if (console.m_Messages != expectedMessages)
+	{
+		Error(eDLL_T::NETCON, NO_ERROR, "Seed '%u': delivered '%zu' frames, expected '%zu'!\n",
+			nSeed, console.m_Messages.size(), expectedMessages.size());
+
+		return false;
+	}
+
+	if (console.m_bDisconnected != (pExpectedReason != nullptr) ||
+		(pExpectedReason && console.m_DisconnectReason != pExpectedReason))
+	{
+		Error(eDLL_T::NETCON, NO_ERROR, "Seed '%u': disconnect reason '%s', expected '%s'!\n",
+			nSeed, console.m_DisconnectReason.c_str(), pExpectedReason ? pExpectedReason : "");
+
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: feeds the stream to the parser in fixed size chunks
+// Input  : &console -
+//			&stream -
+//			nChunkLen -
+//			&duration -
+//-----------------------------------------------------------------------------
+static void RConBench_FeedTimed(CRConBenchConsole& console, const std::string& stream,
+	const size_t nChunkLen, CCycleCount& duration)
+{
+	CConnectedNetConsoleData data;
+	data.m_bAuthorized = true;
+
+	CFastTimer timer;
+	timer.Start();
+
+	for (size_t nOffset = 0; nOffset < stream.size(); nOffset += nChunkLen)
+	{
+		console.ProcessBuffer(data, &stream[nOffset], int(Min(nChunkLen, stream.size() - nOffset)), SOCKET_ERROR);
+	}
+
+	timer.End();
+	duration += timer.GetDuration();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	const int iterations = Benchmark_GetArgInt(argc, argv, 1, 10);
+	const int fuzzCases = Benchmark_GetArgInt(argc, argv, 2, 2000);
+
+	bool failed = false;
+
+	for (int i = 0; i < fuzzCases && !failed; i++)
+	{
+		if (!RConBench_FuzzCase(uint32_t(i)))
+			failed = true;
+	}
+
+	if (failed)
+	{
+		Benchmark_Shutdown();
+		return EXIT_FAILURE;
+	}
+
+	Msg(eDLL_T::NETCON, "Fuzzed '%d' streams\n", fuzzCases);
+
+	// Mostly console log lines, with the occasional large response.
+	std::mt19937 rng(0);
+	std::string stream;
+
+	while (stream.size() < 64 * 1024 * 1024)
+	{
+		const size_t nFrameLen = (rng() % 64) ? 32 + rng() % 480 : 4096 + rng() % (2 * RCON_RECV_CHUNK_SIZE);
+		const std::string payload(nFrameLen, char('a' + rng() % 26));
+
+		RConBench_AppendFrame(stream, u_long(nFrameLen), payload.data(), payload.size());
+	}
+
+	Msg(eDLL_T::NETCON, "Parsing '%zu' bytes '%d' times\n", stream.size(), iterations);
+
+	// The previous receive loop read 1 KiB at a time, the current one reads
+	// up to RCON_RECV_CHUNK_SIZE at once.
+	const size_t chunkSizes[] = { 1024, RCON_RECV_CHUNK_SIZE };
+
+	for (const size_t nChunkLen : chunkSizes)
+	{
+		CRConBenchRefConsole refConsole;
+		CRConBenchConsole curConsole(false);
+
+		CCycleCount refTime, curTime;
+
+		for (int i = 0; i < iterations; i++)
+		{
+			RConBench_FeedTimed(refConsole, stream, nChunkLen, refTime);
+			RConBench_FeedTimed(curConsole, stream, nChunkLen, curTime);
+		}
+
+		if (refConsole.m_nMessageCount != curConsole.m_nMessageCount ||
+			refConsole.m_nMessageBytes != curConsole.m_nMessageBytes ||
+			refConsole.m_nMessageHash != curConsole.m_nMessageHash)
+		{
+			Error(eDLL_T::NETCON, NO_ERROR, "Parsed frames differ with '%zu' byte chunks!\n", nChunkLen);
+			failed = true;
+
+			break;
+		}
+
+		char szName[64];
+		const uint64_t totalBytes = uint64_t(stream.size()) * iterations;
+
+		snprintf(szName, sizeof(szName), "%zu byte chunks (reference)", nChunkLen);
+		Benchmark_Report(szName, refTime, totalBytes, "byte");
+
+		snprintf(szName, sizeof(szName), "%zu byte chunks (current)", nChunkLen);
+		Benchmark_Report(szName, curTime, totalBytes, "byte");
+
+		snprintf(szName, sizeof(szName), "%zu byte chunks speedup", nChunkLen);
+		Benchmark_ReportSpeedup(szName, refTime, curTime);
+	}
+
+	Benchmark_Shutdown();
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
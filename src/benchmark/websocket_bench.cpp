@@ -0,0 +1,652 @@
+//=============================================================================//
+//
+// Purpose: WebSocket send queue test and benchmark; streams frames through
+//          CWebSocket to a local stand-in WebSocket server, checks that every
+//          message the server receives is an intact frame in send order for a
+//          fast, a slow and a disconnecting peer, and reports the time the
+//          sending thread spends per frame
+//
+//=============================================================================//
+#include <random>
+#include "tier0/fasttimer.h"
+#include "tier0/utility.h"
+#include "tier2/websocket.h"
+#include "mbedtls/sha1.h"
+#include "DirtySDK/dirtysock.h"
+#include "DirtySDK/dirtysock/netconn.h"
+#include "benchmark.h"
+
+#define WSBENCH_ACCEPT_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+// The sending socket buffer; most frames are larger, so they are fragmented.
+#define WSBENCH_SOCKET_BUFFER_SIZE 1024
+
+// Frames carry their sequence number and size in front of the random data.
+#define WSBENCH_FRAME_HEADER_SIZE 8
+
+//-----------------------------------------------------------------------------
+// Stand-in WebSocket server, accepts one connection at a time and records
+// every complete message it receives.
+//-----------------------------------------------------------------------------
+class CWebSocketBenchServer
+{
+public:
+	CWebSocketBenchServer()
+		: m_ListenSocket(INVALID_SOCKET)
+		, m_nPort(0)
+		, m_bShutdown(false)
+		, m_nReadDelay(0)
+		, m_nDropAfter(0)
+		, m_nConnections(0)
+		, m_nProtocolErrors(0)
+	{
+	}
+
+	~CWebSocketBenchServer()
+	{
+		Stop();
+	}
+
+	//-------------------------------------------------------------------------
+	// Purpose: starts listening on a free loopback port
+	// Input  : nReadDelay - milliseconds to wait after each read, to simulate
+	//                       a slow consumer
+	//          nDropAfter - number of messages after which each connection is
+	//                       closed without a close handshake, 0 for never
+	// Output : true on success, false otherwise
+	//-------------------------------------------------------------------------
+	bool Start(const int nReadDelay, const int nDropAfter)
+	{
+		m_nReadDelay = nReadDelay;
+		m_nDropAfter = nDropAfter;
+
+		m_ListenSocket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+		if (m_ListenSocket == INVALID_SOCKET)
+			return false;
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+
+		int addrLen = sizeof(addr);
+
+		if (::bind(m_ListenSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR ||
+			::listen(m_ListenSocket, 1) == SOCKET_ERROR ||
+			::getsockname(m_ListenSocket, reinterpret_cast<sockaddr*>(&addr), &addrLen) == SOCKET_ERROR)
+		{
+			::closesocket(m_ListenSocket);
+			m_ListenSocket = INVALID_SOCKET;
+
+			return false;
+		}
+
+		m_nPort = ntohs(addr.sin_port);
+		m_Thread = std::thread(&CWebSocketBenchServer::Serve, this);
+
+		return true;
+	}
+
+	void Stop()
+	{
+		m_bShutdown = true;
+
+		if (m_Thread.joinable())
+			m_Thread.join();
+
+		if (m_ListenSocket != INVALID_SOCKET)
+		{
+			::closesocket(m_ListenSocket);
+			m_ListenSocket = INVALID_SOCKET;
+		}
+	}
+
+	int GetPort() const { return m_nPort; }
+
+	size_t GetMessageCount()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Messages.size();
+	}
+
+	std::vector<std::string> m_Messages; // Only read once stopped.
+	std::atomic<int> m_nConnections;
+	std::atomic<int> m_nProtocolErrors;
+
+private:
+	//-------------------------------------------------------------------------
+	// Purpose: waits up to 50 milliseconds for the socket to become readable
+	// Output : true if readable, false on timeout
+	//-------------------------------------------------------------------------
+	static bool WaitReadable(const SOCKET socket)
+	{
+		fd_set readSet;
+		FD_ZERO(&readSet);
+		FD_SET(socket, &readSet);
+
+		timeval timeOut{ 0, 50000 };
+		return ::select(0, &readSet, nullptr, nullptr, &timeOut) > 0;
+	}
+
+	//-------------------------------------------------------------------------
+	// Purpose: appends received data to the buffer
+	// Output : false if the connection was closed or the server is stopping
+	//-------------------------------------------------------------------------
+	bool Receive(const SOCKET socket, std::string& buffer)
+	{
+		while (!WaitReadable(socket))
+		{
+			if (m_bShutdown)
+				return false;
+		}
+
+		char recvBuf[4096];
+		const int nRecvLen = ::recv(socket, recvBuf, sizeof(recvBuf), 0);
+
+		if (nRecvLen <= 0)
+			return false;
+
+		buffer.append(recvBuf, size_t(nRecvLen));
+
+		if (m_nReadDelay)
+			std::this_thread::sleep_for(std::chrono::milliseconds(m_nReadDelay));
+
+		return true;
+	}
+
+	static bool SendAll(const SOCKET socket, const char* pData, int nLen)
+	{
+		while (nLen > 0)
+		{
+			const int nSent = ::send(socket, pData, nLen, 0);
+
+			if (nSent <= 0)
+				return false;
+
+			pData += nSent;
+			nLen -= nSent;
+		}
+
+		return true;
+	}
+
+	//-------------------------------------------------------------------------
+	// Purpose: sends an unmasked control frame to the client
+	//-------------------------------------------------------------------------
+	static void SendControl(const SOCKET socket, const uint8_t nOpcode, const std::string& payload)
+	{
+		std::string frame;
+
+		frame.push_back(char(0x80 | nOpcode));
+		frame.push_back(char(Min(payload.size(), size_t(125))));
+		frame.append(payload, 0, 125);
+
+		SendAll(socket, frame.data(), int(frame.size()));
+	}
+
+	//-------------------------------------------------------------------------
+	// Purpose: answers the opening handshake of the client
+	// Output : true on success, false otherwise
+	//-------------------------------------------------------------------------
+	bool Handshake(const SOCKET socket, std::string& buffer)
+	{
+		size_t nHeaderEnd;
+
+		while ((nHeaderEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+		{
+			if (!Receive(socket, buffer))
+				return false;
+		}
+
+		const char* const pszKeyField = "Sec-WebSocket-Key:";
+		const size_t nKeyField = buffer.find(pszKeyField);
+
+		if (nKeyField == std::string::npos || nKeyField > nHeaderEnd)
+			return false;
+
+		const size_t nKeyStart = buffer.find_first_not_of(' ', nKeyField + strlen(pszKeyField));
+		const size_t nKeyEnd = buffer.find("\r\n", nKeyStart);
+
+		const std::string key = buffer.substr(nKeyStart, nKeyEnd - nKeyStart) + WSBENCH_ACCEPT_GUID;
+		uint8_t keyHash[20];
+
+		if (mbedtls_sha1(reinterpret_cast<const uint8_t*>(key.data()), key.size(), keyHash) != 0)
+			return false;
+
+		const std::string response = Format(
+			"HTTP/1.1 101 Switching Protocols\r\n"
+			"Upgrade: websocket\r\n"
+			"Connection: upgrade\r\n"
+			"Sec-WebSocket-Accept: %s\r\n\r\n",
+			Base64Encode(std::string(reinterpret_cast<const char*>(keyHash), sizeof(keyHash))).c_str());
+
+		buffer.erase(0, nHeaderEnd + 4);
+		return SendAll(socket, response.data(), int(response.size()));
+	}
+
+	//-------------------------------------------------------------------------
+	// Purpose: reads frames until the connection is closed, any violation of
+	//          the message framing is counted as protocol error
+	//-------------------------------------------------------------------------
+	void HandleConnection(const SOCKET socket)
+	{
+		std::string buffer;
+
+		if (!Handshake(socket, buffer))
+		{
+			m_nProtocolErrors++;
+			return;
+		}
+
+		std::string message;
+		bool bInMessage = false;
+
+		int nConnMessages = 0;
+
+		for (;;)
+		{
+			// Header, extended length and mask.
+			while (buffer.size() < 2)
+			{
+				if (!Receive(socket, buffer))
+					return;
+			}
+
+			const uint8_t nFlags = uint8_t(buffer[0]);
+			const uint8_t nLen7 = uint8_t(buffer[1]) & 0x7F;
+
+			const bool bFin = (nFlags & 0x80) != 0;
+			const uint8_t nOpcode = nFlags & 0x0F;
+
+			if (!(uint8_t(buffer[1]) & 0x80))
+			{
+				m_nProtocolErrors++; // Client frames must be masked.
+				return;
+			}
+
+			const size_t nLenSize = nLen7 == 127 ? 8 : nLen7 == 126 ? 2 : 0;
+			const size_t nHeaderSize = 2 + nLenSize + 4;
+
+			while (buffer.size() < nHeaderSize)
+			{
+				if (!Receive(socket, buffer))
+					return;
+			}
+
+			uint64_t nPayloadLen = nLen7;
+
+			if (nLenSize)
+			{
+				nPayloadLen = 0;
+
+				for (size_t i = 0; i < nLenSize; i++)
+					nPayloadLen = (nPayloadLen << 8) | uint8_t(buffer[2 + i]);
+			}
+
+			while (buffer.size() < nHeaderSize + nPayloadLen)
+			{
+				if (!Receive(socket, buffer))
+					return;
+			}
+
+			const char* const pMask = &buffer[nHeaderSize - 4];
+			std::string payload = buffer.substr(nHeaderSize, size_t(nPayloadLen));
+
+			for (size_t i = 0; i < payload.size(); i++)
+				payload[i] ^= pMask[i & 3];
+
+			buffer.erase(0, nHeaderSize + size_t(nPayloadLen));
+
+			if (nOpcode == 0x8) // Close.
+			{
+				SendControl(socket, 0x8, payload);
+				return;
+			}
+
+			if (nOpcode == 0x9) // Ping.
+			{
+				SendControl(socket, 0xA, payload);
+				continue;
+			}
+
+			if (nOpcode == 0xA) // Pong.
+				continue;
+
+			if (nOpcode == 0x0) // Continuation.
+			{
+				if (!bInMessage)
+				{
+					m_nProtocolErrors++;
+					return;
+				}
+			}
+			else if (nOpcode == 0x1 || nOpcode == 0x2) // Text or binary.
+			{
+				if (bInMessage)
+				{
+					m_nProtocolErrors++; // Previous message wasn't finished.
+					return;
+				}
+
+				bInMessage = true;
+			}
+			else
+			{
+				m_nProtocolErrors++;
+				return;
+			}
+
+			message += payload;
+
+			if (!bFin)
+				continue;
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Messages.push_back(std::move(message));
+			}
+
+			message.clear();
+			bInMessage = false;
+
+			if (m_nDropAfter && ++nConnMessages == m_nDropAfter)
+				return; // Drop the connection in the middle of the stream.
+		}
+	}
+
+	void Serve()
+	{
+		while (!m_bShutdown)
+		{
+			if (!WaitReadable(m_ListenSocket))
+				continue;
+
+			const SOCKET socket = ::accept(m_ListenSocket, nullptr, nullptr);
+
+			if (socket == INVALID_SOCKET)
+				continue;
+
+			m_nConnections++;
+
+			HandleConnection(socket);
+			::closesocket(socket);
+		}
+	}
+
+	SOCKET m_ListenSocket;
+	int m_nPort;
+
+	std::thread m_Thread;
+	std::atomic<bool> m_bShutdown;
+
+	std::mutex m_Mutex;
+
+	int m_nReadDelay;
+	int m_nDropAfter;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: creates frames of random size and content, each starting with its
+//          sequence number and size
+//-----------------------------------------------------------------------------
+static void WebSocketBench_CreateFrames(std::vector<std::string>& frames, const int numFrames, const int maxFrameSize)
+{
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> sizeDist(WSBENCH_FRAME_HEADER_SIZE, maxFrameSize);
+
+	frames.resize(numFrames);
+
+	for (int i = 0; i < numFrames; i++)
+	{
+		std::string& frame = frames[i];
+		frame.resize(sizeDist(rng));
+
+		const uint32_t header[2] = { uint32_t(i), uint32_t(frame.size()) };
+		memcpy(&frame[0], header, sizeof(header));
+
+		for (size_t j = WSBENCH_FRAME_HEADER_SIZE; j < frame.size(); j++)
+			frame[j] = char(rng());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks that every received message is an intact frame, and that
+//          the frames arrived in the order they were sent
+// Input  : *pszCase -
+//          &frames -
+//          &messages -
+// Output : true if valid, false otherwise
+//-----------------------------------------------------------------------------
+static bool WebSocketBench_Verify(const char* const pszCase, const std::vector<std::string>& frames,
+	const std::vector<std::string>& messages)
+{
+	int64_t nLastSeq = -1;
+
+	for (size_t i = 0; i < messages.size(); i++)
+	{
+		const std::string& message = messages[i];
+		uint32_t header[2];
+
+		if (message.size() < sizeof(header))
+		{
+			Error(eDLL_T::NETCON, NO_ERROR, "%s: message '%zu' is truncated ('%zu' bytes)!\n", pszCase, i, message.size());
+			return false;
+		}
+
+		memcpy(header, message.data(), sizeof(header));
+
+		if (header[0] >= frames.size() || message != frames[header[0]])
+		{
+			Error(eDLL_T::NETCON, NO_ERROR, "%s: message '%zu' doesn't match the frame that was sent!\n", pszCase, i);
+			return false;
+		}
+
+		if (int64_t(header[0]) <= nLastSeq)
+		{
+			Error(eDLL_T::NETCON, NO_ERROR, "%s: frame '%u' arrived after frame '%lld'!\n", pszCase, header[0], nLastSeq);
+			return false;
+		}
+
+		nLastSeq = header[0];
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: streams all frames to the server, a few per simulated server frame,
+//          and keeps updating the socket until everything has been sent or
+//          dropped
+// Input  : *pszCase -
+//          &server -
+//          &params -
+//          &frames -
+//          bExpectAll - whether every frame has to arrive
+// Output : true if the test passed, false otherwise
+//-----------------------------------------------------------------------------
+static bool WebSocketBench_Run(const char* const pszCase, CWebSocketBenchServer& server,
+	const CWebSocket::ConnParams_s& params, const std::vector<std::string>& frames, const bool bExpectAll)
+{
+	const std::string address = Format("ws://127.0.0.1:%d", server.GetPort());
+
+	CWebSocket webSocket;
+	const char* initError = nullptr;
+
+	if (!webSocket.Init(address.c_str(), params, initError))
+	{
+		Error(eDLL_T::NETCON, NO_ERROR, "%s: failed to initialize WebSocket: %s\n", pszCase, initError);
+		return false;
+	}
+
+	CCycleCount sendTime;
+	CFastTimer timer;
+
+	const int numFrames = int(frames.size());
+	const int framesPerUpdate = 4;
+
+	for (int i = 0; i < numFrames; i += framesPerUpdate)
+	{
+		timer.Start();
+
+		for (int j = i; j < Min(i + framesPerUpdate, numFrames); j++)
+			webSocket.SendData(frames[j].data(), int32_t(frames[j].size()));
+
+		webSocket.Update();
+
+		timer.End();
+		sendTime += timer.GetDuration();
+	}
+
+	CWebSocket::ConnMetrics_s metrics;
+	const double startTime = Plat_FloatTime();
+
+	size_t lastMessageCount = 0;
+	double lastMessageTime = startTime;
+
+	for (;;)
+	{
+		webSocket.Update();
+		webSocket.GetMetrics(metrics);
+
+		const size_t messageCount = server.GetMessageCount();
+		const double currTime = Plat_FloatTime();
+
+		if (messageCount != lastMessageCount)
+		{
+			lastMessageCount = messageCount;
+			lastMessageTime = currTime;
+		}
+
+		if (!metrics.queuedFrames)
+		{
+			if (messageCount >= metrics.sentFrames)
+				break;
+
+			// Frames the socket took right before the peer dropped the
+			// connection never arrive, stop once nothing arrives anymore.
+			if (!bExpectAll && currTime - lastMessageTime > 1.0)
+				break;
+		}
+
+		if (currTime - startTime > 60.0)
+		{
+			Error(eDLL_T::NETCON, NO_ERROR, "%s: timed out with '%d' frames queued and '%zu' of '%llu' sent frames received!\n",
+				pszCase, metrics.queuedFrames, server.GetMessageCount(), metrics.sentFrames);
+
+			webSocket.Shutdown();
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	webSocket.Shutdown();
+	server.Stop();
+
+	if (!WebSocketBench_Verify(pszCase, frames, server.m_Messages))
+		return false;
+
+	if (server.m_nProtocolErrors)
+	{
+		Error(eDLL_T::NETCON, NO_ERROR, "%s: server saw '%d' protocol error(s)!\n", pszCase, server.m_nProtocolErrors.load());
+		return false;
+	}
+
+	if (metrics.sentFrames + metrics.droppedFrames != uint64_t(numFrames))
+	{
+		Error(eDLL_T::NETCON, NO_ERROR, "%s: '%llu' frames sent and '%llu' dropped, expected '%d' in total!\n",
+			pszCase, metrics.sentFrames, metrics.droppedFrames, numFrames);
+		return false;
+	}
+
+	if (bExpectAll && server.m_Messages.size() != frames.size())
+	{
+		Error(eDLL_T::NETCON, NO_ERROR, "%s: '%zu' of '%zu' frames received!\n", pszCase, server.m_Messages.size(), frames.size());
+		return false;
+	}
+
+	Msg(eDLL_T::NETCON, "%s: '%zu' received, '%llu' dropped, '%d' connection(s), max latency '%.3f' seconds\n", pszCase,
+		server.m_Messages.size(), metrics.droppedFrames, server.m_nConnections.load(), metrics.maxSendLatency);
+
+	char szName[64];
+	snprintf(szName, sizeof(szName), "%s, sending thread", pszCase);
+
+	Benchmark_Report(szName, sendTime, numFrames, "frame");
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	Benchmark_Init();
+
+	const int numFrames = Benchmark_GetArgInt(argc, argv, 1, 2000);
+	const int maxFrameSize = Max(Benchmark_GetArgInt(argc, argv, 2, 16384), WSBENCH_FRAME_HEADER_SIZE);
+
+	WSADATA wsaData;
+
+	if (::WSAStartup(MAKEWORD(2, 2), &wsaData) != 0 || NetConnStartup("-servicename=websocket_bench") < 0)
+	{
+		Error(eDLL_T::NETCON, NO_ERROR, "Failed to start the network modules!\n");
+		Benchmark_Shutdown();
+
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::string> frames;
+	WebSocketBench_CreateFrames(frames, numFrames, maxFrameSize);
+
+	Msg(eDLL_T::NETCON, "Sending '%d' frames of up to '%d' bytes\n", numFrames, maxFrameSize);
+
+	struct TestCase_s
+	{
+		const char* pszName;
+		int nReadDelay;
+		int nDropAfter;
+		int32_t nMaxQueueSize;
+		CWebSocket::DropPolicy_e dropPolicy;
+		bool bExpectAll;
+	};
+
+	const TestCase_s testCases[] =
+	{
+		{ "Fast peer",                     0,   0, 64 * 1024 * 1024, CWebSocket::DP_DROP_OLDEST, true  },
+		{ "Slow peer, drop oldest",        1,   0, 256 * 1024,       CWebSocket::DP_DROP_OLDEST, false },
+		{ "Slow peer, drop newest",        1,   0, 256 * 1024,       CWebSocket::DP_DROP_NEWEST, false },
+		{ "Disconnecting peer",            0, 100, 64 * 1024 * 1024, CWebSocket::DP_DROP_OLDEST, false },
+	};
+
+	bool failed = false;
+
+	for (const TestCase_s& testCase : testCases)
+	{
+		CWebSocketBenchServer server;
+
+		if (!server.Start(testCase.nReadDelay, testCase.nDropAfter))
+		{
+			Error(eDLL_T::NETCON, NO_ERROR, "%s: failed to start the stand-in server!\n", testCase.pszName);
+			failed = true;
+
+			break;
+		}
+
+		CWebSocket::ConnParams_s params;
+
+		params.bufSize = WSBENCH_SOCKET_BUFFER_SIZE;
+		params.maxRetries = INT_MAX - 1; // Reconnect as often as the server drops us.
+		params.maxQueueSize = testCase.nMaxQueueSize;
+		params.dropPolicy = testCase.dropPolicy;
+
+		if (!WebSocketBench_Run(testCase.pszName, server, params, frames, testCase.bExpectAll))
+			failed = true;
+	}
+
+	NetConnShutdown(0);
+	::WSACleanup();
+
+	Benchmark_Shutdown();
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
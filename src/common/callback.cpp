@@ -114,6 +114,9 @@ void Host_Changelevel_f(const CCommand& args)
 static ConVar fs_packedstore_workspace("fs_packedstore_workspace", "ship", FCVAR_DEVELOPMENTONLY, "Determines the current VPK workspace.");
 static ConVar fs_packedstore_compression_level("fs_packedstore_compression_level", "default", FCVAR_DEVELOPMENTONLY, "Determines the VPK compression level.", "fastest faster default better uber");
 static ConVar fs_packedstore_max_helper_threads("fs_packedstore_max_helper_threads", "-1", FCVAR_DEVELOPMENTONLY, "Max # of additional \"helper\" threads to create during compression.", true, -1, true, LZHAM_MAX_HELPER_THREADS, "Must range between [-1,LZHAM_MAX_HELPER_THREADS], where -1=max practical");
+static ConVar fs_packedstore_max_worker_threads("fs_packedstore_max_worker_threads", "-1", FCVAR_DEVELOPMENTONLY, "Max # of threads to pack or unpack entries on.", false, 0.f, false, 0.f, "-1=all available cores");
+static ConVar fs_packedstore_save_chunk_index("fs_packedstore_save_chunk_index", "0", FCVAR_DEVELOPMENTONLY, "Save the chunk deduplication index next to the VPK directory file after packing.");
+static ConVar fs_packedstore_incremental("fs_packedstore_incremental", "0", FCVAR_DEVELOPMENTONLY, "Reuse unchanged entries from the previously built VPK instead of recompressing them.");
 
 /*
 =====================
@@ -147,7 +150,9 @@ void VPK_Pack_f(const CCommand& args)
 	CPackedStoreBuilder builder;
 
 	builder.InitLzEncoder(fs_packedstore_max_helper_threads.GetInt(), fs_packedstore_compression_level.GetString());
-	builder.PackStore(pair, workspacePath, "vpk/");
+	builder.InitChunkIndex(fs_packedstore_save_chunk_index.GetBool());
+	builder.InitIncrementalBuild(fs_packedstore_incremental.GetBool());
+	builder.PackStore(pair, workspacePath, "vpk/", fs_packedstore_max_worker_threads.GetInt());
 
 	timer.End();
 	Msg(eDLL_T::FS, "*** Time elapsed: '%lf' seconds\n", timer.GetDuration().GetSeconds());
@@ -186,7 +191,7 @@ void VPK_Unpack_f(const CCommand& args)
 	CPackedStoreBuilder builder;
 
 	builder.InitLzDecoder();
-	builder.UnpackStore(vpk, fs_packedstore_workspace.GetString());
+	builder.UnpackStore(vpk, fs_packedstore_workspace.GetString(), fs_packedstore_max_worker_threads.GetInt());
 
 	timer.End();
 	Msg(eDLL_T::FS, "*** Time elapsed: '%lf' seconds\n", timer.GetDuration().GetSeconds());
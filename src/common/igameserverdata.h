@@ -7,6 +7,9 @@
 
 typedef int SocketHandle_t;
 
+// Length-prefixed message frame, shared between all connections it is sent to.
+typedef std::shared_ptr<const vector<char>> NetConFrame_t;
+
 enum class ServerDataRequestType_t : int
 {
 	SERVERDATA_REQUEST_VALUE = 0,
@@ -40,6 +43,11 @@ public:
 	bool m_bInputOnly;      // If set, don't send spew to this netconsole.
 	vector<uint8_t> m_RecvBuffer;
 
+	std::deque<NetConFrame_t> m_SendQueue; // Frames waiting for the socket to become writable.
+	size_t m_nSendOffset;    // Num bytes sent from the frame at the front of the send queue.
+	size_t m_nSendQueueSize; // Num bytes waiting in the send queue.
+	bool m_bSendFailed;      // Set when the socket errored or the send queue overflowed.
+
 	CConnectedNetConsoleData(SocketHandle_t hSocket = -1)
 	{
 		m_hSocket = hSocket;
@@ -50,6 +58,9 @@ public:
 		m_bValidated = false;
 		m_bAuthorized = false;
 		m_bInputOnly = true;
+		m_nSendOffset = 0;
+		m_nSendQueueSize = 0;
+		m_bSendFailed = false;
 		m_RecvBuffer.resize(sizeof(u_long)); // Reserve enough for length-prefix.
 	}
 };
@@ -16,8 +16,12 @@
 #include "windows/console.h"
 #include "windows/system.h"
 #include "mathlib/mathlib.h"
+#include "mathlib/parallel_for.h"
 #include "launcher/launcher.h"
 #include "protobuf/stubs/common.h"
+#include "networksystem/pylon.h"
+#include "networksystem/bansystem.h"
+#include "engine/client/client.h"
 #ifndef DEDICATED
 #include "gameui/imgui_system.h"
 #endif // !DEDICATED
@@ -180,8 +184,18 @@ void SDK_Shutdown()
 
     Msg(eDLL_T::NONE, "GameSDK shutdown initiated\n");
 
+    // Request workers must be stopped before curl is cleaned up.
+    g_MasterServer.Shutdown();
     curl_global_cleanup();
 
+#ifndef CLIENT_DLL
+    OnlineAuth_Shutdown();
+#endif // !CLIENT_DLL
+    parallel_shutdown();
+
+    // Let a pending ban list snapshot finish writing.
+    g_BanSystem.Shutdown();
+
 #ifndef DEDICATED
     Input_Shutdown();
 #endif // !DEDICATED
@@ -441,10 +441,13 @@ void QuerySystemInfo()
 
 #if defined (DEDICATED)
 #define SIGDB_FILE "cfg/server/startup.bin"
+#define SIGDB_PATTERN_LIST_FILE "cfg/server/startup_patterns.bin"
 #elif defined (CLIENT_DLL)
 #define SIGDB_FILE "cfg/client/startup.bin"
+#define SIGDB_PATTERN_LIST_FILE "cfg/client/startup_patterns.bin"
 #else
 #define SIGDB_FILE "cfg/startup.bin"
+#define SIGDB_PATTERN_LIST_FILE "cfg/startup_patterns.bin"
 #endif
 
 void DetourInit() // Run the sigscan
@@ -454,7 +457,23 @@ void DetourInit() // Run the sigscan
 	bool bInitDivider = false;
 
 	g_SigCache.SetDisabled(bNoSmap);
-	g_SigCache.ReadCache(SIGDB_FILE);
+
+	// If the cache is absent, outdated, corrupt or disabled, find the patterns
+	// of the last run in a single pass instead of one by one. The pattern list
+	// is kept across SDK releases, the keys of an outdated cache are used if
+	// there is no list yet. On the very first run there is neither, and the
+	// patterns are found one by one.
+	if (!g_SigCache.ReadCache(SIGDB_FILE))
+	{
+		if (g_SigCache.ReadPatternList(SIGDB_PATTERN_LIST_FILE))
+		{
+			g_GameDll.PrefetchPatterns(g_SigCache.GetPatternList());
+		}
+		else if (!g_SigCache.GetOutdatedKeys().empty())
+		{
+			g_GameDll.PrefetchPatterns(g_SigCache.GetOutdatedKeys());
+		}
+	}
 
 	// No debug logging in non dev builds.
 	const bool bDevMode = !IsCert() && !IsRetail();
@@ -482,7 +501,11 @@ void DetourInit() // Run the sigscan
 	Dedicated_Init();
 #endif // DEDICATED
 
-	g_SigCache.WriteCache(SIGDB_FILE);
+	if (g_SigCache.WriteCache(SIGDB_FILE))
+	{
+		g_SigCache.WritePatternList(SIGDB_PATTERN_LIST_FILE);
+	}
+
 	g_SigCache.InvalidateMap();
 		}
 
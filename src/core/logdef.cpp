@@ -1,5 +1,6 @@
 #include "core/stdafx.h"
 #include "core/logdef.h"
+#include "core/logger.h"
 
 std::shared_ptr<spdlog::logger> g_TermLogger;
 std::shared_ptr<spdlog::logger> g_ImGuiLogger;
@@ -110,6 +111,9 @@ void SpdLog_Init(const bool bAnsiColor)
 	spdlog::set_level(spdlog::level::trace);
 	spdlog::flush_every(std::chrono::seconds(5));
 
+	// Emit log records from a separate thread from here on.
+	EngineLoggerSink_StartWriter();
+
 	bInitialized = true;
 }
 
@@ -118,6 +122,9 @@ void SpdLog_Init(const bool bAnsiColor)
 //#############################################################################
 void SpdLog_Shutdown()
 {
+	// Drain all queued log records before the loggers are destroyed.
+	EngineLoggerSink_StopWriter();
+
 	spdlog::shutdown();
 #ifdef _TOOLS
 	// Destroy the tools logger to flush it.
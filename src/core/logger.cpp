@@ -15,9 +15,319 @@
 #ifndef _TOOLS
 #include "vscript/languages/squirrel_re/include/sqstdaux.h"
 #endif // !_TOOLS
-static const std::regex s_AnsiRowRegex("\\\033\\[.*?m");
 static std::mutex s_LogMutex;
 
+//-----------------------------------------------------------------------------
+// Log records are handed off to a writer thread through a bounded lock-free
+// queue, so the caller only pays for formatting the message. The writer emits
+// them to the terminal, the debugger and the log files in submission order.
+//-----------------------------------------------------------------------------
+#define LOG_QUEUE_SIZE 4096 // Must be a power of two.
+
+struct LogRecord_t
+{
+	string message;        // Still contains the ANSI rows if bUseColor is set.
+	const char* pszLogger; // Name of the file logger, always a string literal.
+	bool bToConsole;
+	bool bUseColor;
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: bounded multi-producer single-consumer queue; every slot carries a
+//			sequence number that tells whether it is free for the producer at
+//			that position or filled for the consumer
+//-----------------------------------------------------------------------------
+class CLogQueue
+{
+public:
+	CLogQueue(void)
+		: m_nEnqueuePos(0)
+		, m_nDequeuePos(0)
+	{
+		for (size_t i = 0; i < LOG_QUEUE_SIZE; i++)
+			m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	// Returns the position of the record, or -1 if the queue is full.
+	int64_t TryPush(LogRecord_t& record)
+	{
+		size_t pos = m_nEnqueuePos.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Slot_t& slot = m_Slots[pos & (LOG_QUEUE_SIZE - 1)];
+
+			const size_t seq = slot.sequence.load(std::memory_order_acquire);
+			const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+
+			if (diff == 0)
+			{
+				if (m_nEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					slot.record = std::move(record);
+					slot.sequence.store(pos + 1, std::memory_order_release);
+
+					return int64_t(pos);
+				}
+			}
+			else if (diff < 0)
+				return -1; // Writer hasn't caught up yet.
+			else
+				pos = m_nEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Consumer only.
+	bool TryPop(LogRecord_t& record)
+	{
+		Slot_t& slot = m_Slots[m_nDequeuePos & (LOG_QUEUE_SIZE - 1)];
+
+		if (slot.sequence.load(std::memory_order_acquire) != m_nDequeuePos + 1)
+			return false;
+
+		record = std::move(slot.record);
+		slot.sequence.store(m_nDequeuePos + LOG_QUEUE_SIZE, std::memory_order_release);
+
+		m_nDequeuePos++;
+		return true;
+	}
+
+	// Consumer only.
+	bool IsEmpty(void) const
+	{
+		const Slot_t& slot = m_Slots[m_nDequeuePos & (LOG_QUEUE_SIZE - 1)];
+		return slot.sequence.load(std::memory_order_acquire) != m_nDequeuePos + 1;
+	}
+
+private:
+	struct Slot_t
+	{
+		std::atomic<size_t> sequence;
+		LogRecord_t record;
+	};
+
+	Slot_t m_Slots[LOG_QUEUE_SIZE];
+
+	alignas(64) std::atomic<size_t> m_nEnqueuePos;
+	alignas(64) size_t m_nDequeuePos;
+};
+
+static CLogQueue s_LogQueue;
+
+static std::thread s_LogWriterThread;
+static HANDLE s_hLogWriterEvent = NULL;
+
+static std::atomic<bool> s_bLogWriterRunning = false;
+static std::atomic<bool> s_bLogWriterStop = false;
+static std::atomic<bool> s_bLogWriterSleeping = false;
+static std::atomic<int64_t> s_nLogRecordsWritten = 0;
+
+//-----------------------------------------------------------------------------
+// Purpose: removes all ANSI rows from the message in place
+// Input  : &message - 
+//-----------------------------------------------------------------------------
+static void Logger_StripAnsiRows(string& message)
+{
+	char* const pData = message.data();
+	const size_t nLen = message.size();
+
+	size_t nOut = 0;
+
+	for (size_t i = 0; i < nLen;)
+	{
+		if (pData[i] == '\033' && i + 1 < nLen && pData[i + 1] == '[')
+		{
+			size_t nEnd = i + 2;
+
+			while (nEnd < nLen && pData[nEnd] != 'm' && pData[nEnd] != '\n')
+				nEnd++;
+
+			if (nEnd < nLen && pData[nEnd] == 'm')
+			{
+				i = nEnd + 1;
+				continue;
+			}
+		}
+
+		pData[nOut++] = pData[i++];
+	}
+
+	message.resize(nOut);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: emits a log record to the terminal, the debugger and the log file
+// Input  : &record - 
+//-----------------------------------------------------------------------------
+static void Logger_WriteRecord(LogRecord_t& record)
+{
+	if (record.bToConsole)
+	{
+		g_TermLogger->debug(record.message);
+
+		if (record.bUseColor)
+		{
+			// Remove ANSI rows before emitting to file.
+			Logger_StripAnsiRows(record.message);
+		}
+	}
+
+	// If a debugger is attached, emit the text there too
+	if (Plat_IsInDebugSession())
+		Plat_DebugString(record.message.c_str());
+
+#ifndef _TOOLS
+	// Resolved once per logger, only the writer thread touches this.
+	static std::unordered_map<const char*, std::shared_ptr<spdlog::logger>> s_FileLoggers;
+	auto it = s_FileLoggers.find(record.pszLogger);
+
+	if (it == s_FileLoggers.end())
+		it = s_FileLoggers.emplace(record.pszLogger, spdlog::get(record.pszLogger)).first;
+
+	// Output is always logged to the file.
+	spdlog::logger* const ntlogger = it->second.get(); // <-- Obtain by 'pszLogger'.
+	assert(ntlogger != nullptr);
+
+	if (ntlogger)
+		ntlogger->debug(record.message);
+#else
+	if (g_SuppementalToolsLogger)
+	{
+		g_SuppementalToolsLogger->debug(record.message);
+	}
+#endif // !_TOOLS
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: log writer thread, drains the queue until asked to stop
+//-----------------------------------------------------------------------------
+static void Logger_WriterThread(void)
+{
+	LogRecord_t record;
+
+	for (;;)
+	{
+		if (s_LogQueue.TryPop(record))
+		{
+			Logger_WriteRecord(record);
+			s_nLogRecordsWritten.fetch_add(1, std::memory_order_release);
+
+			continue;
+		}
+
+		if (s_bLogWriterStop)
+			break;
+
+		// Producers only signal the event when we announced we're going to
+		// wait for it, check the queue once more after announcing to not
+		// miss records pushed in between.
+		s_bLogWriterSleeping = true;
+
+		if (s_LogQueue.IsEmpty() && !s_bLogWriterStop)
+			WaitForSingleObject(s_hLogWriterEvent, 100);
+
+		s_bLogWriterSleeping = false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: hands a log record off to the writer thread, or writes it on the
+//			calling thread if the writer isn't running
+// Input  : &record - 
+// Output : position of the record in the queue, -1 if written directly
+//-----------------------------------------------------------------------------
+static int64_t Logger_SubmitRecord(LogRecord_t& record)
+{
+	if (s_bLogWriterRunning)
+	{
+		for (;;)
+		{
+			const int64_t pos = s_LogQueue.TryPush(record);
+
+			if (pos != -1)
+			{
+				if (s_bLogWriterSleeping.exchange(false))
+					SetEvent(s_hLogWriterEvent);
+
+				return pos;
+			}
+
+			if (!s_bLogWriterRunning)
+				break;
+
+			// Queue is full, wait for the writer to make room.
+			SetEvent(s_hLogWriterEvent);
+			std::this_thread::yield();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(s_LogMutex);
+	Logger_WriteRecord(record);
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: waits until the writer has emitted the record at given position
+// Input  : pos - 
+//-----------------------------------------------------------------------------
+static void Logger_WaitForRecord(const int64_t pos)
+{
+	while (pos >= 0 && s_bLogWriterRunning &&
+		s_nLogRecordsWritten.load(std::memory_order_acquire) <= pos)
+	{
+		SetEvent(s_hLogWriterEvent);
+		Sleep(1);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: starts the log writer thread
+//-----------------------------------------------------------------------------
+void EngineLoggerSink_StartWriter(void)
+{
+	if (s_bLogWriterRunning)
+		return;
+
+	s_hLogWriterEvent = CreateEventA(NULL, FALSE, FALSE, NULL);
+
+	if (!s_hLogWriterEvent)
+		return; // Records will be written on the calling thread.
+
+	s_bLogWriterStop = false;
+	s_LogWriterThread = std::thread(Logger_WriterThread);
+
+	s_bLogWriterRunning = true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: drains the log queue and stops the log writer thread
+//-----------------------------------------------------------------------------
+void EngineLoggerSink_StopWriter(void)
+{
+	if (!s_bLogWriterRunning)
+		return;
+
+	s_bLogWriterStop = true;
+	SetEvent(s_hLogWriterEvent);
+
+	// Can be called from the crash handler, which could run on the writer
+	// thread itself, don't wait on ourselves in that case.
+	if (s_LogWriterThread.get_id() != std::this_thread::get_id())
+	{
+		s_LogWriterThread.join();
+		s_bLogWriterRunning = false;
+
+		CloseHandle(s_hLogWriterEvent);
+		s_hLogWriterEvent = NULL;
+	}
+	else
+	{
+		s_bLogWriterRunning = false;
+		s_LogWriterThread.detach();
+	}
+}
+
 #if !defined (DEDICATED) && !defined (_TOOLS)
 ImVec4 CheckForWarnings(LogType_t type, eDLL_T context, const ImVec4& defaultCol)
 {
@@ -262,39 +572,43 @@ void EngineLoggerSink(LogType_t logType, LogLevel_t logLevel, eDLL_T context,
 	//-------------------------------------------------------------------------
 	// Emit to all interfaces
 	//-------------------------------------------------------------------------
-	std::lock_guard<std::mutex> lock(s_LogMutex);
+#if !defined (DEDICATED) && !defined (_TOOLS)
+	// The in-game consoles need the message without ANSI rows.
+	string strippedMessage;
+
 	if (bToConsole)
 	{
-		g_TermLogger->debug(message);
+		strippedMessage = message;
 
 		if (bUseColor)
-		{
-			// Remove ANSI rows before emitting to file or over wire.
-			message = std::regex_replace(message, s_AnsiRowRegex, "");
-		}
+			Logger_StripAnsiRows(strippedMessage);
 	}
+#endif // !DEDICATED && !_TOOLS
 
-	// If a debugger is attached, emit the text there too
-	if (Plat_IsInDebugSession())
-		Plat_DebugString(message.c_str());
+	LogRecord_t record;
 
-#ifndef _TOOLS
-	// Output is always logged to the file.
-	std::shared_ptr<spdlog::logger> ntlogger = spdlog::get(pszLogger); // <-- Obtain by 'pszLogger'.
-	assert(ntlogger.get() != nullptr);
-	ntlogger->debug(message);
+	record.message = std::move(message);
+	record.pszLogger = pszLogger;
+	record.bToConsole = bToConsole;
+	record.bUseColor = bUseColor;
+
+	const int64_t recordPos = Logger_SubmitRecord(record);
 
+#ifndef _TOOLS
 	if (bToConsole)
 	{
 #ifndef CLIENT_DLL
-		if (!LoggedFromClient(context) && RCONServer()->ShouldSend(netcon::response_e::SERVERDATA_RESPONSE_CONSOLE_LOG))
+		// Only serializes the message and hands it to the RCON server frame,
+		// which is the only one touching the sockets.
+		if (!LoggedFromClient(context) && RCONServer()->ShouldSendConsoleLogs())
 		{
 			RCONServer()->SendEncoded(formatted.c_str(), pszUpTime, netcon::response_e::SERVERDATA_RESPONSE_CONSOLE_LOG,
 				int(context), int(logType));
 		}
 #endif // !CLIENT_DLL
 #ifndef DEDICATED
-		g_ImGuiLogger->debug(message);
+		std::lock_guard<std::mutex> lock(s_LogMutex);
+		g_ImGuiLogger->debug(strippedMessage);
 
 		const string logStreamBuf = g_LogStream.str();
 		g_Console.AddLog(logStreamBuf.c_str(), ImGui::ColorConvertFloat4ToU32(overlayColor));
@@ -306,23 +620,18 @@ void EngineLoggerSink(LogType_t logType, LogLevel_t logLevel, eDLL_T context,
 			// Draw to mini console.
 			g_TextOverlay.AddLog(overlayContext, logStreamBuf.c_str());
 		}
-#endif // !DEDICATED
-	}
 
-#ifndef DEDICATED
-	g_LogStream.str(string());
-	g_LogStream.clear();
+		g_LogStream.str(string());
+		g_LogStream.clear();
 #endif // !DEDICATED
-
-#else
-	if (g_SuppementalToolsLogger)
-	{
-		g_SuppementalToolsLogger->debug(message);
 	}
-#endif
+#endif // !_TOOLS
 
 	if (exitCode) // Terminate the process if an exit code was passed.
 	{
+		// Make sure the message made it to the log files first.
+		Logger_WaitForRecord(recordPos);
+
 #ifndef _TOOLS
 		if (!CommandLine()->CheckParm("-nomessagebox"))
 #endif // !_TOOLS
@@ -5,4 +5,7 @@ void EngineLoggerSink(LogType_t logType, LogLevel_t logLevel, eDLL_T context,
 	const char* pszLogger, const char* pszFormat, va_list args,
 	const UINT exitCode /*= NO_ERROR*/, const char* pszUptimeOverride /*= nullptr*/);
 
+void EngineLoggerSink_StartWriter(void);
+void EngineLoggerSink_StopWriter(void);
+
 #endif // LOGGER_H
@@ -33,6 +33,8 @@
 #include <cinttypes>
 #include <regex>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <thread>
 #include <vector>
 #include <string>
@@ -45,6 +47,7 @@
 #include <map>
 #include <unordered_map>
 #include <set>
+#include <deque>
 #include <unordered_set>
 #include <functional>
 
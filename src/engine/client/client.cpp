@@ -16,7 +16,9 @@
 #include "engine/client/client.h"
 #ifndef CLIENT_DLL
 #include "networksystem/hostmanager.h"
+#include "tier0/frametask.h"
 #include "jwt/include/decode.h"
+#include "mbedtls/include/mbedtls/pk.h"
 #include "mbedtls/include/mbedtls/sha256.h"
 #endif
 #include "game/server/gameinterface.h"
@@ -24,6 +26,9 @@
 // Absolute max string cmd length, any character past this will be NULLED.
 #define STRINGCMD_MAX_LEN 512
 
+#define ONLINE_AUTH_WORKER_COUNT 2 // Number of threads verifying online authentication tokens.
+#define ONLINE_AUTH_MAX_QUEUED_REQUESTS 128 // Verifications beyond this are done inline.
+
 //---------------------------------------------------------------------------------
 // Purpose: throw away any residual garbage in the channel
 //---------------------------------------------------------------------------------
@@ -77,20 +82,132 @@ static ConVar sv_onlineAuthIssuedAtTolerance("sv_onlineAuthIssuedAtTolerance", "
 
 static ConVar sv_quota_stringCmdsPerSecond("sv_quota_stringCmdsPerSecond", "32", FCVAR_RELEASE, "How many string commands per second clients are allowed to submit, 0 to disallow all string commands", true, 0.f, false, 0.f);
 
+#ifndef CLIENT_DLL
 //---------------------------------------------------------------------------------
-// Purpose: check whether this client is authorized to join this server
-// Input  : *playerName  - 
+// Online authentication token verification request, holds everything needed to
+// verify the token so it can be verified off the main thread
+//---------------------------------------------------------------------------------
+struct OnlineAuthRequest_s
+{
+	CClient* client;
+	uint32_t serial;
+	NucleusID_t nucleusId;
+
+	string token;
+	string sessionData; // The session id in the token must be the hash of this.
+
+	bool validateExpiry;
+	bool validateIssuedAt;
+	uint8_t expiryTolerance;
+	uint8_t issuedAtTolerance;
+};
+
+//---------------------------------------------------------------------------------
+// Parsed public key, parsed once per thread as mbedtls may cache values in the
+// context while verifying
+//---------------------------------------------------------------------------------
+class COnlineAuthKey
+{
+public:
+	COnlineAuthKey()
+	{
+		mbedtls_pk_init(&m_Context);
+		m_bValid = mbedtls_pk_parse_public_key(&m_Context,
+			(const unsigned char*)JWT_PUBLIC_KEY, sizeof(JWT_PUBLIC_KEY)) == 0;
+	}
+	~COnlineAuthKey()
+	{
+		mbedtls_pk_free(&m_Context);
+	}
+
+	inline mbedtls_pk_context* Get() { return m_bValid ? &m_Context : nullptr; }
+
+private:
+	mbedtls_pk_context m_Context;
+	bool m_bValid;
+};
+
+static mbedtls_pk_context* OnlineAuth_GetKey()
+{
+	static thread_local COnlineAuthKey s_Key;
+	return s_Key.Get();
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: gathers the token and session data of a client
+// Input  : *pClient     - 
+//			*pConVars    - 
+//			nucleusId    - the id from the client's data block
+//			*playerName  - 
+//			&request     - 
 //			*reasonBuf   - 
 //			reasonBufLen - 
-// Output : true if authorized, false otherwise
+// Output : true on success, false otherwise
 //---------------------------------------------------------------------------------
-bool CClient::Authenticate(const char* const playerName, char* const reasonBuf, const size_t reasonBufLen)
+static bool OnlineAuth_BuildRequest(CClient* const pClient, KeyValues* const pConVars, const NucleusID_t nucleusId,
+	const char* const playerName, OnlineAuthRequest_s& request, char* const reasonBuf, const size_t reasonBufLen)
 {
-#ifndef CLIENT_DLL
-	// don't bother checking origin auth on bots or local clients
-	if (IsFakeClient() || GetNetChan()->GetRemoteAddress().IsLoopback())
-		return true;
+	KeyValues* const cl_onlineAuthTokenKv = pConVars->FindKey("cl_onlineAuthToken");
+	KeyValues* const cl_onlineAuthTokenSignature1Kv = pConVars->FindKey("cl_onlineAuthTokenSignature1");
+	KeyValues* const cl_onlineAuthTokenSignature2Kv = pConVars->FindKey("cl_onlineAuthTokenSignature2");
+
+	if (!cl_onlineAuthTokenKv || !cl_onlineAuthTokenSignature1Kv)
+	{
+		V_snprintf(reasonBuf, reasonBufLen, "Missing token");
+		return false;
+	}
+
+	const char* const onlineAuthToken = cl_onlineAuthTokenKv->GetString();
+	const char* const onlineAuthTokenSignature1 = cl_onlineAuthTokenSignature1Kv->GetString();
+	const char* const onlineAuthTokenSignature2 = cl_onlineAuthTokenSignature2Kv ? cl_onlineAuthTokenSignature2Kv->GetString() : "";
+
+	char fullToken[1024]; // enough buffer for 3x255, which is cvar count * userinfo str limit.
+	const int tokenLen = snprintf(fullToken, sizeof(fullToken), "%s.%s%s",
+		onlineAuthToken, onlineAuthTokenSignature1, onlineAuthTokenSignature2);
+
+	if (tokenLen < 0)
+	{
+		V_snprintf(reasonBuf, reasonBufLen, "Token stitching failed");
+		return false;
+	}
+
+	char sessionData[256];
+	const int sessionLen = snprintf(sessionData, sizeof(sessionData), "%llu-%s-%s",
+		nucleusId,
+		playerName,
+		g_ServerHostManager.GetHostIP().c_str());
+
+	if (sessionLen < 0)
+	{
+		V_snprintf(reasonBuf, reasonBufLen, "Session ID stitching failed");
+		return false;
+	}
+
+	request.client = pClient;
+	request.serial = 0;
+	request.nucleusId = nucleusId;
+
+	request.token.assign(fullToken, Min(size_t(tokenLen), sizeof(fullToken) - 1));
+	request.sessionData.assign(sessionData, Min(size_t(sessionLen), sizeof(sessionData) - 1));
+
+	request.validateExpiry = sv_onlineAuthValidateExpiry.GetBool();
+	request.expiryTolerance = (uint8_t)sv_onlineAuthExpiryTolerance.GetInt();
+
+	request.validateIssuedAt = sv_onlineAuthValidateIssuedAt.GetBool();
+	request.issuedAtTolerance = (uint8_t)sv_onlineAuthIssuedAtTolerance.GetInt();
 
+	return true;
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: verifies the token of a request, can be called from any thread
+// Input  : &request     - 
+//			*reasonBuf   - 
+//			reasonBufLen - 
+// Output : true if authorized, false otherwise
+//---------------------------------------------------------------------------------
+static bool OnlineAuth_Verify(const OnlineAuthRequest_s& request, char* const reasonBuf, const size_t reasonBufLen)
+{
 	l8w8jwt_claim* claims = nullptr;
 	size_t numClaims = 0;
 
@@ -104,40 +221,25 @@ bool CClient::Authenticate(const char* const playerName, char* const reasonBuf,
 			return false; \
 		} while(0)\
 
-	KeyValues* const cl_onlineAuthTokenKv = this->m_ConVars->FindKey("cl_onlineAuthToken");
-	KeyValues* const cl_onlineAuthTokenSignature1Kv = this->m_ConVars->FindKey("cl_onlineAuthTokenSignature1");
-	KeyValues* const cl_onlineAuthTokenSignature2Kv = this->m_ConVars->FindKey("cl_onlineAuthTokenSignature2");
-
-	if (!cl_onlineAuthTokenKv || !cl_onlineAuthTokenSignature1Kv)
-		ERROR_AND_RETURN("Missing token");
-
-	const char* const onlineAuthToken = cl_onlineAuthTokenKv->GetString();
-	const char* const onlineAuthTokenSignature1 = cl_onlineAuthTokenSignature1Kv->GetString();
-	const char* const onlineAuthTokenSignature2 = cl_onlineAuthTokenSignature2Kv->GetString();
-
-	char fullToken[1024]; // enough buffer for 3x255, which is cvar count * userinfo str limit.
-	const int tokenLen = snprintf(fullToken, sizeof(fullToken), "%s.%s%s", 
-		onlineAuthToken, onlineAuthTokenSignature1, onlineAuthTokenSignature2);
-
-	if (tokenLen < 0)
-		ERROR_AND_RETURN("Token stitching failed");
-
 	struct l8w8jwt_decoding_params params;
 	l8w8jwt_decoding_params_init(&params);
 
 	params.alg = L8W8JWT_ALG_RS256;
 
-	params.jwt = (char*)fullToken;
-	params.jwt_length = tokenLen;
+	params.jwt = (char*)request.token.c_str();
+	params.jwt_length = request.token.length();
 
 	params.verification_key = (unsigned char*)JWT_PUBLIC_KEY;
 	params.verification_key_length = sizeof(JWT_PUBLIC_KEY);
 
-	params.validate_exp = sv_onlineAuthValidateExpiry.GetBool();
-	params.exp_tolerance_seconds = (uint8_t)sv_onlineAuthExpiryTolerance.GetInt();
+	// Parsed once per thread, rather than on every decode.
+	params.verification_pk = OnlineAuth_GetKey();
+
+	params.validate_exp = request.validateExpiry;
+	params.exp_tolerance_seconds = request.expiryTolerance;
 
-	params.validate_iat = sv_onlineAuthValidateIssuedAt.GetBool();
-	params.iat_tolerance_seconds = (uint8_t)sv_onlineAuthIssuedAtTolerance.GetInt();
+	params.validate_iat = request.validateIssuedAt;
+	params.iat_tolerance_seconds = request.issuedAtTolerance;
 
 	enum l8w8jwt_validation_result validation_result;
 	const int r = l8w8jwt_decode(&params, &validation_result, &claims, &numClaims);
@@ -161,20 +263,11 @@ bool CClient::Authenticate(const char* const playerName, char* const reasonBuf,
 		{
 			const char* const sessionId = claims[i].value;
 
-			char newId[256];
-			const int idLen = snprintf(newId, sizeof(newId), "%llu-%s-%s",
-				(NucleusID_t)this->m_DataBlock.userData,
-				playerName,
-				g_ServerHostManager.GetHostIP().c_str());
-
-			if (idLen < 0)
-				ERROR_AND_RETURN("Session ID stitching failed");
-
 			uint8_t sessionHash[32]; // hash decoded from JWT token
 			V_hextobinary(sessionId, strlen(sessionId), sessionHash, sizeof(sessionHash));
 
 			uint8_t oobHash[32]; // hash of data collected from out of band packet
-			const int shRet = mbedtls_sha256((const uint8_t*)newId, idLen, oobHash, NULL);
+			const int shRet = mbedtls_sha256((const uint8_t*)request.sessionData.c_str(), request.sessionData.length(), oobHash, NULL);
 
 			if (shRet != NULL)
 				ERROR_AND_RETURN("Session ID hashing failed");
@@ -192,9 +285,207 @@ bool CClient::Authenticate(const char* const playerName, char* const reasonBuf,
 	l8w8jwt_free_claims(claims, numClaims);
 
 #undef ERROR_AND_RETURN
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: applies the verification result of a client; admits the client by
+//          resuming its signon if the verification succeeded, and removes the
+//          client otherwise; main thread only
+// Input  : *pClient  - 
+//			serial    - 
+//			nucleusId - 
+//			bSuccess  - 
+//			&reason   - 
+//---------------------------------------------------------------------------------
+static void OnlineAuth_Finish(CClient* const pClient, const uint32_t serial, const NucleusID_t nucleusId,
+	const bool bSuccess, const string& reason)
+{
+	CClientExtended* const pSlot = pClient->GetClientExtended();
+
+	// The client left or the slot has been taken by another client since.
+	if (!pSlot->IsAuthPending() || pSlot->m_nAuthSerial != serial)
+		return;
+
+	pSlot->m_bAuthPending = false;
+
+	if (bSuccess)
+	{
+		const SIGNONSTATE heldSignonState = pSlot->m_nHeldSignonState;
+		pSlot->m_nHeldSignonState = SIGNONSTATE::SIGNONSTATE_NONE;
+
+		// Resume the signon from where it was held.
+		if (heldSignonState != SIGNONSTATE::SIGNONSTATE_NONE)
+			CClient__SetSignonState(pClient, heldSignonState);
+
+		return;
+	}
+
+	if (sv_showconnecting.GetBool())
+	{
+		const CNetChan* const pNetChan = pClient->GetNetChan();
+		const char* const netAdr = pNetChan ? pNetChan->GetAddress() : "<unknown>";
+
+		Warning(eDLL_T::SERVER, "Client '%s' ('%llu') failed online authentication! [%s]\n",
+			netAdr, nucleusId, reason.c_str());
+	}
+
+	pClient->Disconnect(Reputation_t::REP_NONE, "Failed to verify authentication token [%s]", reason.c_str());
+}
+
+//---------------------------------------------------------------------------------
+// Pool of threads verifying online authentication tokens, results are applied
+// on the main thread through 'g_TaskQueue'
+//---------------------------------------------------------------------------------
+class COnlineAuthPool
+{
+public:
+	COnlineAuthPool()
+		: m_bStarted(false)
+		, m_bShutdown(false)
+	{}
+
+	bool Queue(OnlineAuthRequest_s& request);
+	void Shutdown();
+
+private:
+	void WorkerThread();
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<OnlineAuthRequest_s> m_Requests;
+	std::vector<std::thread> m_Workers;
+	bool m_bStarted;
+	bool m_bShutdown;
+};
+
+//---------------------------------------------------------------------------------
+// Purpose: queues a request, starts the workers on first use
+// Input  : &request - contents are moved into the queue on success
+// Output : true if queued, false if the queue is full or the pool is shut down
+//---------------------------------------------------------------------------------
+bool COnlineAuthPool::Queue(OnlineAuthRequest_s& request)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (m_bShutdown || m_Requests.size() >= ONLINE_AUTH_MAX_QUEUED_REQUESTS)
+		return false;
+
+	if (!m_bStarted)
+	{
+		m_bStarted = true;
+		m_Workers.reserve(ONLINE_AUTH_WORKER_COUNT);
+
+		for (int i = 0; i < ONLINE_AUTH_WORKER_COUNT; i++)
+			m_Workers.emplace_back(&COnlineAuthPool::WorkerThread, this);
+	}
+
+	m_Requests.push_back(std::move(request));
+	m_Condition.notify_one();
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: stops the workers, requests that haven't started are dropped
+//---------------------------------------------------------------------------------
+void COnlineAuthPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		m_bShutdown = true;
+		m_Requests.clear();
+	}
+
+	m_Condition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+
+	m_Workers.clear();
+}
+
+//---------------------------------------------------------------------------------
+// Purpose: verifies queued requests
+//---------------------------------------------------------------------------------
+void COnlineAuthPool::WorkerThread()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	for (;;)
+	{
+		m_Condition.wait(lock, [this] { return m_bShutdown || !m_Requests.empty(); });
+
+		if (m_bShutdown)
+			break;
+
+		const OnlineAuthRequest_s request = std::move(m_Requests.front());
+		m_Requests.pop_front();
+
+		lock.unlock();
+
+		char reasonBuf[512];
+		const bool bSuccess = OnlineAuth_Verify(request, reasonBuf, sizeof(reasonBuf));
+
+		const string reason = bSuccess ? "" : reasonBuf;
+		CClient* const pClient = request.client;
+		const uint32_t serial = request.serial;
+		const NucleusID_t nucleusId = request.nucleusId;
+
+		g_TaskQueue.Dispatch([pClient, serial, nucleusId, bSuccess, reason]
+			{
+				OnlineAuth_Finish(pClient, serial, nucleusId, bSuccess, reason);
+			}, 0);
+
+		lock.lock();
+	}
+}
+
+static COnlineAuthPool s_OnlineAuthPool;
+
+//---------------------------------------------------------------------------------
+// Purpose: stops the online authentication workers
+//---------------------------------------------------------------------------------
+void OnlineAuth_Shutdown()
+{
+	s_OnlineAuthPool.Shutdown();
+}
 #endif // !CLIENT_DLL
 
+//---------------------------------------------------------------------------------
+// Purpose: queue this client for authorization, the client is held in a pending
+//          state without signon progress or usercmds until the result is
+//          applied on the main thread; verifies inline if the queue is full
+// Input  : *playerName  - 
+//			*reasonBuf   - 
+//			reasonBufLen - 
+// Output : true if queued or authorized, false otherwise
+//---------------------------------------------------------------------------------
+bool CClient::Authenticate(const char* const playerName, char* const reasonBuf, const size_t reasonBufLen)
+{
+#ifndef CLIENT_DLL
+	// don't bother checking origin auth on bots or local clients
+	if (IsFakeClient() || GetNetChan()->GetRemoteAddress().IsLoopback())
+		return true;
+
+	OnlineAuthRequest_s request;
+
+	if (!OnlineAuth_BuildRequest(this, this->m_ConVars, (NucleusID_t)this->m_DataBlock.userData, playerName, request, reasonBuf, reasonBufLen))
+		return false;
+
+	CClientExtended* const pSlot = GetClientExtended();
+	request.serial = ++pSlot->m_nAuthSerial;
+
+	if (!s_OnlineAuthPool.Queue(request))
+		return OnlineAuth_Verify(request, reasonBuf, reasonBufLen);
+
+	pSlot->m_bAuthPending = true;
 	return true;
+#else
+	return true;
+#endif // !CLIENT_DLL
 }
 
 //---------------------------------------------------------------------------------
@@ -224,6 +515,7 @@ bool CClient::Connect(const char* szName, CNetChan* pNetChan, bool bFakePlayer,
 	if (sv_onlineAuthEnable.GetBool())
 	{
 		char authFailReason[512];
+
 		if (!Authenticate(szName, authFailReason, sizeof(authFailReason)))
 		{
 			REJECT_CONNECTION("Failed to verify authentication token [%s]", authFailReason);
@@ -276,6 +568,32 @@ bool CClient::VConnectionStart(CClient* pClient, CNetChan* pChan)
 	return CClient__ConnectionStart(pClient, pChan);
 }
 
+//---------------------------------------------------------------------------------
+// Purpose: set signon state, held while the client is pending authorization
+// Input  : *pClient - 
+//			signon - 
+// Output : true on success, false otherwise
+//---------------------------------------------------------------------------------
+bool CClient::VSetSignonState(CClient* pClient, SIGNONSTATE signon)
+{
+#ifndef CLIENT_DLL
+	if (signon > SIGNONSTATE::SIGNONSTATE_CONNECTED)
+	{
+		CClientExtended* const pSlot = pClient->GetClientExtended();
+
+		// Don't send any signon data until the client has been authorized,
+		// the signon is resumed from the last requested state once it is.
+		if (pSlot->IsAuthPending())
+		{
+			pSlot->m_nHeldSignonState = signon;
+			return true;
+		}
+	}
+#endif // !CLIENT_DLL
+
+	return CClient__SetSignonState(pClient, signon);
+}
+
 //---------------------------------------------------------------------------------
 // Purpose: disconnect client
 // Input  : nRepLvl - 
@@ -434,6 +752,10 @@ bool CClient::VProcessStringCmd(CClient* pClient, NET_StringCmd* pMsg)
 
 	CClientExtended* const pSlot = pClient_Adj->GetClientExtended();
 
+	// Jettison the cmd if the client hasn't been authorized yet.
+	if (pSlot->IsAuthPending())
+		return true;
+
 	const double flStartTime = Plat_FloatTime();
 	const int nCmdQuotaLimit = sv_quota_stringCmdsPerSecond.GetInt();
 
@@ -640,6 +962,7 @@ void VClient::Detour(const bool bAttach) const
 	DetourSetup(&CClient__Connect, &CClient::VConnect, bAttach);
 	DetourSetup(&CClient__ConnectionStart, &CClient::VConnectionStart, bAttach);
 	DetourSetup(&CClient__ActivatePlayer, &CClient::VActivatePlayer, bAttach);
+	DetourSetup(&CClient__SetSignonState, &CClient::VSetSignonState, bAttach);
 	DetourSetup(&CClient__SendNetMsgEx, &CClient::VSendNetMsgEx, bAttach);
 	//DetourSetup(&CClient__SendSnapshot, &CClient::VSendSnapshot, bAttach);
 	DetourSetup(&CClient__WriteDataBlock, &CClient::WriteDataBlock, bAttach);
@@ -119,6 +119,7 @@ public: // Hook statics:
 		CUtlVector<NET_SetConVar::cvar_t>* conVars, char* szMessage, int nMessageSize);
 
 	static bool VConnectionStart(CClient* pClient, CNetChan* pChan);
+	static bool VSetSignonState(CClient* pClient, SIGNONSTATE signon);
 
 	static void VActivatePlayer(CClient* pClient);
 	static void* VSendSnapshot(CClient* pClient, CClientFrame* pFrame, int nTick, int nTickAck);
@@ -244,6 +245,7 @@ class CClientExtended
 public:
 	CClientExtended(void)
 	{
+		m_nAuthSerial = 0;
 		Reset();
 	}
 	inline void Reset(void)
@@ -254,6 +256,8 @@ public:
 		m_nStringCommandQuotaCount = NULL;
 		m_flMovementTimeForUserCmdProcessingRemaining = 0.0f;
 		m_bInitialConVarsSet = false;
+		m_bAuthPending = false;
+		m_nHeldSignonState = SIGNONSTATE::SIGNONSTATE_NONE;
 	}
 
 public: // Inlines:
@@ -273,6 +277,8 @@ public: // Inlines:
 	inline void SetRemainingMovementTimeForUserCmdProcessing(const float flValue) { m_flMovementTimeForUserCmdProcessingRemaining = flValue; }
 	inline float GetRemainingMovementTimeForUserCmdProcessing() const { return m_flMovementTimeForUserCmdProcessingRemaining; }
 
+	inline bool IsAuthPending(void) const { return m_bAuthPending; }
+
 	void InitializeMovementTimeForUserCmdProcessing(const int numUserCmdProcessTicksMax, const float tickInterval);
 	float ConsumeMovementTimeForUserCmdProcessing(const float flTimeNeeded);
 
@@ -289,8 +295,23 @@ private:
 	float m_flMovementTimeForUserCmdProcessingRemaining;
 
 	bool m_bInitialConVarsSet; // Whether or not the initial ConVar KV's are set
+
+	// Whether the online authentication token is still being verified, and the
+	// serial of the last verification; results of a verification that doesn't
+	// match the serial belong to a previous client in this slot. The serial is
+	// not reset so it stays unique across clients.
+	bool m_bAuthPending;
+	uint32_t m_nAuthSerial;
+
+	// Signon state requested while the verification was pending, the signon
+	// resumes from here once the client is authorized.
+	SIGNONSTATE m_nHeldSignonState;
 };
 
+#ifndef CLIENT_DLL
+void OnlineAuth_Shutdown();
+#endif // !CLIENT_DLL
+
 /* ==== CBASECLIENT ===================================================================================================================================================== */
 inline bool(*CClient__Connect)(CClient* pClient, const char* szName, CNetChan* pNetChan, bool bFakePlayer, CUtlVector<NET_SetConVar::cvar_t>* conVars, char* szMessage, int nMessageSize);
 inline bool(*CClient__Disconnect)(CClient* pClient, const Reputation_t nRepLvl, const char* szReason, ...);
@@ -96,7 +96,8 @@ static void HostState_KeepAlive()
 			).count()
 	};
 
-	std::thread request([&, gameServer]
+	// Skipped if the request queue is full, the next update will retry.
+	g_MasterServer.QueueRequest([gameServer]
 		{
 			string errorMsg;
 			string hostToken;
@@ -132,8 +133,6 @@ static void HostState_KeepAlive()
 				}, 0);
 		}
 	);
-
-	request.detach();
 }
 #endif // DEDICATED
 
@@ -381,6 +380,10 @@ void CHostState::Think(void) const
 		SV_CheckClientsForBan();
 		banListTimer.Start();
 	}
+	if (sv_globalBanlist.GetBool())
+	{
+		SV_RunGlobalBanChecks();
+	}
 #ifdef DEDICATED
 	if (pylonTimer.GetDurationInProgress().GetSeconds() > sv_pylonRefreshRate.GetFloat())
 	{
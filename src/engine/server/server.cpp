@@ -168,6 +168,28 @@ CClient* CServer::ConnectClient(CServer* pServer, user_creds_s* pChallenge)
 		}
 	}
 
+	// Clients connecting over loopback are never checked.
+	const bool bCheckGlobalBan = sv_globalBanlist.GetBool() && !pChallenge->netAdr.IsLoopback();
+	bool bGlobalBanCached = false;
+
+	if (bCheckGlobalBan)
+	{
+		bool bBanned = false;
+		string banReason;
+
+		bGlobalBanCached = SV_GetCachedGlobalBan(pszAddresBuffer, nNucleusID, bBanned, banReason);
+
+		if (bGlobalBanCached && bBanned)
+		{
+			pServer->RejectConnection(pServer->m_Socket, &pChallenge->netAdr, banReason.c_str());
+			if (bEnableLogging)
+				Warning(eDLL_T::SERVER, "Connection rejected for '[%s]:%i' ('%llu' is banned globally!)\n",
+					pszAddresBuffer, nPort, nNucleusID);
+
+			return nullptr;
+		}
+	}
+
 	CClient* pClient = CServer__ConnectClient(pServer, pChallenge);
 
 	for (auto& callback : !g_PluginSystem.GetConnectClientCallbacks())
@@ -179,16 +201,10 @@ CClient* CServer::ConnectClient(CServer* pServer, user_creds_s* pChallenge)
 		}
 	}
 
-	if (pClient && sv_globalBanlist.GetBool())
+	// Checks are batched, banned clients are removed once the verdict is in.
+	if (pClient && bCheckGlobalBan && !bGlobalBanCached)
 	{
-		if (!pClient->GetNetChan()->GetRemoteAddress().IsLoopback())
-		{
-			const string addressBufferCopy(pszAddresBuffer);
-			const string personaNameCopy(pszPersonaName);
-
-			std::thread th(SV_CheckForBanAndDisconnect, pClient, addressBufferCopy, nNucleusID, personaNameCopy, nPort);
-			th.detach();
-		}
+		SV_QueueGlobalBanCheck(pszAddresBuffer, nNucleusID);
 	}
 
 	return pClient;
@@ -16,52 +16,204 @@
 #include "game/server/gameinterface.h"
 
 //-----------------------------------------------------------------------------
-// Purpose: checks if particular client is banned on the comp server
+// Console variables
 //-----------------------------------------------------------------------------
-void SV_CheckForBanAndDisconnect(CClient* const pClient, const string& svIPAddr,
-	const NucleusID_t nNucleusID, const string& svPersonaName, const int nPort)
+static ConVar sv_globalBanlistBatchWindow("sv_globalBanlistBatchWindow", "1.0", FCVAR_RELEASE, "Time in seconds connect-time global ban checks are collected before being sent as one request.", true, 0.f, false, 0.f);
+static ConVar sv_globalBanlistCacheTime("sv_globalBanlistCacheTime", "120.0", FCVAR_RELEASE, "Time in seconds a global ban verdict is cached for.", true, 0.f, false, 0.f);
+
+//-----------------------------------------------------------------------------
+// Global ban verdicts of recently checked clients, keyed by nucleus id and
+// address; all of the state below is main thread only
+//-----------------------------------------------------------------------------
+struct GlobalBanVerdict_s
+{
+	bool banned;
+	string reason;
+	double expireTime;
+};
+
+typedef std::unordered_map<CBanSystem::BannedKey_t, GlobalBanVerdict_s, CBanSystem::BannedKey_t::Hasher_t> GlobalBanCache_t;
+typedef std::unordered_set<CBanSystem::BannedKey_t, CBanSystem::BannedKey_t::Hasher_t> GlobalBanKeySet_t;
+
+static GlobalBanCache_t s_GlobalBanCache;
+
+// Connect-time checks waiting to be sent, these are sent together once the
+// batch window of the first one expires, or with the periodic bulk check.
+static CBanSystem::BannedList_t s_PendingBanChecks;
+static GlobalBanKeySet_t s_PendingBanKeys;
+static double s_flPendingBanCheckTime = 0.0;
+
+//-----------------------------------------------------------------------------
+// Purpose: builds the cache key for a client
+//-----------------------------------------------------------------------------
+static bool SV_MakeGlobalBanKey(const char* const szIPAddr, const NucleusID_t nNucleusID, CBanSystem::BannedKey_t& key)
+{
+	key.m_NucleusID = nNucleusID;
+	return CBanSystem::ParseAddress(szIPAddr, key.m_Address);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the cached global ban verdict of a client
+// Input  : *szIPAddr   - 
+//          nNucleusID  - 
+//          &bOutBanned - 
+//          &svOutReason - <- contains banned reason if banned.
+// Output : true if a verdict was cached, false otherwise
+//-----------------------------------------------------------------------------
+bool SV_GetCachedGlobalBan(const char* const szIPAddr, const NucleusID_t nNucleusID, bool& bOutBanned, string& svOutReason)
+{
+	Assert(ThreadInMainThread());
+	CBanSystem::BannedKey_t key;
+
+	if (!SV_MakeGlobalBanKey(szIPAddr, nNucleusID, key))
+		return false;
+
+	const GlobalBanCache_t::const_iterator it = s_GlobalBanCache.find(key);
+
+	if (it == s_GlobalBanCache.end())
+		return false;
+
+	if (it->second.expireTime < Plat_FloatTime())
+	{
+		s_GlobalBanCache.erase(it);
+		return false;
+	}
+
+	bOutBanned = it->second.banned;
+
+	if (bOutBanned)
+		svOutReason = it->second.reason;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues a client for the next batched global ban check
+//-----------------------------------------------------------------------------
+void SV_QueueGlobalBanCheck(const char* const szIPAddr, const NucleusID_t nNucleusID)
+{
+	Assert(ThreadInMainThread());
+	CBanSystem::BannedKey_t key;
+
+	if (!SV_MakeGlobalBanKey(szIPAddr, nNucleusID, key))
+		return;
+
+	if (!s_PendingBanKeys.insert(key).second)
+		return; // Already queued
+
+	if (s_PendingBanChecks.IsEmpty())
+		s_flPendingBanCheckTime = Plat_FloatTime();
+
+	s_PendingBanChecks.AddToTail(CBanSystem::Banned_t(szIPAddr, nNucleusID));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stores the verdicts of a bulk check, every client that was checked
+//          and isn't in the banned list is not banned
+// Input  : &checkedVec - 
+//          &bannedVec  - 
+//-----------------------------------------------------------------------------
+static void SV_CacheGlobalBanVerdicts(const CBanSystem::BannedList_t& checkedVec, const CBanSystem::BannedList_t& bannedVec)
 {
-	Assert(pClient != nullptr);
+	// The bulk check only returns the nucleus id's of the banned clients, the
+	// reason is stored in the address field.
+	std::unordered_map<NucleusID_t, const char*> bannedIds;
+	bannedIds.reserve(bannedVec.Count());
+
+	FOR_EACH_VEC(bannedVec, i)
+	{
+		const CBanSystem::Banned_t& banned = bannedVec[i];
+		bannedIds.emplace(banned.m_NucleusID, banned.m_Address.String());
+	}
+
+	const double expireTime = Plat_FloatTime() + sv_globalBanlistCacheTime.GetFloat();
+
+	FOR_EACH_VEC(checkedVec, i)
+	{
+		const CBanSystem::Banned_t& checked = checkedVec[i];
+		CBanSystem::BannedKey_t key;
+
+		if (!SV_MakeGlobalBanKey(checked.m_Address.String(), checked.m_NucleusID, key))
+			continue;
+
+		GlobalBanVerdict_s& verdict = s_GlobalBanCache[key];
+		const auto it = bannedIds.find(checked.m_NucleusID);
 
-	string svError;
-	const bool bCompBanned = g_MasterServer.CheckForBan(svIPAddr, nNucleusID, svPersonaName, svError);
+		verdict.banned = it != bannedIds.end();
+		verdict.reason = verdict.banned ? it->second : "";
+		verdict.expireTime = expireTime;
+	}
+}
 
-	if (bCompBanned)
+//-----------------------------------------------------------------------------
+// Purpose: removes all expired verdicts from the cache
+//-----------------------------------------------------------------------------
+static void SV_PruneGlobalBanCache()
+{
+	const double currentTime = Plat_FloatTime();
+
+	for (GlobalBanCache_t::iterator it = s_GlobalBanCache.begin(); it != s_GlobalBanCache.end();)
 	{
-		g_TaskQueue.Dispatch([pClient, svError, svIPAddr, nNucleusID, nPort]
+		if (it->second.expireTime < currentTime)
+			it = s_GlobalBanCache.erase(it);
+		else
+			++it;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: sends a list of clients to the master server for a bulk check, the
+//          verdicts are cached and banned clients are removed the next frame
+// Input  : *pCheckVec - ownership is taken
+//-----------------------------------------------------------------------------
+static void SV_SendBulkCheck(CBanSystem::BannedList_t* const pCheckVec)
+{
+	const bool bQueued = g_MasterServer.QueueRequest([pCheckVec]()
+		{
+			CBanSystem::BannedList_t* outBannedVec = nullptr;
+
+			if (!g_MasterServer.GetBannedList(*pCheckVec, &outBannedVec))
 			{
-				// Make sure client isn't already disconnected,
-				// and that if there is a valid netchannel, that
-				// it hasn't been taken by a different client by
-				// the time this task is getting executed.
-				const CNetChan* const pChan = pClient->GetNetChan();
-				if (pChan && pClient->GetNucleusID() == nNucleusID)
+				delete pCheckVec;
+				return;
+			}
+
+			g_TaskQueue.Dispatch([pCheckVec, outBannedVec]
 				{
-					const int nUserID = pClient->GetUserID();
+					SV_CacheGlobalBanVerdicts(*pCheckVec, *outBannedVec);
 
-					pClient->Disconnect(Reputation_t::REP_MARK_BAD, svError.c_str());
-					Warning(eDLL_T::SERVER, "Removed client '[%s]:%i' from slot #%i ('%llu' is banned globally!)\n",
-						svIPAddr.c_str(), nPort, nUserID, nNucleusID);
-				}
-			}, 0);
-	}
+					if (!outBannedVec->IsEmpty())
+						SV_CheckClientsForBan(outBannedVec);
+
+					delete pCheckVec;
+					delete outBannedVec;
+				}, 0);
+		});
+
+	// Retried on the next refresh.
+	if (!bQueued)
+		delete pCheckVec;
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: checks if particular client is banned on the master server
+// Purpose: sends the queued connect-time checks once their batch window has
+//          expired, should be called every frame
 //-----------------------------------------------------------------------------
-void SV_ProcessBulkCheck(const CBanSystem::BannedList_t* const pBannedVec)
+void SV_RunGlobalBanChecks()
 {
-	CBanSystem::BannedList_t* outBannedVec = nullptr;
+	Assert(ThreadInMainThread());
 
-	if (!g_MasterServer.GetBannedList(*pBannedVec, &outBannedVec))
+	if (s_PendingBanChecks.IsEmpty())
 		return;
 
-	g_TaskQueue.Dispatch([outBannedVec]
-		{
-			SV_CheckClientsForBan(outBannedVec);
-			delete outBannedVec;
-		}, 0);
+	if (Plat_FloatTime() - s_flPendingBanCheckTime < sv_globalBanlistBatchWindow.GetFloat())
+		return;
+
+	CBanSystem::BannedList_t* const pCheckVec = new CBanSystem::BannedList_t;
+	pCheckVec->Swap(s_PendingBanChecks);
+
+	s_PendingBanKeys.clear();
+	SV_SendBulkCheck(pCheckVec);
 }
 
 //-----------------------------------------------------------------------------
@@ -76,6 +228,24 @@ void SV_CheckClientsForBan(const CBanSystem::BannedList_t* const pBannedVec /*=
 		? new CBanSystem::BannedList_t 
 		: nullptr;
 
+	// Banned nucleus id's, mapped to the entry holding the reason.
+	std::unordered_map<NucleusID_t, const CBanSystem::Banned_t*> bannedIds;
+
+	if (pBannedVec)
+	{
+		bannedIds.reserve(pBannedVec->Count());
+
+		FOR_EACH_VEC(*pBannedVec, i)
+		{
+			const CBanSystem::Banned_t& banned = (*pBannedVec)[i];
+			bannedIds.emplace(banned.m_NucleusID, &banned);
+		}
+	}
+	else
+	{
+		SV_PruneGlobalBanCache();
+	}
+
 	for (int c = 0; c < gpGlobals->maxClients; c++) // Loop through all possible client instances.
 	{
 		CClient* const pClient = g_pServer->GetClient(c);
@@ -97,37 +267,56 @@ void SV_CheckClientsForBan(const CBanSystem::BannedList_t* const pBannedVec /*=
 		// on the server. This will be used for bulk checking so live
 		// bans could be performed, as this function is called periodically.
 		if (bannedVec)
+		{
+			CBanSystem::BannedKey_t key;
+
+			// Pending connect-time checks are sent along with this one.
+			if (SV_MakeGlobalBanKey(szIPAddr, nNucleusID, key))
+				s_PendingBanKeys.erase(key);
+
 			bannedVec->AddToTail(CBanSystem::Banned_t(szIPAddr, nNucleusID));
+		}
 		else
 		{
 			// Check if current client is within provided banned list, and
 			// prune if so...
-			FOR_EACH_VEC(*pBannedVec, i)
-			{
-				const CBanSystem::Banned_t& banned = (*pBannedVec)[i];
+			const auto it = bannedIds.find(nNucleusID);
 
-				if (banned.m_NucleusID == pClient->GetNucleusID())
-				{
-					const int nUserID = pClient->GetUserID();
-					const int nPort = pNetChan->GetPort();
+			if (it != bannedIds.end())
+			{
+				const int nUserID = pClient->GetUserID();
+				const int nPort = pNetChan->GetPort();
 
-					pClient->Disconnect(Reputation_t::REP_MARK_BAD, "%s", banned.m_Address.String());
-					Warning(eDLL_T::SERVER, "Removed client '[%s]:%i' from slot #%i ('%llu' is banned globally!)\n",
-						szIPAddr, nPort, nUserID, nNucleusID);
-				}
+				pClient->Disconnect(Reputation_t::REP_MARK_BAD, "%s", it->second->m_Address.String());
+				Warning(eDLL_T::SERVER, "Removed client '[%s]:%i' from slot #%i ('%llu' is banned globally!)\n",
+					szIPAddr, nPort, nUserID, nNucleusID);
 			}
 		}
 	}
 
-	if (bannedVec && !bannedVec->IsEmpty())
+	if (bannedVec)
 	{
-		std::thread bulkCheck([bannedVec]()
+		// Pending checks of clients that weren't found above, e.g. because
+		// they already left; still sent so their verdict gets cached.
+		FOR_EACH_VEC(s_PendingBanChecks, i)
+		{
+			const CBanSystem::Banned_t& pending = s_PendingBanChecks[i];
+			CBanSystem::BannedKey_t key;
+
+			if (SV_MakeGlobalBanKey(pending.m_Address.String(), pending.m_NucleusID, key)
+				&& s_PendingBanKeys.count(key))
 			{
-				SV_ProcessBulkCheck(bannedVec);
-				delete bannedVec;
-			});
+				bannedVec->AddToTail(pending);
+			}
+		}
+
+		s_PendingBanChecks.Purge();
+		s_PendingBanKeys.clear();
+	}
 
-		bulkCheck.detach();
+	if (bannedVec && !bannedVec->IsEmpty())
+	{
+		SV_SendBulkCheck(bannedVec);
 	}
 	else if (bannedVec)
 	{
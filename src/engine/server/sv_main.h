@@ -65,7 +65,9 @@ void SV_ShutdownGameDLL();
 bool SV_ActivateServer();
 void SV_BroadcastVoiceData(CClient* const cl, const int nBytes, char* const data);
 void SV_BroadcastDurangoVoiceData(CClient* const cl, const int nBytes, char* const data, const int nXid, const int unknown, const bool useVoiceStream, const bool skipXidCheck);
-void SV_CheckForBanAndDisconnect(CClient* const pClient, const string& svIPAddr, const NucleusID_t nNucleusID, const string& svPersonaName, const int nPort);
+bool SV_GetCachedGlobalBan(const char* const szIPAddr, const NucleusID_t nNucleusID, bool& bOutBanned, string& svOutReason);
+void SV_QueueGlobalBanCheck(const char* const szIPAddr, const NucleusID_t nNucleusID);
+void SV_RunGlobalBanChecks();
 void SV_CheckClientsForBan(const CBanSystem::BannedList_t* const pBannedVec = nullptr);
 ///////////////////////////////////////////////////////////////////////////////
 
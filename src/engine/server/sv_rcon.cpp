@@ -44,6 +44,7 @@ static ConVar sv_rcon_maxsockets("sv_rcon_maxsockets", "32", FCVAR_RELEASE, "Max
 
 static ConVar sv_rcon_maxconnections("sv_rcon_maxconnections", "1", FCVAR_RELEASE, "Max number of authenticated connections before the server closes the listen socket", true, 1.f, true, MAX_PLAYERS, &RCON_ConnectionCountChanged_f);
 static ConVar sv_rcon_maxframesize("sv_rcon_maxframesize", "1024", FCVAR_RELEASE, "Max number of bytes allowed in a message frame from a non-authenticated netconsole", true, 0.f, false, 0.f);
+static ConVar sv_rcon_maxsendqueuesize("sv_rcon_maxsendqueuesize", "4194304", FCVAR_RELEASE, "Max number of bytes queued for a netconsole that isn't reading fast enough before it is disconnected", true, 0.f, false, 0.f, "0 = Unlimited");
 static ConVar sv_rcon_whitelistaddress("sv_rcon_whitelistaddress", "", FCVAR_RELEASE, "This address is not considered a 'redundant' socket and will never be banned for failed authentication attempts", &RCON_WhiteListAddresChanged_f, "Format: '::ffff:127.0.0.1'");
 
 static ConVar sv_rcon_useloopbacksocket("sv_rcon_useloopbacksocket", "0", FCVAR_RELEASE, "Whether to bind rcon server to the loopback socket", &RCON_UseLoopbackSocketChanged_f);
@@ -55,6 +56,8 @@ CRConServer::CRConServer(void)
 	: m_nConnIndex(0)
 	, m_nAuthConnections(0)
 	, m_bInitialized(false)
+	, m_nPendingSize(0)
+	, m_bSendConsoleLogs(false)
 {
 	memset(m_PasswordHash, 0, sizeof(m_PasswordHash));
 }
@@ -115,6 +118,7 @@ void CRConServer::Shutdown(void)
 	}
 
 	m_bInitialized = false;
+	m_bSendConsoleLogs = false;
 
 	const int nConnCount = m_Socket.GetAcceptedSocketCount();
 	m_Socket.CloseAllAcceptedSockets();
@@ -124,6 +128,13 @@ void CRConServer::Shutdown(void)
 		m_Socket.CloseListenSocket();
 	}
 
+	{
+		std::lock_guard<std::mutex> lock(m_PendingMutex);
+
+		m_PendingMessages.clear();
+		m_nPendingSize = 0;
+	}
+
 	Msg(eDLL_T::SERVER, "Remote server access deinitialized ('%i' accepted sockets closed)\n", nConnCount);
 }
 
@@ -242,6 +253,8 @@ void CRConServer::RunFrame(void)
 {
 	if (m_bInitialized)
 	{
+		SendPending();
+
 		m_Socket.RunFrame();
 		Think();
 
@@ -250,9 +263,15 @@ void CRConServer::RunFrame(void)
 		{
 			CConnectedNetConsoleData& data = m_Socket.GetAcceptedSocketData(m_nConnIndex);
 
+			if (data.m_bSendFailed)
+			{
+				Disconnect("send failed");
+				continue;
+			}
+
 			if (CheckForBan(data))
 			{
-				SendEncoded(data.m_hSocket, s_BannedMessage, "",
+				SendEncoded(data, s_BannedMessage, "",
 					netcon::response_e::SERVERDATA_RESPONSE_AUTH, int(eDLL_T::NETCON));
 
 				Disconnect("banned");
@@ -262,40 +281,42 @@ void CRConServer::RunFrame(void)
 			Recv(data, sv_rcon_maxframesize.GetInt());
 		}
 	}
+
+	m_bSendConsoleLogs = ShouldSend(netcon::response_e::SERVERDATA_RESPONSE_CONSOLE_LOG);
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: send message to all connected sockets
+// Purpose: send message to all connected sockets, the message is framed once
+//			and queued on each socket; sockets that fail or fall too far behind
+//			are disconnected on the next frame
 // Input  : *pMsgBuf - 
 //			nMsgLen - 
 // Output: true on success, false otherwise
 //-----------------------------------------------------------------------------
-bool CRConServer::SendToAll(const char* pMsgBuf, const int nMsgLen) const
+bool CRConServer::SendToAll(const char* pMsgBuf, const int nMsgLen)
 {
-	ostringstream sendbuf;
-	const u_long nLen = htonl(u_long(nMsgLen));
-
+	NetConFrame_t frame;
 	bool bSuccess = true;
 
-	sendbuf.write(reinterpret_cast<const char*>(&nLen), sizeof(u_long));
-	sendbuf.write(pMsgBuf, nMsgLen);
+	const size_t nMaxQueueSize = size_t(sv_rcon_maxsendqueuesize.GetInt());
 
 	const int nCount = m_Socket.GetAcceptedSocketCount();
 	for (int i = nCount - 1; i >= 0; i--)
 	{
-		const CConnectedNetConsoleData& data = m_Socket.GetAcceptedSocketData(i);
+		CConnectedNetConsoleData& data = m_Socket.GetAcceptedSocketData(i);
 
-		if (data.m_bAuthorized && !data.m_bInputOnly)
+		// Skip sockets that are about to be disconnected, so that the error
+		// logged for them isn't sent back to them.
+		if (data.m_bAuthorized && !data.m_bInputOnly && !data.m_bSendFailed)
 		{
-			int ret = ::send(data.m_hSocket, sendbuf.str().data(),
-				int(sendbuf.str().size()), MSG_NOSIGNAL);
+			if (!frame)
+			{
+				frame = CreateFrame(pMsgBuf, nMsgLen);
+			}
 
-			if (ret == SOCKET_ERROR)
+			if (!m_Socket.QueueSend(data, frame, nMaxQueueSize))
 			{
-				if (!bSuccess)
-				{
-					bSuccess = false;
-				}
+				bSuccess = false;
 			}
 		}
 	}
@@ -304,7 +325,38 @@ bool CRConServer::SendToAll(const char* pMsgBuf, const int nMsgLen) const
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: encode and send message to all connected sockets
+// Purpose: sends all messages that were broadcast since the last frame
+//-----------------------------------------------------------------------------
+void CRConServer::SendPending(void)
+{
+	std::vector<vector<char>> pendingMessages;
+
+	{
+		std::lock_guard<std::mutex> lock(m_PendingMutex);
+
+		pendingMessages.swap(m_PendingMessages);
+		m_nPendingSize = 0;
+	}
+
+	bool bSuccess = true;
+
+	for (const vector<char>& vecMsg : pendingMessages)
+	{
+		if (!SendToAll(vecMsg.data(), int(vecMsg.size())))
+		{
+			bSuccess = false;
+		}
+	}
+
+	if (!bSuccess)
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "Failed to send RCON message: (%s)\n", "SOCKET_ERROR");
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: encode and send message to all connected sockets, this can be
+//			called from any thread; the message is sent on the next frame
 // Input  : *pResponseMsg - 
 //			*pResponseVal - 
 //			responseType - 
@@ -313,7 +365,7 @@ bool CRConServer::SendToAll(const char* pMsgBuf, const int nMsgLen) const
 // Output: true on success, false otherwise
 //-----------------------------------------------------------------------------
 bool CRConServer::SendEncoded(const char* pResponseMsg, const char* pResponseVal,
-	const netcon::response_e responseType, const int nMessageId, const int nMessageType) const
+	const netcon::response_e responseType, const int nMessageId, const int nMessageType)
 {
 	vector<char> vecMsg;
 	if (!Serialize(vecMsg, pResponseMsg, pResponseVal,
@@ -321,18 +373,29 @@ bool CRConServer::SendEncoded(const char* pResponseMsg, const char* pResponseVal
 	{
 		return false;
 	}
-	if (!SendToAll(vecMsg.data(), int(vecMsg.size())))
+
+	const size_t nMaxQueueSize = size_t(sv_rcon_maxsendqueuesize.GetInt());
+
+	// NOTE: nothing may be logged while holding the lock, as the logger
+	// broadcasts through here as well.
+	std::lock_guard<std::mutex> lock(m_PendingMutex);
+
+	// Frames aren't being run; drop the message rather than growing
+	// without bounds.
+	if (nMaxQueueSize && m_nPendingSize >= nMaxQueueSize)
 	{
-		Error(eDLL_T::SERVER, NO_ERROR, "Failed to send RCON message: (%s)\n", "SOCKET_ERROR");
 		return false;
 	}
 
+	m_nPendingSize += vecMsg.size();
+	m_PendingMessages.push_back(std::move(vecMsg));
+
 	return true;
 }
 
 //-----------------------------------------------------------------------------
 // Purpose: encode and send message to specific socket
-// Input  : hSocket - 
+// Input  : &data - 
 //			*pResponseMsg - 
 //			*pResponseVal - 
 //			responseType - 
@@ -340,8 +403,8 @@ bool CRConServer::SendEncoded(const char* pResponseMsg, const char* pResponseVal
 //			nMessageType - 
 // Output: true on success, false otherwise
 //-----------------------------------------------------------------------------
-bool CRConServer::SendEncoded(const SocketHandle_t hSocket, const char* pResponseMsg, const char* pResponseVal,
-	const netcon::response_e responseType, const int nMessageId, const int nMessageType) const
+bool CRConServer::SendEncoded(CConnectedNetConsoleData& data, const char* pResponseMsg, const char* pResponseVal,
+	const netcon::response_e responseType, const int nMessageId, const int nMessageType)
 {
 	vector<char> vecMsg;
 	if (!Serialize(vecMsg, pResponseMsg, pResponseVal,
@@ -349,7 +412,8 @@ bool CRConServer::SendEncoded(const SocketHandle_t hSocket, const char* pRespons
 	{
 		return false;
 	}
-	if (!Send(hSocket, vecMsg.data(), int(vecMsg.size())))
+	if (!m_Socket.QueueSend(data, CreateFrame(vecMsg.data(), int(vecMsg.size())),
+		size_t(sv_rcon_maxsendqueuesize.GetInt())))
 	{
 		Error(eDLL_T::SERVER, NO_ERROR, "Failed to send RCON message: (%s)\n", "SOCKET_ERROR");
 		return false;
@@ -399,7 +463,7 @@ void CRConServer::Authenticate(const netcon::request& request, CConnectedNetCons
 
 		const char* pSendLogs = (!sv_rcon_sendlogs.GetBool() || data.m_bInputOnly) ? "0" : "1";
 
-		SendEncoded(data.m_hSocket, s_AuthMessage, pSendLogs,
+		SendEncoded(data, s_AuthMessage, pSendLogs,
 			netcon::response_e::SERVERDATA_RESPONSE_AUTH, static_cast<int>(eDLL_T::NETCON));
 	}
 	else // Bad password.
@@ -410,7 +474,7 @@ void CRConServer::Authenticate(const netcon::request& request, CConnectedNetCons
 			Msg(eDLL_T::SERVER, "Bad RCON password attempt from '%s'\n", netAdr.ToString());
 		}
 
-		SendEncoded(data.m_hSocket, s_WrongPwMessage, "",
+		SendEncoded(data, s_WrongPwMessage, "",
 			netcon::response_e::SERVERDATA_RESPONSE_AUTH, static_cast<int>(eDLL_T::NETCON));
 
 		data.m_bAuthorized = false;
@@ -460,7 +524,7 @@ bool CRConServer::ProcessMessage(const char* pMsgBuf, const int nMsgLen)
 		request.requesttype() != netcon::request_e::SERVERDATA_REQUEST_AUTH)
 	{
 		// Notify netconsole that authentication is required.
-		SendEncoded(data.m_hSocket, s_NoAuthMessage, "",
+		SendEncoded(data, s_NoAuthMessage, "",
 			netcon::response_e::SERVERDATA_RESPONSE_AUTH, static_cast<int>(eDLL_T::NETCON));
 
 		data.m_bValidated = false;
@@ -655,6 +719,16 @@ bool CRConServer::ShouldSend(const netcon::response_e responseType) const
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: checks if console logs should be sent, this can be called from any
+//			thread as it doesn't inspect the sockets
+// Output : true if it should send, false otherwise
+//-----------------------------------------------------------------------------
+bool CRConServer::ShouldSendConsoleLogs(void) const
+{
+	return m_bSendConsoleLogs;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: returns whether the rcon server is initialized
 //-----------------------------------------------------------------------------
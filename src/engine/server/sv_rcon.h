@@ -28,14 +28,15 @@ public:
 	bool SendEncoded(const char* pResponseMsg, const char* pResponseVal,
 		const netcon::response_e responseType,
 		const int nMessageId = static_cast<int>(eDLL_T::NETCON),
-		const int nMessageType = static_cast<int>(LogType_t::LOG_NET)) const;
+		const int nMessageType = static_cast<int>(LogType_t::LOG_NET));
 
-	bool SendEncoded(const SocketHandle_t hSocket, const char* pResponseMsg,
+	bool SendEncoded(CConnectedNetConsoleData& data, const char* pResponseMsg,
 		const char* pResponseVal, const netcon::response_e responseType,
 		const int nMessageId = static_cast<int>(eDLL_T::NETCON),
-		const int nMessageType = static_cast<int>(LogType_t::LOG_NET)) const;
+		const int nMessageType = static_cast<int>(LogType_t::LOG_NET));
 
-	bool SendToAll(const char* pMsgBuf, const int nMsgLen) const;
+	bool SendToAll(const char* pMsgBuf, const int nMsgLen);
+	void SendPending(void);
 	bool Serialize(vector<char>& vecBuf, const char* pResponseMsg, const char* pResponseVal, const netcon::response_e responseType,
 		const int nMessageId = static_cast<int>(eDLL_T::NETCON), const int nMessageType = static_cast<int>(LogType_t::LOG_NET)) const;
 
@@ -52,6 +53,7 @@ public:
 	void CloseNonAuthConnection(void);
 
 	bool ShouldSend(const netcon::response_e responseType) const;
+	bool ShouldSendConsoleLogs(void) const;
 	bool IsInitialized(void) const;
 
 	int GetAuthenticatedCount(void) const;
@@ -64,6 +66,16 @@ private:
 	std::unordered_set<std::string> m_BannedList;
 	uint8_t                  m_PasswordHash[RCON_SHA512_HASH_SIZE];
 	netadr_t                 m_WhiteListAddress;
+
+	// Messages broadcast from any thread, sent by the frame thread as the
+	// sockets are only ever touched from there.
+	std::mutex               m_PendingMutex;
+	std::vector<vector<char>> m_PendingMessages;
+	size_t                   m_nPendingSize;
+
+	// Cached result of ShouldSend for console logs, updated every frame so
+	// loggers on other threads don't have to inspect the sockets.
+	std::atomic<bool>        m_bSendConsoleLogs;
 };
 
 CRConServer* RCONServer();
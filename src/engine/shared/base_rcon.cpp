@@ -137,7 +137,9 @@ bool CNetConBase::Connect(const char* pHostName, const int nPort)
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: parses input response buffer using length-prefix framing
+// Purpose: parses input response buffer using length-prefix framing; frames
+//			that are entirely in the input buffer are processed in place, the
+//			others are gathered in the receive buffer of the connection
 // Input  : &data - 
 //			*pRecvBuf - 
 //			nRecvLen - 
@@ -151,38 +153,25 @@ bool CNetConBase::ProcessBuffer(CConnectedNetConsoleData& data,
 
 	while (nRecvLen > 0)
 	{
-		if (data.m_nPayloadLen)
+		if (!data.m_nPayloadLen) // Read size field.
 		{
-			if (data.m_nPayloadRead < data.m_nPayloadLen)
-			{
-				data.m_RecvBuffer[data.m_nPayloadRead++] = *pRecvBuf;
+			const int nPrefixLen = int(sizeof(u_long));
+			const int nCopyLen = MIN(nPrefixLen - data.m_nPayloadRead, nRecvLen);
 
-				pRecvBuf++;
-				nRecvLen--;
-			}
-			if (data.m_nPayloadRead == data.m_nPayloadLen)
-			{
-				if (!ProcessMessage(
-					reinterpret_cast<const char*>(data.m_RecvBuffer.data()), data.m_nPayloadLen)
-					&& bSuccess)
-				{
-					bSuccess = false;
-				}
+			memcpy(&data.m_RecvBuffer[data.m_nPayloadRead], pRecvBuf, nCopyLen);
+			data.m_nPayloadRead += nCopyLen;
 
-				data.m_nPayloadLen = 0;
-				data.m_nPayloadRead = 0;
-			}
-		}
-		else if (data.m_nPayloadRead < sizeof(int)) // Read size field.
-		{
-			data.m_RecvBuffer[data.m_nPayloadRead++] = *pRecvBuf;
+			pRecvBuf += nCopyLen;
+			nRecvLen -= nCopyLen;
 
-			pRecvBuf++;
-			nRecvLen--;
-		}
-		else // Build prefix.
-		{
-			data.m_nPayloadLen = int(ntohl(*reinterpret_cast<u_long*>(&data.m_RecvBuffer[0])));
+			if (data.m_nPayloadRead < nPrefixLen)
+				break; // Remainder arrives in the next chunk.
+
+			// Build prefix.
+			u_long nNetLen;
+			memcpy(&nNetLen, data.m_RecvBuffer.data(), sizeof(nNetLen));
+
+			data.m_nPayloadLen = int(ntohl(nNetLen));
 			data.m_nPayloadRead = 0;
 
 			if (!data.m_bAuthorized && nMaxLen > -1)
@@ -202,11 +191,47 @@ bool CNetConBase::ProcessBuffer(CConnectedNetConsoleData& data,
 
 				return false;
 			}
-			else
-			{
+
+			continue;
+		}
+
+		const char* pMsgBuf;
+
+		if (!data.m_nPayloadRead && nRecvLen >= data.m_nPayloadLen)
+		{
+			// The whole frame is in the input buffer, no need to copy it.
+			pMsgBuf = pRecvBuf;
+
+			pRecvBuf += data.m_nPayloadLen;
+			nRecvLen -= data.m_nPayloadLen;
+		}
+		else
+		{
+			// Only grows, so the size field always fits as well.
+			if (data.m_RecvBuffer.size() < size_t(data.m_nPayloadLen))
 				data.m_RecvBuffer.resize(data.m_nPayloadLen);
-			}
+
+			const int nCopyLen = MIN(data.m_nPayloadLen - data.m_nPayloadRead, nRecvLen);
+
+			memcpy(&data.m_RecvBuffer[data.m_nPayloadRead], pRecvBuf, nCopyLen);
+			data.m_nPayloadRead += nCopyLen;
+
+			pRecvBuf += nCopyLen;
+			nRecvLen -= nCopyLen;
+
+			if (data.m_nPayloadRead < data.m_nPayloadLen)
+				break; // Remainder arrives in the next chunk.
+
+			pMsgBuf = reinterpret_cast<const char*>(data.m_RecvBuffer.data());
+		}
+
+		if (!ProcessMessage(pMsgBuf, data.m_nPayloadLen) && bSuccess)
+		{
+			bSuccess = false;
 		}
+
+		data.m_nPayloadLen = 0;
+		data.m_nPayloadRead = 0;
 	}
 
 	return bSuccess;
@@ -281,18 +306,32 @@ bool CNetConBase::Decode(google::protobuf::MessageLite* pMsg,
 bool CNetConBase::Send(const SocketHandle_t hSocket, const char* pMsgBuf,
 	const int nMsgLen) const
 {
-	std::ostringstream sendbuf;
-	const u_long nLen = htonl(u_long(nMsgLen));
-
-	sendbuf.write(reinterpret_cast<const char*>(&nLen), sizeof(u_long));
-	sendbuf.write(pMsgBuf, nMsgLen);
+	const NetConFrame_t frame = CreateFrame(pMsgBuf, nMsgLen);
 
-	int ret = ::send(hSocket, sendbuf.str().data(), int(sendbuf.str().size()),
+	int ret = ::send(hSocket, frame->data(), int(frame->size()),
 		MSG_NOSIGNAL);
 
 	return (ret != SOCKET_ERROR);
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: frames message with its length-prefix, the frame can be shared
+//			between all sockets it is sent to
+// Input  : *pMsgBuf - 
+//			nMsgLen - 
+// Output: the framed message
+//-----------------------------------------------------------------------------
+NetConFrame_t CNetConBase::CreateFrame(const char* pMsgBuf, const int nMsgLen)
+{
+	std::shared_ptr<vector<char>> frame = std::make_shared<vector<char>>(sizeof(u_long) + nMsgLen);
+	const u_long nLen = htonl(u_long(nMsgLen));
+
+	memcpy(frame->data(), &nLen, sizeof(u_long));
+	memcpy(frame->data() + sizeof(u_long), pMsgBuf, nMsgLen);
+
+	return frame;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: receive message
 // Input  : &data - 
@@ -301,7 +340,9 @@ bool CNetConBase::Send(const SocketHandle_t hSocket, const char* pMsgBuf,
 //-----------------------------------------------------------------------------
 void CNetConBase::Recv(CConnectedNetConsoleData& data, const int nMaxLen)
 {
-	static char szRecvBuf[1024];
+	// Large enough to hold most frames entirely, so they are processed in
+	// place rather than gathered in the receive buffer of the connection.
+	static char szRecvBuf[RCON_RECV_CHUNK_SIZE];
 
 	{//////////////////////////////////////////////
 		const int nPendingLen = ::recv(data.m_hSocket, szRecvBuf, sizeof(char), MSG_PEEK);
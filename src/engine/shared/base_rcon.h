@@ -9,6 +9,9 @@
 // Max size of the payload in the envelope frame
 #define RCON_MAX_PAYLOAD_SIZE 1024*1024
 
+// Max number of bytes received from a socket at once
+#define RCON_RECV_CHUNK_SIZE 64*1024
+
 class CNetConBase
 {
 public:
@@ -33,6 +36,7 @@ public:
 	virtual bool Decode(google::protobuf::MessageLite* pMsg, const char* pMsgBuf, const size_t nMsgLen) const;
 
 	virtual bool Send(const SocketHandle_t hSocket, const char* pMsgBuf, const int nMsgLen) const;
+	static NetConFrame_t CreateFrame(const char* pMsgBuf, const int nMsgLen);
 	virtual void Recv(CConnectedNetConsoleData& data, const int nMaxLen = SOCKET_ERROR);
 
 	CSocketCreator* GetSocketCreator(void) { return &m_Socket; }
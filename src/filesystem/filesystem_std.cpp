@@ -301,6 +301,34 @@ ssize_t CBaseFileSystem::ReadEx(void* pOutput, ssize_t /*destSize*/, ssize_t siz
 
 }
 
+void CBaseFileSystem::RemoveFile(char const* pRelativePath, const char* pathID)
+{
+	NOTE_UNUSED(pathID);
+
+	char fullPath[1024];
+	snprintf(fullPath, sizeof(fullPath), "%s", pRelativePath);
+
+	V_FixSlashes(fullPath);
+	remove(fullPath);
+}
+
+bool CBaseFileSystem::RenameFile(char const* pOldPath, char const* pNewPath, const char* pathID)
+{
+	NOTE_UNUSED(pathID);
+
+	char oldFullPath[1024];
+	snprintf(oldFullPath, sizeof(oldFullPath), "%s", pOldPath);
+
+	char newFullPath[1024];
+	snprintf(newFullPath, sizeof(newFullPath), "%s", pNewPath);
+
+	V_FixSlashes(oldFullPath);
+	V_FixSlashes(newFullPath);
+
+	// Replaces the destination file if it exists.
+	return MoveFileExA(oldFullPath, newFullPath, MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
+
 int CBaseFileSystem::CreateDirHierarchy(const char* pPath, const char* pPathID)
 {
 	NOTE_UNUSED(pPathID);
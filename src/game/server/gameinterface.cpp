@@ -196,6 +196,13 @@ void CServerGameClients::_ProcessUserCmds(CServerGameClients* thisp, edict_t edi
 		return;
 	}
 
+	// Client hasn't been authorized yet, the commands are read above to keep
+	// the buffer in sync but aren't run.
+	if (g_pServer->GetClient(edict-1)->GetClientExtended()->IsAuthPending())
+	{
+		return;
+	}
+
 	pPlayer->ProcessUserCmds(cmds, numCmds, totalCmds, droppedPackets, paused);
 }
 
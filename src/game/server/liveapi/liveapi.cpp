@@ -1881,96 +1881,86 @@ static bool LiveAPI_HandleCustomEvent(HSQUIRRELVM const v, const SQObject& obj,
 	╚══════╝  ╚═══╝  ╚══════╝╚═╝  ╚═══╝   ╚═╝     ╚═════╝ ╚═╝╚══════╝╚═╝     ╚═╝  ╚═╝   ╚═╝    ╚═════╝╚═╝  ╚═╝╚══════╝╚═╝  ╚═╝
 */
 
-static void LiveAPI_SendEvent(const google::protobuf::Message* const msg)
-{
-	rtech::liveapi::LiveAPIEvent envelope;
-
-	envelope.set_event_size(msg->ByteSize());
-	envelope.mutable_gamemessage()->PackFrom(*msg);
-
-	LiveAPISystem()->LogEvent(&envelope, &envelope.gamemessage());
-}
-
-static google::protobuf::Message* LiveAPI_AllocMessage(const eLiveAPI_EventTypes eventType)
+static google::protobuf::Message* LiveAPI_AllocMessage(const eLiveAPI_EventTypes eventType, google::protobuf::Arena* const arena)
 {
 	switch (eventType)
 	{
 	case eLiveAPI_EventTypes::init:
-		return new rtech::liveapi::Init();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::Init>(arena);
 	case eLiveAPI_EventTypes::matchSetup:
-		return new rtech::liveapi::MatchSetup();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::MatchSetup>(arena);
 	case eLiveAPI_EventTypes::ammoUsed:
-		return new rtech::liveapi::AmmoUsed();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::AmmoUsed>(arena);
 	case eLiveAPI_EventTypes::arenasItemDeselected:
-		return new rtech::liveapi::ArenasItemDeselected();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::ArenasItemDeselected>(arena);
 	case eLiveAPI_EventTypes::arenasItemSelected:
-		return new rtech::liveapi::ArenasItemSelected();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::ArenasItemSelected>(arena);
 	case eLiveAPI_EventTypes::bannerCollected:
-		return new rtech::liveapi::BannerCollected();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::BannerCollected>(arena);
 	case eLiveAPI_EventTypes::customEvent:
-		return new rtech::liveapi::CustomEvent();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::CustomEvent>(arena);
 	case eLiveAPI_EventTypes::inventoryPickUp:
-		return new rtech::liveapi::InventoryPickUp();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::InventoryPickUp>(arena);
 	case eLiveAPI_EventTypes::inventoryDrop:
-		return new rtech::liveapi::InventoryDrop();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::InventoryDrop>(arena);
 	case eLiveAPI_EventTypes::inventoryUse:
-		return new rtech::liveapi::InventoryUse();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::InventoryUse>(arena);
 	case eLiveAPI_EventTypes::gameStateChanged:
-		return new rtech::liveapi::GameStateChanged();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::GameStateChanged>(arena);
 	case eLiveAPI_EventTypes::matchStateEnd:
-		return new rtech::liveapi::MatchStateEnd();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::MatchStateEnd>(arena);
 	case eLiveAPI_EventTypes::characterSelected:
-		return new rtech::liveapi::CharacterSelected();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::CharacterSelected>(arena);
 	case eLiveAPI_EventTypes::warpGateUsed:
-		return new rtech::liveapi::WarpGateUsed();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::WarpGateUsed>(arena);
 	case eLiveAPI_EventTypes::wraithPortal:
-		return new rtech::liveapi::WraithPortal();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::WraithPortal>(arena);
 	case eLiveAPI_EventTypes::playerConnected:
-		return new rtech::liveapi::PlayerConnected();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerConnected>(arena);
 	case eLiveAPI_EventTypes::playerRevive:
-		return new rtech::liveapi::PlayerRevive();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerRevive>(arena);
 	case eLiveAPI_EventTypes::playerDisconnected:
-		return new rtech::liveapi::PlayerDisconnected();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerDisconnected>(arena);
 	case eLiveAPI_EventTypes::playerDamaged:
-		return new rtech::liveapi::PlayerDamaged();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerDamaged>(arena);
 	case eLiveAPI_EventTypes::playerDowned:
-		return new rtech::liveapi::PlayerDowned();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerDowned>(arena);
 	case eLiveAPI_EventTypes::playerKilled:
-		return new rtech::liveapi::PlayerKilled();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerKilled>(arena);
 	case eLiveAPI_EventTypes::playerAssist:
-		return new rtech::liveapi::PlayerAssist();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerAssist>(arena);
 	case eLiveAPI_EventTypes::playerRespawnTeam:
-		return new rtech::liveapi::PlayerRespawnTeam();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerRespawnTeam>(arena);
 	case eLiveAPI_EventTypes::playerStatChanged:
-		return new rtech::liveapi::PlayerStatChanged();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerStatChanged>(arena);
 	case eLiveAPI_EventTypes::playerUpgradeTierChanged:
-		return new rtech::liveapi::PlayerUpgradeTierChanged();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerUpgradeTierChanged>(arena);
 	case eLiveAPI_EventTypes::legendUpgradeSelected:
-		return new rtech::liveapi::LegendUpgradeSelected();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::LegendUpgradeSelected>(arena);
 	case eLiveAPI_EventTypes::gibraltarShieldAbsorbed:
-		return new rtech::liveapi::GibraltarShieldAbsorbed();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::GibraltarShieldAbsorbed>(arena);
 	case eLiveAPI_EventTypes::revenantForgedShadowDamaged:
-		return new rtech::liveapi::RevenantForgedShadowDamaged();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::RevenantForgedShadowDamaged>(arena);
 	case eLiveAPI_EventTypes::ringStartClosing:
-		return new rtech::liveapi::RingStartClosing();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::RingStartClosing>(arena);
 	case eLiveAPI_EventTypes::ringFinishedClosing:
-		return new rtech::liveapi::RingFinishedClosing();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::RingFinishedClosing>(arena);
 	case eLiveAPI_EventTypes::squadEliminated:
-		return new rtech::liveapi::SquadEliminated();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::SquadEliminated>(arena);
 	case eLiveAPI_EventTypes::ziplineUsed:
-		return new rtech::liveapi::ZiplineUsed();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::ZiplineUsed>(arena);
 	case eLiveAPI_EventTypes::grenadeThrown:
-		return new rtech::liveapi::GrenadeThrown();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::GrenadeThrown>(arena);
 	case eLiveAPI_EventTypes::playerAbilityUsed:
-		return new rtech::liveapi::PlayerAbilityUsed();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::PlayerAbilityUsed>(arena);
 	case eLiveAPI_EventTypes::weaponSwitched:
-		return new rtech::liveapi::WeaponSwitched();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::WeaponSwitched>(arena);
 	case eLiveAPI_EventTypes::blackMarketAction:
-		return new rtech::liveapi::BlackMarketAction();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::BlackMarketAction>(arena);
 	case eLiveAPI_EventTypes::observerSwitched:
-		return new rtech::liveapi::ObserverSwitched();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::ObserverSwitched>(arena);
 	case eLiveAPI_EventTypes::observerAnnotation:
-		return new rtech::liveapi::ObserverAnnotation();
+		return google::protobuf::Arena::CreateMessage<rtech::liveapi::ObserverAnnotation>(arena);
 	default:
 		return nullptr;
 	}
@@ -1978,10 +1968,12 @@ static google::protobuf::Message* LiveAPI_AllocMessage(const eLiveAPI_EventTypes
 
 static bool LiveAPI_HandleEventByCategory(HSQUIRRELVM const v, const SQTable* const table, const eLiveAPI_EventTypes eventType)
 {
-	google::protobuf::Message* const msg = LiveAPI_AllocMessage(eventType);
+	LiveAPI::EventArena_s* const eventArena = LiveAPISystem()->AcquireArena();
+	google::protobuf::Message* const msg = LiveAPI_AllocMessage(eventType, &eventArena->arena);
 
 	if (!msg)
 	{
+		LiveAPISystem()->ReleaseArena(eventArena);
 		v_SQVM_RaiseError(v, "Event type \"%d\" not found.", eventType);
 		return false;
 	}
@@ -2000,7 +1992,7 @@ static bool LiveAPI_HandleEventByCategory(HSQUIRRELVM const v, const SQTable* co
 		if (!LiveAPI_CheckSwitchType(v, node.key))
 		{
 			Assert(msg);
-			delete msg;
+			LiveAPISystem()->ReleaseArena(eventArena);
 
 			return false;
 		}
@@ -2135,7 +2127,7 @@ static bool LiveAPI_HandleEventByCategory(HSQUIRRELVM const v, const SQTable* co
 		if (!ret)
 		{
 			Assert(msg);
-			delete msg;
+			LiveAPISystem()->ReleaseArena(eventArena);
 
 			return false;
 		}
@@ -2146,13 +2138,13 @@ static bool LiveAPI_HandleEventByCategory(HSQUIRRELVM const v, const SQTable* co
 		v_SQVM_RaiseError(v, "Empty table on event type \"%d\".", eventType);
 
 		Assert(msg);
-		delete msg;
+		LiveAPISystem()->ReleaseArena(eventArena);
 
 		return false;
 	}
 
-	LiveAPI_SendEvent(msg);
-	delete msg;
+	// Ownership of the arena is transferred here.
+	LiveAPISystem()->LogEvent(eventArena, msg);
 
 	return true;
 }
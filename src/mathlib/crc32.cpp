@@ -1,8 +1,51 @@
+#include "tier0/cpu.h"
 #include "mathlib/crc32.h"
 
-// Karl Malbrain's compact CRC-32, with pre and post conditioning. 
-// See "A compact CCITT crc16 and crc32 C implementation that balances processor cache usage against speed": 
-// http://www.geocities.com/malbrain/
+// Reflected CRC-32 (zlib) polynomial, with pre and post conditioning.
+#define CRC32_POLYNOMIAL 0xEDB88320
+
+// Buffers smaller than this are processed by the table driven path only, as
+// the folding setup costs more than it saves.
+#define CRC32_PCLMUL_MIN_LENGTH 256
+
+//-----------------------------------------------------------------------------
+// Slicing-by-16 tables; table 0 is the classic byte-wise table, table 'n'
+// advances a byte through 'n' more zero bytes.
+//-----------------------------------------------------------------------------
+struct CRC32Tables_s
+{
+	CRC32Tables_s()
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t crc = i;
+
+			for (int j = 0; j < 8; j++)
+				crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0 - (crc & 1)));
+
+			table[0][i] = crc;
+		}
+
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			for (int j = 1; j < 16; j++)
+				table[j][i] = (table[j - 1][i] >> 8) ^ table[0][table[j - 1][i] & 0xFF];
+		}
+	}
+
+	uint32_t table[16][256];
+};
+
+static const CRC32Tables_s s_crc32Tables;
+
+//-----------------------------------------------------------------------------
+// Purpose: updates the crc using the carry-less multiplication folding path
+//          when available, or the slicing-by-16 path otherwise
+// Input  : crc     - 
+//          *ptr    - 
+//          buf_len - 
+// Output : updated crc, or 0 if ptr is NULL
+//-----------------------------------------------------------------------------
 uint32_t crc32::update(uint32_t crc, const uint8_t* ptr, size_t buf_len)
 {
 	if (!ptr)
@@ -10,12 +53,177 @@ uint32_t crc32::update(uint32_t crc, const uint8_t* ptr, size_t buf_len)
 		return NULL;
 	}
 
+	static const bool s_bUsePCLMUL = []()
+	{
+		const CPUInformation& pi = GetCPUInformation();
+		return pi.m_bPCLMUL && pi.m_bSSE41;
+	}();
+
 	crc = ~crc;
+
+	if (s_bUsePCLMUL && buf_len >= CRC32_PCLMUL_MIN_LENGTH)
+	{
+		const size_t nFolded = buf_len & ~size_t(15);
+		crc = update_pclmul(crc, ptr, nFolded);
+
+		ptr += nFolded;
+		buf_len -= nFolded;
+	}
+
+	return ~update_slice16(crc, ptr, buf_len);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: slicing-by-16, processes 16 bytes per iteration with independent
+//          table lookups; the crc is neither pre or post conditioned
+//-----------------------------------------------------------------------------
+uint32_t crc32::update_slice16(uint32_t crc, const uint8_t* ptr, size_t buf_len)
+{
+	const uint32_t(*const t)[256] = s_crc32Tables.table;
+
+	while (buf_len >= 16)
+	{
+		uint32_t a, b, c, d;
+
+		memcpy(&a, ptr + 0, sizeof(a));
+		memcpy(&b, ptr + 4, sizeof(b));
+		memcpy(&c, ptr + 8, sizeof(c));
+		memcpy(&d, ptr + 12, sizeof(d));
+
+		a ^= crc;
+
+		crc = t[15][a & 0xFF] ^ t[14][(a >> 8) & 0xFF] ^ t[13][(a >> 16) & 0xFF] ^ t[12][a >> 24] ^
+			t[11][b & 0xFF] ^ t[10][(b >> 8) & 0xFF] ^ t[9][(b >> 16) & 0xFF] ^ t[8][b >> 24] ^
+			t[7][c & 0xFF] ^ t[6][(c >> 8) & 0xFF] ^ t[5][(c >> 16) & 0xFF] ^ t[4][c >> 24] ^
+			t[3][d & 0xFF] ^ t[2][(d >> 8) & 0xFF] ^ t[1][(d >> 16) & 0xFF] ^ t[0][d >> 24];
+
+		ptr += 16;
+		buf_len -= 16;
+	}
+
+	if (buf_len >= 8)
+	{
+		uint32_t a, b;
+
+		memcpy(&a, ptr + 0, sizeof(a));
+		memcpy(&b, ptr + 4, sizeof(b));
+
+		a ^= crc;
+
+		crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^ t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^
+			t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^ t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+
+		ptr += 8;
+		buf_len -= 8;
+	}
+
 	while (buf_len--)
 	{
-		uint8_t b = *ptr++;
-		crc = (crc >> 4) ^ s_crc32[(crc & 0xF) ^ (b & 0xF)];
-		crc = (crc >> 4) ^ s_crc32[(crc & 0xF) ^ (b >> 4)];
+		crc = (crc >> 8) ^ t[0][(crc ^ *ptr++) & 0xFF];
+	}
+
+	return crc;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: folds 64 bytes per iteration using carry-less multiplication, then
+//          reduces to 32 bits using Barrett reduction; the crc is neither pre
+//          or post conditioned. The length must be a multiple of 16 and at
+//          least 64. Requires PCLMULQDQ and SSE4.1.
+// See "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction":
+// https://www.intel.com/content/dam/www/public/us/en/documents/white-papers/fast-crc-computation-generic-polynomials-pclmulqdq-paper.pdf
+//-----------------------------------------------------------------------------
+uint32_t crc32::update_pclmul(uint32_t crc, const uint8_t* ptr, size_t buf_len)
+{
+	alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+	alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+	alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+	alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+	x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x00));
+	x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x10));
+	x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x20));
+	x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x30));
+
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+
+	ptr += 64;
+	buf_len -= 64;
+
+	// Fold by 4.
+	while (buf_len >= 64)
+	{
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 0x30)));
+
+		ptr += 64;
+		buf_len -= 64;
+	}
+
+	// Fold into 128 bits.
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// Fold the remaining 16 byte blocks, if any.
+	while (buf_len >= 16)
+	{
+		x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+		ptr += 16;
+		buf_len -= 16;
 	}
-	return ~crc;
+
+	// Fold 128 bits to 64 bits.
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+
+	x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduce to 32 bits.
+	x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
 }
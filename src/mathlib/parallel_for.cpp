@@ -0,0 +1,366 @@
+//===========================================================================//
+//
+// Purpose: process-wide work-stealing thread pool behind parallel_for.
+//
+//===========================================================================//
+#include "tier0/cputopology.h"
+#include "mathlib/parallel_for.h"
+
+// Chunks per thread when no grain size is given, more chunks balance better
+// at the cost of more claims.
+#define PARALLEL_FOR_CHUNKS_PER_THREAD 4
+
+struct ParallelTask_s
+{
+    std::function<void()> function;
+    CParallelTaskGroup* group;
+};
+
+//-----------------------------------------------------------------------------
+// Each worker owns a queue it pushes to and pops from the back of, idle
+// threads steal from the front of other queues. Tasks pushed from threads
+// outside the pool go into a shared queue.
+//-----------------------------------------------------------------------------
+class CParallelPool
+{
+public:
+    static CParallelPool& Get();
+    static void ShutdownIfStarted();
+
+    void Push(ParallelTask_s&& task);
+    bool RunOne();
+    void Shutdown();
+
+    inline unsigned GetThreadCount() const { return m_nWorkers + 1; }
+
+private:
+    CParallelPool();
+
+    bool Pop(ParallelTask_s& task);
+    void WorkerThread(const unsigned nIndex);
+
+    struct WorkQueue_s
+    {
+        std::mutex mutex;
+        std::deque<ParallelTask_s> tasks;
+    };
+
+    unsigned m_nWorkers;
+    std::unique_ptr<WorkQueue_s[]> m_Queues; // Per worker, the last one is shared.
+    std::vector<std::thread> m_Workers;
+
+    std::atomic<int> m_nQueued;
+    std::mutex m_SleepMutex;
+    std::condition_variable m_SleepCondition;
+    bool m_bShutdown; // Guarded by m_SleepMutex.
+};
+
+static thread_local int s_nWorkerIndex = -1;
+
+// Never destroyed, waiters may still run queued work on it after the workers
+// have been stopped.
+static std::atomic<CParallelPool*> s_pPool(nullptr);
+static std::once_flag s_PoolOnce;
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the pool, starts it on first use; one thread per core
+//          available to the process, as the caller runs work too
+//-----------------------------------------------------------------------------
+CParallelPool& CParallelPool::Get()
+{
+    std::call_once(s_PoolOnce, []()
+        {
+            s_pPool.store(new CParallelPool(), std::memory_order_release);
+        });
+
+    return *s_pPool.load(std::memory_order_acquire);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stops the pool if it has been started, without starting it
+//-----------------------------------------------------------------------------
+void CParallelPool::ShutdownIfStarted()
+{
+    CParallelPool* const pPool = s_pPool.load(std::memory_order_acquire);
+
+    if (pPool)
+        pPool->Shutdown();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: constructor
+//-----------------------------------------------------------------------------
+CParallelPool::CParallelPool()
+    : m_nQueued(0)
+    , m_bShutdown(false)
+{
+    CpuTopology topo;
+    unsigned nCores = topo.NumberOfProcessCores();
+
+    if (!nCores)
+        nCores = std::thread::hardware_concurrency();
+
+    m_nWorkers = nCores > 1 ? nCores - 1 : 1;
+    m_Queues.reset(new WorkQueue_s[m_nWorkers + 1]);
+    m_Workers.reserve(m_nWorkers);
+
+    for (unsigned i = 0; i < m_nWorkers; i++)
+        m_Workers.emplace_back(&CParallelPool::WorkerThread, this, i);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: wakes and joins the workers, tasks that are still queued are left
+//          to the threads waiting on them
+//-----------------------------------------------------------------------------
+void CParallelPool::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+
+        if (m_bShutdown)
+            return;
+
+        m_bShutdown = true;
+    }
+
+    m_SleepCondition.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+
+    m_Workers.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues a task, on the queue of the calling worker if any
+//-----------------------------------------------------------------------------
+void CParallelPool::Push(ParallelTask_s&& task)
+{
+    const unsigned nQueue = s_nWorkerIndex >= 0 ? unsigned(s_nWorkerIndex) : m_nWorkers;
+    WorkQueue_s& queue = m_Queues[nQueue];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    m_nQueued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock ensures a worker that just found nothing to do is
+    // either already waiting, or will see the new task before it waits.
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+    }
+    m_SleepCondition.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: takes a task; own queue newest first, then the shared queue, then
+//          the oldest task of another worker
+//-----------------------------------------------------------------------------
+bool CParallelPool::Pop(ParallelTask_s& task)
+{
+    if (m_nQueued.load(std::memory_order_acquire) <= 0)
+        return false;
+
+    const int nSelf = s_nWorkerIndex;
+
+    if (nSelf >= 0)
+    {
+        WorkQueue_s& queue = m_Queues[nSelf];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+
+            m_nQueued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    const unsigned nStart = nSelf >= 0 ? unsigned(nSelf) + 1 : 0;
+
+    for (unsigned i = 0; i <= m_nWorkers; i++)
+    {
+        // The shared queue comes first, as nobody owns it.
+        const unsigned nQueue = i == 0 ? m_nWorkers : (nStart + i - 1) % m_nWorkers;
+
+        if (int(nQueue) == nSelf)
+            continue;
+
+        WorkQueue_s& queue = m_Queues[nQueue];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+
+            m_nQueued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs a single queued task, if any
+// Output : true if a task was run, false otherwise
+//-----------------------------------------------------------------------------
+bool CParallelPool::RunOne()
+{
+    ParallelTask_s task;
+
+    if (!Pop(task))
+        return false;
+
+    task.function();
+    task.group->TaskDone();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs tasks, sleeps while there aren't any
+//-----------------------------------------------------------------------------
+void CParallelPool::WorkerThread(const unsigned nIndex)
+{
+    s_nWorkerIndex = int(nIndex);
+
+    for (;;)
+    {
+        if (RunOne())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_SleepCondition.wait(lock, [this] { return m_bShutdown || m_nQueued.load(std::memory_order_acquire) > 0; });
+
+        if (m_bShutdown)
+            break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: runs a task on the pool as part of this group
+//-----------------------------------------------------------------------------
+void CParallelTaskGroup::Run(std::function<void()> task)
+{
+    m_nPending.fetch_add(1, std::memory_order_relaxed);
+    CParallelPool::Get().Push({ std::move(task), this });
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: marks a task of this group as done, wakes the waiter on the last
+//          one; the count drops under the lock, so the group can't be
+//          destroyed by the waiter while it is being signaled
+//-----------------------------------------------------------------------------
+void CParallelTaskGroup::TaskDone()
+{
+    std::lock_guard<std::mutex> lock(m_DoneMutex);
+
+    if (m_nPending.fetch_sub(1, std::memory_order_release) == 1)
+        m_DoneCondition.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: waits until all tasks of this group are done, running queued tasks
+//          in the meantime and sleeping once there are none left to run
+//-----------------------------------------------------------------------------
+void CParallelTaskGroup::Wait()
+{
+    if (!IsDone())
+    {
+        CParallelPool& pool = CParallelPool::Get();
+
+        while (!IsDone())
+        {
+            if (pool.RunOne())
+                continue;
+
+            // Nothing queued, so the remaining tasks of this group are
+            // running on other threads.
+            std::unique_lock<std::mutex> lock(m_DoneMutex);
+            m_DoneCondition.wait(lock, [this] { return IsDone(); });
+        }
+    }
+
+    // Don't return while the last task may still be signaling.
+    std::lock_guard<std::mutex> lock(m_DoneMutex);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: gets the number of threads running parallel work, including the
+//          calling thread
+//-----------------------------------------------------------------------------
+unsigned parallel_thread_count()
+{
+    return CParallelPool::Get().GetThreadCount();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: stops and joins the pool threads, if the pool has been started
+//-----------------------------------------------------------------------------
+void parallel_shutdown()
+{
+    CParallelPool::ShutdownIfStarted();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: splits a loop into chunks that are processed on the pool and the
+//          calling thread, returns once all chunks are done
+//-----------------------------------------------------------------------------
+void parallel_for(unsigned nb_elements,
+                  std::function<void (int start, int end)> functor,
+                  bool use_threads,
+                  unsigned grain_size)
+{
+    if (!nb_elements)
+        return;
+
+    const unsigned nb_threads = use_threads ? parallel_thread_count() : 1;
+
+    if (!grain_size)
+        grain_size = std::max(1u, nb_elements / (nb_threads * PARALLEL_FOR_CHUNKS_PER_THREAD));
+
+    const unsigned nb_chunks = unsigned((uint64_t(nb_elements) + grain_size - 1) / grain_size);
+
+    auto run_chunk = [&](const unsigned chunk)
+    {
+        const uint64_t start = uint64_t(chunk) * grain_size;
+        const uint64_t end = std::min<uint64_t>(start + grain_size, nb_elements);
+
+        functor(int(start), int(end));
+    };
+
+    if (!use_threads || nb_chunks == 1)
+    {
+        // Single thread execution (for easy debugging)
+        for (unsigned i = 0; i < nb_chunks; ++i)
+            run_chunk(i);
+
+        return;
+    }
+
+    std::atomic<unsigned> next_chunk(0);
+
+    auto claim_chunks = [&]()
+    {
+        for (unsigned chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+             chunk < nb_chunks;
+             chunk = next_chunk.fetch_add(1, std::memory_order_relaxed))
+        {
+            run_chunk(chunk);
+        }
+    };
+
+    CParallelTaskGroup group;
+    const unsigned nb_helpers = std::min(nb_chunks, nb_threads) - 1;
+
+    for (unsigned i = 0; i < nb_helpers; ++i)
+        group.Run(claim_chunks);
+
+    claim_chunks();
+    group.Wait();
+}
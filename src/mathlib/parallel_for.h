@@ -1,9 +1,44 @@
-#include <algorithm>
-#include <thread>
 #include <functional>
-#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #pragma once
 
+//-----------------------------------------------------------------------------
+// Group of tasks running on the process-wide work-stealing pool. Waiting on a
+// group runs pending tasks on the waiting thread, so groups can be nested
+// (e.g. a parallel_for inside a parallel_for) without deadlocking the pool.
+// Once there is nothing left to run, the waiting thread sleeps until the
+// tasks of the group still running elsewhere are done.
+//-----------------------------------------------------------------------------
+class CParallelTaskGroup
+{
+public:
+    CParallelTaskGroup() : m_nPending(0) {}
+    ~CParallelTaskGroup() { Wait(); }
+
+    void Run(std::function<void()> task);
+    void Wait();
+
+    inline bool IsDone() const { return m_nPending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class CParallelPool;
+    void TaskDone();
+
+    std::atomic<unsigned> m_nPending;
+    std::mutex m_DoneMutex;
+    std::condition_variable m_DoneCondition;
+};
+
+/// @return the number of threads running parallel work, including the caller.
+unsigned parallel_thread_count();
+
+/// Stops and joins the pool threads. Work queued afterwards is run by the
+/// threads waiting on it, so it must only be called once no more parallel
+/// work is expected to keep the pool busy.
+void parallel_shutdown();
+
 /// @param[in] nb_elements : size of your for loop
 /// @param[in] functor(start, end) :
 /// your function processing a sub chunk of the for loop.
@@ -14,45 +49,12 @@
 ///         computation(i);
 /// @endcode
 /// @param use_threads : enable / disable threads.
+/// @param grain_size : number of elements per chunk, 0 to pick one based on
+/// the number of threads. Chunks are claimed by the pool threads and the
+/// caller as they go, so uneven work is balanced out.
 ///
 ///
-static
 void parallel_for(unsigned nb_elements,
                   std::function<void (int start, int end)> functor,
-                  bool use_threads = true)
-{
-    // -------
-    unsigned nb_threads_hint = std::thread::hardware_concurrency();
-    unsigned nb_threads = nb_threads_hint == 0 ? 8 : (nb_threads_hint);
-
-    unsigned batch_size = nb_elements / nb_threads;
-    unsigned batch_remainder = nb_elements % nb_threads;
-
-    std::vector< std::thread > my_threads(nb_threads);
-
-    if( use_threads )
-    {
-        // Multithread execution
-        for(unsigned i = 0; i < nb_threads; ++i)
-        {
-            int start = i * batch_size;
-            my_threads[i] = std::thread(functor, start, start+batch_size);
-        }
-    }
-    else
-    {
-        // Single thread execution (for easy debugging)
-        for(unsigned i = 0; i < nb_threads; ++i){
-            int start = i * batch_size;
-            functor( start, start+batch_size );
-        }
-    }
-
-    // Deform the elements left
-    int start = nb_threads * batch_size;
-    functor( start, start+batch_remainder);
-
-    // Wait for the other thread to finish their task
-    if( use_threads )
-        std::for_each(my_threads.begin(), my_threads.end(), std::mem_fn(&std::thread::join));
-}
+                  bool use_threads = true,
+                  unsigned grain_size = 0);
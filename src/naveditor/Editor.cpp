@@ -63,7 +63,7 @@ unsigned int EditorDebugDraw::areaToEdgeCol(const unsigned int area) const
 	}
 }
 
-static int s_traverseAnimTraverseFlags[TraverseAnimType_e::ANIMTYPE_COUNT];
+int s_traverseAnimTraverseFlags[TraverseAnimType_e::ANIMTYPE_COUNT];
 
 static void initTraverseMasks()
 {
@@ -262,6 +262,44 @@ void Editor::collectSettings(BuildSettings& settings)
 	settings.partitionType = m_partitionType;
 }
 
+void Editor::copySettings(const Editor& other)
+{
+	m_ignoreWindingOrder = other.m_ignoreWindingOrder;
+	m_filterLowHangingObstacles = other.m_filterLowHangingObstacles;
+	m_filterLedgeSpans = other.m_filterLedgeSpans;
+	m_filterNeighborSlopes = other.m_filterNeighborSlopes;
+	m_filterWalkableLowHeightSpans = other.m_filterWalkableLowHeightSpans;
+	m_buildTraversePortals = other.m_buildTraversePortals;
+	m_traverseRayDynamicOffset = other.m_traverseRayDynamicOffset;
+	m_traverseLinkSinglePortalPerPolyPair = other.m_traverseLinkSinglePortalPerPolyPair;
+	m_collapseLinkedPolyGroups = other.m_collapseLinkedPolyGroups;
+	m_buildBvTree = other.m_buildBvTree;
+
+	m_minTileBits = other.m_minTileBits;
+	m_maxTileBits = other.m_maxTileBits;
+	m_tileSize = other.m_tileSize;
+	m_cellSize = other.m_cellSize;
+	m_cellHeight = other.m_cellHeight;
+	m_agentHeight = other.m_agentHeight;
+	m_agentRadius = other.m_agentRadius;
+	m_agentMaxClimb = other.m_agentMaxClimb;
+	m_agentMaxSlope = other.m_agentMaxSlope;
+	m_traverseRayExtraOffset = other.m_traverseRayExtraOffset;
+	m_traverseEdgeMinOverlap = other.m_traverseEdgeMinOverlap;
+	m_traversePortalMaxAlign = other.m_traversePortalMaxAlign;
+	m_regionMinSize = other.m_regionMinSize;
+	m_regionMergeSize = other.m_regionMergeSize;
+	m_edgeMaxLen = other.m_edgeMaxLen;
+	m_edgeMaxError = other.m_edgeMaxError;
+	m_vertsPerPoly = other.m_vertsPerPoly;
+	m_polyCellRes = other.m_polyCellRes;
+	m_detailSampleDist = other.m_detailSampleDist;
+	m_detailSampleMaxError = other.m_detailSampleMaxError;
+	m_partitionType = other.m_partitionType;
+
+	m_modelName = other.m_modelName;
+}
+
 void Editor::resetCommonSettings()
 {
 	selectNavMeshType(NAVMESH_SMALL);
@@ -125,6 +125,11 @@ const char* BuildContext::getLogText(const rdSizeType i) const
 	return m_messages[i]+1;
 }
 
+rcLogCategory BuildContext::getLogCategory(const rdSizeType i) const
+{
+	return (rcLogCategory)m_messages[i][0];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class GLCheckerTexture
@@ -71,11 +71,42 @@ static void EditorCommon_DrawTilingGrid(duDebugDraw* const dd, const InputGeom*
 	duDebugDrawGridXY(dd, bmax[0], bmin[1], bmin[2], tw, th, s, duRGBA(0, 0, 0, 64), 1.0f, nullptr);
 }
 
+int EditorCommon_SetTileProperties(const InputGeom* const geom,
+	const int minTilebits, const int maxTileBits, const int tileSize,
+	const float cellSize, int& maxTiles, int& maxPolysPerTile)
+{
+	if (!geom)
+	{
+		maxTiles = 0;
+		maxPolysPerTile = 0;
+		return 1;
+	}
+
+	int gw = 0, gh = 0;
+	const float* bmin = geom->getNavMeshBoundsMin();
+	const float* bmax = geom->getNavMeshBoundsMax();
+	rcCalcGridSize(bmin, bmax, cellSize, &gw, &gh);
+	const int ts = tileSize;
+	const int tw = (gw + ts-1) / ts;
+	const int th = (gh + ts-1) / ts;
+
+	// Max tiles and max polys affect how the tile IDs are calculated.
+	// There are MAX_TILE_BITS bits available for identifying a tile and a polygon.
+	const int tileBits = rdMin((int)rdIlog2(rdNextPow2(tw*th)), minTilebits);
+	const int polyBits = maxTileBits - tileBits;
+
+	maxTiles = 1 << tileBits;
+	maxPolysPerTile = 1 << polyBits;
+
+	return tw*th;
+}
+
 int EditorCommon_SetAndRenderTileProperties(const InputGeom* const geom, 
 	const int minTilebits, const int maxTileBits, const int tileSize,
 	const float cellSize, int& maxTiles, int& maxPolysPerTile)
 {
-	int gridSize = 1;
+	const int gridSize = EditorCommon_SetTileProperties(geom, minTilebits, maxTileBits,
+		tileSize, cellSize, maxTiles, maxPolysPerTile);
 
 	if (geom)
 	{
@@ -90,25 +121,9 @@ int EditorCommon_SetAndRenderTileProperties(const InputGeom* const geom,
 		ImGui::Text("Tiles: %d x %d", tw, th);
 		ImGui::Text("Tile Sizes: %g x %g (%g)", tw*cellSize, th*cellSize, tileSize*cellSize);
 
-		// Max tiles and max polys affect how the tile IDs are calculated.
-		// There are MAX_TILE_BITS bits available for identifying a tile and a polygon.
-		const int tileBits = rdMin((int)rdIlog2(rdNextPow2(tw*th)), minTilebits);
-		const int polyBits = maxTileBits - tileBits;
-
-		maxTiles = 1 << tileBits;
-		maxPolysPerTile = 1 << polyBits;
-
-		gridSize = tw*th;
-
 		ImGui::Text("Max Tiles: %d", maxTiles);
 		ImGui::Text("Max Polys: %d", maxPolysPerTile);
 	}
-	else
-	{
-		maxTiles = 0;
-		maxPolysPerTile = 0;
-		gridSize = 1;
-	}
 
 	return gridSize;
 }
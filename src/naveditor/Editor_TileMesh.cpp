@@ -30,12 +30,14 @@
 #include "NavEditor/Include/ShapeVolumeTool.h"
 #include "NavEditor/Include/CrowdTool.h"
 #include "NavEditor/Include/InputGeom.h"
+#include "NavEditor/Include/PerfTimer.h"
 #include "NavEditor/Include/Editor.h"
 #include "NavEditor/Include/Editor_TileMesh.h"
 
 #include "game/server/ai_navmesh.h"
 #include "game/server/ai_hull.h"
 #include "coordsize.h"
+#include "mathlib/parallel_for.h"
 
 
 #ifdef DT_POLYREF64
@@ -473,13 +475,49 @@ public:
 
 
 
+TileMeshBuildData::TileMeshBuildData() :
+	triareas(0),
+	solid(0),
+	chf(0),
+	cset(0),
+	pmesh(0),
+	dmesh(0),
+	triCount(0),
+	memUsage(0),
+	buildTime(0)
+{
+	memset(&cfg, 0, sizeof(cfg));
+}
+
+TileMeshBuildData::~TileMeshBuildData()
+{
+	cleanup();
+}
+
+void TileMeshBuildData::cleanup()
+{
+	delete[] triareas;
+	triareas = 0;
+	rcFreeHeightField(solid);
+	solid = 0;
+	rcFreeCompactHeightfield(chf);
+	chf = 0;
+	rcFreeContourSet(cset);
+	cset = 0;
+	rcFreePolyMesh(pmesh);
+	pmesh = 0;
+	rcFreePolyMeshDetail(dmesh);
+	dmesh = 0;
+}
+
 Editor_TileMesh::Editor_TileMesh() :
 	m_buildAll(true),
 	m_maxTiles(0),
 	m_maxPolysPerTile(0),
 	m_tileBuildTime(0),
 	m_tileMemUsage(0),
-	m_tileTriCount(0)
+	m_tileTriCount(0),
+	m_buildThreadCount(0)
 {
 	memset(m_lastBuiltTileBmin, 0, sizeof(m_lastBuiltTileBmin));
 	memset(m_lastBuiltTileBmax, 0, sizeof(m_lastBuiltTileBmax));
@@ -505,6 +543,7 @@ void Editor_TileMesh::handleSettings()
 
 	ImGui::Checkbox("Build All Tiles", &m_buildAll);
 	ImGui::Checkbox("Keep Intermediate Results", &m_keepInterResults);
+	ImGui::SliderInt("Build Threads", &m_buildThreadCount, 0, 64, m_buildThreadCount ? "%d" : "Auto");
 	
 	EditorCommon_SetAndRenderTileProperties(m_geom, m_minTileBits, m_maxTileBits, m_tileSize, m_cellSize, m_maxTiles, m_maxPolysPerTile);
 	
@@ -778,7 +817,7 @@ void Editor_TileMesh::buildTile(const float* pos)
 	m_ctx->dumpLog("Build Tile (%d,%d):", tx,ty);
 }
 
-void Editor_TileMesh::getTileExtents(int tx, int ty, float* tmin, float* tmax)
+void Editor_TileMesh::getTileExtents(int tx, int ty, float* tmin, float* tmax) const
 {
 	const float ts = m_tileSize * m_cellSize;
 	const float* bmin = m_geom->getNavMeshBoundsMin();
@@ -839,6 +878,69 @@ void Editor_TileMesh::removeTile(const float* pos)
 	}
 }
 
+// Collects the errors logged while building a tile, these are forwarded to
+// the context of the editor once the tile is added to the navmesh.
+static void collectBuildErrors(const BuildContext& ctx, std::vector<std::string>& errors)
+{
+	for (int i = 0; i < ctx.getLogCount(); i++)
+	{
+		if (ctx.getLogCategory(i) == RC_LOG_ERROR)
+			errors.push_back(ctx.getLogText(i));
+	}
+}
+
+// Returns whether both configurations rasterize the input geometry into the
+// same spans, in which case their tiles can share a single heightfield.
+static bool canShareHeightfield(const rcConfig& a, const rcConfig& b)
+{
+	return a.cs == b.cs && a.ch == b.ch && a.tileSize == b.tileSize &&
+		a.walkableClimb == b.walkableClimb && a.walkableSlopeAngle == b.walkableSlopeAngle &&
+		a.ignoreWindingOrder == b.ignoreWindingOrder;
+}
+
+// Copies the spans of a tile heightfield that was rasterized with a larger
+// border into the (smaller) heightfield of the build configuration. Both must
+// share the same tile, cell size, cell height and walkable climb; spans don't
+// depend on the extents of the heightfield, so the result is the same as
+// rasterizing the geometry into the smaller heightfield directly, apart from
+// floating point rounding of the cell boundaries.
+static bool cropHeightfield(rcContext* ctx, const rcHeightfield& src, TileMeshBuildData& build)
+{
+	const rcConfig& cfg = build.cfg;
+	const int offset = (src.width - cfg.width) / 2;
+
+	rdAssert(offset >= 0 && src.height - cfg.height == offset*2);
+
+	build.solid = rcAllocHeightfield();
+	if (!build.solid)
+	{
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'solid'.");
+		return false;
+	}
+	if (!rcCreateHeightfield(ctx, *build.solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch))
+	{
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not create solid heightfield.");
+		return false;
+	}
+
+	for (int y = 0; y < cfg.height; ++y)
+	{
+		for (int x = 0; x < cfg.width; ++x)
+		{
+			const rcSpan* span = src.spans[(x+offset) + (y+offset)*src.width];
+
+			// Spans in a column never touch, so they are added as is.
+			for (; span; span = span->next)
+			{
+				if (!rcAddSpan(ctx, *build.solid, x, y, (unsigned short)span->smin, (unsigned short)span->smax, (unsigned char)span->area, 0))
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 void Editor_TileMesh::buildAllTiles()
 {
 	if (!m_geom) return;
@@ -851,18 +953,89 @@ void Editor_TileMesh::buildAllTiles()
 	const int ts = m_tileSize;
 	const int tw = (gw + ts-1) / ts;
 	const int th = (gh + ts-1) / ts;
+	const int tileCount = tw*th;
+
+	if (!tileCount)
+		return;
 	
 	// Start the build process.
 	m_ctx->startTimer(RC_TIMER_TEMP);
 
+	// Intermediate results are only kept for the interactive single tile
+	// builds, as every tile would otherwise overwrite those of the previous.
+	cleanup();
+
+	int threadCount = m_buildThreadCount > 0
+		? m_buildThreadCount
+		: (int)parallel_thread_count();
+
+	threadCount = rdClamp(threadCount, 1, tileCount);
+
+	std::vector<TileMeshBuildResult> results(tileCount);
+	std::atomic<int> nextTile(0);
+
+	// Tiles don't depend on each other, so every thread takes the next tile
+	// that hasn't been built yet using its own context and scratch data.
+	auto buildWorker = [&]()
+	{
+		BuildContext ctx;
+		TileMeshBuildData build;
+
+		for (;;)
+		{
+			const int i = nextTile.fetch_add(1, std::memory_order_relaxed);
+
+			if (i >= tileCount)
+				break;
+
+			const int x = i % tw;
+			const int y = i / tw;
+
+			float tileBmin[3], tileBmax[3];
+			getTileExtents(x, y, tileBmin, tileBmax);
+
+			ctx.resetLog();
+
+			TileMeshBuildResult& result = results[i];
+			result.data = buildTileMesh(&ctx, build, false, x, y, tileBmin, tileBmax, result.dataSize);
+
+			build.cleanup();
+
+			collectBuildErrors(ctx, result.errors);
+		}
+	};
+
+	CParallelTaskGroup workers;
+
+	for (int i = 1; i < threadCount; i++)
+		workers.Run(buildWorker);
+
+	buildWorker();
+	workers.Wait();
+
+	addAllTiles(results, tw, th);
+	
+	// Start the build process.	
+	m_ctx->stopTimer(RC_TIMER_TEMP);
+
+	m_totalBuildTimeMs = m_ctx->getAccumulatedTime(RC_TIMER_TEMP)/1000.0f;
+	m_tileCol = duRGBA(0,0,0,64);
+}
+
+void Editor_TileMesh::addAllTiles(std::vector<TileMeshBuildResult>& results, const int tw, const int th)
+{
+	// Add the tiles in the same order as they would be built serially, this
+	// keeps the tile references identical between builds.
 	for (int y = 0; y < th; ++y)
 	{
 		for (int x = 0; x < tw; ++x)
 		{
-			getTileExtents(x, y, m_lastBuiltTileBmin, m_lastBuiltTileBmax);
-			
-			int dataSize = 0;
-			unsigned char* data = buildTileMesh(x, y, m_lastBuiltTileBmin, m_lastBuiltTileBmax, dataSize);
+			TileMeshBuildResult& result = results[y*tw + x];
+
+			for (const std::string& error : result.errors)
+				m_ctx->log(RC_LOG_ERROR, "Tile (%d,%d): %s", x, y, error.c_str());
+
+			unsigned char* data = result.data;
 			if (data)
 			{
 				// Remove any previous data (navmesh owns and deletes the data).
@@ -870,7 +1043,7 @@ void Editor_TileMesh::buildAllTiles()
 				// Let the navmesh own the data.
 
 				dtTileRef tileRef = 0;
-				dtStatus status = m_navMesh->addTile(data,dataSize,DT_TILE_FREE_DATA,0,&tileRef);
+				dtStatus status = m_navMesh->addTile(data,result.dataSize,DT_TILE_FREE_DATA,0,&tileRef);
 				if (dtStatusFailed(status))
 					rdFree(data);
 				else
@@ -879,18 +1052,14 @@ void Editor_TileMesh::buildAllTiles()
 		}
 	}
 
+	getTileExtents(tw-1, th-1, m_lastBuiltTileBmin, m_lastBuiltTileBmax);
+
 	connectOffMeshLinks();
 
 	if (m_buildTraversePortals)
 		createTraverseLinks();
 
 	createStaticPathingData();
-	
-	// Start the build process.	
-	m_ctx->stopTimer(RC_TIMER_TEMP);
-
-	m_totalBuildTimeMs = m_ctx->getAccumulatedTime(RC_TIMER_TEMP)/1000.0f;
-	m_tileCol = duRGBA(0,0,0,64);
 }
 
 void Editor_TileMesh::removeAllTiles()
@@ -914,65 +1083,428 @@ void Editor_TileMesh::removeAllTiles()
 	createStaticPathingData();
 }
 
-void Editor_TileMesh::buildAllHulls()
+bool Editor_TileMesh::buildHull(const NavMeshType_e navMeshType)
 {
-	for (const NavMeshDefaults_s& h : g_navMeshDefaults)
-	{
-		m_agentRadius = h.radius;
-		m_agentMaxClimb = h.climbHeight;
-		m_agentHeight = h.height;
-		m_navmeshName = h.name;
-		m_cellSize = h.cellSize;
-		m_polyCellRes = h.polyCellResolution;
+	selectNavMeshType(navMeshType);
 
-		m_ctx->resetLog();
+	m_ctx->resetLog();
 
-		handleSettings();
-		handleBuild();
+	// Don't go through handleSettings() here as this also runs headless.
+	EditorCommon_SetTileProperties(m_geom, m_minTileBits, m_maxTileBits, m_tileSize, m_cellSize, m_maxTiles, m_maxPolysPerTile);
+	const bool result = handleBuild();
 
-		m_ctx->dumpLog("Build log %s:", h.name);
+	m_ctx->dumpLog("Build log %s:", m_navmeshName);
+
+	if (result)
 		Editor::saveAll(m_modelName.c_str(), m_navMesh);
-	}
+
+	return result;
 }
 
-unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const float* bmin, const float* bmax, int& dataSize)
+bool Editor_TileMesh::buildHulls(const unsigned int navMeshTypeMask)
 {
 	if (!m_geom || !m_geom->getMesh() || !m_geom->getChunkyMesh())
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Input mesh is not specified.");
-		return 0;
+		m_ctx->log(RC_LOG_ERROR, "buildHulls: Input mesh is not specified.");
+		return false;
 	}
-	
-	m_tileMemUsage = 0;
-	m_tileBuildTime = 0;
-	
+
+	// Every hull is built by its own editor so the navmeshes can be built,
+	// linked and written independently from each other.
+	struct HullBuild
+	{
+		Editor_TileMesh* editor;
+		BuildContext* ctx;
+		std::vector<TileMeshBuildResult> results;
+		bool result;
+	};
+
+	// Hulls that rasterize the input geometry into the same spans are built
+	// together, the geometry of each tile is then only rasterized once for
+	// the whole group using the largest border of the group.
+	struct HullBuildGroup
+	{
+		int hulls[NAVMESH_COUNT];
+		int hullCount;
+		int borderSize;
+		int tw, th;
+		std::atomic<int> tilesLeft;
+	};
+
+	struct HullBuildJob
+	{
+		int group;
+		int tile;
+	};
+
+	// Context and scratch data used by a tile build.
+	struct HullBuildScratch
+	{
+		BuildContext ctx;
+		TileMeshBuildData shared;
+		TileMeshBuildData build;
+		std::vector<std::string> sharedErrors;
+	};
+
+	const rdTimeType startTime = getPerfTime();
+
+	HullBuild hulls[NAVMESH_COUNT];
+	int hullCount = 0;
+
+	// Constructing an editor resets the traverse tables, restore the ones
+	// that might have been tuned in this editor afterwards.
+	TraverseType_s traverseTable[NUM_TRAVERSE_TYPES];
+	int traverseAnimTraverseFlags[ANIMTYPE_COUNT];
+	memcpy(traverseTable, s_traverseTable, sizeof(traverseTable));
+	memcpy(traverseAnimTraverseFlags, s_traverseAnimTraverseFlags, sizeof(traverseAnimTraverseFlags));
+
+	for (int i = 0; i < NAVMESH_COUNT; i++)
+	{
+		if (!(navMeshTypeMask & (1<<i)))
+			continue;
+
+		HullBuild& hull = hulls[hullCount++];
+		hull.ctx = new BuildContext;
+		hull.editor = new Editor_TileMesh;
+
+		Editor_TileMesh* editor = hull.editor;
+		editor->setContext(hull.ctx);
+		editor->handleMeshChanged(m_geom);
+		editor->copySettings(*this);
+		editor->selectNavMeshType(NavMeshType_e(i));
+
+		EditorCommon_SetTileProperties(m_geom, editor->m_minTileBits, editor->m_maxTileBits, editor->m_tileSize,
+			editor->m_cellSize, editor->m_maxTiles, editor->m_maxPolysPerTile);
+
+		// Only initialize the navmesh, the tiles are built below.
+		editor->m_buildAll = false;
+		hull.result = editor->handleBuild();
+	}
+
+	memcpy(s_traverseTable, traverseTable, sizeof(traverseTable));
+	memcpy(s_traverseAnimTraverseFlags, traverseAnimTraverseFlags, sizeof(traverseAnimTraverseFlags));
+
+	HullBuildGroup groups[NAVMESH_COUNT];
+	int groupCount = 0;
+
+	const float* bmin = m_geom->getNavMeshBoundsMin();
+	const float* bmax = m_geom->getNavMeshBoundsMax();
+
+	for (int i = 0; i < hullCount; i++)
+	{
+		const Editor_TileMesh* editor = hulls[i].editor;
+
+		if (!hulls[i].result)
+			continue;
+
+		rcConfig cfg;
+		editor->initTileConfig(cfg, 0, bmin, bmax);
+
+		int j = 0;
+		for (; j < groupCount; j++)
+		{
+			rcConfig groupCfg;
+			hulls[groups[j].hulls[0]].editor->initTileConfig(groupCfg, 0, bmin, bmax);
+
+			if (canShareHeightfield(cfg, groupCfg))
+				break;
+		}
+
+		HullBuildGroup& group = groups[j];
+
+		if (j == groupCount)
+		{
+			groupCount++;
+
+			int gw = 0, gh = 0;
+			rcCalcGridSize(bmin, bmax, cfg.cs, &gw, &gh);
+
+			group.hullCount = 0;
+			group.borderSize = 0;
+			group.tw = (gw + cfg.tileSize-1) / cfg.tileSize;
+			group.th = (gh + cfg.tileSize-1) / cfg.tileSize;
+			group.tilesLeft = group.tw*group.th;
+		}
+
+		group.hulls[group.hullCount++] = i;
+		group.borderSize = rdMax(group.borderSize, editor->getTileBorderSize());
+
+		hulls[i].results.resize(group.tw*group.th);
+	}
+
+	// Queue the groups with the most work first, so the hulls that take the
+	// longest to build are also the first to be linked and written.
+	int groupOrder[NAVMESH_COUNT];
+	for (int i = 0; i < groupCount; i++)
+		groupOrder[i] = i;
+
+	std::sort(groupOrder, groupOrder + groupCount, [&](const int a, const int b)
+		{
+			return groups[a].tw*groups[a].th*groups[a].hullCount > groups[b].tw*groups[b].th*groups[b].hullCount;
+		});
+
+	std::vector<HullBuildJob> jobs;
+
+	for (int i = 0; i < groupCount; i++)
+	{
+		const int g = groupOrder[i];
+		const HullBuildGroup& group = groups[g];
+		const int tileCount = group.tw*group.th;
+
+		for (int j = 0; j < tileCount; j++)
+			jobs.push_back({ g, j });
+	}
+
+	const int jobCount = (int)jobs.size();
+
+	int threadCount = m_buildThreadCount > 0
+		? m_buildThreadCount
+		: (int)parallel_thread_count();
+
+	threadCount = rdClamp(threadCount, 1, rdMax(jobCount, 1));
+
+	std::mutex logMutex;
+
+	// Scratch data of the tiles in flight, reused by the tiles that follow.
+	std::vector<std::unique_ptr<HullBuildScratch>> scratches;
+	std::vector<HullBuildScratch*> freeScratches;
+	std::mutex scratchMutex;
+
+	auto acquireScratch = [&]() -> HullBuildScratch*
+	{
+		std::lock_guard<std::mutex> lock(scratchMutex);
+
+		if (freeScratches.empty())
+		{
+			scratches.emplace_back(new HullBuildScratch);
+			return scratches.back().get();
+		}
+
+		HullBuildScratch* scratch = freeScratches.back();
+		freeScratches.pop_back();
+
+		return scratch;
+	};
+
+	auto releaseScratch = [&](HullBuildScratch* scratch)
+	{
+		std::lock_guard<std::mutex> lock(scratchMutex);
+		freeScratches.push_back(scratch);
+	};
+
+	auto buildTile = [&](HullBuildScratch& scratch, const HullBuildGroup& group, const int tile)
+	{
+		BuildContext& ctx = scratch.ctx;
+		TileMeshBuildData& shared = scratch.shared;
+		TileMeshBuildData& build = scratch.build;
+		std::vector<std::string>& sharedErrors = scratch.sharedErrors;
+
+		const int x = tile % group.tw;
+		const int y = tile / group.tw;
+
+		const Editor_TileMesh* leader = hulls[group.hulls[0]].editor;
+
+		float tileBmin[3], tileBmax[3];
+		leader->getTileExtents(x, y, tileBmin, tileBmax);
+
+		if (group.hullCount == 1)
+		{
+			TileMeshBuildResult& result = hulls[group.hulls[0]].results[tile];
+
+			ctx.resetLog();
+			result.data = leader->buildTileMesh(&ctx, build, false, x, y, tileBmin, tileBmax, result.dataSize);
+
+			build.cleanup();
+			collectBuildErrors(ctx, result.errors);
+
+			return;
+		}
+
+		ctx.resetLog();
+		leader->initTileConfig(shared.cfg, group.borderSize, tileBmin, tileBmax);
+
+		const bool rasterized = leader->rasterizeTileMesh(&ctx, shared, false);
+
+		sharedErrors.clear();
+		collectBuildErrors(ctx, sharedErrors);
+
+		for (int i = 0; i < group.hullCount; i++)
+		{
+			const Editor_TileMesh* editor = hulls[group.hulls[i]].editor;
+			TileMeshBuildResult& result = hulls[group.hulls[i]].results[tile];
+
+			result.errors = sharedErrors;
+
+			if (!rasterized)
+				continue;
+
+			ctx.resetLog();
+			ctx.resetTimers();
+			ctx.startTimer(RC_TIMER_TOTAL);
+
+			editor->initTileConfig(build.cfg, editor->getTileBorderSize(), tileBmin, tileBmax);
+
+			if (cropHeightfield(&ctx, *shared.solid, build))
+				result.data = editor->buildTileMeshFromSolid(&ctx, build, false, x, y, result.dataSize);
+
+			build.cleanup();
+			collectBuildErrors(ctx, result.errors);
+		}
+
+		shared.cleanup();
+	};
+
+	auto finishHull = [&](HullBuild& hull, const HullBuildGroup& group)
+	{
+		Editor_TileMesh* editor = hull.editor;
+
+		editor->addAllTiles(hull.results, group.tw, group.th);
+		std::vector<TileMeshBuildResult>().swap(hull.results);
+
+		// Write the navmesh as soon as it's done.
+		editor->Editor::saveAll(editor->m_modelName.c_str(), editor->m_navMesh);
+
+		hull.ctx->log(RC_LOG_PROGRESS, "Built navmesh in %.2fms", getPerfTimeUsec(getPerfTime() - startTime) / 1000.0f);
+
+		std::lock_guard<std::mutex> lock(logMutex);
+		hull.ctx->dumpLog("Build log %s:", editor->m_navmeshName);
+	};
+
+	CParallelTaskGroup tasks;
+
+	auto queueFinishHulls = [&](const HullBuildGroup& group)
+	{
+		for (int i = 0; i < group.hullCount; i++)
+		{
+			HullBuild& hull = hulls[group.hulls[i]];
+			tasks.Run([&finishHull, &hull, &group]() { finishHull(hull, group); });
+		}
+	};
+
+	// Tiles of all groups are interleaved on the thread pool, at most
+	// threadCount at a time; every tile queues the next one once done. The
+	// tile that completes a group queues the jobs that link and write its
+	// navmeshes after that, tasks queued on a pool thread run newest first
+	// so those go before the remaining tiles.
+	std::atomic<int> nextJob(0);
+	std::function<void()> runTileJob;
+
+	runTileJob = [&]()
+	{
+		const int j = nextJob.fetch_add(1, std::memory_order_relaxed);
+
+		if (j >= jobCount)
+			return;
+
+		const HullBuildJob& job = jobs[j];
+		HullBuildGroup& group = groups[job.group];
+
+		HullBuildScratch* scratch = acquireScratch();
+		buildTile(*scratch, group, job.tile);
+		releaseScratch(scratch);
+
+		tasks.Run(runTileJob);
+
+		if (group.tilesLeft.fetch_sub(1) == 1)
+			queueFinishHulls(group);
+	};
+
+	// Groups without any tiles only need their navmeshes linked and written.
+	for (int i = 0; i < groupCount; i++)
+	{
+		const HullBuildGroup& group = groups[groupOrder[i]];
+
+		if (!(group.tw*group.th))
+			queueFinishHulls(group);
+	}
+
+	for (int i = 0; i < threadCount; i++)
+		tasks.Run(runTileJob);
+
+	tasks.Wait();
+
+	bool result = hullCount > 0;
+
+	for (int i = 0; i < hullCount; i++)
+	{
+		HullBuild& hull = hulls[i];
+
+		if (!hull.result)
+		{
+			hull.ctx->dumpLog("Build log %s:", hull.editor->m_navmeshName);
+			result = false;
+		}
+
+		delete hull.editor;
+		delete hull.ctx;
+	}
+
+	return result;
+}
+
+void Editor_TileMesh::buildAllHulls()
+{
+	buildHulls((1<<NAVMESH_COUNT)-1);
+}
+
+unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const float* bmin, const float* bmax, int& dataSize)
+{
 	cleanup();
-	
-	const float* verts = m_geom->getMesh()->getVerts();
-	const int nverts = m_geom->getMesh()->getVertCount();
-	const int ntris = m_geom->getMesh()->getTriCount();
-	const rcChunkyTriMesh* chunkyMesh = m_geom->getChunkyMesh();
-		
+
+	TileMeshBuildData build;
+	unsigned char* navData = buildTileMesh(m_ctx, build, m_keepInterResults, tx, ty, bmin, bmax, dataSize);
+
+	// Hand the intermediate results over to the editor so they can be rendered.
+	m_triareas = build.triareas;
+	m_solid = build.solid;
+	m_chf = build.chf;
+	m_cset = build.cset;
+	m_pmesh = build.pmesh;
+	m_dmesh = build.dmesh;
+	m_cfg = build.cfg;
+
+	build.triareas = 0;
+	build.solid = 0;
+	build.chf = 0;
+	build.cset = 0;
+	build.pmesh = 0;
+	build.dmesh = 0;
+
+	m_tileTriCount = build.triCount;
+	m_tileMemUsage = build.memUsage;
+	m_tileBuildTime = build.buildTime;
+
+	return navData;
+}
+
+int Editor_TileMesh::getTileBorderSize() const
+{
+	// Reserve enough padding.
+	return (int)ceilf(m_agentRadius / m_cellSize) + 3;
+}
+
+void Editor_TileMesh::initTileConfig(rcConfig& cfg, const int borderSize, const float* bmin, const float* bmax) const
+{
 	// Init build configuration from GUI
-	memset(&m_cfg, 0, sizeof(m_cfg));
-	m_cfg.cs = m_cellSize;
-	m_cfg.ch = m_cellHeight;
-	m_cfg.walkableSlopeAngle = m_agentMaxSlope;
-	m_cfg.walkableHeight = (int)ceilf(m_agentHeight / m_cfg.ch);
-	m_cfg.walkableClimb = (int)floorf(m_agentMaxClimb / m_cfg.ch);
-	m_cfg.walkableRadius = (int)ceilf(m_agentRadius / m_cfg.cs);
-	m_cfg.maxEdgeLen = (int)(m_edgeMaxLen / m_cellSize);
-	m_cfg.maxSimplificationError = m_edgeMaxError;
-	m_cfg.minRegionArea = rdSqr(m_regionMinSize);		// Note: area = size*size
-	m_cfg.mergeRegionArea = rdSqr(m_regionMergeSize);	// Note: area = size*size
-	m_cfg.maxVertsPerPoly = (int)m_vertsPerPoly;
-	m_cfg.tileSize = m_tileSize;
-	m_cfg.borderSize = m_cfg.walkableRadius + 3; // Reserve enough padding.
-	m_cfg.width = m_cfg.tileSize + m_cfg.borderSize*2;
-	m_cfg.height = m_cfg.tileSize + m_cfg.borderSize*2;
-	m_cfg.detailSampleDist = m_detailSampleDist < 0.9f ? 0 : m_cellSize * m_detailSampleDist;
-	m_cfg.detailSampleMaxError = m_cellHeight * m_detailSampleMaxError;
-	m_cfg.ignoreWindingOrder = m_ignoreWindingOrder;
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.cs = m_cellSize;
+	cfg.ch = m_cellHeight;
+	cfg.walkableSlopeAngle = m_agentMaxSlope;
+	cfg.walkableHeight = (int)ceilf(m_agentHeight / cfg.ch);
+	cfg.walkableClimb = (int)floorf(m_agentMaxClimb / cfg.ch);
+	cfg.walkableRadius = (int)ceilf(m_agentRadius / cfg.cs);
+	cfg.maxEdgeLen = (int)(m_edgeMaxLen / m_cellSize);
+	cfg.maxSimplificationError = m_edgeMaxError;
+	cfg.minRegionArea = rdSqr(m_regionMinSize);		// Note: area = size*size
+	cfg.mergeRegionArea = rdSqr(m_regionMergeSize);	// Note: area = size*size
+	cfg.maxVertsPerPoly = (int)m_vertsPerPoly;
+	cfg.tileSize = m_tileSize;
+	cfg.borderSize = borderSize;
+	cfg.width = cfg.tileSize + cfg.borderSize*2;
+	cfg.height = cfg.tileSize + cfg.borderSize*2;
+	cfg.detailSampleDist = m_detailSampleDist < 0.9f ? 0 : m_cellSize * m_detailSampleDist;
+	cfg.detailSampleMaxError = m_cellHeight * m_detailSampleMaxError;
+	cfg.ignoreWindingOrder = m_ignoreWindingOrder;
 	
 	// Expand the heighfield bounding box by border size to find the extents of geometry we need to build this tile.
 	//
@@ -995,58 +1527,55 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 	// For example if you build a navmesh for terrain, and want the navmesh tiles to match the terrain tile size
 	// you will need to pass in data from neighbour terrain tiles too! In a simple case, just pass in all the 8 neighbours,
 	// or use the bounding box below to only pass in a sliver of each of the 8 neighbours.
-	rdVcopy(m_cfg.bmin, bmin);
-	rdVcopy(m_cfg.bmax, bmax);
-	m_cfg.bmin[0] -= m_cfg.borderSize*m_cfg.cs;
-	m_cfg.bmin[1] -= m_cfg.borderSize*m_cfg.cs;
-	m_cfg.bmax[0] += m_cfg.borderSize*m_cfg.cs;
-	m_cfg.bmax[1] += m_cfg.borderSize*m_cfg.cs;
-	
-	// Reset build times gathering.
-	m_ctx->resetTimers();
-	
-	// Start the build process.
-	m_ctx->startTimer(RC_TIMER_TOTAL);
-	
-	m_ctx->log(RC_LOG_PROGRESS, "Building navigation:");
-	m_ctx->log(RC_LOG_PROGRESS, " - %d x %d cells", m_cfg.width, m_cfg.height);
-	m_ctx->log(RC_LOG_PROGRESS, " - %.1fK verts, %.1fK tris", nverts/1000.0f, ntris/1000.0f);
-	
+	rdVcopy(cfg.bmin, bmin);
+	rdVcopy(cfg.bmax, bmax);
+	cfg.bmin[0] -= cfg.borderSize*cfg.cs;
+	cfg.bmin[1] -= cfg.borderSize*cfg.cs;
+	cfg.bmax[0] += cfg.borderSize*cfg.cs;
+	cfg.bmax[1] += cfg.borderSize*cfg.cs;
+}
+
+bool Editor_TileMesh::rasterizeTileMesh(rcContext* ctx, TileMeshBuildData& build, const bool keepInterResults) const
+{
+	const float* verts = m_geom->getMesh()->getVerts();
+	const int nverts = m_geom->getMesh()->getVertCount();
+	const rcChunkyTriMesh* chunkyMesh = m_geom->getChunkyMesh();
+
 	// Allocate voxel heightfield where we rasterize our input data to.
-	m_solid = rcAllocHeightfield();
-	if (!m_solid)
+	build.solid = rcAllocHeightfield();
+	if (!build.solid)
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'solid'.");
-		return 0;
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'solid'.");
+		return false;
 	}
-	if (!rcCreateHeightfield(m_ctx, *m_solid, m_cfg.width, m_cfg.height, m_cfg.bmin, m_cfg.bmax, m_cfg.cs, m_cfg.ch))
+	if (!rcCreateHeightfield(ctx, *build.solid, build.cfg.width, build.cfg.height, build.cfg.bmin, build.cfg.bmax, build.cfg.cs, build.cfg.ch))
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not create solid heightfield.");
-		return 0;
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not create solid heightfield.");
+		return false;
 	}
 	
 	// Allocate array that can hold triangle flags.
 	// If you have multiple meshes you need to process, allocate
 	// an array which can hold the max number of triangles you need to process.
-	m_triareas = new unsigned char[chunkyMesh->maxTrisPerChunk];
-	if (!m_triareas)
+	build.triareas = new unsigned char[chunkyMesh->maxTrisPerChunk];
+	if (!build.triareas)
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'm_triareas' (%d).", chunkyMesh->maxTrisPerChunk);
-		return 0;
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'build.triareas' (%d).", chunkyMesh->maxTrisPerChunk);
+		return false;
 	}
 	
 	float tbmin[2], tbmax[2];
-	tbmin[0] = m_cfg.bmin[0];
-	tbmin[1] = m_cfg.bmin[1];
-	tbmax[0] = m_cfg.bmax[0];
-	tbmax[1] = m_cfg.bmax[1];
+	tbmin[0] = build.cfg.bmin[0];
+	tbmin[1] = build.cfg.bmin[1];
+	tbmax[0] = build.cfg.bmax[0];
+	tbmax[1] = build.cfg.bmax[1];
 #if 0 //NOTE(warmist): original algo
 	int cid[2048];// TODO: Make grow when returning too many items.
 	const int ncid = rcGetChunksOverlappingRect(chunkyMesh, tbmin, tbmax, cid, 2048);
 	if (!ncid)
-		return 0;
+		return false;
 	
-	m_tileTriCount = 0;
+	build.triCount = 0;
 	
 	for (int i = 0; i < ncid; ++i)
 	{
@@ -1054,21 +1583,21 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 		const int* ctris = &chunkyMesh->tris[node.i*3];
 		const int nctris = node.n;
 		
-		m_tileTriCount += nctris;
+		build.triCount += nctris;
 		
-		memset(m_triareas, 0, nctris*sizeof(unsigned char));
-		rcMarkWalkableTriangles(m_ctx, m_cfg.walkableSlopeAngle,
-								verts, nverts, ctris, nctris, m_triareas, m_cfg.ignoreWindingOrder);
+		memset(build.triareas, 0, nctris*sizeof(unsigned char));
+		rcMarkWalkableTriangles(ctx, build.cfg.walkableSlopeAngle,
+								verts, nverts, ctris, nctris, build.triareas, build.cfg.ignoreWindingOrder);
 		
-		if (!rcRasterizeTriangles(m_ctx, verts, nverts, ctris, m_triareas, nctris, *m_solid, m_cfg.walkableClimb))
-			return 0;
+		if (!rcRasterizeTriangles(ctx, verts, nverts, ctris, build.triareas, nctris, *build.solid, build.cfg.walkableClimb))
+			return false;
 	}
 #else //NOTE(warmist): algo with limited return but can be reinvoked to continue the query
 	int cid[1024];//NOTE: we don't grow it but we reuse it (e.g. like a yieldable function or iterator or sth)
 	int currentNode = 0;
 
 	bool done = false;
-	m_tileTriCount = 0;
+	build.triCount = 0;
 	do{
 		int currentCount = 0;
 		done=rcGetChunksOverlappingRect(chunkyMesh, tbmin, tbmax, cid, 1024,currentCount,currentNode);
@@ -1078,61 +1607,67 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 			const int* ctris = &chunkyMesh->tris[node.i*3];
 			const int nctris = node.n;
 
-			m_tileTriCount += nctris;
+			build.triCount += nctris;
 
-			memset(m_triareas, 0, nctris * sizeof(unsigned char));
-			rcMarkWalkableTriangles(m_ctx, m_cfg.walkableSlopeAngle,
-				verts, nverts, ctris, nctris, m_triareas, m_cfg.ignoreWindingOrder);
+			memset(build.triareas, 0, nctris * sizeof(unsigned char));
+			rcMarkWalkableTriangles(ctx, build.cfg.walkableSlopeAngle,
+				verts, nverts, ctris, nctris, build.triareas, build.cfg.ignoreWindingOrder);
 
-			if (!rcRasterizeTriangles(m_ctx, verts, nverts, ctris, m_triareas, nctris, *m_solid, m_cfg.walkableClimb))
-				return 0;
+			if (!rcRasterizeTriangles(ctx, verts, nverts, ctris, build.triareas, nctris, *build.solid, build.cfg.walkableClimb))
+				return false;
 		}
 	} while (!done);
 
-	if (m_tileTriCount == 0)
-		return 0;
+	if (build.triCount == 0)
+		return false;
 #endif
-	if (!m_keepInterResults)
+	if (!keepInterResults)
 	{
-		delete [] m_triareas;
-		m_triareas = 0;
+		delete [] build.triareas;
+		build.triareas = 0;
 	}
-	
+
+	return true;
+}
+
+unsigned char* Editor_TileMesh::buildTileMeshFromSolid(rcContext* ctx, TileMeshBuildData& build, const bool keepInterResults,
+	const int tx, const int ty, int& dataSize) const
+{
 	// Once all geometry is rasterized, we do initial pass of filtering to
 	// remove unwanted overhangs caused by the conservative rasterization
 	// as well as filter spans where the character cannot possibly stand.
 	if (m_filterLowHangingObstacles)
-		rcFilterLowHangingWalkableObstacles(m_ctx, m_cfg.walkableClimb, *m_solid);
+		rcFilterLowHangingWalkableObstacles(ctx, build.cfg.walkableClimb, *build.solid);
 	if (m_filterLedgeSpans)
-		rcFilterLedgeSpans(m_ctx, m_cfg.walkableHeight, m_cfg.walkableClimb, m_filterNeighborSlopes, *m_solid);
+		rcFilterLedgeSpans(ctx, build.cfg.walkableHeight, build.cfg.walkableClimb, m_filterNeighborSlopes, *build.solid);
 	if (m_filterWalkableLowHeightSpans)
-		rcFilterWalkableLowHeightSpans(m_ctx, m_cfg.walkableHeight, *m_solid);
+		rcFilterWalkableLowHeightSpans(ctx, build.cfg.walkableHeight, *build.solid);
 	
 	// Compact the heightfield so that it is faster to handle from now on.
 	// This will result more cache coherent data as well as the neighbours
 	// between walkable cells will be calculated.
-	m_chf = rcAllocCompactHeightfield();
-	if (!m_chf)
+	build.chf = rcAllocCompactHeightfield();
+	if (!build.chf)
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'chf'.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'chf'.");
 		return 0;
 	}
-	if (!rcBuildCompactHeightfield(m_ctx, m_cfg.walkableHeight, m_cfg.walkableClimb, *m_solid, *m_chf))
+	if (!rcBuildCompactHeightfield(ctx, build.cfg.walkableHeight, build.cfg.walkableClimb, *build.solid, *build.chf))
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build compact data.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build compact data.");
 		return 0;
 	}
 	
-	if (!m_keepInterResults)
+	if (!keepInterResults)
 	{
-		rcFreeHeightField(m_solid);
-		m_solid = 0;
+		rcFreeHeightField(build.solid);
+		build.solid = 0;
 	}
 
 	// Erode the walkable area by agent radius.
-	if (!rcErodeWalkableArea(m_ctx, m_cfg.walkableRadius, *m_chf))
+	if (!rcErodeWalkableArea(ctx, build.cfg.walkableRadius, *build.chf))
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not erode.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not erode.");
 		return 0;
 	}
 
@@ -1145,13 +1680,13 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 		switch (vol.type)
 		{
 		case VOLUME_BOX:
-			rcMarkBoxArea(m_ctx, &vol.verts[0], &vol.verts[3], vol.flags, vol.area, *m_chf);
+			rcMarkBoxArea(ctx, &vol.verts[0], &vol.verts[3], vol.flags, vol.area, *build.chf);
 			break;
 		case VOLUME_CYLINDER:
-			rcMarkCylinderArea(m_ctx, &vol.verts[0], vol.verts[3], vol.verts[4], vol.flags, vol.area, *m_chf);
+			rcMarkCylinderArea(ctx, &vol.verts[0], vol.verts[3], vol.verts[4], vol.flags, vol.area, *build.chf);
 			break;
 		case VOLUME_CONVEX:
-			rcMarkConvexPolyArea(m_ctx, vol.verts, vol.nverts, vol.hmin, vol.hmax, vol.flags, vol.area, *m_chf);
+			rcMarkConvexPolyArea(ctx, vol.verts, vol.nverts, vol.hmin, vol.hmax, vol.flags, vol.area, *build.chf);
 			break;
 		}
 	}
@@ -1186,16 +1721,16 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 	if (m_partitionType == EDITOR_PARTITION_WATERSHED)
 	{
 		// Prepare for region partitioning, by calculating distance field along the walkable surface.
-		if (!rcBuildDistanceField(m_ctx, *m_chf))
+		if (!rcBuildDistanceField(ctx, *build.chf))
 		{
-			m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build distance field.");
+			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build distance field.");
 			return 0;
 		}
 		
 		// Partition the walkable surface into simple regions without holes.
-		if (!rcBuildRegions(m_ctx, *m_chf, m_cfg.borderSize, m_cfg.minRegionArea, m_cfg.mergeRegionArea))
+		if (!rcBuildRegions(ctx, *build.chf, build.cfg.borderSize, build.cfg.minRegionArea, build.cfg.mergeRegionArea))
 		{
-			m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build watershed regions.");
+			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build watershed regions.");
 			return 0;
 		}
 	}
@@ -1203,103 +1738,103 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 	{
 		// Partition the walkable surface into simple regions without holes.
 		// Monotone partitioning does not need distancefield.
-		if (!rcBuildRegionsMonotone(m_ctx, *m_chf, m_cfg.borderSize, m_cfg.minRegionArea, m_cfg.mergeRegionArea))
+		if (!rcBuildRegionsMonotone(ctx, *build.chf, build.cfg.borderSize, build.cfg.minRegionArea, build.cfg.mergeRegionArea))
 		{
-			m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build monotone regions.");
+			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build monotone regions.");
 			return 0;
 		}
 	}
 	else // EDITOR_PARTITION_LAYERS
 	{
 		// Partition the walkable surface into simple regions without holes.
-		if (!rcBuildLayerRegions(m_ctx, *m_chf, m_cfg.borderSize, m_cfg.minRegionArea))
+		if (!rcBuildLayerRegions(ctx, *build.chf, build.cfg.borderSize, build.cfg.minRegionArea))
 		{
-			m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build layer regions.");
+			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build layer regions.");
 			return 0;
 		}
 	}
 	 	
 	// Create contours.
-	m_cset = rcAllocContourSet();
-	if (!m_cset)
+	build.cset = rcAllocContourSet();
+	if (!build.cset)
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'cset'.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'cset'.");
 		return 0;
 	}
-	if (!rcBuildContours(m_ctx, *m_chf, m_cfg.maxSimplificationError, m_cfg.maxEdgeLen, *m_cset))
+	if (!rcBuildContours(ctx, *build.chf, build.cfg.maxSimplificationError, build.cfg.maxEdgeLen, *build.cset))
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not create contours.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not create contours.");
 		return 0;
 	}
 
-	if (m_cset->nconts == 0)
+	if (build.cset->nconts == 0)
 	{
 		return 0;
 	}
 	
 	// Build polygon navmesh from the contours.
-	m_pmesh = rcAllocPolyMesh();
-	if (!m_pmesh)
+	build.pmesh = rcAllocPolyMesh();
+	if (!build.pmesh)
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'pmesh'.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'pmesh'.");
 		return 0;
 	}
-	if (!rcBuildPolyMesh(m_ctx, *m_cset, m_cfg.maxVertsPerPoly, *m_pmesh))
+	if (!rcBuildPolyMesh(ctx, *build.cset, build.cfg.maxVertsPerPoly, *build.pmesh))
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not triangulate contours.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not triangulate contours.");
 		return 0;
 	}
 	
 	// Build detail mesh.
-	m_dmesh = rcAllocPolyMeshDetail();
-	if (!m_dmesh)
+	build.dmesh = rcAllocPolyMeshDetail();
+	if (!build.dmesh)
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'dmesh'.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'dmesh'.");
 		return 0;
 	}
 	
-	if (!rcBuildPolyMeshDetail(m_ctx, *m_pmesh, *m_chf,
-							   m_cfg.detailSampleDist, m_cfg.detailSampleMaxError,
-							   *m_dmesh))
+	if (!rcBuildPolyMeshDetail(ctx, *build.pmesh, *build.chf,
+							   build.cfg.detailSampleDist, build.cfg.detailSampleMaxError,
+							   *build.dmesh))
 	{
-		m_ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build polymesh detail.");
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build polymesh detail.");
 		return 0;
 	}
 	
-	if (!m_keepInterResults)
+	if (!keepInterResults)
 	{
-		rcFreeCompactHeightfield(m_chf);
-		m_chf = 0;
-		rcFreeContourSet(m_cset);
-		m_cset = 0;
+		rcFreeCompactHeightfield(build.chf);
+		build.chf = 0;
+		rcFreeContourSet(build.cset);
+		build.cset = 0;
 	}
 	
 	unsigned char* navData = 0;
 	int navDataSize = 0;
-	if (m_cfg.maxVertsPerPoly <= RD_VERTS_PER_POLYGON)
+	if (build.cfg.maxVertsPerPoly <= RD_VERTS_PER_POLYGON)
 	{
-		if (m_pmesh->nverts >= 0xffff)
+		if (build.pmesh->nverts >= 0xffff)
 		{
 			// The vertex indices are ushorts, and cannot point to more than 0xffff vertices.
-			m_ctx->log(RC_LOG_ERROR, "Too many vertices per tile %d (max: %d).", m_pmesh->nverts, 0xffff);
+			ctx->log(RC_LOG_ERROR, "Too many vertices per tile %d (max: %d).", build.pmesh->nverts, 0xffff);
 			return 0;
 		}
 		
 		// Update poly flags from areas.
-		for (int i = 0; i < m_pmesh->npolys; ++i)
+		for (int i = 0; i < build.pmesh->npolys; ++i)
 		{
-			if (m_pmesh->areas[i] == RC_WALKABLE_AREA)
-				m_pmesh->areas[i] = DT_POLYAREA_GROUND;
+			if (build.pmesh->areas[i] == RC_WALKABLE_AREA)
+				build.pmesh->areas[i] = DT_POLYAREA_GROUND;
 		
-			if (m_pmesh->areas[i] == DT_POLYAREA_GROUND ||
-				m_pmesh->areas[i] == DT_POLYAREA_TRIGGER)
-				m_pmesh->flags[i] |= DT_POLYFLAGS_WALK;
+			if (build.pmesh->areas[i] == DT_POLYAREA_GROUND ||
+				build.pmesh->areas[i] == DT_POLYAREA_TRIGGER)
+				build.pmesh->flags[i] |= DT_POLYFLAGS_WALK;
 
-			if (m_pmesh->surfa[i] <= RC_POLY_SURFAREA_TOO_SMALL_THRESHOLD)
-				m_pmesh->flags[i] |= DT_POLYFLAGS_TOO_SMALL;
+			if (build.pmesh->surfa[i] <= RC_POLY_SURFAREA_TOO_SMALL_THRESHOLD)
+				build.pmesh->flags[i] |= DT_POLYFLAGS_TOO_SMALL;
 
-			const int nvp = m_pmesh->nvp;
-			const unsigned short* p = &m_pmesh->polys[i*nvp*2];
+			const int nvp = build.pmesh->nvp;
+			const unsigned short* p = &build.pmesh->polys[i*nvp*2];
 
 			// If polygon connects to a polygon on a neighbouring tile, flag it.
 			for (int j = 0; j < nvp; ++j)
@@ -1311,26 +1846,26 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 				if ((p[nvp+j] & 0xf) == 0xf)
 					continue;
 
-				m_pmesh->flags[i] |= DT_POLYFLAGS_HAS_NEIGHBOUR;
+				build.pmesh->flags[i] |= DT_POLYFLAGS_HAS_NEIGHBOUR;
 			}
 		}
 		
 		dtNavMeshCreateParams params;
 		memset(&params, 0, sizeof(params));
-		params.verts = m_pmesh->verts;
-		params.vertCount = m_pmesh->nverts;
-		params.polys = m_pmesh->polys;
-		params.polyFlags = m_pmesh->flags;
-		params.polyAreas = m_pmesh->areas;
-		params.surfAreas = m_pmesh->surfa;
-		params.polyCount = m_pmesh->npolys;
-		params.nvp = m_pmesh->nvp;
+		params.verts = build.pmesh->verts;
+		params.vertCount = build.pmesh->nverts;
+		params.polys = build.pmesh->polys;
+		params.polyFlags = build.pmesh->flags;
+		params.polyAreas = build.pmesh->areas;
+		params.surfAreas = build.pmesh->surfa;
+		params.polyCount = build.pmesh->npolys;
+		params.nvp = build.pmesh->nvp;
 		params.cellResolution = m_polyCellRes;
-		params.detailMeshes = m_dmesh->meshes;
-		params.detailVerts = m_dmesh->verts;
-		params.detailVertsCount = m_dmesh->nverts;
-		params.detailTris = m_dmesh->tris;
-		params.detailTriCount = m_dmesh->ntris;
+		params.detailMeshes = build.dmesh->meshes;
+		params.detailVerts = build.dmesh->verts;
+		params.detailVertsCount = build.dmesh->nverts;
+		params.detailTris = build.dmesh->tris;
+		params.detailTriCount = build.dmesh->ntris;
 		params.offMeshConVerts = m_geom->getOffMeshConnectionVerts();
 		params.offMeshConRefPos = m_geom->getOffMeshConnectionRefPos();
 		params.offMeshConRad = m_geom->getOffMeshConnectionRads();
@@ -1348,42 +1883,72 @@ unsigned char* Editor_TileMesh::buildTileMesh(const int tx, const int ty, const
 		params.tileX = tx;
 		params.tileY = ty;
 		params.tileLayer = 0;
-		rdVcopy(params.bmin, m_pmesh->bmin);
-		rdVcopy(params.bmax, m_pmesh->bmax);
-		params.cs = m_cfg.cs;
-		params.ch = m_cfg.ch;
+		rdVcopy(params.bmin, build.pmesh->bmin);
+		rdVcopy(params.bmax, build.pmesh->bmax);
+		params.cs = build.cfg.cs;
+		params.ch = build.cfg.ch;
 		params.buildBvTree = m_buildBvTree;
 
 		const bool navMeshBuildSuccess = dtCreateNavMeshData(&params, &navData, &navDataSize);
 
 		// Restore poly areas.
-		for (int i = 0; i < m_pmesh->npolys; ++i)
+		for (int i = 0; i < build.pmesh->npolys; ++i)
 		{
 			// The game's poly area (ground) shares the same value as
 			// RC_NULL_AREA, if we try to render the recast polymesh cache
 			// without restoring this, the renderer will draw it as NULL area
 			// even though it's walkable. The other values will get color ID'd
 			// by the renderer so we don't need to check on those.
-			if (m_pmesh->areas[i] == DT_POLYAREA_GROUND)
-				m_pmesh->areas[i] = RC_WALKABLE_AREA;
+			if (build.pmesh->areas[i] == DT_POLYAREA_GROUND)
+				build.pmesh->areas[i] = RC_WALKABLE_AREA;
 		}
 
 		if (!navMeshBuildSuccess)
 		{
-			m_ctx->log(RC_LOG_ERROR, "Could not build Detour navmesh.");
+			ctx->log(RC_LOG_ERROR, "Could not build Detour navmesh.");
 			return 0;
 		}
 	}
-	m_tileMemUsage = navDataSize/1024.0f;
+	build.memUsage = navDataSize/1024.0f;
 	
-	m_ctx->stopTimer(RC_TIMER_TOTAL);
+	ctx->stopTimer(RC_TIMER_TOTAL);
 	
 	// Show performance stats.
-	duLogBuildTimes(*m_ctx, m_ctx->getAccumulatedTime(RC_TIMER_TOTAL));
-	m_ctx->log(RC_LOG_PROGRESS, ">> Polymesh: %d vertices  %d polygons", m_pmesh->nverts, m_pmesh->npolys);
+	duLogBuildTimes(*ctx, ctx->getAccumulatedTime(RC_TIMER_TOTAL));
+	ctx->log(RC_LOG_PROGRESS, ">> Polymesh: %d vertices  %d polygons", build.pmesh->nverts, build.pmesh->npolys);
 	
-	m_tileBuildTime = m_ctx->getAccumulatedTime(RC_TIMER_TOTAL)/1000.0f;
+	build.buildTime = ctx->getAccumulatedTime(RC_TIMER_TOTAL)/1000.0f;
 
 	dataSize = navDataSize;
 	return navData;
 }
+
+unsigned char* Editor_TileMesh::buildTileMesh(rcContext* ctx, TileMeshBuildData& build, const bool keepInterResults,
+	const int tx, const int ty, const float* bmin, const float* bmax, int& dataSize) const
+{
+	if (!m_geom || !m_geom->getMesh() || !m_geom->getChunkyMesh())
+	{
+		ctx->log(RC_LOG_ERROR, "buildNavigation: Input mesh is not specified.");
+		return 0;
+	}
+	
+	const int nverts = m_geom->getMesh()->getVertCount();
+	const int ntris = m_geom->getMesh()->getTriCount();
+
+	initTileConfig(build.cfg, getTileBorderSize(), bmin, bmax);
+
+	// Reset build times gathering.
+	ctx->resetTimers();
+	
+	// Start the build process.
+	ctx->startTimer(RC_TIMER_TOTAL);
+	
+	ctx->log(RC_LOG_PROGRESS, "Building navigation:");
+	ctx->log(RC_LOG_PROGRESS, " - %d x %d cells", build.cfg.width, build.cfg.height);
+	ctx->log(RC_LOG_PROGRESS, " - %.1fK verts, %.1fK tris", nverts/1000.0f, ntris/1000.0f);
+
+	if (!rasterizeTileMesh(ctx, build, keepInterResults))
+		return 0;
+
+	return buildTileMeshFromSolid(ctx, build, keepInterResults, tx, ty, dataSize);
+}
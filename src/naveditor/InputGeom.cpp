@@ -450,7 +450,8 @@ bool InputGeom::saveGeomSet(const BuildSettings* settings)
 }
 
 static const int MAX_CHUNK_INDICES = 0xffff;
-static int s_chunkIndices[MAX_CHUNK_INDICES];
+// Per thread as traverse links of several navmeshes can be built at once.
+static thread_local int s_chunkIndices[MAX_CHUNK_INDICES];
 
 bool InputGeom::raycastMesh(const float* src, const float* dst, const unsigned int mask, int* vidx, float* tmin) const
 {
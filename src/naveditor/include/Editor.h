@@ -109,6 +109,11 @@ enum TraverseType_e // todo(amos): move elsewhere
 	INVALID_TRAVERSE_TYPE = DT_NULL_TRAVERSE_TYPE
 };
 
+// Traverse type parameters and the traverse types supported per anim type,
+// shared by all editors and reset when an editor is constructed.
+extern TraverseType_s s_traverseTable[NUM_TRAVERSE_TYPES];
+extern int s_traverseAnimTraverseFlags[ANIMTYPE_COUNT];
+
 /// Tool types.
 enum EditorToolType
 {
@@ -326,6 +331,7 @@ public:
 	virtual bool handleBuild();
 	virtual void handleUpdate(const float dt);
 	virtual void collectSettings(struct BuildSettings& settings);
+	void copySettings(const Editor& other);
 
 	virtual class InputGeom* getInputGeom() { return m_geom; }
 	virtual class dtNavMesh* getNavMesh() { return m_navMesh; }
@@ -48,6 +48,8 @@ public:
 	int getLogCount() const;
 	/// Returns log message text.
 	const char* getLogText(const rdSizeType i) const;
+	/// Returns log message category.
+	rcLogCategory getLogCategory(const rdSizeType i) const;
 	
 protected:	
 	/// Virtual functions for custom implementations.
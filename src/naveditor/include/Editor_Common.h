@@ -89,6 +89,11 @@ protected:
 	bool m_keepInterResults;
 };
 
+// Computes the tile properties without rendering them, used by headless builds.
+int EditorCommon_SetTileProperties(const InputGeom* const geom,
+	const int minTilebits, const int maxTileBits, const int tileSize,
+	const float cellSize, int& maxTiles, int& maxPolysPerTile);
+
 int EditorCommon_SetAndRenderTileProperties(const InputGeom* const geom, 
 	const int minTilebits, const int maxTileBits, const int tileSize,
 	const float cellSize, int& maxTiles, int& maxPolysPerTile);
@@ -25,6 +25,44 @@
 #include "NavEditor/Include/Editor.h"
 #include "NavEditor/Include/Editor_Common.h"
 
+/// Intermediate results of a single tile build. Each build thread owns
+/// its own instance so tiles can be rasterized concurrently.
+struct TileMeshBuildData
+{
+	TileMeshBuildData();
+	~TileMeshBuildData();
+
+	void cleanup();
+
+	unsigned char* triareas;
+	rcHeightfield* solid;
+	rcCompactHeightfield* chf;
+	rcContourSet* cset;
+	rcPolyMesh* pmesh;
+	rcPolyMeshDetail* dmesh;
+	rcConfig cfg;
+
+	int triCount;
+	float memUsage;
+	double buildTime;
+
+private:
+	// Explicitly disabled copy constructor and copy assignment operator.
+	TileMeshBuildData(const TileMeshBuildData&);
+	TileMeshBuildData& operator=(const TileMeshBuildData&);
+};
+
+/// Result of a tile built by one of the build threads, the tiles are added
+/// to the navmesh once all tiles of the navmesh have been built.
+struct TileMeshBuildResult
+{
+	TileMeshBuildResult() : data(0), dataSize(0) {}
+
+	unsigned char* data;
+	int dataSize;
+	std::vector<std::string> errors;
+};
+
 class Editor_TileMesh : public Editor_StaticTileMeshCommon
 {
 protected:
@@ -37,7 +75,19 @@ protected:
 	float m_tileMemUsage;
 	int m_tileTriCount;
 
+	int m_buildThreadCount; // 0 = use all hardware threads.
+
+	int getTileBorderSize() const;
+	void initTileConfig(rcConfig& cfg, const int borderSize, const float* bmin, const float* bmax) const;
+	bool rasterizeTileMesh(rcContext* ctx, TileMeshBuildData& build, const bool keepInterResults) const;
+
 	unsigned char* buildTileMesh(const int tx, const int ty, const float* bmin, const float* bmax, int& dataSize);
+	unsigned char* buildTileMesh(rcContext* ctx, TileMeshBuildData& build, const bool keepInterResults,
+		const int tx, const int ty, const float* bmin, const float* bmax, int& dataSize) const;
+	unsigned char* buildTileMeshFromSolid(rcContext* ctx, TileMeshBuildData& build, const bool keepInterResults,
+		const int tx, const int ty, int& dataSize) const;
+
+	void addAllTiles(std::vector<TileMeshBuildResult>& results, const int tw, const int th);
 	
 	void saveAll(const char* path, const dtNavMesh* mesh);
 	dtNavMesh* loadAll(const char* path);
@@ -56,13 +106,18 @@ public:
 	virtual void collectSettings(struct BuildSettings& settings);
 	
 	void getTilePos(const float* pos, int& tx, int& ty);
-	void getTileExtents(int tx, int ty, float* bmin, float* bmax);
+	void getTileExtents(int tx, int ty, float* bmin, float* bmax) const;
+
+	inline int getBuildThreadCount() const { return m_buildThreadCount; }
+	inline void setBuildThreadCount(const int count) { m_buildThreadCount = count; }
 
 	void buildTile(const float* pos);
 	void removeTile(const float* pos);
 	void buildAllTiles();
 	void removeAllTiles();
 
+	bool buildHull(const NavMeshType_e navMeshType);
+	bool buildHulls(const unsigned int navMeshTypeMask);
 	void buildAllHulls();
 private:
 	// Explicitly disabled copy constructor and copy assignment operator.
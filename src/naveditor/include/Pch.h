@@ -22,6 +22,10 @@
 #include <unordered_map>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <condition_variable>
 
 // Required for shared SDK code.
 #include <regex>
@@ -0,0 +1,130 @@
+//=============================================================================//
+//
+// Purpose: headless navmesh builder; builds and writes the navmeshes of the
+//          given geometry without creating a window or an ImGui context.
+//
+//=============================================================================//
+#include "Recast/Include/Recast.h"
+#include "NavEditor/Include/PerfTimer.h"
+#include "NavEditor/Include/EditorInterfaces.h"
+#include "NavEditor/Include/InputGeom.h"
+#include "NavEditor/Include/Editor_TileMesh.h"
+
+#include "game/server/ai_navmesh.h"
+
+static void print_usage(const char* exeName)
+{
+	printf("Usage: %s <geometry.obj|.ply|.gset> [options]\n", exeName);
+	printf("Options:\n");
+	printf("  -hull <name>       build this hull only, can be repeated (default: all hulls)\n");
+	printf("  -threads <count>   number of build threads (default: all hardware threads)\n");
+	printf("Hulls:\n");
+
+	for (int i = 0; i < NAVMESH_COUNT; i++)
+		printf("  %s\n", NavMesh_GetNameForType(NavMeshType_e(i)));
+}
+
+static bool get_navmesh_type_for_name(const char* name, NavMeshType_e& navMeshType)
+{
+	for (int i = 0; i < NAVMESH_COUNT; i++)
+	{
+		if (strcmp(name, NavMesh_GetNameForType(NavMeshType_e(i))) == 0)
+		{
+			navMeshType = NavMeshType_e(i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void get_model_name(const std::string& path, std::string& modelName)
+{
+	const size_t slashPos = path.find_last_of("\\/");
+	modelName = slashPos == std::string::npos
+		? path
+		: path.substr(slashPos + 1);
+
+	const size_t dotPos = modelName.find_last_of('.');
+	if (dotPos != std::string::npos)
+		modelName.resize(dotPos);
+}
+
+int main(int argc, char** argv)
+{
+	const char* geomPath = nullptr;
+	bool buildHull[NAVMESH_COUNT] = {};
+	bool buildAll = true;
+	int threadCount = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-hull") == 0 && i+1 < argc)
+		{
+			NavMeshType_e navMeshType;
+			if (!get_navmesh_type_for_name(argv[++i], navMeshType))
+			{
+				printf("Unknown hull '%s'.\n", argv[i]);
+				print_usage(argv[0]);
+
+				return EXIT_FAILURE;
+			}
+
+			buildHull[navMeshType] = true;
+			buildAll = false;
+		}
+		else if (strcmp(argv[i], "-threads") == 0 && i+1 < argc)
+		{
+			threadCount = atoi(argv[++i]);
+		}
+		else if (argv[i][0] != '-' && !geomPath)
+		{
+			geomPath = argv[i];
+		}
+		else
+		{
+			printf("Unknown argument '%s'.\n", argv[i]);
+			print_usage(argv[0]);
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (!geomPath)
+	{
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	BuildContext ctx;
+	InputGeom geom;
+
+	if (!geom.load(&ctx, geomPath))
+	{
+		ctx.dumpLog("Geom load log %s:", geomPath);
+		return EXIT_FAILURE;
+	}
+
+	Editor_TileMesh editor;
+	editor.setContext(&ctx);
+	editor.handleMeshChanged(&geom);
+	editor.setBuildThreadCount(threadCount);
+
+	get_model_name(geomPath, editor.m_modelName);
+
+	unsigned int navMeshTypeMask = 0;
+
+	for (int i = 0; i < NAVMESH_COUNT; i++)
+	{
+		if (buildAll || buildHull[i])
+			navMeshTypeMask |= 1<<i;
+	}
+
+	// The hulls are built in parallel, each navmesh is written and its build
+	// log is printed as soon as it's done.
+	const rdTimeType totalStartTime = getPerfTime();
+	const bool result = editor.buildHulls(navMeshTypeMask);
+
+	printf("Total build time: %.2fms\n", getPerfTimeUsec(getPerfTime() - totalStartTime) / 1000.0f);
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
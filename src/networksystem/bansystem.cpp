@@ -6,6 +6,8 @@
 //=====================================================================================//
 
 #include "core/stdafx.h"
+#include "tier0/binstream.h"
+#include "tier1/cvar.h"
 #include "tier1/strtools.h"
 #include "tier2/jsonutils.h"
 #include "engine/net.h"
@@ -16,16 +18,374 @@
 #include "game/server/gameinterface.h"
 
 //-----------------------------------------------------------------------------
-// Purpose: loads and parses the banned list
+// Banned list files, all of which live in the PLATFORM path
 //-----------------------------------------------------------------------------
-void CBanSystem::LoadList(void)
+#define BANLIST_SNAPSHOT_FILE     "banlist.bin"
+#define BANLIST_SNAPSHOT_TMP_FILE "banlist.bin.tmp"
+#define BANLIST_JOURNAL_FILE      "banlist.journal"
+#define BANLIST_JOURNAL_OLD_FILE  "banlist.journal.old" // Journal that is being compacted.
+#define BANLIST_LEGACY_FILE       "banlist.json"
+
+static ConVar sv_banlistJournalMaxRecords("sv_banlistJournalMaxRecords", "1024", FCVAR_RELEASE, "Number of banned list journal records after which the journal is compacted into a new snapshot.", true, 1.f, false, 0.f);
+
+//-----------------------------------------------------------------------------
+// Purpose: hashes a banned address
+//-----------------------------------------------------------------------------
+size_t CBanSystem::BannedAddress_t::Hasher_t::operator()(const BannedAddress_t& address) const
 {
-	if (IsBanListValid())
-		m_BannedList.Purge();
+	uint64_t parts[2];
+	memcpy(parts, &address.m_Address, sizeof(parts));
+
+	return size_t((parts[0] * 0x9E3779B97F4A7C15ull) ^ parts[1] ^ (uint64_t(address.m_nPrefixLen) << 56));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: hashes a banned entry key
+//-----------------------------------------------------------------------------
+size_t CBanSystem::BannedKey_t::Hasher_t::operator()(const BannedKey_t& key) const
+{
+	return BannedAddress_t::Hasher_t()(key.m_Address) ^ size_t(key.m_NucleusID * 0xC2B2AE3D27D4EB4Full);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: clears all bits past the prefix length of the address
+// Input  : &address  - 
+//			nPrefixLen - 
+//-----------------------------------------------------------------------------
+static void BanSystem_MaskAddress(IN6_ADDR& address, const int nPrefixLen)
+{
+	uint8_t* const pBytes = reinterpret_cast<uint8_t*>(&address);
+
+	for (int i = 0; i < int(sizeof(IN6_ADDR)); i++)
+	{
+		const int nBits = nPrefixLen - (i * 8);
+
+		if (nBits >= 8)
+			continue;
+
+		pBytes[i] &= nBits > 0 ? uint8_t(0xFF << (8 - nBits)) : 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: renders a binary address into its textual form, IPv4 addresses
+//          and ranges are rendered in dotted notation
+// Input  : &address - 
+//			*pBuffer - 
+//			nBufSize - 
+//-----------------------------------------------------------------------------
+static void BanSystem_FormatAddress(const CBanSystem::BannedAddress_t& address, char* const pBuffer, const size_t nBufSize)
+{
+	char szAddress[INET6_ADDRSTRLEN];
+	int nPrefixLen = address.m_nPrefixLen;
+
+	if (IN6_IS_ADDR_V4MAPPED(&address.m_Address) && nPrefixLen >= 96)
+	{
+		inet_ntop(AF_INET, &address.m_Address.s6_addr[12], szAddress, sizeof(szAddress));
+
+		if (nPrefixLen == 128)
+			nPrefixLen = 32; // Exact address.
+		else
+			nPrefixLen -= 96;
+
+		if (nPrefixLen == 32)
+		{
+			V_strncpy(pBuffer, szAddress, nBufSize);
+			return;
+		}
+	}
+	else
+	{
+		inet_ntop(AF_INET6, &address.m_Address, szAddress, sizeof(szAddress));
+
+		if (nPrefixLen == 128)
+		{
+			V_strncpy(pBuffer, szAddress, nBufSize);
+			return;
+		}
+	}
+
+	V_snprintf(pBuffer, nBufSize, "%s/%d", szAddress, nPrefixLen);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: converts an on-disk entry into a banned entry
+// Input  : &entry  - 
+//			&banned - 
+// Output : true on success, false if the entry is invalid
+//-----------------------------------------------------------------------------
+static bool BanSystem_EntryToBanned(const BanListEntry_s& entry, CBanSystem::Banned_t& banned)
+{
+	if (entry.prefixLen > 128)
+		return false;
+
+	CBanSystem::BannedAddress_t& address = banned.m_BinaryAddress;
+
+	memcpy(&address.m_Address, entry.address, sizeof(address.m_Address));
+	address.m_nPrefixLen = entry.prefixLen;
+
+	BanSystem_MaskAddress(address.m_Address, address.m_nPrefixLen);
+
+	char szAddress[128];
+	BanSystem_FormatAddress(address, szAddress, sizeof(szAddress));
+
+	banned.m_Address = szAddress;
+	banned.m_NucleusID = entry.nucleusId;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: converts a banned entry into its on-disk form
+// Input  : &banned - 
+//			&entry  - 
+//-----------------------------------------------------------------------------
+static void BanSystem_BannedToEntry(const CBanSystem::Banned_t& banned, BanListEntry_s& entry)
+{
+	entry.nucleusId = banned.m_NucleusID;
+	memcpy(entry.address, &banned.m_BinaryAddress.m_Address, sizeof(entry.address));
+	entry.prefixLen = uint8_t(banned.m_BinaryAddress.m_nPrefixLen);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: constructor
+//-----------------------------------------------------------------------------
+CBanSystem::CBanSystem(void)
+	: m_nJournalRecords(0)
+	, m_bCompacting(false)
+	, m_nSnapshotSerial(0)
+	, m_nWrittenSerial(0)
+{
+	ClearIndex();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: waits for a running journal compaction to finish writing its
+//          snapshot
+//-----------------------------------------------------------------------------
+void CBanSystem::Shutdown(void)
+{
+	if (m_CompactThread.joinable())
+		m_CompactThread.join();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: parses an ip address, or an address range in CIDR notation, into
+//          its normalized binary form
+// Input  : *ipAddress - 
+//			&address   - 
+// Output : true on success, false if the address is invalid
+//-----------------------------------------------------------------------------
+bool CBanSystem::ParseAddress(const char* ipAddress, BannedAddress_t& address)
+{
+	char szAddress[128];
+	V_strncpy(szAddress, ipAddress, sizeof(szAddress));
+
+	int nPrefixLen = 128;
+	char* const pSlash = strchr(szAddress, '/');
+
+	if (pSlash)
+	{
+		*pSlash = '\0';
+		const char* const pPrefixLen = &pSlash[1];
+
+		if (!*pPrefixLen || !V_IsAllDigit(pPrefixLen))
+			return false;
+
+		nPrefixLen = atoi(pPrefixLen);
+
+		// IPv4 addresses are mapped to IPv6, so the prefix is as well.
+		if (!strchr(szAddress, ':'))
+		{
+			if (nPrefixLen > 32)
+				return false;
+
+			nPrefixLen += 96;
+		}
+		else if (nPrefixLen > 128)
+			return false;
+	}
+
+	CNetAdr netAdr;
+
+	if (!netAdr.SetFromString(szAddress))
+		return false;
+
+	address.m_Address = netAdr.GetIP();
+	address.m_nPrefixLen = nPrefixLen;
+
+	BanSystem_MaskAddress(address.m_Address, nPrefixLen);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: inserts a banned entry into the list and the lookup tables
+// Input  : &banned - 
+// Output : true on success, false if the entry is already in the list
+//-----------------------------------------------------------------------------
+bool CBanSystem::InsertEntry(const Banned_t& banned)
+{
+	const BannedKey_t key{ banned.m_BinaryAddress, banned.m_NucleusID };
+
+	if (m_EntryIndex.find(key) != m_EntryIndex.end())
+		return false;
+
+	AddToIndex(banned, m_BannedList.AddToTail(banned));
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: removes a banned entry from the list and the lookup tables, the
+//          last entry in the list takes its place
+// Input  : index - 
+//-----------------------------------------------------------------------------
+void CBanSystem::RemoveEntry(const int index)
+{
+	RemoveFromIndex(m_BannedList[index]);
+	m_BannedList.FastRemove(index);
+
+	if (index < m_BannedList.Count())
+	{
+		const Banned_t& moved = m_BannedList[index];
+		m_EntryIndex[BannedKey_t{ moved.m_BinaryAddress, moved.m_NucleusID }] = index;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: adds a banned entry to the lookup tables
+// Input  : &banned - 
+//			index   - the position of the entry in the list
+//-----------------------------------------------------------------------------
+void CBanSystem::AddToIndex(const Banned_t& banned, const int index)
+{
+	const BannedAddress_t& address = banned.m_BinaryAddress;
+	m_EntryIndex[BannedKey_t{ address, banned.m_NucleusID }] = index;
+
+	if (banned.m_NucleusID != NULL)
+		m_NucleusIDIndex[banned.m_NucleusID]++;
+
+	// Exact address bans require a nucleus id, address ranges can be banned
+	// on their own.
+	if (banned.m_NucleusID != NULL || address.m_nPrefixLen < 128)
+	{
+		m_AddressIndex[address]++;
+		m_PrefixLenCount[address.m_nPrefixLen]++;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: removes a banned entry from the lookup tables
+// Input  : &banned - 
+//-----------------------------------------------------------------------------
+void CBanSystem::RemoveFromIndex(const Banned_t& banned)
+{
+	const BannedAddress_t& address = banned.m_BinaryAddress;
+
+	const auto decrement = [](auto& index, const auto& key)
+	{
+		const auto it = index.find(key);
+
+		if (it != index.end() && --it->second <= 0)
+			index.erase(it);
+	};
+
+	m_EntryIndex.erase(BannedKey_t{ address, banned.m_NucleusID });
+
+	if (banned.m_NucleusID != NULL)
+		decrement(m_NucleusIDIndex, banned.m_NucleusID);
+
+	if (banned.m_NucleusID != NULL || address.m_nPrefixLen < 128)
+	{
+		decrement(m_AddressIndex, address);
+		m_PrefixLenCount[address.m_nPrefixLen]--;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: clears the lookup tables
+//-----------------------------------------------------------------------------
+void CBanSystem::ClearIndex(void)
+{
+	m_NucleusIDIndex.clear();
+	m_AddressIndex.clear();
+	m_EntryIndex.clear();
+
+	memset(m_PrefixLenCount, 0, sizeof(m_PrefixLenCount));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the banned list snapshot by mapping it into memory
+// Input  : *fileName - 
+// Output : true on success, false if the snapshot is missing or invalid
+//-----------------------------------------------------------------------------
+bool CBanSystem::LoadSnapshot(const char* fileName)
+{
+	char szFullPath[MAX_PATH];
+
+	if (!FileSystem()->RelativePathToFullPath(fileName, "PLATFORM", szFullPath, sizeof(szFullPath)))
+		return false;
+
+	CMappedFile snapshotMap;
+
+	if (!snapshotMap.Open(szFullPath))
+		return false;
+
+	const size_t nSize = snapshotMap.GetSize();
+
+	if (nSize < sizeof(BanListHeader_s))
+	{
+		Warning(eDLL_T::SERVER, "%s: snapshot '%s' is truncated\n", __FUNCTION__, fileName);
+		return false;
+	}
+
+	const BanListHeader_s* const pHeader = reinterpret_cast<const BanListHeader_s*>(snapshotMap.GetData());
+
+	if (pHeader->magic != BANLIST_SNAPSHOT_MAGIC || pHeader->version != BANLIST_FILE_VERSION)
+	{
+		Warning(eDLL_T::SERVER, "%s: snapshot '%s' has an invalid header (magic=%x, version=%hu)\n",
+			__FUNCTION__, fileName, pHeader->magic, pHeader->version);
+		return false;
+	}
+
+	// Validate the size before touching the list, a partially written
+	// snapshot must not be loaded at all.
+	if ((nSize - sizeof(BanListHeader_s)) / sizeof(BanListEntry_s) < pHeader->entryCount)
+	{
+		Warning(eDLL_T::SERVER, "%s: snapshot '%s' is truncated\n", __FUNCTION__, fileName);
+		return false;
+	}
+
+	const BanListEntry_s* const pEntries = reinterpret_cast<const BanListEntry_s*>(&pHeader[1]);
+
+	m_BannedList.EnsureCapacity(pHeader->entryCount);
+	m_EntryIndex.reserve(pHeader->entryCount);
+
+	for (uint32_t i = 0; i < pHeader->entryCount; i++)
+	{
+		Banned_t banned;
+
+		if (!BanSystem_EntryToBanned(pEntries[i], banned))
+		{
+			Warning(eDLL_T::SERVER, "%s: entry '%u' has an invalid prefix length '%hhu'; ignored\n",
+				__FUNCTION__, i, pEntries[i].prefixLen);
+			continue;
+		}
+
+		InsertEntry(banned);
+	}
 
-	FileHandle_t pFile = FileSystem()->Open("banlist.json", "rt", "PLATFORM");
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads and parses the banned list from the legacy JSON format
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CBanSystem::LoadLegacyList(void)
+{
+	FileHandle_t pFile = FileSystem()->Open(BANLIST_LEGACY_FILE, "rt", "PLATFORM");
 	if (!pFile)
-		return;
+		return false;
 
 	const ssize_t nLen = FileSystem()->Size(pFile);
 	std::unique_ptr<char[]> pBuf(new char[nLen + 1]);
@@ -40,20 +400,20 @@ void CBanSystem::LoadList(void)
 	{
 		Warning(eDLL_T::SERVER, "%s: JSON parse error at position %zu: %s\n",
 			__FUNCTION__, document.GetErrorOffset(), rapidjson::GetParseError_En(document.GetParseError()));
-		return;
+		return false;
 	}
 
 	if (!document.IsObject())
 	{
 		Warning(eDLL_T::SERVER, "%s: JSON root was not an object\n", __FUNCTION__);
-		return;
+		return false;
 	}
 
 	int nTotalBans = 0;
 
 	if (!JSON_GetValue(document, "totalBans", nTotalBans))
 	{
-		return;
+		return false;
 	}
 
 	for (int i = 0; i < nTotalBans; i++)
@@ -72,54 +432,306 @@ void CBanSystem::LoadList(void)
 			if (JSON_GetValue(entry, "ipAddress", ipAddress) && 
 				JSON_GetValue(entry, "nucleusId", nucleusId))
 			{
-				Banned_t banned;
-
-				banned.m_Address = ipAddress;
-				banned.m_NucleusID = nucleusId;
-
-				m_BannedList.AddToTail(banned);
+				Banned_t banned(ipAddress, nucleusId);
+
+				if (ParseAddress(ipAddress, banned.m_BinaryAddress))
+				{
+					InsertEntry(banned);
+				}
+				else
+				{
+					Warning(eDLL_T::SERVER, "%s: entry '%s' has an invalid ip address '%s'; ignored\n",
+						__FUNCTION__, idx, ipAddress);
+				}
 			}
 		}
 	}
+
+	return true;
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: saves the banned list
+// Purpose: applies the records of a journal on top of the banned list; adds
+//          of existing entries and deletes of missing entries are no-ops, so
+//          replaying a journal that was already compacted is harmless
+// Input  : *fileName - 
+// Output : number of records applied, -1 if the journal doesn't exist
 //-----------------------------------------------------------------------------
-void CBanSystem::SaveList(void) const
+int CBanSystem::ReplayJournal(const char* fileName)
 {
-	FileHandle_t pFile = FileSystem()->Open("banlist.json", "wt", "PLATFORM");
+	FileHandle_t pFile = FileSystem()->Open(fileName, "rb", "PLATFORM");
 	if (!pFile)
+		return -1;
+
+	const ssize_t nLen = FileSystem()->Size(pFile);
+	std::unique_ptr<uint8_t[]> pBuf(new uint8_t[nLen]);
+
+	const ssize_t nRead = FileSystem()->Read(pBuf.get(), nLen, pFile);
+	FileSystem()->Close(pFile);
+
+	if (nRead < ssize_t(sizeof(BanListHeader_s)))
+		return 0; // Crashed before the header was written.
+
+	const BanListHeader_s* const pHeader = reinterpret_cast<const BanListHeader_s*>(pBuf.get());
+
+	if (pHeader->magic != BANLIST_JOURNAL_MAGIC || pHeader->version != BANLIST_FILE_VERSION)
 	{
-		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, "banlist.json");
-		return;
+		Warning(eDLL_T::SERVER, "%s: journal '%s' has an invalid header (magic=%x, version=%hu)\n",
+			__FUNCTION__, fileName, pHeader->magic, pHeader->version);
+		return 0;
 	}
 
-	rapidjson::Document document;
-	document.SetObject();
+	// A record that was cut off by a crash is dropped.
+	const int nRecords = int((nRead - sizeof(BanListHeader_s)) / sizeof(BanListJournalRecord_s));
+	const BanListJournalRecord_s* const pRecords = reinterpret_cast<const BanListJournalRecord_s*>(&pHeader[1]);
+
+	for (int i = 0; i < nRecords; i++)
+	{
+		const BanListJournalRecord_s& record = pRecords[i];
+		Banned_t banned;
+
+		if (!BanSystem_EntryToBanned(record.entry, banned))
+		{
+			Warning(eDLL_T::SERVER, "%s: record '%d' has an invalid prefix length '%hhu'; ignored\n",
+				__FUNCTION__, i, record.entry.prefixLen);
+			continue;
+		}
+
+		switch (record.op)
+		{
+		case BANLIST_JOURNAL_ADD:
+		{
+			InsertEntry(banned);
+			break;
+		}
+		case BANLIST_JOURNAL_DELETE:
+		{
+			const auto it = m_EntryIndex.find(BannedKey_t{ banned.m_BinaryAddress, banned.m_NucleusID });
+
+			if (it != m_EntryIndex.end())
+				RemoveEntry(it->second);
+
+			break;
+		}
+		default:
+		{
+			Warning(eDLL_T::SERVER, "%s: record '%d' has an invalid operation '%hhu'; ignored\n",
+				__FUNCTION__, i, record.op);
+		}
+		}
+	}
 
-	rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+	return nRecords;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the banned list snapshot and applies the journal on top
+//-----------------------------------------------------------------------------
+void CBanSystem::LoadList(void)
+{
+	bool bCompact = false;
+
+	{
+		// Don't read the files while a compaction is swapping them.
+		std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+
+		if (IsBanListValid())
+			m_BannedList.Purge();
+
+		ClearIndex();
+
+		// The temporary snapshot is only left behind on its own if we went
+		// down between removing the old snapshot and renaming the new one.
+		if (!LoadSnapshot(BANLIST_SNAPSHOT_FILE) &&
+			!LoadSnapshot(BANLIST_SNAPSHOT_TMP_FILE))
+		{
+			// Convert the banned list from the old format on first load.
+			bCompact = LoadLegacyList();
+		}
+
+		// Left behind if we went down during a compaction.
+		if (ReplayJournal(BANLIST_JOURNAL_OLD_FILE) != -1)
+			bCompact = true;
+
+		m_nJournalRecords = Max(ReplayJournal(BANLIST_JOURNAL_FILE), 0);
+	}
+
+	if (bCompact)
+		SaveList();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: copies the banned list into its on-disk form
+// Input  : &entries - 
+//-----------------------------------------------------------------------------
+void CBanSystem::BuildSnapshot(std::vector<BanListEntry_s>& entries) const
+{
+	entries.resize(m_BannedList.Count());
 
 	FOR_EACH_VEC(m_BannedList, i)
 	{
-		const Banned_t& banned = m_BannedList[i];
-		char idx[12]; itoa(i, idx, 10);
+		BanSystem_BannedToEntry(m_BannedList[i], entries[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes the banned list snapshot, the caller must hold the snapshot
+//          mutex
+// Input  : &entries - 
+//			serial   - the serial of the snapshot, older snapshots than the
+//			           one on disk are dropped
+// Output : true if the snapshot on disk is at least as new as this one
+//-----------------------------------------------------------------------------
+bool CBanSystem::WriteSnapshot(const std::vector<BanListEntry_s>& entries, const int serial)
+{
+	if (serial <= m_nWrittenSerial)
+		return true;
+
+	FileHandle_t pFile = FileSystem()->Open(BANLIST_SNAPSHOT_TMP_FILE, "wb", "PLATFORM");
+	if (!pFile)
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, BANLIST_SNAPSHOT_TMP_FILE);
+		return false;
+	}
+
+	BanListHeader_s header;
+
+	header.magic = BANLIST_SNAPSHOT_MAGIC;
+	header.version = BANLIST_FILE_VERSION;
+	header.reserved = 0;
+	header.entryCount = uint32_t(entries.size());
+
+	const ssize_t nEntriesSize = ssize_t(entries.size() * sizeof(BanListEntry_s));
+
+	const bool bWritten = FileSystem()->Write(&header, sizeof(header), pFile) == sizeof(header)
+		&& FileSystem()->Write(entries.data(), nEntriesSize, pFile) == nEntriesSize;
+
+	FileSystem()->Close(pFile);
+
+	if (!bWritten)
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (disk full?)\n", __FUNCTION__, BANLIST_SNAPSHOT_TMP_FILE);
+		FileSystem()->RemoveFile(BANLIST_SNAPSHOT_TMP_FILE, "PLATFORM");
+
+		return false;
+	}
+
+	FileSystem()->RemoveFile(BANLIST_SNAPSHOT_FILE, "PLATFORM");
+
+	if (!FileSystem()->RenameFile(BANLIST_SNAPSHOT_TMP_FILE, BANLIST_SNAPSHOT_FILE, "PLATFORM"))
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to rename '%s' to '%s'\n", __FUNCTION__,
+			BANLIST_SNAPSHOT_TMP_FILE, BANLIST_SNAPSHOT_FILE);
+		return false;
+	}
+
+	m_nWrittenSerial = serial;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes a snapshot of the banned list and discards the journal
+//-----------------------------------------------------------------------------
+void CBanSystem::SaveList(void)
+{
+	std::vector<BanListEntry_s> entries;
+	BuildSnapshot(entries);
+
+	// Waits for a compaction that is in progress, its snapshot is older than
+	// this one and is dropped if it didn't make it to disk yet.
+	std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+
+	if (!WriteSnapshot(entries, ++m_nSnapshotSerial))
+		return;
+
+	FileSystem()->RemoveFile(BANLIST_JOURNAL_OLD_FILE, "PLATFORM");
+	FileSystem()->RemoveFile(BANLIST_JOURNAL_FILE, "PLATFORM");
+
+	m_nJournalRecords = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: appends a record to the banned list journal, and compacts the
+//          journal once it grew too large
+// Input  : op      - 
+//			&banned - 
+//-----------------------------------------------------------------------------
+void CBanSystem::AppendJournal(const uint8_t op, const Banned_t& banned)
+{
+	FileHandle_t pFile = FileSystem()->Open(BANLIST_JOURNAL_FILE, "ab", "PLATFORM");
+	if (!pFile)
+	{
+		Error(eDLL_T::SERVER, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, BANLIST_JOURNAL_FILE);
+		return;
+	}
 
-		rapidjson::Value obj(rapidjson::kObjectType);
+	if (FileSystem()->Size(pFile) == 0)
+	{
+		BanListHeader_s header;
 
-		obj.AddMember("ipAddress", rapidjson::Value(banned.m_Address.String(), allocator), allocator);
-		obj.AddMember("nucleusId", banned.m_NucleusID, allocator);
+		header.magic = BANLIST_JOURNAL_MAGIC;
+		header.version = BANLIST_FILE_VERSION;
+		header.reserved = 0;
+		header.entryCount = 0;
 
-		document.AddMember(rapidjson::Value(idx, allocator), obj, allocator);
+		FileSystem()->Write(&header, sizeof(header), pFile);
 	}
 
-	document.AddMember("totalBans", m_BannedList.Count(), allocator);
+	BanListJournalRecord_s record;
 
-	rapidjson::StringBuffer buffer;
-	JSON_DocumentToBufferDeserialize(document, buffer);
+	record.op = op;
+	BanSystem_BannedToEntry(banned, record.entry);
 
-	FileSystem()->Write(buffer.GetString(), buffer.GetSize(), pFile);
+	FileSystem()->Write(&record, sizeof(record), pFile);
 	FileSystem()->Close(pFile);
+
+	if (++m_nJournalRecords >= sv_banlistJournalMaxRecords.GetInt())
+		CompactJournal();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: compacts the banned list journal into a new snapshot on a separate
+//          thread; new records go to a fresh journal in the meantime
+//-----------------------------------------------------------------------------
+void CBanSystem::CompactJournal(void)
+{
+	if (m_bCompacting.exchange(true))
+		return; // Still running, the records are picked up by the next one.
+
+	// A journal that is left over from a compaction that failed can't be
+	// replaced, so write the snapshot here and discard both journals.
+	if (FileSystem()->FileExists(BANLIST_JOURNAL_OLD_FILE, "PLATFORM") ||
+		!FileSystem()->RenameFile(BANLIST_JOURNAL_FILE, BANLIST_JOURNAL_OLD_FILE, "PLATFORM"))
+	{
+		m_bCompacting = false;
+		SaveList();
+
+		return;
+	}
+
+	std::vector<BanListEntry_s> entries;
+	BuildSnapshot(entries);
+
+	const int serial = ++m_nSnapshotSerial;
+	m_nJournalRecords = 0;
+
+	// The previous compaction is done, but its thread still has to be joined.
+	if (m_CompactThread.joinable())
+		m_CompactThread.join();
+
+	m_CompactThread = std::thread([this, serial](std::vector<BanListEntry_s> snapshot)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+
+			// Keep the old journal if the snapshot couldn't be written, it is
+			// replayed on the next load.
+			if (WriteSnapshot(snapshot, serial))
+				FileSystem()->RemoveFile(BANLIST_JOURNAL_OLD_FILE, "PLATFORM");
+		}
+
+		m_bCompacting = false;
+	}, std::move(entries));
 }
 
 //-----------------------------------------------------------------------------
@@ -130,23 +742,26 @@ void CBanSystem::SaveList(void) const
 bool CBanSystem::AddEntry(const char* ipAddress, const NucleusID_t nucleusId)
 {
 	Assert(VALID_CHARSTAR(ipAddress));
-	const Banned_t banned(ipAddress, nucleusId);
+	Banned_t banned;
 
-	if (IsBanListValid())
-	{
-		if (m_BannedList.Find(banned) == m_BannedList.InvalidIndex())
-		{
-			m_BannedList.AddToTail(banned);
-			return true;
-		}
-	}
-	else
+	if (!ParseAddress(ipAddress, banned.m_BinaryAddress))
 	{
-		m_BannedList.AddToTail(banned);
-		return true;
+		Warning(eDLL_T::SERVER, "%s: invalid ip address '%s'\n", __FUNCTION__, ipAddress);
+		return false;
 	}
 
-	return false;
+	// Store the address the way it is loaded back from the snapshot.
+	char szAddress[128];
+	BanSystem_FormatAddress(banned.m_BinaryAddress, szAddress, sizeof(szAddress));
+
+	banned.m_Address = szAddress;
+	banned.m_NucleusID = nucleusId;
+
+	if (!InsertEntry(banned))
+		return false;
+
+	AppendJournal(BANLIST_JOURNAL_ADD, banned);
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -160,14 +775,21 @@ bool CBanSystem::DeleteEntry(const char* ipAddress, const NucleusID_t nucleusId)
 
 	if (IsBanListValid())
 	{
+		BannedAddress_t address;
+		const bool bValidAddress = ParseAddress(ipAddress, address);
+
 		FOR_EACH_VEC(m_BannedList, i)
 		{
 			const Banned_t& banned = m_BannedList[i];
 
-			if (banned.m_NucleusID == nucleusId ||
-				banned.m_Address.IsEqual_CaseInsensitive(ipAddress))
+			if ((nucleusId != NULL && banned.m_NucleusID == nucleusId) ||
+				banned.m_Address.IsEqual_CaseInsensitive(ipAddress) ||
+				(bValidAddress && banned.m_BinaryAddress == address))
 			{
-				m_BannedList.Remove(i);
+				const Banned_t deleted = banned;
+				RemoveEntry(i);
+
+				AppendJournal(BANLIST_JOURNAL_DELETE, deleted);
 				return true;
 			}
 		}
@@ -184,22 +806,30 @@ bool CBanSystem::DeleteEntry(const char* ipAddress, const NucleusID_t nucleusId)
 //-----------------------------------------------------------------------------
 bool CBanSystem::IsBanned(const char* ipAddress, const NucleusID_t nucleusId) const
 {
-	FOR_EACH_VEC(m_BannedList, i)
-	{
-		const Banned_t& banned = m_BannedList[i];
+	if (nucleusId != NULL && m_NucleusIDIndex.find(nucleusId) != m_NucleusIDIndex.end())
+		return true;
 
-		if (banned.m_NucleusID == NULL ||
-			banned.m_Address.IsEmpty())
-		{
-			// Cannot be NULL.
+	BannedAddress_t address;
+
+	if (!ParseAddress(ipAddress, address))
+		return false;
+
+	const IN6_ADDR fullAddress = address.m_Address;
+
+	// Check the exact address first, followed by all address ranges that
+	// are in use, from narrowest to widest.
+	for (int i = 128; i >= 0; i--)
+	{
+		if (!m_PrefixLenCount[i])
 			continue;
-		}
 
-		if (banned.m_NucleusID == nucleusId ||
-			banned.m_Address.IsEqual_CaseInsensitive(ipAddress))
-		{
+		address.m_Address = fullAddress;
+		address.m_nPrefixLen = i;
+
+		BanSystem_MaskAddress(address.m_Address, i);
+
+		if (m_AddressIndex.find(address) != m_AddressIndex.end())
 			return true;
-		}
 	}
 
 	return false;
@@ -271,7 +901,7 @@ void CBanSystem::BanPlayerById(const char* playerHandle, const char* reason)
 //-----------------------------------------------------------------------------
 void CBanSystem::UnbanPlayer(const char* criteria)
 {
-	bool bSave = false;
+	bool bModified = false;
 	if (V_IsAllDigit(criteria)) // Check if we have an ip address or nucleus id.
 	{
 		char* pEnd = nullptr;
@@ -279,20 +909,19 @@ void CBanSystem::UnbanPlayer(const char* criteria)
 
 		if (DeleteEntry("-<[InVaLiD]>-", nTargetID)) // Delete ban entry.
 		{
-			bSave = true;
+			bModified = true;
 		}
 	}
 	else
 	{
 		if (DeleteEntry(criteria, 0)) // Delete ban entry.
 		{
-			bSave = true;
+			bModified = true;
 		}
 	}
 
-	if (bSave)
+	if (bModified)
 	{
-		SaveList(); // Save modified vector to file.
 		Msg(eDLL_T::SERVER, "Removed '%s' from banned list\n", criteria);
 	}
 }
@@ -307,7 +936,7 @@ void CBanSystem::AuthorPlayerByName(const char* playerName, const bool shouldBan
 {
 	Assert(VALID_CHARSTAR(playerName));
 	bool bDisconnect = false;
-	bool bSave = false;
+	bool bModified = false;
 
 	if (!reason)
 		reason = shouldBan ? "Banned from server" : "Kicked from server";
@@ -324,8 +953,8 @@ void CBanSystem::AuthorPlayerByName(const char* playerName, const bool shouldBan
 		{
 			if (strcmp(playerName, pNetChan->GetName()) == NULL) // Our wanted name?
 			{
-				if (shouldBan && AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bSave)
-					bSave = true;
+				if (shouldBan && AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bModified)
+					bModified = true;
 
 				pClient->Disconnect(REP_MARK_BAD, reason);
 				bDisconnect = true;
@@ -333,9 +962,8 @@ void CBanSystem::AuthorPlayerByName(const char* playerName, const bool shouldBan
 		}
 	}
 
-	if (bSave)
+	if (bModified)
 	{
-		SaveList();
 		Msg(eDLL_T::SERVER, "Added '%s' to banned list\n", playerName);
 	}
 	else if (bDisconnect)
@@ -356,7 +984,7 @@ void CBanSystem::AuthorPlayerById(const char* playerHandle, const bool shouldBan
 
 	bool bOnlyDigits = V_IsAllDigit(playerHandle);
 	bool bDisconnect = false;
-	bool bSave = false;
+	bool bModified = false;
 
 	if (!reason)
 		reason = shouldBan ? "Banned from server" : "Kicked from server";
@@ -389,8 +1017,8 @@ void CBanSystem::AuthorPlayerById(const char* playerHandle, const bool shouldBan
 					continue;
 			}
 
-			if (shouldBan && AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bSave)
-				bSave = true;
+			if (shouldBan && AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bModified)
+				bModified = true;
 
 			pClient->Disconnect(REP_MARK_BAD, reason);
 			bDisconnect = true;
@@ -400,17 +1028,16 @@ void CBanSystem::AuthorPlayerById(const char* playerHandle, const bool shouldBan
 			if (strcmp(playerHandle, pNetChan->GetAddress()) != NULL)
 				continue;
 
-			if (shouldBan && AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bSave)
-				bSave = true;
+			if (shouldBan && AddEntry(pNetChan->GetAddress(), pClient->GetNucleusID()) && !bModified)
+				bModified = true;
 
 			pClient->Disconnect(REP_MARK_BAD, reason);
 			bDisconnect = true;
 		}
 	}
 
-	if (bSave)
+	if (bModified)
 	{
-		SaveList();
 		Msg(eDLL_T::SERVER, "Added '%s' to banned list\n", playerHandle);
 	}
 	else if (bDisconnect)
@@ -9,14 +9,89 @@ enum EKickType
 	BAN_ID
 };
 
+//-----------------------------------------------------------------------------
+// On-disk format of the banned list; a snapshot holds a header followed by
+// entries, the journal holds a header followed by records that are applied
+// on top of the snapshot in order.
+//-----------------------------------------------------------------------------
+#define BANLIST_SNAPSHOT_MAGIC   (('T'<<24)+('S'<<16)+('L'<<8)+'B')
+#define BANLIST_JOURNAL_MAGIC    (('J'<<24)+('S'<<16)+('L'<<8)+'B')
+#define BANLIST_FILE_VERSION     1
+
+enum BanListJournalOp_e : uint8_t
+{
+	BANLIST_JOURNAL_ADD = 1,
+	BANLIST_JOURNAL_DELETE
+};
+
+#pragma pack(push, 1)
+struct BanListHeader_s
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+	uint32_t entryCount; // Unused by the journal.
+};
+
+struct BanListEntry_s
+{
+	NucleusID_t nucleusId;
+	uint8_t address[16]; // IPv6, IPv4 addresses are mapped.
+	uint8_t prefixLen;
+};
+
+struct BanListJournalRecord_s
+{
+	uint8_t op; // See BanListJournalOp_e.
+	BanListEntry_s entry;
+};
+#pragma pack(pop)
+
 class CBanSystem
 {
 public:
+	// Binary IPv6 address (IPv4 addresses are mapped), masked to the prefix
+	// length of the ban; exact addresses have a prefix length of 128.
+	struct BannedAddress_t
+	{
+		IN6_ADDR m_Address;
+		int m_nPrefixLen;
+
+		inline bool operator==(const BannedAddress_t& other) const
+		{
+			return m_nPrefixLen == other.m_nPrefixLen
+				&& memcmp(&m_Address, &other.m_Address, sizeof(m_Address)) == 0;
+		}
+
+		struct Hasher_t
+		{
+			size_t operator()(const BannedAddress_t& address) const;
+		};
+	};
+
+	struct BannedKey_t
+	{
+		BannedAddress_t m_Address;
+		NucleusID_t m_NucleusID;
+
+		inline bool operator==(const BannedKey_t& other) const
+		{
+			return m_NucleusID == other.m_NucleusID
+				&& m_Address == other.m_Address;
+		}
+
+		struct Hasher_t
+		{
+			size_t operator()(const BannedKey_t& key) const;
+		};
+	};
+
 	struct Banned_t
 	{
 		Banned_t(const char* ipAddress = "", NucleusID_t nucleusId = NULL)
 			: m_Address(ipAddress)
 			, m_NucleusID(nucleusId)
+			, m_BinaryAddress()
 		{}
 
 		inline bool operator==(const Banned_t& other) const
@@ -27,13 +102,19 @@ public:
 
 		NucleusID_t m_NucleusID;
 		CUtlString m_Address;
+		BannedAddress_t m_BinaryAddress; // Parsed form of m_Address.
 	};
 
 	typedef CUtlVector<Banned_t> BannedList_t;
 
 public:
+	CBanSystem(void);
+	~CBanSystem(void) { Shutdown(); }
+
+	void Shutdown(void);
+
 	void LoadList(void);
-	void SaveList(void) const;
+	void SaveList(void);
 
 	bool AddEntry(const char* ipAddress, const NucleusID_t nucleusId);
 	bool DeleteEntry(const char* ipAddress, const NucleusID_t nucleusId);
@@ -49,11 +130,54 @@ public:
 
 	void UnbanPlayer(const char* criteria);
 
+	static bool ParseAddress(const char* ipAddress, BannedAddress_t& address);
+
 private:
+	bool InsertEntry(const Banned_t& banned);
+	void RemoveEntry(const int index);
+
+	void AddToIndex(const Banned_t& banned, const int index);
+	void RemoveFromIndex(const Banned_t& banned);
+	void ClearIndex(void);
+
+	bool LoadSnapshot(const char* fileName);
+	bool LoadLegacyList(void);
+	int ReplayJournal(const char* fileName);
+
+	void AppendJournal(const uint8_t op, const Banned_t& banned);
+	void CompactJournal(void);
+
+	void BuildSnapshot(std::vector<BanListEntry_s>& entries) const;
+	bool WriteSnapshot(const std::vector<BanListEntry_s>& entries, const int serial);
+
 	void AuthorPlayerByName(const char* playerName, const bool bBan, const char* reason = nullptr);
 	void AuthorPlayerById(const char* playerHandle, const bool bBan, const char* reason = nullptr);
 
 	BannedList_t m_BannedList;
+
+	// Hashed lookup tables for the banned list, so IsBanned doesn't depend
+	// on the size of the list. The values of the id and address tables are
+	// the number of entries in the list that map to the key, the values of
+	// the entry table are the positions of the entries in the list.
+	std::unordered_map<NucleusID_t, int> m_NucleusIDIndex;
+	std::unordered_map<BannedAddress_t, int, BannedAddress_t::Hasher_t> m_AddressIndex;
+	std::unordered_map<BannedKey_t, int, BannedKey_t::Hasher_t> m_EntryIndex;
+
+	// Number of address bans per prefix length, only the prefix lengths that
+	// are in use are looked up.
+	int m_PrefixLenCount[129];
+
+	// Number of records in the journal since the last compaction.
+	int m_nJournalRecords;
+
+	// Held while a snapshot is being written, compaction runs on its own
+	// thread while the journal keeps taking new records. Snapshots are taken
+	// in serial order, a snapshot older than the one on disk is dropped.
+	std::mutex m_SnapshotMutex;
+	std::thread m_CompactThread;
+	std::atomic<bool> m_bCompacting;
+	int m_nSnapshotSerial;
+	int m_nWrittenSerial;
 };
 
 extern CBanSystem g_BanSystem;
@@ -20,6 +20,34 @@ ConVar pylon_matchmaking_hostname("pylon_matchmaking_hostname", "r5r.org", FCVAR
 ConVar pylon_host_update_interval("pylon_host_update_interval", "5", FCVAR_RELEASE | FCVAR_ACCESSIBLE_FROM_THREADS, "Length of time in seconds between each status update interval to master server", true, 5.f, false, 0.f);
 ConVar pylon_showdebuginfo("pylon_showdebuginfo", "0", FCVAR_RELEASE | FCVAR_ACCESSIBLE_FROM_THREADS, "Shows debug output for pylon");
 
+//-----------------------------------------------------------------------------
+// Handle of the request worker running on this thread, null if this thread
+// isn't a request worker
+//-----------------------------------------------------------------------------
+static thread_local CURL* s_pWorkerCurl = nullptr;
+
+//-----------------------------------------------------------------------------
+// Locks for the shared caches, one per data type
+//-----------------------------------------------------------------------------
+static std::mutex s_ShareMutex[CURL_LOCK_DATA_LAST];
+
+static void Pylon_ShareLock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr)
+{
+    NOTE_UNUSED(handle);
+    NOTE_UNUSED(access);
+    NOTE_UNUSED(userptr);
+
+    s_ShareMutex[data].lock();
+}
+
+static void Pylon_ShareUnlock(CURL* handle, curl_lock_data data, void* userptr)
+{
+    NOTE_UNUSED(handle);
+    NOTE_UNUSED(userptr);
+
+    s_ShareMutex[data].unlock();
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: checks if server listing fields are valid, and sets outGameServer
 // Input  : &value - 
@@ -223,7 +251,8 @@ bool CPylon::PostServerHost(string& outMessage, string& outToken, string& outHos
 //-----------------------------------------------------------------------------
 // Purpose: Checks a list of clients for their banned status.
 // Input  : &inBannedVec - 
-//			**outBannedVec  - allocated; caller is responsible for freeing it
+//			**outBannedVec  - allocated; caller is responsible for freeing it,
+//			                  empty if none of the clients are banned
 // Output : True on success, false otherwise.
 //-----------------------------------------------------------------------------
 bool CPylon::GetBannedList(const CBanSystem::BannedList_t& inBannedVec, CBanSystem::BannedList_t** outBannedVec) const
@@ -271,9 +300,6 @@ bool CPylon::GetBannedList(const CBanSystem::BannedList_t& inBannedVec, CBanSyst
 
     const rapidjson::Value::ConstArray bannedPlayers = bannedPlayersIt->value.GetArray();
 
-    if (bannedPlayers.Empty())
-        return false;
-
     *outBannedVec = new CBanSystem::BannedList_t();
     Assert(*outBannedVec);
 
@@ -546,25 +572,55 @@ bool CPylon::QueryServer(const char* endpoint, const char* request,
     CURLParams params;
 
     params.writeFunction = CURLWriteStringCallback;
+    params.share = GetShare();
     params.timeout = curl_timeout.GetInt();
     params.verifyPeer = ssl_verify_peer.GetBool();
     params.verbose = curl_debug.GetBool();
 
+    // Requests from the worker pool reuse the handle of the worker, as the
+    // connection cache lives in the handle.
+    CURL* const workerCurl = s_pWorkerCurl;
+    CURL* curl;
+
     curl_slist* sList = nullptr;
-    CURL* curl = CURLInitRequest(finalUrl.c_str(), request, outResponse, sList, params);
+
+    if (workerCurl)
+    {
+        params.keepAlive = true;
+        curl_easy_reset(workerCurl);
+
+        curl = CURLSetupRequest(workerCurl, finalUrl.c_str(), request, outResponse, sList, params)
+            ? workerCurl
+            : nullptr;
+    }
+    else
+    {
+        curl = CURLInitRequest(finalUrl.c_str(), request, outResponse, sList, params);
+    }
+
     if (!curl)
     {
         return false;
     }
 
     CURLcode res = CURLSubmitRequest(curl, sList);
-    if (!CURLHandleError(curl, res, outMessage,
-        !IsDedicated(/* Errors are already shown for dedicated! */)))
+    const bool success = CURLHandleError(curl, res, outMessage,
+        !IsDedicated(/* Errors are already shown for dedicated! */));
+
+    if (success)
     {
-        return false;
+        outStatus = CURLRetrieveInfo(curl);
     }
 
-    outStatus = CURLRetrieveInfo(curl);
+    if (!workerCurl)
+    {
+        curl_easy_cleanup(curl);
+    }
+
+    if (!success)
+    {
+        return false;
+    }
 
     if (showDebug)
     {
@@ -575,6 +631,138 @@ bool CPylon::QueryServer(const char* endpoint, const char* request,
     return true;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: Queues a request for the worker pool, the request runs on one of
+//          the workers; results should be dispatched to the main thread
+//          through 'g_TaskQueue'.
+// Input  : request - 
+// Output : True if queued, false if the queue is full or the pool is shut down.
+//-----------------------------------------------------------------------------
+bool CPylon::QueueRequest(std::function<void()> request)
+{
+    std::lock_guard<std::mutex> lock(m_RequestMutex);
+
+    if (m_bShutdown)
+    {
+        return false;
+    }
+
+    if (m_RequestQueue.size() >= PYLON_MAX_QUEUED_REQUESTS)
+    {
+        return false;
+    }
+
+    // Started on first use, as the pylon is constructed during static init.
+    if (!m_bWorkersStarted)
+    {
+        m_bWorkersStarted = true;
+        m_Workers.reserve(PYLON_REQUEST_WORKER_COUNT);
+
+        for (int i = 0; i < PYLON_REQUEST_WORKER_COUNT; i++)
+        {
+            m_Workers.emplace_back(&CPylon::WorkerThread, this);
+        }
+    }
+
+    m_RequestQueue.push_back(std::move(request));
+    m_RequestCondition.notify_one();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Stops the worker pool, requests that haven't started are dropped.
+//          Must be called before the curl library is cleaned up.
+//-----------------------------------------------------------------------------
+void CPylon::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_RequestMutex);
+
+        m_bShutdown = true;
+        m_RequestQueue.clear();
+    }
+
+    m_RequestCondition.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+
+    m_Workers.clear();
+
+    if (m_Share)
+    {
+        curl_share_cleanup(m_Share);
+        m_Share = nullptr;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Request worker, performs queued requests on a persistent handle.
+//-----------------------------------------------------------------------------
+void CPylon::WorkerThread()
+{
+    CURL* const curl = curl_easy_init();
+    s_pWorkerCurl = curl;
+
+    std::unique_lock<std::mutex> lock(m_RequestMutex);
+
+    for (;;)
+    {
+        m_RequestCondition.wait(lock, [this]
+            {
+                return m_bShutdown || !m_RequestQueue.empty();
+            });
+
+        if (m_bShutdown)
+        {
+            break;
+        }
+
+        const std::function<void()> request = std::move(m_RequestQueue.front());
+        m_RequestQueue.pop_front();
+
+        lock.unlock();
+        request();
+        lock.lock();
+    }
+
+    s_pWorkerCurl = nullptr;
+
+    if (curl)
+    {
+        curl_easy_cleanup(curl);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Returns the share handle for the DNS and SSL session caches,
+//          creates it on first use.
+//-----------------------------------------------------------------------------
+CURLSH* CPylon::GetShare() const
+{
+    std::call_once(m_ShareInitFlag, [this]
+        {
+            CURLSH* const share = curl_share_init();
+
+            if (!share)
+            {
+                return;
+            }
+
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, Pylon_ShareLock);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, Pylon_ShareUnlock);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+            m_Share = share;
+        });
+
+    return m_Share;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: Extracts the error from the result json.
 // Input  : &resultJson - 
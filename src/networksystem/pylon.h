@@ -8,6 +8,9 @@ extern ConVar pylon_matchmaking_hostname;
 extern ConVar pylon_host_update_interval;
 extern ConVar pylon_showdebuginfo;
 
+#define PYLON_REQUEST_WORKER_COUNT 4 // Number of threads performing queued requests.
+#define PYLON_MAX_QUEUED_REQUESTS 256 // Requests beyond this are refused.
+
 struct MSEulaData_t
 {
 	int version;
@@ -18,7 +21,16 @@ struct MSEulaData_t
 class CPylon
 {
 public:
-	CPylon() { SetLanguage(g_LanguageNames[0]); }
+	CPylon()
+		: m_Share(nullptr)
+		, m_bWorkersStarted(false)
+		, m_bShutdown(false)
+	{
+		SetLanguage(g_LanguageNames[0]);
+	}
+
+	bool QueueRequest(std::function<void()> request);
+	void Shutdown();
 
 	bool GetServerList(vector<NetGameServer_t>& outServerList, string& outMessage) const;
 	bool GetServerByToken(NetGameServer_t& slOutServer, string& outMessage, const string& svToken) const;
@@ -53,8 +65,25 @@ private:
 
 	void SetDisabledMessage(string& outMsg) const;
 
+	CURLSH* GetShare() const;
+	void WorkerThread();
+
 private:
 	string m_Language;
 	mutable CThreadFastMutex m_StringMutex;
+
+	// Shared DNS and SSL session caches, so new connections resume sessions
+	// rather than doing a full handshake.
+	mutable CURLSH* m_Share;
+	mutable std::once_flag m_ShareInitFlag;
+
+	// Requests queued for the worker pool, each worker keeps its own handle
+	// alive so connections to the master server are reused.
+	std::mutex m_RequestMutex;
+	std::condition_variable m_RequestCondition;
+	std::deque<std::function<void()>> m_RequestQueue;
+	std::vector<std::thread> m_Workers;
+	bool m_bWorkersStarted;
+	bool m_bShutdown;
 };
 extern CPylon g_MasterServer;
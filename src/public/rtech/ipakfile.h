@@ -75,6 +75,19 @@
 #define PAK_DECODE_OUT_RING_BUFFER_SIZE 0x400000
 #define PAK_DECODE_OUT_RING_BUFFER_MASK (PAK_DECODE_OUT_RING_BUFFER_SIZE-1)
 
+// the amount of decoded data per frame when a pak is encoded as multiple
+// independent ZStd frames, each frame can be compressed or decompressed on a
+// separate thread
+#define PAK_ZSTD_DEFAULT_FRAME_SIZE (1ull << 24)
+
+// multi-frame ZStd encoded paks start with a skippable frame containing the
+// frame index, the magic is matched against the payload of that frame
+#define PAK_ZSTD_FRAME_INDEX_MAGIC (('X'<<24)+('D'<<16)+('N'<<8)+'I')
+#define PAK_ZSTD_FRAME_INDEX_VERSION 1
+
+// the skippable frame variant used to store the frame index
+#define PAK_ZSTD_FRAME_INDEX_SKIPPABLE_VARIANT 0
+
 // max amount to read per async fs read request
 #define PAK_READ_DATA_CHUNK_SIZE (1ull << 19)
 
@@ -587,6 +600,50 @@ struct PakDecoder_s
 	};
 };
 
+//-----------------------------------------------------------------------------
+// Frame index for multi-frame ZStd encoded paks; this is stored in a skippable
+// frame directly after the file header, followed by 'frameCount' entries. The
+// decoder skips over it, and tools can use it to decode any frame on its own
+//-----------------------------------------------------------------------------
+struct PakZStdFrameIndexEntry_s
+{
+	uint32_t compressedSize;
+	uint32_t decompressedSize;
+};
+
+struct PakZStdFrameIndexHeader_s
+{
+	inline const PakZStdFrameIndexEntry_s* GetEntries() const
+	{
+		return reinterpret_cast<const PakZStdFrameIndexEntry_s*>(this + 1);
+	}
+
+	inline size_t GetTotalSize() const
+	{
+		return sizeof(PakZStdFrameIndexHeader_s) + (frameCount * sizeof(PakZStdFrameIndexEntry_s));
+	}
+
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+
+	uint32_t frameCount;
+	uint32_t frameSize; // decoded size of each frame, except for the last one
+
+	// decoded size of all frames combined, this excludes the file header
+	uint64_t decompressedSize;
+};
+
+// describes where a single frame is located in the encoded and decoded pak
+struct PakZStdFrame_s
+{
+	uint64_t inOffset;  // offset from the start of the encoded pak file
+	uint64_t outOffset; // offset from the start of the decoded pak file
+
+	uint32_t compressedSize;
+	uint32_t decompressedSize;
+};
+
 struct PakRingBufferFrame_s
 {
 	size_t bufIndex;
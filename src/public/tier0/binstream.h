@@ -123,3 +123,31 @@ private:
 	std::ios_base::openmode m_flags;  // Stream flags.
 	Mode_e                  m_mode;   // Stream mode.
 };
+
+//-----------------------------------------------------------------------------
+// Read-only memory mapped file; the file's contents get paged in on access, so
+// large files can be processed without reading them into a heap buffer first
+//-----------------------------------------------------------------------------
+class CMappedFile
+{
+public:
+	CMappedFile();
+	~CMappedFile();
+
+	bool Open(const char* const filePath, const size_t readPadding = 0);
+	void Close();
+
+	inline const uint8_t* GetData() const { return m_data; }
+	inline size_t GetSize() const { return m_size; }
+
+	inline bool IsOpen() const { return m_data != nullptr; }
+
+private:
+	bool MapPadded(const size_t fileSize, const size_t readPadding, const SYSTEM_INFO& systemInfo);
+
+	HANDLE         m_fileHandle; // File handle.
+	HANDLE         m_mapHandle;  // File mapping handle.
+	const uint8_t* m_data;       // Mapped view.
+	uint8_t*       m_tailData;   // Padded copy of the end of the file, placed right after the view.
+	size_t         m_size;       // File size.
+};
@@ -3,6 +3,60 @@
 
 #include "public/iframetask.h"
 
+// Functors up to this size are stored in the task itself, larger functors are
+// allocated separately.
+#define FRAMETASK_INLINE_SIZE 128
+
+// Number of frame buckets in the timing wheel, must be a power of 2. Tasks
+// delayed by more frames wrap around and are skipped until their frame.
+#define FRAMETASK_WHEEL_SIZE 64
+
+// Number of tasks allocated at once when the pool runs dry.
+#define FRAMETASK_SLAB_SIZE 64
+
+//-----------------------------------------------------------------------------
+// Queued task, holds the functor and the frame it should run on
+//-----------------------------------------------------------------------------
+struct QueuedTask_s
+{
+    QueuedTask_s* m_pNext;
+
+    union
+    {
+        unsigned int m_nDelayedFrames; // Set by the producer.
+        uint64_t m_nTargetFrame; // Set once scheduled by the consumer.
+    };
+
+    void (*m_pInvoke)(void* const storage);
+    void (*m_pDestroy)(void* const storage);
+
+    alignas(16) char m_Storage[FRAMETASK_INLINE_SIZE];
+
+    template <typename T>
+    void Construct(T&& functor)
+    {
+        typedef typename std::decay<T>::type Functor_t;
+
+        if constexpr (sizeof(Functor_t) <= sizeof(m_Storage) && alignof(Functor_t) <= 16)
+        {
+            new (m_Storage) Functor_t(std::forward<T>(functor));
+
+            m_pInvoke = [](void* const storage) { (*reinterpret_cast<Functor_t*>(storage))(); };
+            m_pDestroy = [](void* const storage) { reinterpret_cast<Functor_t*>(storage)->~Functor_t(); };
+        }
+        else
+        {
+            *reinterpret_cast<Functor_t**>(m_Storage) = new Functor_t(std::forward<T>(functor));
+
+            m_pInvoke = [](void* const storage) { (**reinterpret_cast<Functor_t**>(storage))(); };
+            m_pDestroy = [](void* const storage) { delete *reinterpret_cast<Functor_t**>(storage); };
+        }
+    }
+
+    inline void Invoke() { m_pInvoke(m_Storage); }
+    inline void Destroy() { m_pDestroy(m_Storage); }
+};
+
 //=============================================================================//
 // This class is set up to run before each frame, committed tasks are scheduled
 // to execute after 'i' frames.
@@ -11,19 +65,49 @@
 // performing a web request in a separate thread, and apply the results (such as
 // server lists in the browser) onto the imgui panels which are created/drawn in
 // the main thread
+// ----------------------------------------------------------------------------
+// Dispatch is lock-free and can be called from any thread, the tasks are moved
+// into a timing wheel keyed by frame when RunFrame runs on the main thread.
+// Tasks dispatched while RunFrame runs are scheduled on the next frame.
 //=============================================================================//
 class CFrameTask : public IFrameTask
 {
 public:
-    virtual ~CFrameTask() {}
+    CFrameTask();
+    virtual ~CFrameTask();
     virtual void RunFrame();
     virtual bool IsFinished() const;
 
-    void Dispatch(std::function<void()> functor, unsigned int frames);
+    template <typename T>
+    void Dispatch(T&& functor, unsigned int frames)
+    {
+        QueuedTask_s* const task = AllocTask();
+
+        task->Construct(std::forward<T>(functor));
+        task->m_nDelayedFrames = frames;
+
+        Submit(task);
+    }
 
 private:
-    mutable CThreadMutex m_Mutex;
-    std::list<QueuedTasks_s> m_QueuedTasks;
+    struct Bucket_s
+    {
+        QueuedTask_s* m_pHead;
+        QueuedTask_s* m_pTail;
+    };
+
+    static QueuedTask_s* AllocTask();
+    static void FreeTask(QueuedTask_s* const task);
+
+    void Submit(QueuedTask_s* const task);
+    void Schedule(QueuedTask_s* const task);
+
+    // Tasks submitted since the last frame, newest first.
+    std::atomic<QueuedTask_s*> m_pSubmitted;
+
+    // Main thread only.
+    Bucket_s m_Wheel[FRAMETASK_WHEEL_SIZE];
+    uint64_t m_nFrame;
 };
 
 extern std::list<IFrameTask*> g_TaskQueueList;
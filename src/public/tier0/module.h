@@ -28,6 +28,10 @@ public:
 	void LoadSections();
 
 	CMemory FindPatternSIMD(const char* szPattern, const ModuleSections_t* moduleSection = nullptr) const;
+	size_t FindPatternsSIMD(const char* const* szPatterns, const size_t nCount, CMemory* const pResults,
+		const ModuleSections_t* moduleSection = nullptr) const;
+	void PrefetchPatterns(const vector<string>& patterns);
+
 	CMemory FindString(const char* szString, const ptrdiff_t occurrence = 1, bool nullTerminator = false) const;
 	CMemory FindStringReadOnly(const char* szString, bool nullTerminator) const;
 	CMemory FindFreeDataPage(const size_t nSize) const;
@@ -77,6 +81,7 @@ private:
 	DWORD                m_nModuleSize;
 	string               m_ModuleName;
 	ModuleSectionsMap_t  m_ModuleSections;
+	unordered_map<string, QWORD> m_PrefetchedPatterns; // RVA's found by PrefetchPatterns().
 };
 
 #endif // MODULE_H
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "protoc/sig_map.pb.h"
 
 #define SIGDB_MAGIC	(('p'<<24)+('a'<<16)+('M'<<8)+'S')
+#define SIGDB_PATTERN_LIST_MAGIC (('t'<<24)+('s'<<16)+('L'<<8)+'S')
 #define SIGDB_DICT_SIZE 20
 
 #define SIGDB_MAJOR_VERSION 0x2 // Increment when library changes are made.
@@ -26,11 +27,22 @@ public:
 	bool ReadCache(const char* szCacheFile);
 	bool WriteCache(const char* szCacheFile) const;
 
+	bool ReadPatternList(const char* szListFile);
+	bool WritePatternList(const char* szListFile) const;
+
+	// Keys of a cache file from another SDK release, empty otherwise.
+	inline const vector<string>& GetOutdatedKeys() const { return m_OutdatedKeys; }
+
+	// Patterns of the last run that wrote a cache, empty if never written.
+	inline const vector<string>& GetPatternList() const { return m_PatternList; }
+
 private:
 	bool CompressBlob(const size_t nSrcLen, size_t& nDstLen, uint32_t& nAdler32, const uint8_t* pSrcBuf, uint8_t* pDstBuf) const;
 	bool DecompressBlob(const size_t nSrcLen, size_t& nDstLen, uint32_t& nAdler32, const uint8_t* pSrcBuf, uint8_t* pDstBuf) const;
 
 	SigMap_Pb m_Cache;
+	vector<string> m_OutdatedKeys;
+	vector<string> m_PatternList;
 	bool m_bInitialized;
 	bool m_bDisabled;
 };
@@ -27,6 +27,7 @@ public:
 	bool	SetFromString(const char* pch, bool bUseDNS = false);
 
 	inline netadrtype_t	GetType(void) const { return type; }
+	inline const IN6_ADDR&	GetIP(void) const { return adr; }
 	inline uint16_t		GetPort(void) const { return port; }
 
 	bool		CompareAdr(const CNetAdr& other) const;
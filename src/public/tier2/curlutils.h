@@ -22,22 +22,27 @@ struct CURLParams
 		: readFunction(nullptr)
 		, writeFunction(nullptr)
 		, statusFunction(nullptr)
+		, share(nullptr)
 		, timeout(0)
 		, verifyPeer(false)
 		, followRedirect(false)
 		, verbose(false)
 		, failOnError(false)
+		, keepAlive(false)
 	{}
 
 	void* readFunction;
 	void* writeFunction;
 	void* statusFunction;
 
+	CURLSH* share; // shared DNS and SSL session caches.
+
 	int timeout;
 	bool verifyPeer;
 	bool followRedirect;
 	bool verbose;
 	bool failOnError;
+	bool keepAlive; // TCP keep-alive probes on reused connections.
 };
 
 size_t CURLReadFileCallback(void* data, const size_t size, const size_t nmemb, FILE* stream);
@@ -53,6 +58,8 @@ bool CURLDownloadFile(const char* remote, const char* savePath, const char* file
 
 CURL* CURLInitRequest(const char* remote, const char* request, string& outResponse,
 	curl_slist*& slist, const CURLParams& params);
+bool CURLSetupRequest(CURL* curl, const char* remote, const char* request, string& outResponse,
+	curl_slist*& slist, const CURLParams& params);
 
 CURLcode CURLSubmitRequest(CURL* curl, curl_slist*& slist);
 CURLINFO CURLRetrieveInfo(CURL* curl);
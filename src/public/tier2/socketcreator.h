@@ -13,6 +13,10 @@ public:
 
 	void RunFrame(void);
 	void ProcessAccept(void);
+	void ProcessSend(void);
+
+	bool QueueSend(CConnectedNetConsoleData& data, const NetConFrame_t& frame, const size_t nMaxQueueSize = 0);
+	bool FlushSendQueue(CConnectedNetConsoleData& data);
 
 	bool CreateListenSocket(const netadr_t& netAdr, bool bDualStack = true);
 	void CloseListenSocket(void);
@@ -53,6 +57,8 @@ public:
 
 private:
 	CUtlVector<AcceptedSocket_t>  m_AcceptedSockets;
+	CUtlVector<WSAPOLLFD>         m_PollSockets;     // Sockets with pending sends, rebuilt every frame.
+	CUtlVector<int>               m_PollSocketIndex; // Accepted socket index of each polled socket.
 	SocketHandle_t                m_hListenSocket; // Used to accept connections.
 
 	enum
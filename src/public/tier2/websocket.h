@@ -7,6 +7,7 @@
 #define TIER2_WEBSOCKET_H
 
 #define WEBSOCKET_DEFAULT_BUFFER_SIZE 1024
+#define WEBSOCKET_DEFAULT_QUEUE_SIZE (1024*1024)
 
 //-----------------------------------------------------------------------------
 // forward declarations
@@ -42,6 +43,20 @@ public:
 		CS_UNAVAIL
 	};
 
+	// What to do when a frame is queued on a connection with a full send queue
+	enum DropPolicy_e
+	{
+		// Drop the oldest frames that haven't been sent yet
+		DP_DROP_OLDEST = 0,
+
+		// Drop the frame that is being queued
+		DP_DROP_NEWEST,
+
+		// Drop all queued frames and destroy the connection, the connection
+		// is reattempted if retries are set
+		DP_DISCONNECT
+	};
+
 	//-------------------------------------------------------------------------
 	// Connection parameters for the system & each individual connection, if
 	// these are changed, call CWebSocket::UpdateParams() to apply the new
@@ -58,6 +73,9 @@ public:
 			timeOut = -1;
 			keepAlive = -1;
 			laxSSL = 0;
+
+			maxQueueSize = WEBSOCKET_DEFAULT_QUEUE_SIZE;
+			dropPolicy = DP_DROP_OLDEST;
 		}
 
 		// Total amount of buffer size that could be queued up and sent
@@ -81,8 +99,56 @@ public:
 		// Whether to validate the clients certificate, if this is set, no
 		// validation is performed
 		int32_t laxSSL;
+
+		// Total amount of bytes that could be queued up per connection while
+		// the socket isn't able to take them
+		int32_t maxQueueSize;
+
+		// What to do with frames that don't fit in the queue
+		DropPolicy_e dropPolicy;
+	};
+
+	//-------------------------------------------------------------------------
+	// Send queue statistics of a connection, or of all connections combined
+	//-------------------------------------------------------------------------
+	struct ConnMetrics_s
+	{
+		ConnMetrics_s()
+		{
+			queuedBytes = 0;
+			queuedFrames = 0;
+
+			sentFrames = 0;
+			droppedFrames = 0;
+
+			lastSendLatency = 0.0;
+			maxSendLatency = 0.0;
+		}
+
+		int64_t queuedBytes; // Bytes the socket hasn't taken yet
+		int32_t queuedFrames;
+
+		uint64_t sentFrames;
+		uint64_t droppedFrames;
+
+		// Time in seconds between queuing a frame and the socket taking all
+		// of it
+		double lastSendLatency;
+		double maxSendLatency;
+	};
+
+	//-------------------------------------------------------------------------
+	// A frame queued for sending, the data is shared between all connections
+	// the frame was queued on
+	//-------------------------------------------------------------------------
+	struct QueuedFrame_s
+	{
+		std::shared_ptr<const string> data;
+		double queueTime;
 	};
 
+	typedef std::deque<QueuedFrame_s> SendQueue_t;
+
 	//-------------------------------------------------------------------------
 	// Represents an individual socket connection
 	//-------------------------------------------------------------------------
@@ -97,11 +163,20 @@ public:
 
 			tryCount = 0;
 			lastQueryTime = 0;
+
+			sendQueue = nullptr;
+			sendOffset = 0;
 		}
 
 		bool Connect(const double queryTime, const ConnParams_s& params);
 		bool Process(const double queryTime);
 
+		void QueueFrame(const QueuedFrame_s& frame, const ConnParams_s& params);
+		bool ProcessQueue(const double queryTime);
+
+		void DropPartialFrame();
+		void FreeQueue();
+
 		void SetParams(const ConnParams_s& params);
 
 		void Disconnect();
@@ -115,6 +190,14 @@ public:
 		double lastQueryTime;
 
 		CUtlString address;
+
+		// Allocated on the first queued frame, the queue outlives reconnects
+		// so frames aren't lost when the connection is reestablished. This is
+		// a pointer as the connection list relocates its elements.
+		SendQueue_t* sendQueue;
+		int32_t sendOffset; // Number of bytes of the front frame already sent
+
+		ConnMetrics_s metrics;
 	};
 
 	CWebSocket();
@@ -135,6 +218,9 @@ public:
 	void SendData(const char* const dataBuf, const int32_t dataSize);
 	bool IsInitialized() const;
 
+	void GetMetrics(ConnMetrics_s& metrics) const;
+	inline const CUtlVector<ConnContext_s>& GetConnections() const { return m_addressList; }
+
 private:
 	bool m_initialized;
 	ConnParams_s m_connParams;
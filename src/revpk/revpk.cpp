@@ -91,12 +91,16 @@ static void ReVPK_Usage()
         "\t<%s>\t- ( optional ) path to the workspace containing the manifest file\n"
         "\t<%s>\t- ( optional ) path in which the VPK files will be built\n"
         "\t<%s>\t- ( optional ) max LZHAM helper threads [\"%d\", \"%d\"] \"%d\" ( default ) for max practical\n"
-        "\t<%s>\t- ( optional ) the level of compression [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\"]\n\n"
+        "\t<%s>\t- ( optional ) the level of compression [\"%s\", \"%s\", \"%s\", \"%s\", \"%s\"]\n"
+        "\t<%s>\t- ( optional ) number of worker threads to pack entries on, \"%d\" ( default ) for all cores\n"
+        "\t<%s>\t- ( optional ) whether to save the chunk deduplication index next to the directory file\n"
+        "\t<%s>\t- ( optional ) whether to reuse unchanged entries from the previous build\n\n"
 
         "For unpacking; run 'revpk %s' with the following parameters:\n"
         "\t<%s>\t- path and name of the target VPK files\n"
         "\t<%s>\t- ( optional ) path in which the VPK files will be unpacked\n"
-        "\t<%s>\t- ( optional ) whether to parse the directory file name from the pack file name\n",
+        "\t<%s>\t- ( optional ) whether to parse the directory file name from the pack file name\n"
+        "\t<%s>\t- ( optional ) number of worker threads to unpack entries on, \"%d\" ( default ) for all cores\n",
 
         PACK_COMMAND, // Pack parameters:
         "locale", g_LanguageNames[0],
@@ -110,8 +114,11 @@ static void ReVPK_Usage()
         "compressLevel", // Compress level.
         "fastest", "faster", "default", "better", "uber",
 
+        "numWorkers", -1, // Num worker threads.
+        "saveChunkIndex", "incremental",
+
         UNPACK_COMMAND,// Unpack parameters:
-        "fileName", "outPath", "sanitize"
+        "fileName", "outPath", "sanitize", "numWorkers", -1
     );
 
     Warning(eDLL_T::FS, "%s", usage.Get());
@@ -199,7 +206,11 @@ static void ReVPK_Pack(const CCommand& args)
         argCount > 7 ? Min(atoi(args.Arg(7)), LZHAM_MAX_HELPER_THREADS) : -1, // Num threads.
         argCount > 8 ? args.Arg(8) : "default"); // Compress level.
 
-    builder.PackStore(pair, workspacePath.String(), buildPath.String());
+    builder.InitChunkIndex(argCount > 10 ? atoi(args.Arg(10)) != 0 : false); // Save chunk index.
+    builder.InitIncrementalBuild(argCount > 11 ? atoi(args.Arg(11)) != 0 : false); // Incremental.
+
+    builder.PackStore(pair, workspacePath.String(), buildPath.String(),
+        argCount > 9 ? atoi(args.Arg(9)) : -1); // Num workers.
 
     timer.End();
     Msg(eDLL_T::FS, "*** Time elapsed: '%lf' seconds\n", timer.GetDuration().GetSeconds());
@@ -247,7 +258,8 @@ static void ReVPK_Unpack(const CCommand& args)
     CPackedStoreBuilder builder;
 
     builder.InitLzDecoder();
-    builder.UnpackStore(vpk, argCount > 3 ? args.Arg(3) : "ship/");
+    builder.UnpackStore(vpk, argCount > 3 ? args.Arg(3) : "ship/",
+        argCount > 5 ? atoi(args.Arg(5)) : -1); // Num workers.
 
     timer.End();
     Msg(eDLL_T::FS, "*** Time elapsed: '%lf' seconds\n", timer.GetDuration().GetSeconds());
@@ -6,6 +6,11 @@
 #include "liveapi.h"
 #include "protobuf/util/json_util.h"
 
+#pragma warning(push)
+#pragma warning(disable : 4505)
+#include "protoc/events.pb.h"
+#pragma warning(pop)
+
 #include "DirtySDK/dirtysock.h"
 #include "DirtySDK/dirtysock/netconn.h"
 #include "DirtySDK/proto/protossl.h"
@@ -51,6 +56,10 @@ static ConVar liveapi_timeout("liveapi_timeout", "300", FCVAR_RELEASE | FCVAR_SE
 static ConVar liveapi_keepalive("liveapi_keepalive", "30", FCVAR_RELEASE | FCVAR_SERVER_FRAME_THREAD, "Interval of time to send Pong to any connected server", &LiveAPI_ParamsChangedCallback);
 static ConVar liveapi_lax_ssl("liveapi_lax_ssl", "1", FCVAR_RELEASE | FCVAR_SERVER_FRAME_THREAD, "Skip SSL certificate validation for all WSS connections (allows the use of self-signed certificates)", &LiveAPI_ParamsChangedCallback);
 
+// WebSocket send queue parameters
+static ConVar liveapi_queue_size("liveapi_queue_size", "1048576", FCVAR_RELEASE | FCVAR_SERVER_FRAME_THREAD, "Maximum amount of bytes queued per connection while the connection isn't able to take them", true, 65536.f, false, 0.f, &LiveAPI_ParamsChangedCallback);
+static ConVar liveapi_queue_drop_policy("liveapi_queue_drop_policy", "0", FCVAR_RELEASE | FCVAR_SERVER_FRAME_THREAD, "What to do with events that don't fit in the send queue of a connection", &LiveAPI_ParamsChangedCallback, "0 = Drop oldest, 1 = Drop newest, 2 = Disconnect");
+
 // Print core
 static ConVar liveapi_print_enabled("liveapi_print_enabled", "0", FCVAR_RELEASE | FCVAR_SERVER_FRAME_THREAD, "Whether to enable the printing of all events to a LiveAPI JSON file");
 
@@ -66,9 +75,14 @@ LiveAPI::LiveAPI()
 	matchLogCount = 0;
 	initialLog = false;
 	initialized = false;
+	workerRunning = false;
+	workerStop = false;
+	workerBusy = false;
 }
 LiveAPI::~LiveAPI()
 {
+	for (EventArena_s* const eventArena : freeArenas)
+		delete eventArena;
 }
 
 //-----------------------------------------------------------------------------
@@ -80,6 +94,8 @@ void LiveAPI::Init()
 		return;
 
 	InitWebSocket();
+	StartWorker();
+
 	initialized = true;
 }
 
@@ -88,6 +104,12 @@ void LiveAPI::Init()
 //-----------------------------------------------------------------------------
 void LiveAPI::Shutdown()
 {
+	// Drain the queue first, so everything logged so far is sent and printed.
+	StopWorker();
+
+	if (WebSocketInitialized())
+		SendPendingFrames();
+
 	webSocketSystem.Shutdown();
 	DestroyLogger();
 	initialized = false;
@@ -120,6 +142,10 @@ void LiveAPI::CreateParams(CWebSocket::ConnParams_s& params)
 	params.timeOut = liveapi_timeout.GetInt();
 	params.keepAlive = liveapi_keepalive.GetInt();
 	params.laxSSL = liveapi_lax_ssl.GetInt();
+
+	params.maxQueueSize = liveapi_queue_size.GetInt();
+	params.dropPolicy = (CWebSocket::DropPolicy_e)Clamp(liveapi_queue_drop_policy.GetInt(),
+		int(CWebSocket::DP_DROP_OLDEST), int(CWebSocket::DP_DISCONNECT));
 }
 
 //-----------------------------------------------------------------------------
@@ -194,6 +220,10 @@ void LiveAPI::CreateLogger()
 	// possible if the game scripts crashed or something along those lines.
 	DestroyLogger();
 
+	// Events logged before this call belong to the previous logger, which
+	// the worker could still be printing to.
+	FlushEvents();
+
 	if (!liveapi_print_enabled.GetBool())
 		return; // Logging is disabled
 
@@ -209,6 +239,9 @@ void LiveAPI::CreateLogger()
 //-----------------------------------------------------------------------------
 void LiveAPI::DestroyLogger()
 {
+	// The worker must be done printing before the file gets closed off.
+	FlushEvents();
+
 	if (initialLog)
 		initialLog = false;
 
@@ -230,48 +263,272 @@ void LiveAPI::RunFrame()
 		return;
 
 	if (WebSocketInitialized())
+	{
+		SendPendingFrames();
 		webSocketSystem.Update();
+	}
 }
 
 //-----------------------------------------------------------------------------
-// Send an event to all sockets
+// Get an arena to build an event on, reuses released arenas when available
 //-----------------------------------------------------------------------------
-void LiveAPI::LogEvent(const google::protobuf::Message* const toTransmit, const google::protobuf::Message* toPrint)
+LiveAPI::EventArena_s* LiveAPI::AcquireArena()
 {
-	if (!IsEnabled())
-		return;
+	{
+		std::lock_guard<std::mutex> lock(arenaMutex);
+
+		if (!freeArenas.empty())
+		{
+			EventArena_s* const eventArena = freeArenas.back();
+			freeArenas.pop_back();
+
+			return eventArena;
+		}
+	}
+
+	return new EventArena_s();
+}
+
+//-----------------------------------------------------------------------------
+// Release an arena, all messages allocated on it are destroyed
+//-----------------------------------------------------------------------------
+void LiveAPI::ReleaseArena(EventArena_s* const eventArena)
+{
+	// Reset() keeps the initial block, only the blocks allocated after it
+	// are freed.
+	eventArena->arena.Reset();
 
-	if (WebSocketInitialized())
 	{
-		const string data = toTransmit->SerializeAsString();
-		webSocketSystem.SendData(data.c_str(), (int)data.size());
+		std::lock_guard<std::mutex> lock(arenaMutex);
+
+		if (freeArenas.size() < LIVE_API_MAX_FREE_ARENAS)
+		{
+			freeArenas.push_back(eventArena);
+			return;
+		}
 	}
 
+	delete eventArena;
+}
+
+//-----------------------------------------------------------------------------
+// Queue an event for all sockets and the file logger, the event must be
+// allocated on the given arena; ownership of the arena is taken
+//-----------------------------------------------------------------------------
+void LiveAPI::LogEvent(EventArena_s* const eventArena, const google::protobuf::Message* const event)
+{
 	// NOTE: we don't check on the cvar 'liveapi_print_enabled' here because if
 	// this cvar gets disabled on the fly and we check it here, the output will
 	// be truncated and thus invalid! Log for as long as the SpdLog instance is
 	// valid.
-	if (matchLogger)
+	QueuedEvent_s queued;
+
+	queued.eventArena = eventArena;
+	queued.event = event;
+	queued.logger = matchLogger;
+	queued.transmit = WebSocketInitialized();
+	queued.printPretty = liveapi_print_pretty.GetBool();
+	queued.printPrimitive = liveapi_print_primitive.GetBool();
+
+	if (!IsEnabled() || (!queued.transmit && !queued.logger))
+	{
+		ReleaseArena(eventArena);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(eventMutex);
+
+		if (workerRunning)
+		{
+			pendingEvents.push_back(std::move(queued));
+			eventCondition.notify_one();
+
+			return;
+		}
+	}
+
+	// No worker, serialize it here; frames are sent on the next frame.
+	ProcessEvent(queued);
+	ReleaseArena(eventArena);
+}
+
+//-----------------------------------------------------------------------------
+// Wait until the worker has processed all queued events
+//-----------------------------------------------------------------------------
+void LiveAPI::FlushEvents()
+{
+	std::unique_lock<std::mutex> lock(eventMutex);
+
+	idleCondition.wait(lock, [this]
+		{
+			return !workerRunning || (pendingEvents.empty() && !workerBusy);
+		});
+}
+
+//-----------------------------------------------------------------------------
+// Start the serialization worker
+//-----------------------------------------------------------------------------
+void LiveAPI::StartWorker()
+{
+	std::lock_guard<std::mutex> lock(eventMutex);
+
+	if (workerRunning)
+		return;
+
+	workerStop = false;
+	workerRunning = true;
+
+	workerThread = std::thread(&LiveAPI::WorkerThread, this);
+}
+
+//-----------------------------------------------------------------------------
+// Stop the serialization worker, events queued so far are processed first
+//-----------------------------------------------------------------------------
+void LiveAPI::StopWorker()
+{
+	{
+		std::lock_guard<std::mutex> lock(eventMutex);
+
+		if (!workerRunning)
+			return;
+
+		workerStop = true;
+		eventCondition.notify_one();
+	}
+
+	workerThread.join();
+
+	std::lock_guard<std::mutex> lock(eventMutex);
+
+	workerRunning = false;
+	idleCondition.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+// Serialization worker, takes all queued events at once so the lock is only
+// taken once per batch rather than once per event
+//-----------------------------------------------------------------------------
+void LiveAPI::WorkerThread()
+{
+	std::vector<QueuedEvent_s> batch;
+	std::unique_lock<std::mutex> lock(eventMutex);
+
+	for (;;)
+	{
+		eventCondition.wait(lock, [this]
+			{
+				return workerStop || !pendingEvents.empty();
+			});
+
+		if (pendingEvents.empty())
+			break; // Stop requested and nothing left to process.
+
+		batch.swap(pendingEvents);
+		workerBusy = true;
+
+		lock.unlock();
+
+		for (const QueuedEvent_s& queued : batch)
+		{
+			ProcessEvent(queued);
+			ReleaseArena(queued.eventArena);
+		}
+
+		batch.clear();
+		lock.lock();
+
+		workerBusy = false;
+		idleCondition.notify_all();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Wrap an event in its envelope, serialize it for the sockets and print it to
+// the file logger
+//-----------------------------------------------------------------------------
+void LiveAPI::ProcessEvent(const QueuedEvent_s& queued)
+{
+	google::protobuf::Arena* const arena = &queued.eventArena->arena;
+	rtech::liveapi::LiveAPIEvent* const envelope =
+		google::protobuf::Arena::CreateMessage<rtech::liveapi::LiveAPIEvent>(arena);
+
+	// PackFrom() serializes the event into the Any, its size is therefore the
+	// size of the event, no need to walk the event twice.
+	envelope->mutable_gamemessage()->PackFrom(*queued.event);
+	envelope->set_event_size(uint32_t(envelope->gamemessage().value().size()));
+
+	if (queued.transmit)
+	{
+		string data;
+		envelope->SerializeToString(&data);
+
+		std::lock_guard<std::mutex> lock(frameMutex);
+		pendingFrames.push_back(std::move(data));
+	}
+
+	if (queued.logger)
 	{
 		std::string jsonStr(initialLog ? ",\n" : "");
 		google::protobuf::util::JsonPrintOptions options;
 
-		options.add_whitespace = liveapi_print_pretty.GetBool();
-		options.always_print_primitive_fields = liveapi_print_primitive.GetBool();
+		options.add_whitespace = queued.printPretty;
+		options.always_print_primitive_fields = queued.printPrimitive;
 
-		google::protobuf::util::MessageToJsonString(*toPrint, &jsonStr, options);
+		google::protobuf::util::MessageToJsonString(envelope->gamemessage(), &jsonStr, options);
 
 		// Remove the trailing newline character
 		if (options.add_whitespace && !jsonStr.empty())
 			jsonStr.pop_back();
 
-		matchLogger.get()->info(jsonStr);
+		queued.logger.get()->info(jsonStr);
 
 		if (!initialLog)
 			initialLog = true;
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Send all frames serialized since the last call to all sockets
+//-----------------------------------------------------------------------------
+void LiveAPI::SendPendingFrames()
+{
+	{
+		std::lock_guard<std::mutex> lock(frameMutex);
+
+		if (pendingFrames.empty())
+			return;
+
+		sendFrames.swap(pendingFrames);
+	}
+
+	for (const string& data : sendFrames)
+		webSocketSystem.SendData(data.c_str(), (int)data.size());
+
+	sendFrames.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Print the send queue statistics of each connection
+//-----------------------------------------------------------------------------
+void LiveAPI::PrintWebSocketStats() const
+{
+	if (!WebSocketInitialized())
+	{
+		Msg(eDLL_T::RTECH, "LiveAPI: WebSocket not initialized\n");
+		return;
+	}
+
+	for (const CWebSocket::ConnContext_s& conn : webSocketSystem.GetConnections())
+	{
+		const CWebSocket::ConnMetrics_s& metrics = conn.metrics;
+
+		Msg(eDLL_T::RTECH, "LiveAPI: '%s': queued %lld bytes in %d frames, sent %llu frames, dropped %llu frames, latency %.3f ms (max %.3f ms)\n",
+			conn.address.String(), metrics.queuedBytes, metrics.queuedFrames, metrics.sentFrames, metrics.droppedFrames,
+			metrics.lastSendLatency * 1000.0, metrics.maxSendLatency * 1000.0);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Returns whether the system is enabled
 //-----------------------------------------------------------------------------
@@ -290,6 +547,13 @@ bool LiveAPI::IsValidToRun() const
 
 static LiveAPI s_liveApi;
 
+static void LiveAPI_WebSocketStats_f(const CCommand& args)
+{
+	s_liveApi.PrintWebSocketStats();
+}
+
+static ConCommand liveapi_websocket_stats("liveapi_websocket_stats", LiveAPI_WebSocketStats_f, "Prints the send queue statistics of each LiveAPI WebSocket connection", FCVAR_RELEASE | FCVAR_SERVER_FRAME_THREAD);
+
 //-----------------------------------------------------------------------------
 // Singleton accessor
 //-----------------------------------------------------------------------------
@@ -2,9 +2,13 @@
 #define RTECH_LIVEAPI_H
 #include "tier2/websocket.h"
 #include "thirdparty/protobuf/message.h"
+#include "thirdparty/protobuf/arena.h"
 
 #define LIVE_API_MAX_FRAME_BUFFER_SIZE 0x8000
 
+#define LIVE_API_ARENA_BLOCK_SIZE 0x1000 // Initial block of each event arena, most events fit in here.
+#define LIVE_API_MAX_FREE_ARENAS 64 // Max number of released arenas kept around for reuse.
+
 extern ConVar liveapi_enabled;
 extern ConVar liveapi_session_name;
 extern ConVar liveapi_truncate_hash_fields;
@@ -14,6 +18,20 @@ typedef void (*LiveAPISendCallback_t)(ProtoWebSocketRefT* webSocket);
 
 class LiveAPI
 {
+public:
+	// Arena an event and its envelope are allocated on, events are built on
+	// the frame thread and serialized on the worker thread; the arena is owned
+	// by the system once the event is logged.
+	struct EventArena_s
+	{
+		EventArena_s()
+			: arena(initialBlock, sizeof(initialBlock))
+		{}
+
+		alignas(8) char initialBlock[LIVE_API_ARENA_BLOCK_SIZE];
+		google::protobuf::Arena arena;
+	};
+
 public:
 	LiveAPI();
 	~LiveAPI();
@@ -37,7 +55,14 @@ public:
 	void DestroyLogger();
 
 	void RunFrame();
-	void LogEvent(const google::protobuf::Message* const toTransmit, const google::protobuf::Message* toPrint);
+
+	EventArena_s* AcquireArena();
+	void ReleaseArena(EventArena_s* const eventArena);
+
+	void LogEvent(EventArena_s* const eventArena, const google::protobuf::Message* const event);
+	void FlushEvents();
+
+	void PrintWebSocketStats() const;
 
 	bool IsEnabled() const;
 	bool IsValidToRun() const;
@@ -46,8 +71,48 @@ public:
 	inline bool FileLoggerInitialized() const { return matchLogger != nullptr; }
 
 private:
+	struct QueuedEvent_s
+	{
+		EventArena_s* eventArena;
+		const google::protobuf::Message* event;
+
+		// Snapshot of the outputs and print parameters at the time the event
+		// was logged, so the worker doesn't read cvars or the logger handle.
+		std::shared_ptr<spdlog::logger> logger;
+		bool transmit;
+		bool printPretty;
+		bool printPrimitive;
+	};
+
+	void StartWorker();
+	void StopWorker();
+
+	void WorkerThread();
+	void ProcessEvent(const QueuedEvent_s& queued);
+
+	void SendPendingFrames();
+
 	CWebSocket webSocketSystem;
 
+	// Events queued for the worker, the worker takes all of them at once.
+	std::mutex eventMutex;
+	std::condition_variable eventCondition;
+	std::condition_variable idleCondition;
+	std::vector<QueuedEvent_s> pendingEvents;
+	std::thread workerThread;
+	bool workerRunning;
+	bool workerStop;
+	bool workerBusy;
+
+	// Frames serialized by the worker, sent from the frame thread as the
+	// websocket system can only be used from there.
+	std::mutex frameMutex;
+	std::vector<string> pendingFrames;
+	std::vector<string> sendFrames;
+
+	std::mutex arenaMutex;
+	std::vector<EventArena_s*> freeArenas;
+
 	std::shared_ptr<spdlog::logger> matchLogger;
 	int matchLogCount;
 	bool initialLog;
@@ -5,6 +5,7 @@
 //=============================================================================//
 #include "tier0/binstream.h"
 #include "tier1/fmtstr.h"
+#include "mathlib/parallel_for.h"
 
 #include "rtech/ipakfile.h"
 
@@ -324,6 +325,15 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 	qword70 = decoder->qword70;
 	inputBuf = decoder->inputBuf;
 
+	// these never change while decoding, keep them in registers rather than
+	// reloading them through the decoder for every symbol
+	const uint64_t inputMask = decoder->inputMask;
+	const uint64_t outputInvMask = decoder->outputInvMask;
+
+	outputMask = decoder->outputMask;
+	inputInvMask = decoder->inputInvMask;
+	decompSize = decoder->decompSize;
+
 	if (decoder->compressedStreamSize < qword70)
 		qword70 = decoder->compressedStreamSize;
 
@@ -334,7 +344,7 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 	if (!currentBit)
 		goto LABEL_11;
 
-	v13 = (*(_QWORD*)&inputBuf[inBufBytePos & decoder->inputMask] << (64 - (unsigned __int8)currentBit)) | currentByte;
+	v13 = (*(_QWORD*)&inputBuf[inBufBytePos & inputMask] << (64 - (unsigned __int8)currentBit)) | currentByte;
 	for (i = currentBit; ; i = currentBit)
 	{
 		currentBit &= 7u;
@@ -352,12 +362,12 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 		if ((s_defaultDecoderLUT[v18] & 0x80u) != 0)
 		{
 			v56 = -(int)v20;
-			v57 = &inputBuf[inBufBytePos & decoder->inputMask];
+			v57 = &inputBuf[inBufBytePos & inputMask];
 			v71 = 1;
-			v58 = &outputBuf[outBufBytePos & decoder->outputMask];
+			v58 = &outputBuf[outBufBytePos & outputMask];
 			if (v56 == s_defaultDecoderLUT[v16 + 1248])
 			{
-				if ((~inBufBytePos & decoder->inputInvMask) < 0xF || (decoder->outputInvMask & ~outBufBytePos) < 0xF || decoder->decompSize - outBufBytePos < 0x10)
+				if ((~inBufBytePos & inputInvMask) < 0xF || (outputInvMask & ~outBufBytePos) < 0xF || decompSize - outBufBytePos < 0x10)
 					v56 = 1;
 				v59 = v19;
 				v60 = v19 >> 3;
@@ -379,7 +389,15 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 				currentBit += v64 + 3;
 				v19 = v62 >> v64;
 				v66 = v63 + (v62 & ((1 << v64) - 1)) + v56;
-				for (j = v66 >> 3; j; --j)
+				// input and output never overlap, copy the literals in
+				// 16 byte blocks first
+				for (j = v66 >> 4; j; --j)
+				{
+					_mm_storeu_si128((__m128i*)v58, _mm_loadu_si128((const __m128i*)v57));
+					v57 += 16;
+					v58 += 16;
+				}
+				if ((v66 & 8) != 0)
 				{
 					v68 = *(_QWORD*)v57;
 					v57 += 8;
@@ -418,7 +436,6 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 			v22 = ((unsigned __int64)(unsigned int)v19 >> (((unsigned int)(v21 - 31) >> 3) & 6)) & 0x3F;
 			v23 = 1 << (v21 + ((v19 >> 4) & ((24 * (((unsigned int)(v21 - 31) >> 3) & 2)) >> 4)));
 			currentBit += (((unsigned int)(v21 - 31) >> 3) & 6) + s_defaultDecoderLUT[v22 + 1088] + v21 + ((v19 >> 4) & ((24 * (((unsigned int)(v21 - 31) >> 3) & 2)) >> 4));
-			outputMask = decoder->outputMask;
 			v25 = 16 * (v23 + ((v23 - 1) & (v19 >> ((((unsigned int)(v21 - 31) >> 3) & 6) + s_defaultDecoderLUT[v22 + 1088]))));
 			v19 >>= (((unsigned int)(v21 - 31) >> 3) & 6) + s_defaultDecoderLUT[v22 + 1088] + v21 + ((v19 >> 4) & ((24 * (((unsigned int)(v21 - 31) >> 3) & 2)) >> 4));
 			v26 = v25 + s_defaultDecoderLUT[v22 + 1024] - 16;
@@ -445,7 +462,7 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 					v45 = s_defaultDecoderLUT[v46 + 1216];
 					if (v74 && currentBit + v45 >= 61)
 					{
-						v47 = inBufBytePos++ & decoder->inputMask;
+						v47 = inBufBytePos++ & inputMask;
 						v43 |= (unsigned __int64)v74[v47] << (61 - (unsigned __int8)currentBit);
 						currentBit -= 8;
 					}
@@ -463,7 +480,15 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 						v51 = *v29;
 						//++dword_14D40B2BC;
 						v52 = 0i64;
-						for (k = 0x101010101010101i64 * v51; (unsigned int)v52 < v50; v52 = (unsigned int)(v52 + 8))
+						k = 0x101010101010101i64 * v51;
+
+						// fill in 16 byte blocks, the remainder is written in
+						// qwords so we never write further than before
+						const __m128i fill = _mm_set1_epi64x(k);
+
+						for (; (unsigned int)v52 + 16 <= v50; v52 = (unsigned int)(v52 + 16))
+							_mm_storeu_si128((__m128i*)&v28[v52], fill);
+						for (; (unsigned int)v52 < v50; v52 = (unsigned int)(v52 + 8))
 							*(_QWORD*)&v28[v52] = k;
 					}
 					else
@@ -485,7 +510,18 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 				else
 				{
 					//++dword_14D40B2AC;
-					for (m = 0i64; (unsigned int)m < (unsigned int)v48; m = (unsigned int)(m + 8))
+					m = 0i64;
+
+					// if the source is at least 16 bytes behind in the ring
+					// buffer, it never overlaps the block being written and we
+					// can copy in 16 byte blocks; the match distance itself
+					// can't be used as it may wrap around the ring buffer
+					if ((uint64_t)(v28 - v29) >= 16)
+					{
+						for (; (unsigned int)m + 16 <= (unsigned int)v48; m = (unsigned int)(m + 16))
+							_mm_storeu_si128((__m128i*)&v28[m], _mm_loadu_si128((const __m128i*)&v29[m]));
+					}
+					for (; (unsigned int)m < (unsigned int)v48; m = (unsigned int)(m + 8))
 						*(_QWORD*)&v28[m] = *(_QWORD*)&v29[m];
 				}
 			}
@@ -501,17 +537,15 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 			break;
 	LABEL_29:
 		outputBuf = v70;
-		v13 = (*(_QWORD*)&inputBuf[inBufBytePos & decoder->inputMask] << (64 - (unsigned __int8)currentBit)) | v19;
+		v13 = (*(_QWORD*)&inputBuf[inBufBytePos & inputMask] << (64 - (unsigned __int8)currentBit)) | v19;
 	}
 	if (outBufBytePos != decoder->decompressedStreamSize)
 		goto LABEL_25;
-	decompSize = decoder->decompSize;
 	if (outBufBytePos == decompSize)
 	{
 		result = true;
 		goto LABEL_69;
 	}
-	inputInvMask = decoder->inputInvMask;
 	headerOffset = decoder->headerOffset;
 	v33 = inputInvMask & -(__int64)inBufBytePos;
 	v19 >>= 1;
@@ -523,9 +557,9 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 		if (inBufBytePos > v34)
 			decoder->qword70 = inputInvMask + v34 + 1;
 	}
-	v35 = inBufBytePos & decoder->inputMask;
+	v35 = inBufBytePos & inputMask;
 	inBufBytePos += headerOffset;
-	v36 = outBufBytePos + decoder->outputInvMask + 1;
+	v36 = outBufBytePos + outputInvMask + 1;
 	v37 = *(_QWORD*)&inputBuf[v35] & ((1i64 << (8 * (unsigned __int8)headerOffset)) - 1);
 	v38 = v37 + decoder->bufferSizeNeeded;
 	v39 = v37 + decoder->compressedStreamSize;
@@ -543,8 +577,8 @@ static bool Pak_RTechStreamDecode(PakDecoder_s* const decoder, const size_t inLe
 		qword70 = decoder->qword70;
 		if (inBufBytePos >= qword70)
 		{
-			inBufBytePos = ~decoder->inputInvMask & (inBufBytePos + 7);
-			qword70 += decoder->inputInvMask + 1;
+			inBufBytePos = ~inputInvMask & (inBufBytePos + 7);
+			qword70 += inputInvMask + 1;
 			decoder->qword70 = qword70;
 		}
 		if (decoder->compressedStreamSize < qword70)
@@ -590,6 +624,25 @@ static size_t Pak_ZStdDecoderInit(PakDecoder_s* const decoder, const uint8_t* fr
 		return NULL; // content size error
 	}
 
+	size_t frameContentSize = dctx->fParams.frameContentSize;
+
+	// paks encoded as multiple frames start with the frame index, which holds
+	// the decoded size of all frames combined
+	if (dctx->fParams.frameType == ZSTD_skippableFrame)
+	{
+		const PakZStdFrameIndexHeader_s* const frameIndex = Pak_GetZStdFrameIndex(frameHeader, dataSize);
+
+		if (!frameIndex)
+		{
+			ZSTD_freeDStream(decoder->zstreamContext);
+			decoder->zstreamContext = nullptr;
+
+			return NULL; // frame index error
+		}
+
+		frameContentSize = frameIndex->decompressedSize;
+	}
+
 	// ideally the frame header of the block gets parsed first, the length
 	// thereof is returned by initDStream and thus being processed first
 	// before moving on to actual data
@@ -600,7 +653,7 @@ static size_t Pak_ZStdDecoderInit(PakDecoder_s* const decoder, const uint8_t* fr
 	decoder->bufferSizeNeeded = decoder->inBufBytePos + decoder->frameHeaderSize;
 
 	// must include header size
-	decoder->decompSize = dctx->fParams.frameContentSize + headerSize;
+	decoder->decompSize = frameContentSize + headerSize;
 	return decoder->decompSize;
 }
 
@@ -608,57 +661,155 @@ static size_t Pak_ZStdDecoderInit(PakDecoder_s* const decoder, const uint8_t* fr
 // decodes the ZStd data stream up to available buffer or data, whichever ends
 // first
 //-----------------------------------------------------------------------------
-static bool Pak_ZStdStreamDecode(PakDecoder_s* const decoder, const PakRingBufferFrame_s& outFrame, const PakRingBufferFrame_s& inFrame)
+static bool Pak_ZStdStreamDecode(PakDecoder_s* const decoder, const size_t inLen, const size_t outLen)
 {
-	ZSTD_outBuffer outBuffer = {
-		&decoder->outputBuf[outFrame.bufIndex],
-		outFrame.frameLen, NULL
-	};
+	ZSTD_DStream* const dctx = decoder->zstreamContext;
 
-	ZSTD_inBuffer inBuffer = {
-		&decoder->inputBuf[inFrame.bufIndex],
-		inFrame.frameLen, NULL
-	};
+	// paks encoded as multiple frames are decoded frame by frame, the decoder
+	// stops at the end of each frame so keep going until we either ran out of
+	// streamed data or buffer room, or until all frames have been decoded
+	for (;;)
+	{
+		const PakRingBufferFrame_s outFrame = Pak_DetermineRingBufferFrame(decoder->outputMask, decoder->outBufBytePos, outLen);
+		const PakRingBufferFrame_s inFrame = Pak_DetermineRingBufferFrame(decoder->inputMask, decoder->inBufBytePos, inLen);
 
-	ZSTD_DStream* const dctx = decoder->zstreamContext;
-	const size_t ret = ZSTD_decompressStream(dctx, &outBuffer, &inBuffer);
+		ZSTD_outBuffer outBuffer = {
+			&decoder->outputBuf[outFrame.bufIndex],
+			outFrame.frameLen, NULL
+		};
+
+		ZSTD_inBuffer inBuffer = {
+			&decoder->inputBuf[inFrame.bufIndex],
+			inFrame.frameLen, NULL
+		};
+
+		const size_t ret = ZSTD_decompressStream(dctx, &outBuffer, &inBuffer);
+
+		if (ZSTD_isError(ret))
+		{
+			// NOTE: obtained here and not in the error formatter as we could check
+			// the error string during the assertion
+			const char* const decodeError = ZSTD_getErrorName(ret);
+			assert(0);
+
+			Error(eDLL_T::RTECH, EXIT_FAILURE, "%s: decode error: %s\n", __FUNCTION__, decodeError);
+			return false;
+		}
+
+		// advance buffer io positions, required so the main parser could already
+		// start parsing the headers while the rest is getting decoded still
+		decoder->outBufBytePos += outBuffer.pos;
+		decoder->inBufBytePos += inBuffer.pos;
+
+		// on the next call, we need at least this amount of data streamed in order
+		// to decode the rest of the pak file, as this is where reading has stopped
+		// this value may equal the currently streamed input size, as its possible
+		// this function is getting called to flush the remainder decoded data into
+		// the out buffer which got truncated off on the call prior due to wrapping
+		//
+		// if the input stream has fully decoded, this should equal the size of the
+		// encoded pak file
+		decoder->bufferSizeNeeded = decoder->inBufBytePos + ZSTD_nextSrcSizeToDecompress(dctx);
+
+		// frame hasn't been fully decoded yet
+		if (ret != NULL)
+			return false;
+
+		// zstd decoder no longer necessary at this point, deallocate
+		if (decoder->outBufBytePos == decoder->decompSize)
+		{
+			ZSTD_freeDStream(dctx);
+			decoder->zstreamContext = nullptr;
+
+			return true;
+		}
+
+		// more frames are following, we need at least the start of the next
+		// frame header before we can continue
+		decoder->bufferSizeNeeded = decoder->inBufBytePos + ZSTD_FRAMEHEADERSIZE_PREFIX(ZSTD_f_zstd1);
+
+		if (!Pak_HasEnoughStreamedDataForDecode(decoder, inLen))
+			return false;
+
+		if (!Pak_HasEnoughDecodeBufferAvailable(decoder, outLen))
+			return false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// returns the frame index if the encoded data starts with one, this is the
+// case for paks that were encoded as multiple independent frames; the data
+// must point to the start of the encoded data, right after the file header
+//-----------------------------------------------------------------------------
+const PakZStdFrameIndexHeader_s* Pak_GetZStdFrameIndex(const uint8_t* const encodedData, const size_t encodedSize)
+{
+	if (encodedSize < ZSTD_SKIPPABLEHEADERSIZE + sizeof(PakZStdFrameIndexHeader_s))
+		return nullptr;
+
+	const uint32_t frameMagic = *reinterpret_cast<const uint32_t*>(encodedData);
+
+	if (frameMagic != ZSTD_MAGIC_SKIPPABLE_START + PAK_ZSTD_FRAME_INDEX_SKIPPABLE_VARIANT)
+		return nullptr;
+
+	const uint32_t frameSize = *reinterpret_cast<const uint32_t*>(&encodedData[sizeof(uint32_t)]);
+
+	// the skippable frame must fit in the encoded data
+	if (frameSize > encodedSize - ZSTD_SKIPPABLEHEADERSIZE)
+		return nullptr;
 
-	if (ZSTD_isError(ret))
+	const PakZStdFrameIndexHeader_s* const frameIndex =
+		reinterpret_cast<const PakZStdFrameIndexHeader_s*>(&encodedData[ZSTD_SKIPPABLEHEADERSIZE]);
+
+	if (frameSize < sizeof(PakZStdFrameIndexHeader_s) ||
+		frameIndex->magic != PAK_ZSTD_FRAME_INDEX_MAGIC ||
+		frameIndex->version != PAK_ZSTD_FRAME_INDEX_VERSION)
 	{
-		// NOTE: obtained here and not in the error formatter as we could check
-		// the error string during the assertion
-		const char* const decodeError = ZSTD_getErrorName(ret);
-		assert(0);
+		return nullptr;
+	}
 
-		Error(eDLL_T::RTECH, EXIT_FAILURE, "%s: decode error: %s\n", __FUNCTION__, decodeError);
+	// index entries must fit in the skippable frame
+	if (frameIndex->GetTotalSize() > frameSize)
+		return nullptr;
+
+	return frameIndex;
+}
+
+//-----------------------------------------------------------------------------
+// gets the location of given frame in the encoded and decoded pak file, the
+// frame can be decoded on its own by initializing a decoder with the encoded
+// frame as input and a header size of 0; fails if the frame doesn't fit in the
+// encoded or decoded pak file, as the index could be corrupt
+//-----------------------------------------------------------------------------
+bool Pak_GetZStdFrame(const PakZStdFrameIndexHeader_s* const frameIndex, const uint32_t frameNum,
+	const size_t encodedFileSize, PakZStdFrame_s* const outFrame)
+{
+	if (frameNum >= frameIndex->frameCount)
 		return false;
-	}
 
-	// advance buffer io positions, required so the main parser could already
-	// start parsing the headers while the rest is getting decoded still
-	decoder->outBufBytePos += outBuffer.pos;
-	decoder->inBufBytePos += inBuffer.pos;
+	const PakZStdFrameIndexEntry_s* const entries = frameIndex->GetEntries();
 
-	// on the next call, we need at least this amount of data streamed in order
-	// to decode the rest of the pak file, as this is where reading has stopped
-	// this value may equal the currently streamed input size, as its possible
-	// this function is getting called to flush the remainder decoded data into
-	// the out buffer which got truncated off on the call prior due to wrapping
-	//
-	// if the input stream has fully decoded, this should equal the size of the
-	// encoded pak file
-	decoder->bufferSizeNeeded = decoder->inBufBytePos + ZSTD_nextSrcSizeToDecompress(dctx);
+	// the first frame starts right after the index
+	uint64_t inOffset = sizeof(PakFileHeader_s) + ZSTD_SKIPPABLEHEADERSIZE + frameIndex->GetTotalSize();
+
+	for (uint32_t i = 0; i < frameNum; i++)
+		inOffset += entries[i].compressedSize;
+
+	outFrame->inOffset = inOffset;
+	outFrame->outOffset = sizeof(PakFileHeader_s) + (uint64_t(frameNum) * frameIndex->frameSize);
 
-	const bool decoded = ret == NULL;
+	outFrame->compressedSize = entries[frameNum].compressedSize;
+	outFrame->decompressedSize = entries[frameNum].decompressedSize;
 
-	// zstd decoder no longer necessary at this point, deallocate
-	if (decoded)
+	if (outFrame->inOffset + outFrame->compressedSize > encodedFileSize)
+		return false;
+
+	if (outFrame->decompressedSize > frameIndex->frameSize ||
+		outFrame->outOffset + outFrame->decompressedSize > sizeof(PakFileHeader_s) + frameIndex->decompressedSize)
 	{
-		ZSTD_freeDStream(dctx);
-		decoder->zstreamContext = nullptr;
+		return false;
 	}
 
-	return decoded;
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -740,10 +891,20 @@ bool Pak_StreamToBufferDecode(PakDecoder_s* const decoder, const size_t inLen, c
 	// this position in code
 	assert(decoder->zstreamContext && decoder->inBufBytePos <= inLen);
 
-	const PakRingBufferFrame_s outFrame = Pak_DetermineRingBufferFrame(decoder->outputMask, decoder->outBufBytePos , outLen);
-	const PakRingBufferFrame_s inFrame  = Pak_DetermineRingBufferFrame(decoder->inputMask, decoder->inBufBytePos, inLen);
+	return Pak_ZStdStreamDecode(decoder, inLen, outLen);
+}
+
+//-----------------------------------------------------------------------------
+// updates the header of a decoded pak so the runtime won't try to decode it
+//-----------------------------------------------------------------------------
+static void Pak_SetDecodedHeader(PakFileHeader_s* const outHeader)
+{
+	// remove compress flags
+	outHeader->flags &= ~PAK_HEADER_FLAGS_COMPRESSED;
+	outHeader->flags &= ~PAK_HEADER_FLAGS_ZSTREAM_ENCODED;
 
-	return Pak_ZStdStreamDecode(decoder, outFrame, inFrame);
+	// equal compressed size with decompressed
+	outHeader->compressedSize = outHeader->decompressedSize;
 }
 
 //-----------------------------------------------------------------------------
@@ -779,22 +940,178 @@ bool Pak_BufferToBufferDecode(uint8_t* const inBuf, uint8_t* const outBuf, const
 
 	// copy the header over to the decoded buffer
 	*outHeader = *inHeader;
+	Pak_SetDecodedHeader(outHeader);
 
-	// remove compress flags
-	outHeader->flags &= ~PAK_HEADER_FLAGS_COMPRESSED;
-	outHeader->flags &= ~PAK_HEADER_FLAGS_ZSTREAM_ENCODED;
+	return true;
+}
 
-	// equal compressed size with decompressed
-	outHeader->compressedSize = outHeader->decompressedSize;
+//-----------------------------------------------------------------------------
+// copies decoded data that belongs to the header section into the buffer
+//-----------------------------------------------------------------------------
+static void Pak_CaptureHeaderData(uint8_t* const headerBuf, const size_t headerBufSize,
+	const uint8_t* const data, const size_t dataPos, const size_t dataLen)
+{
+	if (dataPos >= headerBufSize)
+		return;
+
+	memcpy(&headerBuf[dataPos], data, Min(headerBufSize - dataPos, dataLen));
+}
+
+//-----------------------------------------------------------------------------
+// decodes buffered input pak data into an output ring buffer, which gets
+// flushed to the stream as it fills up; the stream position must be at the
+// end of the pak file header
+//-----------------------------------------------------------------------------
+static bool Pak_BufferToStreamDecode(const uint8_t* const inBuf, CIOStream& outStream,
+	uint8_t* const headerBuf, const size_t headerBufSize, const PakDecodeMode_e decodeMode)
+{
+	const PakFileHeader_s* const inHeader = reinterpret_cast<const PakFileHeader_s*>(inBuf);
+
+	// the RTech decoder copies data in qwords and could therefore write a few
+	// bytes past the end of the ring buffer
+	const size_t ringBufSlack = 64;
+
+	std::unique_ptr<uint8_t[]> ringBufContainer(new uint8_t[PAK_DECODE_OUT_RING_BUFFER_SIZE + ringBufSlack]);
+	uint8_t* const ringBuf = ringBufContainer.get();
+
+	PakDecoder_s decoder{};
+	const size_t decompressedSize = Pak_InitDecoder(&decoder, inBuf, ringBuf, UINT64_MAX, PAK_DECODE_OUT_RING_BUFFER_MASK,
+		inHeader->compressedSize, NULL, sizeof(PakFileHeader_s), decodeMode);
+
+	if (decompressedSize != inHeader->decompressedSize)
+	{
+		Error(eDLL_T::RTECH, NO_ERROR, "%s: decompressed size: '%zu' expected: '%zu'!\n",
+			__FUNCTION__, decompressedSize, inHeader->decompressedSize);
+
+		return false;
+	}
+
+	size_t flushedBytePos = sizeof(PakFileHeader_s);
+	bool decoded = false;
+
+	while (!decoded)
+	{
+		const size_t inBytePos = decoder.inBufBytePos;
+
+		// all data up to the flushed position has been written out, so the
+		// decoder is free to use the entire ring buffer from there on
+		decoded = Pak_StreamToBufferDecode(&decoder, inHeader->compressedSize,
+			flushedBytePos + PAK_DECODE_OUT_RING_BUFFER_SIZE, decodeMode);
+
+		const size_t outBytePos = decoder.outBufBytePos;
+
+		if (!decoded && outBytePos == flushedBytePos && decoder.inBufBytePos == inBytePos)
+		{
+			Error(eDLL_T::RTECH, NO_ERROR, "%s: decoder stalled at '%zu' of '%zu'!\n",
+				__FUNCTION__, outBytePos, decompressedSize);
+
+			if (decodeMode == PakDecodeMode_e::MODE_ZSTD && decoder.zstreamContext)
+				ZSTD_freeDStream(decoder.zstreamContext);
+
+			return false;
+		}
+
+		// flush everything that has been decoded, the data could wrap around
+		// the end of the ring buffer
+		while (flushedBytePos != outBytePos)
+		{
+			const PakRingBufferFrame_s frame = Pak_DetermineRingBufferFrame(PAK_DECODE_OUT_RING_BUFFER_MASK, flushedBytePos, outBytePos);
+			const uint8_t* const frameData = &ringBuf[frame.bufIndex];
+
+			Pak_CaptureHeaderData(headerBuf, headerBufSize, frameData, flushedBytePos, frame.frameLen);
+			outStream.Write(frameData, frame.frameLen);
+
+			flushedBytePos += frame.frameLen;
+		}
+	}
 
 	return true;
 }
 
 //-----------------------------------------------------------------------------
-// decodes the pak file from file name
+// decodes a multi-frame ZStd encoded pak; frames get decoded concurrently by
+// the workers, but are written to the stream in order to keep the memory
+// usage bounded to one frame per worker; the stream position must be at the
+// end of the pak file header
 //-----------------------------------------------------------------------------
-bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile)
+static bool Pak_FrameToStreamDecode(const uint8_t* const inBuf, const size_t inBufSize, const PakZStdFrameIndexHeader_s* const frameIndex,
+	CIOStream& outStream, uint8_t* const headerBuf, const size_t headerBufSize, const int workerCount)
 {
+	const uint32_t frameCount = frameIndex->frameCount;
+
+	std::atomic<uint32_t> nextFrame(0);
+	std::atomic<bool> failed(false);
+
+	std::mutex writeMutex;
+	std::condition_variable writeCondition;
+	uint32_t nextWriteFrame = 0;
+
+	const auto workerFunc = [&]()
+	{
+		std::unique_ptr<uint8_t[]> frameBufContainer(new uint8_t[frameIndex->frameSize]);
+		uint8_t* const frameBuf = frameBufContainer.get();
+
+		for (uint32_t i = nextFrame++; i < frameCount; i = nextFrame++)
+		{
+			PakZStdFrame_s frame;
+			bool decoded = !failed && Pak_GetZStdFrame(frameIndex, i, inBufSize, &frame);
+
+			if (decoded)
+			{
+				// frames are standalone, so we don't have a header here
+				PakDecoder_s decoder{};
+				const size_t decompressedSize = Pak_InitDecoder(&decoder, &inBuf[frame.inOffset], frameBuf,
+					UINT64_MAX, UINT64_MAX, frame.compressedSize, NULL, NULL, PakDecodeMode_e::MODE_ZSTD);
+
+				decoded = decompressedSize == frame.decompressedSize &&
+					Pak_StreamToBufferDecode(&decoder, frame.compressedSize, frame.decompressedSize, PakDecodeMode_e::MODE_ZSTD);
+
+				if (decoder.zstreamContext)
+					ZSTD_freeDStream(decoder.zstreamContext);
+			}
+
+			std::unique_lock<std::mutex> lock(writeMutex);
+			writeCondition.wait(lock, [&]() { return nextWriteFrame == i; });
+
+			if (decoded && !failed)
+			{
+				Pak_CaptureHeaderData(headerBuf, headerBufSize, frameBuf, frame.outOffset, frame.decompressedSize);
+				outStream.Write(frameBuf, frame.decompressedSize);
+			}
+			else if (!failed)
+			{
+				Error(eDLL_T::RTECH, NO_ERROR, "%s: failed to decode frame '%u' of '%u'!\n",
+					__FUNCTION__, i, frameCount);
+
+				failed = true;
+			}
+
+			nextWriteFrame++;
+			writeCondition.notify_all();
+		}
+	};
+
+	const uint32_t threadCount = Min(static_cast<uint32_t>(Max(workerCount, 1)), frameCount);
+	CParallelTaskGroup workers;
+
+	// the calling thread participates as well
+	for (uint32_t i = 1; i < threadCount; i++)
+		workers.Run(workerFunc);
+
+	workerFunc();
+	workers.Wait();
+
+	return !failed;
+}
+
+//-----------------------------------------------------------------------------
+// decodes the pak file from file name, the decoded data is streamed to the out
+// file; multi-frame ZStd encoded paks are decoded using workerCount threads
+//-----------------------------------------------------------------------------
+bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile, const int workerCount)
+{
+	const double startTime = Plat_FloatTime();
+
 	// if this path doesn't exist, we must create it first before trying to
 	// open the out file
 	if (!Pak_CreateOverridePath())
@@ -805,9 +1122,14 @@ bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
-	CIOStream inPakStream;
+	// the input is mapped rather than read into a buffer, so the memory usage
+	// stays constant regardless of the pak size; the RTech decoder reads its
+	// input in qwords and could read past the end of the mapped view, so have
+	// the end of the file padded if it ends right before a page boundary
+	const size_t inputReadPadding = 16;
+	CMappedFile inPakMap;
 
-	if (!inPakStream.Open(inPakFile, CIOStream::Mode_e::Read))
+	if (!inPakMap.Open(inPakFile, inputReadPadding))
 	{
 		Error(eDLL_T::RTECH, NO_ERROR, "%s: failed to open pak file '%s' for read!\n",
 			__FUNCTION__, inPakFile);
@@ -825,7 +1147,7 @@ bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
-	const size_t fileSize = inPakStream.GetSize();
+	const size_t fileSize = inPakMap.GetSize();
 
 	if (fileSize <= sizeof(PakFileHeader_s))
 	{
@@ -835,13 +1157,8 @@ bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
-	std::unique_ptr<uint8_t[]> inPakBufContainer(new uint8_t[fileSize]);
-	uint8_t* const inPakBuf = inPakBufContainer.get();
-
-	inPakStream.Read(inPakBuf, fileSize);
-	inPakStream.Close();
-
-	PakFileHeader_s* const inHeader = reinterpret_cast<PakFileHeader_s*>(inPakBuf);
+	const uint8_t* const inPakBuf = inPakMap.GetData();
+	const PakFileHeader_s* const inHeader = reinterpret_cast<const PakFileHeader_s*>(inPakBuf);
 
 	if (inHeader->magic != PAK_HEADER_MAGIC || inHeader->version != PAK_HEADER_VERSION)
 	{
@@ -871,10 +1188,48 @@ bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile
 
 	Pak_ShowHeaderDetails(inHeader);
 
-	std::unique_ptr<uint8_t[]> outPakBufContainer(new uint8_t[inHeader->decompressedSize]);
-	uint8_t* const outPakBuf = outPakBufContainer.get();
+	// only the header data is kept in memory, everything else is streamed
+	// out as soon as it has been decoded
+	const size_t headerDataSize = Pak_GetHeaderDataSize(inHeader);
 
-	if (!Pak_BufferToBufferDecode(inPakBuf, outPakBuf, fileSize, decodeMode))
+	if (headerDataSize > inHeader->decompressedSize)
+	{
+		Error(eDLL_T::RTECH, NO_ERROR, "%s: pak '%s' has a corrupt header!\n",
+			__FUNCTION__, inPakFile);
+
+		return false;
+	}
+
+	std::unique_ptr<uint8_t[]> headerBufContainer(new uint8_t[headerDataSize]);
+	uint8_t* const headerBuf = headerBufContainer.get();
+
+	PakFileHeader_s* const outHeader = reinterpret_cast<PakFileHeader_s*>(headerBuf);
+
+	// copy the header over, this gets written again once the remainder of the
+	// header data has been decoded and updated
+	*outHeader = *inHeader;
+	outPakStream.Write(headerBuf, sizeof(PakFileHeader_s));
+
+	const uint8_t* const encodedData = &inPakBuf[sizeof(PakFileHeader_s)];
+	const size_t encodedSize = fileSize - sizeof(PakFileHeader_s);
+
+	const PakZStdFrameIndexHeader_s* const frameIndex = decodeMode == PakDecodeMode_e::MODE_ZSTD
+		? Pak_GetZStdFrameIndex(encodedData, encodedSize)
+		: nullptr;
+
+	if (frameIndex && frameIndex->decompressedSize + sizeof(PakFileHeader_s) != inHeader->decompressedSize)
+	{
+		Error(eDLL_T::RTECH, NO_ERROR, "%s: pak '%s' has a corrupt frame index; decompressed size: '%zu' expected: '%zu'!\n",
+			__FUNCTION__, inPakFile, frameIndex->decompressedSize + sizeof(PakFileHeader_s), inHeader->decompressedSize);
+
+		return false;
+	}
+
+	const bool decoded = frameIndex
+		? Pak_FrameToStreamDecode(inPakBuf, fileSize, frameIndex, outPakStream, headerBuf, headerDataSize, workerCount)
+		: Pak_BufferToStreamDecode(inPakBuf, outPakStream, headerBuf, headerDataSize, decodeMode);
+
+	if (!decoded)
 	{
 		Error(eDLL_T::RTECH, NO_ERROR, "%s: failed to decompress pak file '%s'!\n",
 			__FUNCTION__, inPakFile);
@@ -882,18 +1237,73 @@ bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
-	const PakFileHeader_s* const outHeader = reinterpret_cast<PakFileHeader_s*>(outPakBuf);
+	Pak_SetDecodedHeader(outHeader);
 
 	// NOTE: if the paks this particular pak patches have different sizes than
 	// current sizes in the patch header, the runtime will crash!
-	if (outHeader->patchIndex && !Pak_UpdatePatchHeaders(outPakBuf, outPakFile))
+	if (outHeader->patchIndex && !Pak_UpdatePatchHeaders(headerBuf, outPakFile))
 	{
 		Warning(eDLL_T::RTECH, "%s: pak '%s' is a patch pak, but the pak(s) it patches weren't found; patch headers not updated!\n",
 			__FUNCTION__, inPakFile);
 	}
 
-	outPakStream.Write(outPakBuf, outHeader->decompressedSize);
+	outPakStream.SeekPut(0);
+	outPakStream.Write(headerBuf, headerDataSize);
+
+	const double elapsedTime = Max(Plat_FloatTime() - startTime, 0.000001);
+	const double throughput = (outHeader->decompressedSize / elapsedTime) / (1024.0 * 1024.0);
+
+	Msg(eDLL_T::RTECH, "Decompressed pak file to: '%s' in %.3f seconds (%.2f MB/s)\n",
+		outPakFile, elapsedTime, throughput);
 
-	Msg(eDLL_T::RTECH, "Decompressed pak file to: '%s'\n", outPakFile);
 	return true;
 }
+
+//-----------------------------------------------------------------------------
+// decodes a batch of pak files concurrently, workers not used for decoding
+// separate files will be used to decode frames of multi-frame encoded paks;
+// returns the number of pak files that have been decoded successfully
+//-----------------------------------------------------------------------------
+int Pak_DecodePakFiles(const char* const* const inPakFiles, const char* const* const outPakFiles,
+	const int numPakFiles, const int workerCount)
+{
+	if (numPakFiles <= 0)
+		return 0;
+
+	const double startTime = Plat_FloatTime();
+
+	const int fileWorkerCount = Clamp(workerCount, 1, numPakFiles);
+	const int frameWorkerCount = Max(workerCount / fileWorkerCount, 1);
+
+	std::atomic<int> nextPakFile(0);
+	std::atomic<int> numDecoded(0);
+
+	const auto workerFunc = [&]()
+	{
+		for (int i = nextPakFile++; i < numPakFiles; i = nextPakFile++)
+		{
+			if (Pak_DecodePakFile(inPakFiles[i], outPakFiles[i], frameWorkerCount))
+				numDecoded++;
+			else
+			{
+				Error(eDLL_T::RTECH, NO_ERROR, "%s: decompression failed for '%s'!\n",
+					__FUNCTION__, inPakFiles[i]);
+			}
+		}
+	};
+
+	CParallelTaskGroup workers;
+
+	// the calling thread participates as well; each file's frames are decoded
+	// on the same pool, waiting on them runs other queued work meanwhile
+	for (int i = 1; i < fileWorkerCount; i++)
+		workers.Run(workerFunc);
+
+	workerFunc();
+	workers.Wait();
+
+	Msg(eDLL_T::RTECH, "Decompressed '%i' of '%i' pak files in %.3f seconds\n",
+		numDecoded.load(), numPakFiles, Plat_FloatTime() - startTime);
+
+	return numDecoded;
+}
@@ -9,6 +9,12 @@ extern size_t Pak_InitDecoder(PakDecoder_s* const decoder, const uint8_t* const
 extern bool Pak_StreamToBufferDecode(PakDecoder_s* const decoder, const size_t inLen, const size_t outLen, const PakDecodeMode_e decodeMode);
 extern bool Pak_BufferToBufferDecode(uint8_t* const inBuf, uint8_t* const outBuf, const size_t pakSize, const PakDecodeMode_e decodeMode);
 
-extern bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile);
+extern const PakZStdFrameIndexHeader_s* Pak_GetZStdFrameIndex(const uint8_t* const encodedData, const size_t encodedSize);
+extern bool Pak_GetZStdFrame(const PakZStdFrameIndexHeader_s* const frameIndex, const uint32_t frameNum,
+	const size_t encodedFileSize, PakZStdFrame_s* const outFrame);
+
+extern bool Pak_DecodePakFile(const char* const inPakFile, const char* const outPakFile, const int workerCount);
+extern int Pak_DecodePakFiles(const char* const* const inPakFiles, const char* const* const outPakFiles,
+	const int numPakFiles, const int workerCount);
 
 #endif // RTECH_PAKDECODE_H
@@ -4,6 +4,7 @@
 //
 //=============================================================================//
 #include "tier0/binstream.h"
+#include "mathlib/parallel_for.h"
 #include "rtech/ipakfile.h"
 #include "paktools.h"
 #include "pakencode.h"
@@ -24,14 +25,315 @@ static const char* Pak_GetEncodeError(const size_t result)
 	return ZSTD_getErrorName(result);
 }
 
+//-----------------------------------------------------------------------------
+// returns the encode error code as result, zstd encodes error codes as negated
+// values
+//-----------------------------------------------------------------------------
+static size_t Pak_GetEncodeErrorResult(const ZSTD_ErrorCode error)
+{
+	return static_cast<size_t>(-static_cast<int>(error));
+}
+
+//-----------------------------------------------------------------------------
+// sets the compressed size and flags on the header of an encoded pak
+//-----------------------------------------------------------------------------
+static void Pak_SetEncodedHeader(PakFileHeader_s* const outHeader, const size_t compressSize)
+{
+	// the compressed size includes the entire buffer, even the data we didn't
+	// compress like the file header
+	outHeader->compressedSize = compressSize + sizeof(PakFileHeader_s);
+
+	// these flags are required for the game's runtime to decide whether or not to
+	// decompress the pak, and how; see Pak_ProcessPakFile() for more details
+	outHeader->flags |= PAK_HEADER_FLAGS_COMPRESSED;
+	outHeader->flags |= PAK_HEADER_FLAGS_ZSTREAM_ENCODED;
+}
+
+//-----------------------------------------------------------------------------
+// returns the size of the skippable frame containing the frame index
+//-----------------------------------------------------------------------------
+static size_t Pak_GetFrameIndexSize(const size_t srcLen)
+{
+	const size_t frameCount = (srcLen + PAK_ZSTD_DEFAULT_FRAME_SIZE - 1) / PAK_ZSTD_DEFAULT_FRAME_SIZE;
+	return ZSTD_SKIPPABLEHEADERSIZE + sizeof(PakZStdFrameIndexHeader_s) + (frameCount * sizeof(PakZStdFrameIndexEntry_s));
+}
+
+//-----------------------------------------------------------------------------
+// writes the skippable frame containing the frame index, the entries are
+// filled in while the frames are getting encoded
+//-----------------------------------------------------------------------------
+static PakZStdFrameIndexHeader_s* Pak_WriteFrameIndex(uint8_t* const dstBuf, const size_t srcLen)
+{
+	const size_t indexSize = Pak_GetFrameIndexSize(srcLen) - ZSTD_SKIPPABLEHEADERSIZE;
+
+	*reinterpret_cast<uint32_t*>(&dstBuf[0]) = ZSTD_MAGIC_SKIPPABLE_START + PAK_ZSTD_FRAME_INDEX_SKIPPABLE_VARIANT;
+	*reinterpret_cast<uint32_t*>(&dstBuf[sizeof(uint32_t)]) = static_cast<uint32_t>(indexSize);
+
+	PakZStdFrameIndexHeader_s* const frameIndex = reinterpret_cast<PakZStdFrameIndexHeader_s*>(&dstBuf[ZSTD_SKIPPABLEHEADERSIZE]);
+
+	frameIndex->magic = PAK_ZSTD_FRAME_INDEX_MAGIC;
+	frameIndex->version = PAK_ZSTD_FRAME_INDEX_VERSION;
+	frameIndex->reserved = 0;
+	frameIndex->frameCount = static_cast<uint32_t>((srcLen + PAK_ZSTD_DEFAULT_FRAME_SIZE - 1) / PAK_ZSTD_DEFAULT_FRAME_SIZE);
+	frameIndex->frameSize = static_cast<uint32_t>(PAK_ZSTD_DEFAULT_FRAME_SIZE);
+	frameIndex->decompressedSize = srcLen;
+
+	return frameIndex;
+}
+
+//-----------------------------------------------------------------------------
+// encodes the data as multiple independent frames on a pool of worker threads
+// the frames are handed to the write callback in order, so the output is the
+// same regardless of the amount of workers used, and at most one encoded
+// frame per worker is held in memory
+//
+// if prefixData is provided, it replaces the first prefixLen bytes of srcBuf
+// without having to modify the source, used for updated patch headers
+//-----------------------------------------------------------------------------
+static size_t Pak_EncodeFrames(const uint8_t* const srcBuf, const size_t srcLen,
+	const uint8_t* const prefixData, const size_t prefixLen, PakZStdFrameIndexHeader_s* const frameIndex,
+	const int level, const int workerCount, const std::function<bool(const uint8_t* const, const size_t)>& writeFunc)
+{
+	const size_t frameSize = frameIndex->frameSize;
+	const uint32_t frameCount = frameIndex->frameCount;
+
+	PakZStdFrameIndexEntry_s* const entries = const_cast<PakZStdFrameIndexEntry_s*>(frameIndex->GetEntries());
+
+	std::atomic<uint32_t> nextFrame(0);
+	std::atomic<size_t> encodeError(0);
+
+	std::mutex writeMutex;
+	std::condition_variable writeCondition;
+	uint32_t nextWriteFrame = 0;
+	size_t totalSize = 0;
+
+	// each worker owns a compression context and keeps grabbing the next frame
+	// until all of them have been encoded
+	const auto workerFunc = [&]()
+	{
+		ZSTD_CCtx* const cctx = ZSTD_createCCtx();
+
+		const size_t frameBound = ZSTD_compressBound(frameSize);
+		std::unique_ptr<uint8_t[]> frameBufContainer(new uint8_t[frameBound]);
+		std::unique_ptr<uint8_t[]> prefixBufContainer;
+
+		for (uint32_t i = nextFrame++; i < frameCount; i = nextFrame++)
+		{
+			const size_t frameOffset = i * frameSize;
+			const size_t frameLen = Min(frameSize, srcLen - frameOffset);
+
+			const uint8_t* frameSrc = &srcBuf[frameOffset];
+
+			// this frame overlaps the replaced data; encode from a copy
+			if (frameOffset < prefixLen)
+			{
+				if (!prefixBufContainer)
+					prefixBufContainer.reset(new uint8_t[frameSize]);
+
+				memcpy(prefixBufContainer.get(), frameSrc, frameLen);
+				memcpy(prefixBufContainer.get(), &prefixData[frameOffset], Min(prefixLen - frameOffset, frameLen));
+
+				frameSrc = prefixBufContainer.get();
+			}
+
+			const size_t result = cctx
+				? ZSTD_compressCCtx(cctx, frameBufContainer.get(), frameBound, frameSrc, frameLen, level)
+				: Pak_GetEncodeErrorResult(ZSTD_error_memory_allocation);
+
+			std::unique_lock<std::mutex> lock(writeMutex);
+			writeCondition.wait(lock, [&]() { return nextWriteFrame == i; });
+
+			if (!encodeError)
+			{
+				if (Pak_HasEncodeFailed(result))
+					encodeError = result;
+				else if (!writeFunc(frameBufContainer.get(), result))
+					encodeError = Pak_GetEncodeErrorResult(ZSTD_error_dstSize_tooSmall);
+				else
+				{
+					entries[i].compressedSize = static_cast<uint32_t>(result);
+					entries[i].decompressedSize = static_cast<uint32_t>(frameLen);
+
+					totalSize += result;
+				}
+			}
+
+			nextWriteFrame++;
+			writeCondition.notify_all();
+		}
+
+		ZSTD_freeCCtx(cctx);
+	};
+
+	const uint32_t threadCount = Min(static_cast<uint32_t>(Max(workerCount, 1)), frameCount);
+	CParallelTaskGroup workers;
+
+	// the calling thread participates as well
+	for (uint32_t i = 1; i < threadCount; i++)
+		workers.Run(workerFunc);
+
+	workerFunc();
+	workers.Wait();
+
+	if (encodeError)
+		return encodeError;
+
+	return totalSize;
+}
+
+//-----------------------------------------------------------------------------
+// encodes the pak data as multiple independent frames on a pool of worker
+// threads, the frames are preceded by a frame index which is stored in a
+// skippable frame; the decoder parses the total decompressed size from there
+// and skips over the rest, see Pak_ZStdDecoderInit() for more details
+//-----------------------------------------------------------------------------
+static size_t Pak_FrameEncode(uint8_t* const dstBuf, const size_t dstLen,
+	const uint8_t* const srcBuf, const size_t srcLen, const int level, const int workerCount)
+{
+	const size_t indexFrameSize = Pak_GetFrameIndexSize(srcLen);
+
+	if (dstLen < indexFrameSize)
+		return Pak_GetEncodeErrorResult(ZSTD_error_dstSize_tooSmall);
+
+	PakZStdFrameIndexHeader_s* const frameIndex = Pak_WriteFrameIndex(dstBuf, srcLen);
+	size_t writePos = indexFrameSize;
+
+	const size_t result = Pak_EncodeFrames(srcBuf, srcLen, nullptr, 0, frameIndex, level, workerCount,
+		[&](const uint8_t* const frameData, const size_t frameLen)
+		{
+			if (writePos + frameLen > dstLen)
+				return false;
+
+			memcpy(&dstBuf[writePos], frameData, frameLen);
+			writePos += frameLen;
+
+			return true;
+		});
+
+	if (Pak_HasEncodeFailed(result))
+		return result;
+
+	return indexFrameSize + result;
+}
+
+//-----------------------------------------------------------------------------
+// encodes the pak data as multiple independent frames, and writes them to the
+// stream as soon as they are done; the stream position must be at the end of
+// the pak file header
+//-----------------------------------------------------------------------------
+static size_t Pak_FrameEncodeToStream(CIOStream& outStream, const uint8_t* const srcBuf, const size_t srcLen,
+	const uint8_t* const prefixData, const size_t prefixLen, const int level, const int workerCount)
+{
+	const size_t indexFrameSize = Pak_GetFrameIndexSize(srcLen);
+
+	std::unique_ptr<uint8_t[]> indexBufContainer(new uint8_t[indexFrameSize]);
+	uint8_t* const indexBuf = indexBufContainer.get();
+
+	PakZStdFrameIndexHeader_s* const frameIndex = Pak_WriteFrameIndex(indexBuf, srcLen);
+
+	// the entries are only known once all frames are written, reserve the
+	// space here and write the index again afterwards
+	outStream.Write(indexBuf, indexFrameSize);
+
+	const size_t result = Pak_EncodeFrames(srcBuf, srcLen, prefixData, prefixLen, frameIndex, level, workerCount,
+		[&](const uint8_t* const frameData, const size_t frameLen)
+		{
+			outStream.Write(frameData, frameLen);
+			return outStream.IsWritable();
+		});
+
+	if (Pak_HasEncodeFailed(result))
+		return result;
+
+	outStream.SeekPut(sizeof(PakFileHeader_s));
+	outStream.Write(indexBuf, indexFrameSize);
+
+	return indexFrameSize + result;
+}
+
+//-----------------------------------------------------------------------------
+// encodes the pak data as a single frame, and writes the output to the stream
+// in chunks; the pledged source size makes sure the decompressed size ends up
+// in the frame header, see Pak_BufferToBufferEncode()
+//-----------------------------------------------------------------------------
+static size_t Pak_StreamEncode(CIOStream& outStream, const uint8_t* const srcBuf, const size_t srcLen,
+	const uint8_t* const prefixData, const size_t prefixLen, const int level)
+{
+	ZSTD_CCtx* const cctx = ZSTD_createCCtx();
+
+	if (!cctx)
+		return Pak_GetEncodeErrorResult(ZSTD_error_memory_allocation);
+
+	size_t result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+
+	if (!Pak_HasEncodeFailed(result))
+		result = ZSTD_CCtx_setPledgedSrcSize(cctx, srcLen);
+
+	if (Pak_HasEncodeFailed(result))
+	{
+		ZSTD_freeCCtx(cctx);
+		return result;
+	}
+
+	const size_t outChunkSize = ZSTD_CStreamOutSize();
+
+	std::unique_ptr<uint8_t[]> outChunkContainer(new uint8_t[outChunkSize]);
+	uint8_t* const outChunk = outChunkContainer.get();
+
+	// the replaced data is fed first, followed by the rest of the source
+	const ZSTD_inBuffer inputs[] = {
+		{ prefixData, prefixLen, NULL },
+		{ &srcBuf[prefixLen], srcLen - prefixLen, NULL }
+	};
+
+	size_t totalSize = 0;
+
+	for (size_t i = 0; i < V_ARRAYSIZE(inputs); i++)
+	{
+		ZSTD_inBuffer inBuffer = inputs[i];
+		const ZSTD_EndDirective mode = (i == V_ARRAYSIZE(inputs) - 1) ? ZSTD_e_end : ZSTD_e_continue;
+
+		bool finished = false;
+
+		while (!finished)
+		{
+			ZSTD_outBuffer outBuffer = { outChunk, outChunkSize, NULL };
+			result = ZSTD_compressStream2(cctx, &outBuffer, &inBuffer, mode);
+
+			if (Pak_HasEncodeFailed(result))
+			{
+				ZSTD_freeCCtx(cctx);
+				return result;
+			}
+
+			outStream.Write(outChunk, outBuffer.pos);
+			totalSize += outBuffer.pos;
+
+			// on the last input, the frame must be flushed completely
+			finished = (mode == ZSTD_e_end) ? (result == NULL) : (inBuffer.pos == inBuffer.size);
+		}
+	}
+
+	ZSTD_freeCCtx(cctx);
+
+	if (!outStream.IsWritable())
+		return Pak_GetEncodeErrorResult(ZSTD_error_dstSize_tooSmall);
+
+	return totalSize;
+}
+
 //-----------------------------------------------------------------------------
 // encodes the pak file from buffer, we can't do streamed compression as we
 // need to know the actual decompress size ahead of time, else the runtime will
 // fail as we wouldn't be able to parse the decompressed size from the frame
 // header
+//
+// if workerCount is above 0, the data will be encoded as multiple independent
+// frames across the given amount of threads; only the SDK's decoder is able
+// to decode those, see Pak_ZStdStreamDecode()
 //-----------------------------------------------------------------------------
 bool Pak_BufferToBufferEncode(const uint8_t* const inBuf, const uint64_t inLen,
-	uint8_t* const outBuf, const uint64_t outLen, const int level)
+	uint8_t* const outBuf, const uint64_t outLen, const int level, const int workerCount)
 {
 	// offset to the actual pak data, the main file header shouldn't be
 	// compressed
@@ -45,7 +347,10 @@ bool Pak_BufferToBufferEncode(const uint8_t* const inBuf, const uint64_t inLen,
 
 	size_t compressSize = NULL;
 
-	compressSize = ZSTD_compress(dstBuf, dstLen, srcBuf, srcLen, level);
+	if (workerCount > 0)
+		compressSize = Pak_FrameEncode(dstBuf, dstLen, srcBuf, srcLen, level, workerCount);
+	else
+		compressSize = ZSTD_compress(dstBuf, dstLen, srcBuf, srcLen, level);
 
 	if (Pak_HasEncodeFailed(compressSize))
 	{
@@ -56,23 +361,17 @@ bool Pak_BufferToBufferEncode(const uint8_t* const inBuf, const uint64_t inLen,
 	}
 
 	PakFileHeader_s* const outHeader = reinterpret_cast<PakFileHeader_s* const>(outBuf);
-
-	// the compressed size includes the entire buffer, even the data we didn't
-	// compress like the file header
-	outHeader->compressedSize = compressSize + dataOffset;
-
-	// these flags are required for the game's runtime to decide whether or not to
-	// decompress the pak, and how; see Pak_ProcessPakFile() for more details
-	outHeader->flags |= PAK_HEADER_FLAGS_COMPRESSED;
-	outHeader->flags |= PAK_HEADER_FLAGS_ZSTREAM_ENCODED;
+	Pak_SetEncodedHeader(outHeader, compressSize);
 
 	return true;
 }
 
 //-----------------------------------------------------------------------------
-// encodes the pak file from file name
+// encodes the pak file from file name, the input file is memory mapped and the
+// encoded data is streamed to the out file, so the memory usage stays bounded
+// regardless of the pak size
 //-----------------------------------------------------------------------------
-bool Pak_EncodePakFile(const char* const inPakFile, const char* const outPakFile, const int level)
+bool Pak_EncodePakFile(const char* const inPakFile, const char* const outPakFile, const int level, const int workerCount)
 {
 	if (!Pak_CreateBasePath())
 	{
@@ -82,9 +381,9 @@ bool Pak_EncodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
-	CIOStream inPakStream;
+	CMappedFile inPakMap;
 
-	if (!inPakStream.Open(inPakFile, CIOStream::Mode_e::Read))
+	if (!inPakMap.Open(inPakFile))
 	{
 		Error(eDLL_T::RTECH, NO_ERROR, "%s: failed to open pak file '%s' for read!\n",
 			__FUNCTION__, inPakFile);
@@ -102,7 +401,7 @@ bool Pak_EncodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
-	const size_t fileSize = inPakStream.GetSize();
+	const size_t fileSize = inPakMap.GetSize();
 
 	// file appears truncated
 	if (fileSize <= sizeof(PakFileHeader_s))
@@ -113,13 +412,8 @@ bool Pak_EncodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
-	std::unique_ptr<uint8_t[]> inPakBufContainer(new uint8_t[fileSize]);
-	uint8_t* const inPakBuf = inPakBufContainer.get();
-
-	inPakStream.Read(inPakBuf, fileSize);
-	inPakStream.Close();
-
-	const PakFileHeader_s* const inHeader = reinterpret_cast<PakFileHeader_s* const>(inPakBuf);
+	const uint8_t* const inPakBuf = inPakMap.GetData();
+	const PakFileHeader_s* const inHeader = reinterpret_cast<const PakFileHeader_s*>(inPakBuf);
 
 	if (inHeader->magic != PAK_HEADER_MAGIC || inHeader->version != PAK_HEADER_VERSION)
 	{
@@ -145,39 +439,61 @@ bool Pak_EncodePakFile(const char* const inPakFile, const char* const outPakFile
 		return false;
 	}
 
+	const size_t headerDataSize = Pak_GetHeaderDataSize(inHeader);
+
+	if (headerDataSize > fileSize)
+	{
+		Error(eDLL_T::RTECH, NO_ERROR, "%s: pak '%s' has a corrupt header!\n",
+			__FUNCTION__, inPakFile);
+
+		return false;
+	}
+
+	// the input is mapped read only, the header data gets updated in a copy
+	// which replaces the original data during encoding
+	std::unique_ptr<uint8_t[]> headerBufContainer(new uint8_t[headerDataSize]);
+	uint8_t* const headerBuf = headerBufContainer.get();
+
+	memcpy(headerBuf, inPakBuf, headerDataSize);
+
 	// NOTE: if the paks this particular pak patches have different sizes than
 	// current sizes in the patch header, the runtime will crash!
-	if (inHeader->patchIndex && !Pak_UpdatePatchHeaders(inPakBuf, outPakFile))
+	if (inHeader->patchIndex && !Pak_UpdatePatchHeaders(headerBuf, outPakFile))
 	{
 		Warning(eDLL_T::RTECH, "%s: pak '%s' is a patch pak, but the pak(s) it patches weren't found; patch headers not updated!\n",
 			__FUNCTION__, inPakFile);
 	}
 
-	const size_t outBufSize = inHeader->decompressedSize;
+	PakFileHeader_s* const outHeader = reinterpret_cast<PakFileHeader_s* const>(headerBuf);
+
+	// the header gets written again once we know the compressed size
+	outPakStream.Write(headerBuf, sizeof(PakFileHeader_s));
 
-	std::unique_ptr<uint8_t[]> outPakBufContainer(new uint8_t[outBufSize]);
-	uint8_t* const outPakBuf = outPakBufContainer.get();
+	const uint8_t* const srcBuf = &inPakBuf[sizeof(PakFileHeader_s)];
+	const size_t srcLen = fileSize - sizeof(PakFileHeader_s);
 
-	PakFileHeader_s* const outHeader = reinterpret_cast<PakFileHeader_s* const>(outPakBuf);
+	const uint8_t* const prefixData = &headerBuf[sizeof(PakFileHeader_s)];
+	const size_t prefixLen = headerDataSize - sizeof(PakFileHeader_s);
 
-	// copy the header over
-	*outHeader = *inHeader;
+	const size_t compressSize = workerCount > 0
+		? Pak_FrameEncodeToStream(outPakStream, srcBuf, srcLen, prefixData, prefixLen, level, workerCount)
+		: Pak_StreamEncode(outPakStream, srcBuf, srcLen, prefixData, prefixLen, level);
 
 	// encoding failed
-	if (!Pak_BufferToBufferEncode(inPakBuf, fileSize, outPakBuf, outBufSize, level))
+	if (Pak_HasEncodeFailed(compressSize))
 	{
-		Error(eDLL_T::RTECH, NO_ERROR, "%s: failed to compress pak file '%s'!\n",
-			__FUNCTION__, inPakFile);
+		Error(eDLL_T::RTECH, NO_ERROR, "%s: failed to compress pak file '%s'! [%s]\n",
+			__FUNCTION__, inPakFile, Pak_GetEncodeError(compressSize));
 
 		return false;
 	}
 
-	const PakFileHeader_s* const outPakHeader = reinterpret_cast<PakFileHeader_s* const>(outPakBuf);
+	Pak_SetEncodedHeader(outHeader, compressSize);
 
-	Pak_ShowHeaderDetails(outPakHeader);
+	outPakStream.SeekPut(0);
+	outPakStream.Write(outHeader, sizeof(PakFileHeader_s));
 
-	// this will be true if the entire buffer has been written
-	outPakStream.Write(outPakBuf, outPakHeader->compressedSize);
+	Pak_ShowHeaderDetails(outHeader);
 
 	Msg(eDLL_T::RTECH, "Compressed pak file to: '%s'\n", outPakFile);
 	return true;
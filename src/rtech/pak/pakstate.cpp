@@ -4,6 +4,7 @@
 //
 //=============================================================================//
 #include "tier1/fmtstr.h"
+#include "mathlib/parallel_for.h"
 #include "common/completion.h"
 #include "rtech/ipakfile.h"
 #include "pakencode.h"
@@ -219,13 +220,52 @@ static void Pak_Decompress_f(const CCommand& args)
 	const CFmtStr1024 inPakFile(PAK_PLATFORM_PATH "%s", args.Arg(1));
 	const CFmtStr1024 outPakFile(PAK_PLATFORM_OVERRIDE_PATH "%s", args.Arg(1));
 
-	if (!Pak_DecodePakFile(inPakFile.String(), outPakFile.String()))
+	if (!Pak_DecodePakFile(inPakFile.String(), outPakFile.String(), parallel_thread_count()))
 	{
 		Error(eDLL_T::RTECH, NO_ERROR, "%s - decompression failed for '%s'!\n",
 			__FUNCTION__, inPakFile.String());
 	}
 }
 
+/*
+=====================
+Pak_DecompressBatch_f
+
+  Decompresses all input RPak files
+  concurrently and dumps results to
+  override path
+=====================
+*/
+static void Pak_DecompressBatch_f(const CCommand& args)
+{
+	if (args.ArgC() < 2)
+	{
+		return;
+	}
+
+	const int numPakFiles = args.ArgC() - 1;
+
+	CUtlVector<CUtlString> inPakFiles;
+	CUtlVector<CUtlString> outPakFiles;
+
+	inPakFiles.SetSize(numPakFiles);
+	outPakFiles.SetSize(numPakFiles);
+
+	CUtlVector<const char*> inPakFilePtrs;
+	CUtlVector<const char*> outPakFilePtrs;
+
+	for (int i = 0; i < numPakFiles; i++)
+	{
+		inPakFiles[i].Format(PAK_PLATFORM_PATH "%s", args.Arg(i + 1));
+		outPakFiles[i].Format(PAK_PLATFORM_OVERRIDE_PATH "%s", args.Arg(i + 1));
+
+		inPakFilePtrs.AddToTail(inPakFiles[i].String());
+		outPakFilePtrs.AddToTail(outPakFiles[i].String());
+	}
+
+	Pak_DecodePakFiles(inPakFilePtrs.Base(), outPakFilePtrs.Base(), numPakFiles, parallel_thread_count());
+}
+
 /*
 =====================
 Pak_Compress_f
@@ -247,7 +287,11 @@ static void Pak_Compress_f(const CCommand& args)
 	// NULL means default compress level
 	const int compressLevel = args.ArgC() > 2 ? atoi(args.Arg(2)) : NULL;
 
-	if (!Pak_EncodePakFile(inPakFile.String(), outPakFile.String(), compressLevel))
+	// NULL means single frame, anything above encodes the pak as multiple
+	// frames using this many worker threads
+	const int workerCount = args.ArgC() > 3 ? atoi(args.Arg(3)) : NULL;
+
+	if (!Pak_EncodePakFile(inPakFile.String(), outPakFile.String(), compressLevel, workerCount))
 	{
 		Error(eDLL_T::RTECH, NO_ERROR, "%s - compression failed for '%s'!\n",
 			__FUNCTION__, inPakFile.String());
@@ -258,6 +302,7 @@ static ConCommand pak_stringtoguid("pak_stringtoguid", Pak_StringToGUID_f, "Comp
 
 static ConCommand pak_compress("pak_compress", Pak_Compress_f, "Compresses specified RPAK file", FCVAR_DEVELOPMENTONLY, RTech_PakCompress_f_CompletionFunc);
 static ConCommand pak_decompress("pak_decompress", Pak_Decompress_f, "Decompresses specified RPAK file", FCVAR_DEVELOPMENTONLY, RTech_PakDecompress_f_CompletionFunc);
+static ConCommand pak_decompress_batch("pak_decompress_batch", Pak_DecompressBatch_f, "Decompresses all specified RPAK files concurrently", FCVAR_DEVELOPMENTONLY, RTech_PakDecompress_f_CompletionFunc);
 
 static ConCommand pak_requestload("pak_requestload", Pak_RequestLoad_f, "Requests asynchronous load for specified RPAK file", FCVAR_DEVELOPMENTONLY, RTech_PakLoad_f_CompletionFunc);
 static ConCommand pak_requestunload("pak_requestunload", Pak_RequestUnload_f, "Requests asynchronous unload for specified RPAK file or ID", FCVAR_DEVELOPMENTONLY, RTech_PakUnload_f_CompletionFunc);
@@ -325,6 +325,25 @@ short Pak_GetPatchNumberForIndex(PakFileHeader_s* const pakHeader, const int ind
 	return patchNumber[index];
 }
 
+//-----------------------------------------------------------------------------
+// returns the size of the leading pak data up to and including the patch
+// headers; this is the data that must be updated when repacking a pak file
+//-----------------------------------------------------------------------------
+size_t Pak_GetHeaderDataSize(const PakFileHeader_s* const pakHeader)
+{
+	size_t headerSize = sizeof(PakFileHeader_s);
+
+	if (pakHeader->patchIndex > 0)
+	{
+		headerSize += sizeof(PakPatchDataHeader_s);
+
+		// patch file headers are followed by a patch number for each patch
+		headerSize += pakHeader->patchIndex * (sizeof(PakPatchFileHeader_s) + sizeof(short));
+	}
+
+	return headerSize;
+}
+
 //-----------------------------------------------------------------------------
 // searches for pak patches and updates all referenced files in patch headers
 //-----------------------------------------------------------------------------
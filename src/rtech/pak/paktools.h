@@ -24,6 +24,7 @@ extern PakPatchDataHeader_s* Pak_GetPatchDataHeader(PakFileHeader_s* const pakHe
 extern PakPatchFileHeader_s* Pak_GetPatchFileHeader(PakFileHeader_s* const pakHeader, const int index);
 extern short Pak_GetPatchNumberForIndex(PakFileHeader_s* const pakHeader, const int index);
 
+extern size_t Pak_GetHeaderDataSize(const PakFileHeader_s* const pakHeader);
 extern bool Pak_UpdatePatchHeaders(uint8_t* const inBuf, const char* const outPakFile);
 
 extern void Pak_ShowHeaderDetails(const PakFileHeader_s* const pakHeader);
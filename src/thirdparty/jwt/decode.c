@@ -597,7 +597,13 @@ static int l8w8jwt_verify_signature(const struct l8w8jwt_decoding_params* params
         case L8W8JWT_ALG_RS384:
         case L8W8JWT_ALG_RS512: {
 
-            if (!is_cert)
+            mbedtls_pk_context* verify_pk = &pk;
+
+            if (params->verification_pk != NULL)
+            {
+                verify_pk = (mbedtls_pk_context*)params->verification_pk;
+            }
+            else if (!is_cert)
             {
                 r = mbedtls_pk_parse_public_key(&pk, key, key_length);
                 if (r != 0)
@@ -607,7 +613,7 @@ static int l8w8jwt_verify_signature(const struct l8w8jwt_decoding_params* params
                 }
             }
 
-            r = mbedtls_pk_verify(&pk, md_type, hash, md_length, (const unsigned char*)signature, signature_length);
+            r = mbedtls_pk_verify(verify_pk, md_type, hash, md_length, (const unsigned char*)signature, signature_length);
             if (r != 0)
             {
                 *out_validation_res |= (unsigned)L8W8JWT_SIGNATURE_VERIFICATION_FAILURE;
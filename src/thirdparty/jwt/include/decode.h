@@ -252,6 +252,13 @@ struct l8w8jwt_decoding_params
      * validate_typ string length.
      */
     size_t validate_typ_length;
+
+    /**
+     * [OPTIONAL] Pre-parsed <code>mbedtls_pk_context*</code> of the {@link #verification_key} (RS256/384/512 only). <p>
+     * Set this to skip parsing the PEM key on every decode. The context is only read from, but mbedtls may
+     * cache values in it on first use; don't share it between threads!
+     */
+    void* verification_pk;
 };
 
 /**
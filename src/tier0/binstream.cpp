@@ -379,3 +379,210 @@ void CIOStream::CalcSkipDelta(const std::streamoff offset, const std::ios_base::
 	if (m_skip < 0)
 		m_skip = 0;
 }
+
+//-----------------------------------------------------------------------------
+// Purpose: CMappedFile constructors
+//-----------------------------------------------------------------------------
+CMappedFile::CMappedFile()
+	: m_fileHandle(INVALID_HANDLE_VALUE)
+	, m_mapHandle(NULL)
+	, m_data(nullptr)
+	, m_tailData(nullptr)
+	, m_size(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: CMappedFile destructor
+//-----------------------------------------------------------------------------
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: opens and maps the entire file for read
+// Input  : *filePath - 
+//			readPadding - number of zeroed bytes that must be readable past
+//			the end of the data
+// Output : true if operation is successful
+//-----------------------------------------------------------------------------
+bool CMappedFile::Open(const char* const filePath, const size_t readPadding)
+{
+	Close();
+
+	// the data is generally processed from front to back
+	m_fileHandle = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+
+	// empty files can't be mapped
+	if (!GetFileSizeEx(m_fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_mapHandle = CreateFileMappingA(m_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (!m_mapHandle)
+	{
+		Close();
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(fileSize.QuadPart);
+
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+
+	// the view is rounded up to whole pages, which are zero filled past the
+	// end of the file; only pad if that isn't enough
+	const size_t pageSlack = (0 - size) & (systemInfo.dwPageSize - 1);
+
+	if (readPadding > pageSlack)
+	{
+		if (!MapPadded(size, readPadding, systemInfo))
+		{
+			Close();
+			return false;
+		}
+	}
+	else
+	{
+		m_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(m_mapHandle, FILE_MAP_READ, 0, 0, 0));
+
+		if (!m_data)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	m_size = size;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: maps the file up to the last allocation granularity boundary, and
+//			places a zero padded copy of the remainder right after the view
+// Input  : fileSize - 
+//			readPadding - 
+//			&systemInfo - 
+// Output : true if operation is successful
+//-----------------------------------------------------------------------------
+bool CMappedFile::MapPadded(const size_t fileSize, const size_t readPadding, const SYSTEM_INFO& systemInfo)
+{
+	const size_t granularity = systemInfo.dwAllocationGranularity;
+	const size_t pageSize = systemInfo.dwPageSize;
+
+	// views and allocations both start at an allocation granularity boundary,
+	// so the view can only cover the file up to the last one
+	const size_t headSize = fileSize & ~(granularity - 1);
+	const size_t tailSize = fileSize - headSize;
+	const size_t tailAllocSize = (tailSize + readPadding + pageSize - 1) & ~(pageSize - 1);
+
+	// this is less than one allocation granularity worth of data, and there
+	// is nothing to copy if the file ends right at a boundary
+	const uint8_t* tailView = nullptr;
+
+	if (tailSize)
+	{
+		tailView = reinterpret_cast<const uint8_t*>(MapViewOfFile(m_mapHandle,
+			FILE_MAP_READ, DWORD(uint64_t(headSize) >> 32), DWORD(headSize), tailSize));
+
+		if (!tailView)
+			return false;
+	}
+
+	// find a range where both fit by reserving it, then release it and place
+	// the view and the tail there; another thread could take the range in
+	// between, so try again if that happens
+	for (int attempt = 0; attempt < 16; attempt++)
+	{
+		uint8_t* const base = reinterpret_cast<uint8_t*>(VirtualAlloc(NULL, headSize + tailAllocSize, MEM_RESERVE, PAGE_NOACCESS));
+
+		if (!base)
+			break;
+
+		VirtualFree(base, 0, MEM_RELEASE);
+
+		const uint8_t* headView = nullptr;
+
+		if (headSize)
+		{
+			headView = reinterpret_cast<const uint8_t*>(MapViewOfFileEx(m_mapHandle, FILE_MAP_READ, 0, 0, headSize, base));
+
+			if (!headView)
+				continue;
+		}
+
+		// committed pages are zero filled, which makes up the padding
+		uint8_t* const tail = reinterpret_cast<uint8_t*>(VirtualAlloc(base + headSize, tailAllocSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+
+		if (!tail)
+		{
+			if (headView)
+				UnmapViewOfFile(headView);
+
+			continue;
+		}
+
+		if (tailView)
+		{
+			memcpy(tail, tailView, tailSize);
+			UnmapViewOfFile(tailView);
+		}
+
+		DWORD oldProtect;
+		VirtualProtect(tail, tailAllocSize, PAGE_READONLY, &oldProtect);
+
+		m_data = headView ? headView : tail;
+		m_tailData = tail;
+
+		return true;
+	}
+
+	if (tailView)
+		UnmapViewOfFile(tailView);
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: unmaps and closes the file
+//-----------------------------------------------------------------------------
+void CMappedFile::Close()
+{
+	if (m_data)
+	{
+		if (m_data != m_tailData)
+			UnmapViewOfFile(m_data);
+
+		m_data = nullptr;
+	}
+
+	if (m_tailData)
+	{
+		VirtualFree(m_tailData, 0, MEM_RELEASE);
+		m_tailData = nullptr;
+	}
+
+	if (m_mapHandle)
+	{
+		CloseHandle(m_mapHandle);
+		m_mapHandle = NULL;
+	}
+
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	m_size = 0;
+}
@@ -471,6 +471,7 @@ const CPUInformation& GetCPUInformation(void)
 		pi.m_bSSE42 = (cpuid1.ecx >> 20) & 1;
 		pi.m_b3DNow = Check3DNowTechnology();
 		pi.m_bPOPCNT= (cpuid1.ecx >> 23) & 1;
+		pi.m_bPCLMUL= (cpuid1.ecx >> 1) & 1;
 		pi.m_bAVX   = (cpuid1.ecx >> 28) & 1;
 		pi.m_bHRVSR = (cpuid1.ecx >> 31) & 1;
 		pi.m_szProcessorID = const_cast<char*>(GetProcessorVendorId());
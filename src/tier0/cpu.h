@@ -63,6 +63,7 @@ struct CPUInformation
 		m_bSSE41 : 1,
 		m_bSSE42 : 1,
 		m_bPOPCNT: 1, // Pop count
+		m_bPCLMUL: 1, // Carry-less multiplication
 		m_bAVX   : 1, // Advanced Vector Extensions
 		m_bHRVSR : 1; // Hypervisor
 
@@ -102,6 +103,7 @@ struct CPUInformation
 		m_bSSE41  = false;
 		m_bSSE42  = false;
 		m_bPOPCNT = false;
+		m_bPCLMUL = false;
 		m_bAVX    = false;
 		m_bHRVSR  = false;
 
@@ -7,32 +7,138 @@
 //=============================================================================//
 #include "tier0/frametask.h"
 
+//-----------------------------------------------------------------------------
+// Task pool; tasks are recycled by the main thread onto a shared stack, which
+// producers take over as a whole into their own cache. Taking the whole stack
+// never reads a node another thread may pop, so it is free of ABA issues. The
+// slabs live for the lifetime of the process; a cache is pushed back onto the
+// shared stack when its thread exits, so short lived producers don't take the
+// tasks with them.
+//-----------------------------------------------------------------------------
+static std::atomic<QueuedTask_s*> s_pFreeTasks = nullptr;
+
+struct TaskCache_s
+{
+    ~TaskCache_s()
+    {
+        if (!m_pHead)
+            return;
+
+        QueuedTask_s* tail = m_pHead;
+
+        while (tail->m_pNext)
+            tail = tail->m_pNext;
+
+        QueuedTask_s* head = s_pFreeTasks.load(std::memory_order_relaxed);
+
+        do
+        {
+            tail->m_pNext = head;
+        } while (!s_pFreeTasks.compare_exchange_weak(head, m_pHead,
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    QueuedTask_s* m_pHead = nullptr;
+};
+
+static thread_local TaskCache_s s_CachedTasks;
+
+//-----------------------------------------------------------------------------
+// Purpose: constructor
+//-----------------------------------------------------------------------------
+CFrameTask::CFrameTask()
+    : m_pSubmitted(nullptr)
+    , m_nFrame(0)
+{
+    memset(m_Wheel, 0, sizeof(m_Wheel));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: destructor, releases tasks that never ran
+//-----------------------------------------------------------------------------
+CFrameTask::~CFrameTask()
+{
+    QueuedTask_s* task = m_pSubmitted.exchange(nullptr, std::memory_order_acquire);
+
+    while (task)
+    {
+        QueuedTask_s* const next = task->m_pNext;
+        task->Destroy();
+
+        task = next;
+    }
+
+    for (Bucket_s& bucket : m_Wheel)
+    {
+        for (task = bucket.m_pHead; task; task = task->m_pNext)
+            task->Destroy();
+    }
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: run frame task and process queued calls
 //-----------------------------------------------------------------------------
 void CFrameTask::RunFrame()
 {
-    AUTO_LOCK(m_Mutex);
+    // Take over everything that has been submitted so far, and restore the
+    // submission order as the list is built newest first.
+    QueuedTask_s* submitted = m_pSubmitted.exchange(nullptr, std::memory_order_acquire);
+    QueuedTask_s* ordered = nullptr;
+
+    while (submitted)
+    {
+        QueuedTask_s* const next = submitted->m_pNext;
+
+        submitted->m_pNext = ordered;
+        ordered = submitted;
+
+        submitted = next;
+    }
 
-    for (QueuedTasks_s& delay : m_QueuedTasks)
+    while (ordered)
     {
-        if (delay.m_nDelayedFrames == 0)
+        QueuedTask_s* const next = ordered->m_pNext;
+        Schedule(ordered);
+
+        ordered = next;
+    }
+
+    // Detach the bucket of this frame before running anything, tasks that
+    // aren't due yet (delayed by more frames than the wheel has buckets) are
+    // put back in order.
+    Bucket_s& bucket = m_Wheel[m_nFrame & (FRAMETASK_WHEEL_SIZE - 1)];
+    QueuedTask_s* task = bucket.m_pHead;
+
+    bucket.m_pHead = nullptr;
+    bucket.m_pTail = nullptr;
+
+    while (task)
+    {
+        QueuedTask_s* const next = task->m_pNext;
+
+        if (task->m_nTargetFrame == m_nFrame)
         {
-            delay.m_rFunctor();
+            task->Invoke();
+            task->Destroy();
+
+            FreeTask(task);
         }
         else
         {
-            --delay.m_nDelayedFrames;
+            task->m_pNext = nullptr;
+
+            if (bucket.m_pTail)
+                bucket.m_pTail->m_pNext = task;
+            else
+                bucket.m_pHead = task;
+
+            bucket.m_pTail = task;
         }
-    }
 
-    const auto newEnd = std::remove_if(m_QueuedTasks.begin(), m_QueuedTasks.end(),
-        [](const QueuedTasks_s& delay)
-        {
-            return delay.m_nDelayedFrames == 0;
-        });
+        task = next;
+    }
 
-    m_QueuedTasks.erase(newEnd, m_QueuedTasks.end());
+    m_nFrame++;
 }
 
 //-----------------------------------------------------------------------------
@@ -45,14 +151,83 @@ bool CFrameTask::IsFinished() const
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: adds function to list, to be called after 'i' frames.
-// Input  : functor - 
-//          frames - 
+// Purpose: gets a free task from the pool, can be called from any thread
+// Output : task with uninitialized functor
 //-----------------------------------------------------------------------------
-void CFrameTask::Dispatch(std::function<void()> functor, unsigned int frames)
+QueuedTask_s* CFrameTask::AllocTask()
 {
-    AUTO_LOCK(m_Mutex);
-    m_QueuedTasks.emplace_back(frames, functor);
+    QueuedTask_s*& cache = s_CachedTasks.m_pHead;
+
+    if (!cache)
+        cache = s_pFreeTasks.exchange(nullptr, std::memory_order_acquire);
+
+    if (!cache)
+    {
+        QueuedTask_s* const slab = new QueuedTask_s[FRAMETASK_SLAB_SIZE];
+
+        for (int i = 0; i < FRAMETASK_SLAB_SIZE - 1; i++)
+            slab[i].m_pNext = &slab[i + 1];
+
+        slab[FRAMETASK_SLAB_SIZE - 1].m_pNext = nullptr;
+        cache = slab;
+    }
+
+    QueuedTask_s* const task = cache;
+    cache = task->m_pNext;
+
+    task->m_pNext = nullptr;
+    return task;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: returns a task to the pool, the functor must be destroyed
+// Input  : *task - 
+//-----------------------------------------------------------------------------
+void CFrameTask::FreeTask(QueuedTask_s* const task)
+{
+    QueuedTask_s* head = s_pFreeTasks.load(std::memory_order_relaxed);
+
+    do
+    {
+        task->m_pNext = head;
+    } while (!s_pFreeTasks.compare_exchange_weak(head, task,
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: submits a task, can be called from any thread
+// Input  : *task - 
+//-----------------------------------------------------------------------------
+void CFrameTask::Submit(QueuedTask_s* const task)
+{
+    QueuedTask_s* head = m_pSubmitted.load(std::memory_order_relaxed);
+
+    do
+    {
+        task->m_pNext = head;
+    } while (!m_pSubmitted.compare_exchange_weak(head, task,
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: moves a submitted task into the bucket of its target frame
+// Input  : *task - 
+//-----------------------------------------------------------------------------
+void CFrameTask::Schedule(QueuedTask_s* const task)
+{
+    // A task delayed by 0 frames runs on this frame, matching the behavior
+    // of the decrementing counters this replaced.
+    task->m_nTargetFrame = m_nFrame + task->m_nDelayedFrames;
+    task->m_pNext = nullptr;
+
+    Bucket_s& bucket = m_Wheel[task->m_nTargetFrame & (FRAMETASK_WHEEL_SIZE - 1)];
+
+    if (bucket.m_pTail)
+        bucket.m_pTail->m_pNext = task;
+    else
+        bucket.m_pHead = task;
+
+    bucket.m_pTail = task;
 }
 
 //-----------------------------------------------------------------------------
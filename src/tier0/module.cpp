@@ -194,6 +194,18 @@ CMemory CModule::FindPatternSIMD(const char* szPattern,
 		return CMemory(nRVA + GetModuleBase());
 	}
 
+	// Prefetched patterns are only scanned in the code section.
+	if (!moduleSection && !m_PrefetchedPatterns.empty())
+	{
+		const auto it = m_PrefetchedPatterns.find(szPattern);
+
+		if (it != m_PrefetchedPatterns.end())
+		{
+			g_SigCache.AddEntry(szPattern, it->second);
+			return CMemory(it->second + GetModuleBase());
+		}
+	}
+
 	const pair<vector<uint8_t>, string>
 		patternInfo = PatternToMaskedBytes(szPattern);
 
@@ -204,6 +216,335 @@ CMemory CModule::FindPatternSIMD(const char* szPattern,
 	return memory;
 }
 
+//-----------------------------------------------------------------------------
+// Batch pattern scanning
+//-----------------------------------------------------------------------------
+#define PATTERN_SCAN_MIN_CHUNK_SIZE (1024 * 1024) // Smallest range scanned by a single thread.
+#define PATTERN_SCAN_SAMPLE_STRIDE 1024 // Distance between sampled blocks for the byte histogram.
+#define PATTERN_SCAN_SAMPLE_SIZE 64 // Size of each sampled block.
+
+struct ScanPattern_s
+{
+	vector<uint8_t> bytes; // Padded to a multiple of 16.
+	vector<int> masks; // One bit per byte in each 16-byte block, set if the byte must match.
+	size_t length;
+	size_t anchor; // Offset of the least frequent byte in the pattern.
+};
+
+//-----------------------------------------------------------------------------
+// Purpose: checks whether a string is formatted as a byte pattern, e.g.
+//          "48 8B ?? 89", to tell them apart from other keys in the cache
+// Input  : *szPattern - 
+// Output : true if pattern, false otherwise
+//-----------------------------------------------------------------------------
+static bool IsBytePattern(const char* szPattern)
+{
+	bool bHasByte = false;
+
+	while (*szPattern)
+	{
+		if (szPattern[0] == '?')
+		{
+			szPattern += (szPattern[1] == '?') ? 2 : 1;
+		}
+		else if (isxdigit(static_cast<uint8_t>(szPattern[0])) && isxdigit(static_cast<uint8_t>(szPattern[1])))
+		{
+			szPattern += 2;
+			bHasByte = true;
+		}
+		else
+		{
+			return false;
+		}
+
+		if (*szPattern == ' ')
+			szPattern++;
+		else if (*szPattern)
+			return false;
+	}
+
+	return bHasByte;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: checks a pattern against the data using SIMD instructions
+// Input  : &pattern - 
+//          *pData   - 
+//          bCanRead - whether all 16-byte blocks of the pattern can be read
+// Output : true if matched, false otherwise
+//-----------------------------------------------------------------------------
+static bool MatchScanPattern(const ScanPattern_s& pattern, const uint8_t* const pData, const bool bCanRead)
+{
+	if (!bCanRead)
+	{
+		for (size_t i = 0; i < pattern.length; i++)
+		{
+			if ((pattern.masks[i / 16] & (1 << (i % 16))) && pData[i] != pattern.bytes[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	for (size_t i = 0; i < pattern.masks.size(); i++)
+	{
+		const __m128i xmm1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pattern.bytes[i * 16]));
+		const __m128i xmm2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i * 16));
+
+		if ((_mm_movemask_epi8(_mm_cmpeq_epi8(xmm1, xmm2)) & pattern.masks[i]) != pattern.masks[i])
+			return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: find multiple arrays of bytes in process memory in a single pass,
+//          the memory is split into chunks that are scanned in parallel
+// Input  : *szPatterns    - 
+//          nCount         - 
+//          *pResults      - receives the first match of each pattern
+//          *moduleSection - 
+// Output : number of patterns found
+//-----------------------------------------------------------------------------
+size_t CModule::FindPatternsSIMD(const char* const* szPatterns, const size_t nCount,
+	CMemory* const pResults, const ModuleSections_t* moduleSection) const
+{
+	for (size_t i = 0; i < nCount; i++)
+		pResults[i] = CMemory();
+
+	const ModuleSections_t& executableCode = GetSectionByName(".text");
+
+	if (!executableCode.IsSectionValid() || !nCount)
+		return 0;
+
+	const bool bSectionValid = moduleSection ? moduleSection->IsSectionValid() : false;
+
+	const QWORD nBase = bSectionValid ?
+		moduleSection->m_pSectionBase : executableCode.m_pSectionBase;
+	const QWORD nSize = bSectionValid ?
+		moduleSection->m_nSectionSize : executableCode.m_nSectionSize;
+
+	const uint8_t* const pData = reinterpret_cast<uint8_t*>(nBase);
+
+	// Sample the byte frequencies of the memory, so each pattern can be
+	// anchored on its least common byte.
+	uint32_t nHistogram[256] = {};
+
+	for (QWORD i = 0; i + PATTERN_SCAN_SAMPLE_SIZE <= nSize; i += PATTERN_SCAN_SAMPLE_STRIDE)
+	{
+		for (QWORD j = i; j < i + PATTERN_SCAN_SAMPLE_SIZE; j++)
+			nHistogram[pData[j]]++;
+	}
+
+	vector<ScanPattern_s> patterns(nCount);
+	vector<size_t> anchorCounts(257, 0);
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		ScanPattern_s& pattern = patterns[i];
+		const pair<vector<uint8_t>, string> patternInfo = PatternToMaskedBytes(szPatterns[i]);
+
+		pattern.length = patternInfo.first.size();
+		pattern.bytes = patternInfo.first;
+		pattern.bytes.resize((pattern.length + 15) & ~size_t(15), 0);
+		pattern.masks.resize(pattern.bytes.size() / 16, 0);
+		pattern.anchor = SIZE_MAX;
+
+		for (size_t j = 0; j < pattern.length; j++)
+		{
+			if (patternInfo.second[j] != 'x')
+				continue;
+
+			pattern.masks[j / 16] |= (1 << (j % 16));
+
+			if (pattern.anchor == SIZE_MAX || nHistogram[pattern.bytes[j]] < nHistogram[pattern.bytes[pattern.anchor]])
+				pattern.anchor = j;
+		}
+
+		// Patterns without any bytes to match are never found, matching the
+		// behavior of the single pattern scanner.
+		if (pattern.anchor == SIZE_MAX || pattern.length > nSize)
+			continue;
+
+		anchorCounts[pattern.bytes[pattern.anchor] + 1]++;
+	}
+
+	// Group the patterns by anchor byte.
+	for (size_t i = 1; i < anchorCounts.size(); i++)
+		anchorCounts[i] += anchorCounts[i - 1];
+
+	vector<uint32_t> anchorPatterns(anchorCounts[256]);
+	vector<size_t> anchorOffsets(anchorCounts.begin(), anchorCounts.end() - 1);
+
+	// Set of anchor bytes for the SIMD sweep, indexed by the low nibble and
+	// holding one bit per high nibble; bytes >= 0x80 are in the second table.
+	alignas(16) uint8_t anchorSetLow[16] = {};
+	alignas(16) uint8_t anchorSetHigh[16] = {};
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		const ScanPattern_s& pattern = patterns[i];
+
+		if (pattern.anchor == SIZE_MAX || pattern.length > nSize)
+			continue;
+
+		const uint8_t anchorByte = pattern.bytes[pattern.anchor];
+		anchorPatterns[anchorOffsets[anchorByte]++] = static_cast<uint32_t>(i);
+
+		uint8_t* const anchorSet = (anchorByte & 0x80) ? anchorSetHigh : anchorSetLow;
+		anchorSet[anchorByte & 0xF] |= static_cast<uint8_t>(1 << ((anchorByte >> 4) & 0x7));
+	}
+
+	const size_t nTotal = anchorPatterns.size();
+
+	if (!nTotal)
+		return 0;
+
+	const size_t nMaxThreads = Max<size_t>(1, std::thread::hardware_concurrency());
+	const size_t nThreads = Clamp<size_t>(nSize / PATTERN_SCAN_MIN_CHUNK_SIZE, 1, nMaxThreads);
+	const QWORD nChunkSize = ((nSize / nThreads) + 15) & ~QWORD(15);
+
+	// First match of each pattern per chunk, the chunks are scanned by anchor
+	// position so the earliest chunk with a match holds the first match.
+	vector<vector<QWORD>> chunkResults(nThreads, vector<QWORD>(nCount, QWORD(-1)));
+
+	auto scanChunk = [&](const size_t nChunk)
+	{
+		vector<QWORD>& results = chunkResults[nChunk];
+		size_t nRemaining = nTotal;
+
+		const QWORD nChunkStart = nChunk * nChunkSize;
+		const QWORD nChunkEnd = Min<QWORD>(nChunkStart + nChunkSize, nSize);
+
+		const __m128i lowNibbleMask = _mm_set1_epi8(0x0F);
+		const __m128i setLow = _mm_load_si128(reinterpret_cast<const __m128i*>(anchorSetLow));
+		const __m128i setHigh = _mm_load_si128(reinterpret_cast<const __m128i*>(anchorSetHigh));
+		const __m128i bitTable = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+		for (QWORD nBlock = nChunkStart; nBlock < nChunkEnd && nRemaining; nBlock += 16)
+		{
+			uint32_t nCandidates;
+
+			if (nBlock + 16 <= nSize)
+			{
+				const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + nBlock));
+
+				const __m128i lowNibbles = _mm_and_si128(data, lowNibbleMask);
+				const __m128i highNibbles = _mm_and_si128(_mm_srli_epi16(data, 4), lowNibbleMask);
+
+				// Select the table by the top bit, and test the bit of the high nibble.
+				const __m128i isHigh = _mm_cmplt_epi8(data, _mm_setzero_si128());
+				const __m128i rows = _mm_or_si128(
+					_mm_andnot_si128(isHigh, _mm_shuffle_epi8(setLow, lowNibbles)),
+					_mm_and_si128(isHigh, _mm_shuffle_epi8(setHigh, lowNibbles)));
+				const __m128i bits = _mm_shuffle_epi8(bitTable, highNibbles);
+
+				nCandidates = ~static_cast<uint32_t>(_mm_movemask_epi8(
+					_mm_cmpeq_epi8(_mm_and_si128(rows, bits), _mm_setzero_si128()))) & 0xFFFF;
+			}
+			else
+			{
+				nCandidates = (1u << (nSize - nBlock)) - 1;
+			}
+
+			if (nBlock + 16 > nChunkEnd)
+				nCandidates &= (1u << (nChunkEnd - nBlock)) - 1;
+
+			while (nCandidates)
+			{
+				unsigned long nIndex;
+				_BitScanForward(&nIndex, nCandidates);
+				nCandidates &= nCandidates - 1;
+
+				const QWORD nAnchorPos = nBlock + nIndex;
+				const uint8_t anchorByte = pData[nAnchorPos];
+
+				const size_t nFirst = anchorByte ? anchorOffsets[anchorByte - 1] : 0;
+				const size_t nLast = anchorOffsets[anchorByte];
+
+				for (size_t i = nFirst; i < nLast; i++)
+				{
+					const uint32_t nPattern = anchorPatterns[i];
+					const ScanPattern_s& pattern = patterns[nPattern];
+
+					if (results[nPattern] != QWORD(-1) || nAnchorPos < pattern.anchor)
+						continue;
+
+					const QWORD nStart = nAnchorPos - pattern.anchor;
+
+					if (nStart + pattern.length > nSize)
+						continue;
+
+					if (MatchScanPattern(pattern, pData + nStart, nStart + pattern.bytes.size() <= nSize))
+					{
+						results[nPattern] = nStart;
+						nRemaining--;
+					}
+				}
+			}
+		}
+	};
+
+	vector<std::thread> workers;
+
+	for (size_t i = 1; i < nThreads; i++)
+		workers.emplace_back(scanChunk, i);
+
+	scanChunk(0);
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	size_t nFound = 0;
+
+	for (size_t i = 0; i < nCount; i++)
+	{
+		for (size_t j = 0; j < nThreads; j++)
+		{
+			if (chunkResults[j][i] != QWORD(-1))
+			{
+				pResults[i] = CMemory(nBase + chunkResults[j][i]);
+				nFound++;
+
+				break;
+			}
+		}
+	}
+
+	return nFound;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: scans for a set of string patterns in a single pass, the results
+//          are used by FindPatternSIMD for scans of the code section and from
+//          there added to the signature cache
+// Input  : &patterns - strings that aren't byte patterns are skipped
+//-----------------------------------------------------------------------------
+void CModule::PrefetchPatterns(const vector<string>& patterns)
+{
+	vector<const char*> bytePatterns;
+	bytePatterns.reserve(patterns.size());
+
+	for (const string& pattern : patterns)
+	{
+		if (IsBytePattern(pattern.c_str()))
+			bytePatterns.push_back(pattern.c_str());
+	}
+
+	if (bytePatterns.empty())
+		return;
+
+	vector<CMemory> results(bytePatterns.size());
+	FindPatternsSIMD(bytePatterns.data(), bytePatterns.size(), results.data());
+
+	for (size_t i = 0; i < bytePatterns.size(); i++)
+	{
+		if (results[i])
+			m_PrefetchedPatterns[bytePatterns[i]] = GetRVA(results[i].GetPtr());
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: find address of reference to string constant in executable memory
 // Input  : *szString       - 
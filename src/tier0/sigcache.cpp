@@ -15,6 +15,11 @@
 // of time initializing the DLL by parsing the precomputed data instead of 
 // searching for each signature in the memory region of the target executable.
 //
+// Next to the cache, a list of the patterns is written. Unlike the cache, the
+// list doesn't depend on the SDK release and is read even if the cache is
+// disabled, so the patterns can be scanned for in a single pass whenever the
+// cache can't be used.
+//
 ///////////////////////////////////////////////////////////////////////////////
 #include "tier0/sigcache.h"
 #include "tier0/binstream.h"
@@ -33,12 +38,17 @@ void CSigCache::SetDisabled(const bool bDisabled)
 //-----------------------------------------------------------------------------
 void CSigCache::InvalidateMap()
 {
+	m_PatternList.clear();
+	m_PatternList.shrink_to_fit();
+
 	if (m_bDisabled)
 	{
 		return;
 	}
 
 	m_Cache.mutable_smap()->clear();
+	m_OutdatedKeys.clear();
+	m_OutdatedKeys.shrink_to_fit();
 }
 
 //-----------------------------------------------------------------------------
@@ -116,11 +126,10 @@ bool CSigCache::ReadCache(const char* szCacheFile)
 		return false;
 	}
 
+	// Caches from other SDK releases have the same layout, their keys are
+	// still useful as a list of patterns to prefetch.
 	header.m_nMinorVersion = reader.Read<uint16_t>();
-	if (header.m_nMinorVersion != SIGDB_MINOR_VERSION)
-	{
-		return false;
-	}
+	const bool bOutdated = header.m_nMinorVersion != SIGDB_MINOR_VERSION;
 
 	header.m_nBlobSizeMem = reader.Read<uint64_t>();
 	header.m_nBlobSizeDisk = reader.Read<uint64_t>();
@@ -151,6 +160,20 @@ bool CSigCache::ReadCache(const char* szCacheFile)
 		return false;
 	}
 
+	if (bOutdated)
+	{
+		const google::protobuf::Map<string, uint64_t>& sMap = m_Cache.smap();
+		m_OutdatedKeys.reserve(sMap.size());
+
+		for (const auto& entry : sMap)
+		{
+			m_OutdatedKeys.push_back(entry.first);
+		}
+
+		m_Cache.mutable_smap()->clear();
+		return false;
+	}
+
 	m_bInitialized = true;
 	return true;
 }
@@ -200,6 +223,76 @@ bool CSigCache::WriteCache(const char* szCacheFile) const
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: loads the pattern list from the disk, regardless of whether the
+//          cache is disabled
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CSigCache::ReadPatternList(const char* szListFile)
+{
+	CIOStream reader;
+	if (!reader.Open(szListFile, CIOStream::Mode_e::Read))
+	{
+		return false;
+	}
+	if (reader.GetSize() <= sizeof(int) + sizeof(uint32_t))
+	{
+		return false;
+	}
+
+	if (reader.Read<int>() != SIGDB_PATTERN_LIST_MAGIC)
+	{
+		return false;
+	}
+
+	const uint32_t nCount = reader.Read<uint32_t>();
+
+	for (uint32_t i = 0; i < nCount && !reader.IsEof(); i++)
+	{
+		string pattern;
+		reader.ReadString(pattern);
+
+		if (!pattern.empty())
+		{
+			m_PatternList.push_back(std::move(pattern));
+		}
+	}
+
+	return !m_PatternList.empty();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: writes the keys of the cache map to the disk as a pattern list
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CSigCache::WritePatternList(const char* szListFile) const
+{
+	if (m_bDisabled || m_Cache.smap().empty())
+	{
+		return false;
+	}
+
+	CIOStream writer;
+	if (!writer.Open(szListFile, CIOStream::Mode_e::Write))
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", 
+			__FUNCTION__, szListFile);
+		return false;
+	}
+
+	const google::protobuf::Map<string, uint64_t>& sMap = m_Cache.smap();
+
+	writer.Write<int>(SIGDB_PATTERN_LIST_MAGIC);
+	writer.Write<uint32_t>(static_cast<uint32_t>(sMap.size()));
+
+	for (const auto& entry : sMap)
+	{
+		writer.WriteString(entry.first, true);
+	}
+
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: decompresses the blob containing the signature map
 // Input  : nSrcLen - 
@@ -42,6 +42,16 @@ void CURLInitCommonOptions(CURL* curl, const char* remote,
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, params.writeFunction);
     curl_easy_setopt(curl, CURLOPT_READFUNCTION, params.readFunction);
 
+    if (params.share)
+    {
+        curl_easy_setopt(curl, CURLOPT_SHARE, params.share);
+    }
+
+    if (params.keepAlive)
+    {
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    }
+
     if (params.statusFunction)
     {
         Assert(progressData);
@@ -223,18 +233,32 @@ bool CURLDownloadFile(const char* remote, const char* savePath, const char* file
 CURL* CURLInitRequest(const char* remote, const char* request,
     string& outResponse, curl_slist*& slist, const CURLParams& params)
 {
-    slist = CURLSlistAppend(slist, "Content-Type: application/json");
-    if (!slist)
+    CURL* curl = EasyInit();
+    if (!curl)
     {
         return nullptr;
     }
 
-    CURL* curl = EasyInit();
-    if (!curl)
+    if (!CURLSetupRequest(curl, remote, request, outResponse, slist, params))
     {
+        curl_easy_cleanup(curl);
         return nullptr;
     }
 
+    return curl;
+}
+
+// Sets up a request on an existing handle, handles that are reused keep their
+// connections alive between requests.
+bool CURLSetupRequest(CURL* curl, const char* remote, const char* request,
+    string& outResponse, curl_slist*& slist, const CURLParams& params)
+{
+    slist = CURLSlistAppend(slist, "Content-Type: application/json");
+    if (!slist)
+    {
+        return false;
+    }
+
     CURLInitCommonOptions(curl, remote, nullptr, &outResponse, params, nullptr);
 
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, slist);
@@ -244,7 +268,7 @@ CURL* CURLInitRequest(const char* remote, const char* request,
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request);
     }
 
-    return curl;
+    return true;
 }
 
 CURLcode CURLSubmitRequest(CURL* curl, curl_slist*& slist)
@@ -255,11 +279,12 @@ CURLcode CURLSubmitRequest(CURL* curl, curl_slist*& slist)
     return res;
 }
 
+// Note: the handle is not cleaned up, this is up to the caller so handles can
+// be reused.
 CURLINFO CURLRetrieveInfo(CURL* curl)
 {
     CURLINFO status;
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
-    curl_easy_cleanup(curl);
 
     return status;
 }
@@ -275,8 +300,6 @@ bool CURLHandleError(CURL* curl, const CURLcode res, string& outMessage, const b
         Error(eDLL_T::COMMON, NO_ERROR, "CURL: %s\n", curlError);
 
     outMessage = curlError;
-    curl_easy_cleanup(curl);
-
     return false;
 }
 
@@ -36,6 +36,8 @@ void CSocketCreator::RunFrame(void)
 	{
 		ProcessAccept(); // handle any new connection requests.
 	}
+
+	ProcessSend(); // drain the send queues of sockets that became writable.
 }
 
 //-----------------------------------------------------------------------------
@@ -67,6 +69,139 @@ void CSocketCreator::ProcessAccept(void)
 	OnSocketAccepted(newSocket, netAdr);
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: polls the sockets that have pending sends and drains the queues of
+//			the ones that are writable, sockets without pending sends are not
+//			touched at all
+//-----------------------------------------------------------------------------
+void CSocketCreator::ProcessSend(void)
+{
+	m_PollSockets.RemoveAll();
+	m_PollSocketIndex.RemoveAll();
+
+	for (int i = 0; i < m_AcceptedSockets.Count(); ++i)
+	{
+		const CConnectedNetConsoleData& data = m_AcceptedSockets[i].m_Data;
+
+		if (data.m_SendQueue.empty() || data.m_bSendFailed)
+			continue;
+
+		WSAPOLLFD& pollSocket = m_PollSockets[m_PollSockets.AddToTail()];
+
+		pollSocket.fd = SOCKET(data.m_hSocket);
+		pollSocket.events = POLLWRNORM;
+		pollSocket.revents = 0;
+
+		m_PollSocketIndex.AddToTail(i);
+	}
+
+	if (m_PollSockets.IsEmpty())
+		return;
+
+	// Never wait, a slow connection must not stall the caller's frame.
+	const int nReady = ::WSAPoll(m_PollSockets.Base(), ULONG(m_PollSockets.Count()), 0);
+
+	if (nReady == SOCKET_ERROR)
+	{
+		Error(eDLL_T::COMMON, NO_ERROR, "%s - Error: %s\n", __FUNCTION__, NET_ErrorString(WSAGetLastError()));
+		return;
+	}
+
+	if (nReady == 0)
+		return;
+
+	FOR_EACH_VEC(m_PollSockets, i)
+	{
+		const WSAPOLLFD& pollSocket = m_PollSockets[i];
+		CConnectedNetConsoleData& data = m_AcceptedSockets[m_PollSocketIndex[i]].m_Data;
+
+		if (pollSocket.revents & (POLLERR | POLLHUP | POLLNVAL))
+		{
+			data.m_bSendFailed = true;
+		}
+		else if (pollSocket.revents & POLLWRNORM)
+		{
+			FlushSendQueue(data);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: queues a frame for sending, the frame is sent right away if nothing
+//			else is queued and the socket can take it
+// Input  : &data - 
+//			&frame - 
+//			nMaxQueueSize - max number of bytes already queued, 0 for no limit;
+//			                a frame is always accepted if the queue is empty
+// Output : true on success, false if the socket failed or the queue overflowed
+// NOTE   : the send state isn't synchronized, this must only be called from
+//			the thread that runs RunFrame
+//-----------------------------------------------------------------------------
+bool CSocketCreator::QueueSend(CConnectedNetConsoleData& data, const NetConFrame_t& frame, const size_t nMaxQueueSize)
+{
+	if (data.m_bSendFailed)
+		return false;
+
+	if (nMaxQueueSize && data.m_nSendQueueSize >= nMaxQueueSize)
+	{
+		// The remote isn't reading fast enough; give up on it, the owner
+		// closes the socket.
+		data.m_SendQueue.clear();
+		data.m_nSendOffset = 0;
+		data.m_nSendQueueSize = 0;
+		data.m_bSendFailed = true;
+
+		return false;
+	}
+
+	const bool bWasEmpty = data.m_SendQueue.empty();
+
+	data.m_SendQueue.push_back(frame);
+	data.m_nSendQueueSize += frame->size();
+
+	if (bWasEmpty)
+		return FlushSendQueue(data);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: sends as much of the send queue as the socket takes without
+//			blocking, partially sent frames are resumed on the next call
+// Input  : &data - 
+// Output : true on success, false if the socket failed
+//-----------------------------------------------------------------------------
+bool CSocketCreator::FlushSendQueue(CConnectedNetConsoleData& data)
+{
+	while (!data.m_SendQueue.empty())
+	{
+		const vector<char>& frame = *data.m_SendQueue.front();
+
+		const int nSendLen = int(frame.size() - data.m_nSendOffset);
+		const int nSent = ::send(data.m_hSocket, &frame[data.m_nSendOffset], nSendLen, MSG_NOSIGNAL);
+
+		if (nSent == SOCKET_ERROR)
+		{
+			if (IsSocketBlocking())
+				return true; // Socket buffer is full, resume once writable.
+
+			data.m_bSendFailed = true;
+			return false;
+		}
+
+		data.m_nSendOffset += nSent;
+		data.m_nSendQueueSize -= nSent;
+
+		if (data.m_nSendOffset < frame.size())
+			return true; // Socket buffer is full, resume once writable.
+
+		data.m_SendQueue.pop_front();
+		data.m_nSendOffset = 0;
+	}
+
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: bind to a TCP port and accept incoming connections
 // Input  : *netAdr - 
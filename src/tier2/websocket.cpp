@@ -120,7 +120,9 @@ void CWebSocket::Update()
 
 		if (conn.state == CS_CONNECTED || conn.state == CS_LISTENING)
 		{
-			conn.Process(queryTime);
+			if (conn.Process(queryTime))
+				conn.ProcessQueue(queryTime);
+
 			continue;
 		}
 
@@ -150,8 +152,13 @@ void CWebSocket::DeleteUnavailable()
 {
 	FOR_EACH_VEC_BACK(m_addressList, i)
 	{
-		if (m_addressList[i].state == CS_UNAVAIL)
+		ConnContext_s& conn = m_addressList[i];
+
+		if (conn.state == CS_UNAVAIL)
+		{
+			conn.FreeQueue();
 			m_addressList.FastRemove(i);
+		}
 	}
 }
 
@@ -183,11 +190,17 @@ void CWebSocket::ReconnectAll()
 void CWebSocket::ClearAll()
 {
 	DisconnectAll();
+
+	for (ConnContext_s& conn : m_addressList)
+	{
+		conn.FreeQueue();
+	}
+
 	m_addressList.Purge();
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: send data to all sockets
+// Purpose: queue data for all sockets, the queues are drained in Update()
 //-----------------------------------------------------------------------------
 void CWebSocket::SendData(const char* const dataBuf, const int32_t dataSize)
 {
@@ -197,13 +210,19 @@ void CWebSocket::SendData(const char* const dataBuf, const int32_t dataSize)
 	if (!IsInitialized())
 		return;
 
+	QueuedFrame_s frame;
+
+	frame.queueTime = Plat_FloatTime();
+	frame.data = std::make_shared<const string>(dataBuf, dataSize);
+
 	for (ConnContext_s& conn : m_addressList)
 	{
-		if (conn.state != CS_LISTENING)
+		// Connections that are being (re)established queue as well, so the
+		// frames are sent once the connection is back.
+		if (conn.state == CS_UNAVAIL)
 			continue;
 
-		if (ProtoWebSocketSend(conn.webSocket, dataBuf, dataSize) < 0)
-			conn.Destroy(); // Reattempt the connection for this socket
+		conn.QueueFrame(frame, m_connParams);
 	}
 }
 
@@ -215,6 +234,26 @@ bool CWebSocket::IsInitialized() const
 	return m_initialized;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: gets the send queue statistics of all connections combined
+//-----------------------------------------------------------------------------
+void CWebSocket::GetMetrics(ConnMetrics_s& metrics) const
+{
+	metrics = ConnMetrics_s();
+
+	for (const ConnContext_s& conn : m_addressList)
+	{
+		metrics.queuedBytes += conn.metrics.queuedBytes;
+		metrics.queuedFrames += conn.metrics.queuedFrames;
+
+		metrics.sentFrames += conn.metrics.sentFrames;
+		metrics.droppedFrames += conn.metrics.droppedFrames;
+
+		metrics.lastSendLatency = Max(metrics.lastSendLatency, conn.metrics.lastSendLatency);
+		metrics.maxSendLatency = Max(metrics.maxSendLatency, conn.metrics.maxSendLatency);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: connect to a socket
 //-----------------------------------------------------------------------------
@@ -279,6 +318,167 @@ bool CWebSocket::ConnContext_s::Process(const double queryTime)
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: queue a frame on this socket, applies the drop policy if the frame
+// doesn't fit in the queue
+//-----------------------------------------------------------------------------
+void CWebSocket::ConnContext_s::QueueFrame(const QueuedFrame_s& frame, const ConnParams_s& params)
+{
+	const int64_t frameSize = (int64_t)frame.data->size();
+
+	if (frameSize > params.maxQueueSize)
+	{
+		metrics.droppedFrames++; // Would never fit
+		return;
+	}
+
+	if (!sendQueue)
+		sendQueue = new SendQueue_t();
+
+	if (metrics.queuedBytes + frameSize > params.maxQueueSize)
+	{
+		if (params.dropPolicy == DP_DROP_NEWEST)
+		{
+			metrics.droppedFrames++;
+			return;
+		}
+
+		if (params.dropPolicy == DP_DISCONNECT)
+		{
+			if (state == CS_CONNECTED || state == CS_LISTENING)
+				Destroy(); // Reattempt the connection for this socket
+
+			metrics.droppedFrames += sendQueue->size();
+			metrics.queuedBytes = 0;
+			metrics.queuedFrames = 0;
+
+			sendQueue->clear();
+			sendOffset = 0;
+		}
+		else // DP_DROP_OLDEST
+		{
+			// The front frame can't be dropped if it was partially sent, the
+			// socket is in the middle of its fragmented message and the next
+			// fragment it sends is a continuation of it. Only its unsent bytes
+			// are counted as queued.
+			const size_t firstDroppable = sendOffset ? 1 : 0;
+
+			while (metrics.queuedBytes + frameSize > params.maxQueueSize
+				&& sendQueue->size() > firstDroppable)
+			{
+				const SendQueue_t::iterator it = sendQueue->begin() + firstDroppable;
+
+				metrics.queuedBytes -= (int64_t)it->data->size();
+				metrics.queuedFrames--;
+				metrics.droppedFrames++;
+
+				sendQueue->erase(it);
+			}
+
+			if (metrics.queuedBytes + frameSize > params.maxQueueSize)
+			{
+				metrics.droppedFrames++;
+				return;
+			}
+		}
+	}
+
+	sendQueue->push_back(frame);
+
+	metrics.queuedBytes += frameSize;
+	metrics.queuedFrames++;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: send as many queued frames as the socket takes, destroys the socket
+// on failure; the queue is kept for the next connection attempt
+//-----------------------------------------------------------------------------
+bool CWebSocket::ConnContext_s::ProcessQueue(const double queryTime)
+{
+	if (!sendQueue)
+		return true;
+
+	while (!sendQueue->empty())
+	{
+		const QueuedFrame_s& frame = sendQueue->front();
+
+		const int32_t frameSize = (int32_t)frame.data->size();
+		const int32_t remaining = frameSize - sendOffset;
+
+		// Sent as a message, so each frame reaches the peer as a single
+		// WebSocket message; if it doesn't fit in the socket buffer, it is
+		// fragmented and only the final fragment carries the FIN bit.
+		const int32_t sent = ProtoWebSocketSendMessage(webSocket, frame.data->data() + sendOffset, remaining);
+
+		if (sent < 0)
+		{
+			Destroy(); // Reattempt the connection for this socket
+			lastQueryTime = queryTime;
+
+			return false;
+		}
+
+		if (sent == 0)
+			break; // Socket is busy, continue next update
+
+		sendOffset += sent;
+		metrics.queuedBytes -= sent;
+
+		if (sendOffset < frameSize)
+			continue; // Send the next fragment of this frame
+
+		const double latency = queryTime - frame.queueTime;
+
+		metrics.lastSendLatency = latency;
+		metrics.maxSendLatency = Max(metrics.maxSendLatency, latency);
+
+		metrics.queuedFrames--;
+		metrics.sentFrames++;
+
+		sendQueue->pop_front();
+		sendOffset = 0;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: drop the front frame if it was partially sent, a new connection
+// can't continue a message that was started on the previous one
+//-----------------------------------------------------------------------------
+void CWebSocket::ConnContext_s::DropPartialFrame()
+{
+	if (!sendOffset)
+		return;
+
+	Assert(sendQueue && !sendQueue->empty());
+
+	metrics.queuedBytes -= (int64_t)sendQueue->front().data->size() - sendOffset;
+	metrics.queuedFrames--;
+	metrics.droppedFrames++;
+
+	sendQueue->pop_front();
+	sendOffset = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: free the send queue along with all frames in it
+//-----------------------------------------------------------------------------
+void CWebSocket::ConnContext_s::FreeQueue()
+{
+	if (!sendQueue)
+		return;
+
+	metrics.droppedFrames += sendQueue->size();
+	metrics.queuedBytes = 0;
+	metrics.queuedFrames = 0;
+
+	delete sendQueue;
+
+	sendQueue = nullptr;
+	sendOffset = 0;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: set parameters for this socket
 //-----------------------------------------------------------------------------
@@ -310,6 +510,7 @@ void CWebSocket::ConnContext_s::Disconnect()
 		webSocket = nullptr;
 	}
 
+	DropPartialFrame();
 	state = CS_UNAVAIL;
 }
 
@@ -29,7 +29,8 @@
 #include "tier2/fileutils.h"
 #include "mathlib/adler32.h"
 #include "mathlib/crc32.h"
-#include "mathlib/sha1.h"
+#include "mathlib/parallel_for.h"
+#include "mbedtls/sha1.h"
 #include "localize/ilocalize.h"
 #include "vpklib/packedstore.h"
 
@@ -55,6 +56,36 @@ static lzham_compress_level DetermineCompressionLevel(const char* compressionLev
 		return lzham_compress_level::LZHAM_COMP_LEVEL_DEFAULT;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: constructor
+//-----------------------------------------------------------------------------
+CPackedStoreBuilder::CPackedStoreBuilder()
+	: m_bPersistChunkIndex(false)
+	, m_bIncrementalBuild(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: initialize the chunk deduplication index
+// Input  : bPersist - whether to save the index next to the directory file
+//                     after packing
+//-----------------------------------------------------------------------------
+void CPackedStoreBuilder::InitChunkIndex(const bool bPersist)
+{
+	m_ChunkIndex.Clear();
+	m_bPersistChunkIndex = bPersist;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: initialize incremental building
+// Input  : bIncremental - whether to reuse unchanged entries from the previous
+//                         build instead of recompressing them
+//-----------------------------------------------------------------------------
+void CPackedStoreBuilder::InitIncrementalBuild(const bool bIncremental)
+{
+	m_bIncrementalBuild = bIncremental;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: initialize parameters for compression algorithm
 //-----------------------------------------------------------------------------
@@ -383,57 +414,64 @@ static void BuildManifest(const CUtlVector<VPKEntryBlock_t>& entryBlocks, const
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: validates extraction result with precomputed CRC32 hash
-// Input  : &assetPath - 
-//        : nFileCRC   - 
+// Purpose: attempts to deduplicate a chunk of data by comparing it to existing chunks
+// Input  : &chunkHash  - 
+//          &descriptor - 
+//          chunkIndex  - 
+// Output : true if the chunk was deduplicated, false otherwise
+// NOTE   : the chunk that first stored the data must have been written, and
+//          its descriptor set in the chunk index already
 //-----------------------------------------------------------------------------
-static void ValidateCRC32PostDecomp(const CUtlString& assetPath, const uint32_t nFileCRC)
+bool CPackedStoreBuilder::Deduplicate(const VPKChunkHash_t& chunkHash, VPKChunkDescriptor_t& descriptor, const size_t chunkIndex)
 {
-	const char* pAssetPath = assetPath.Get();
+	const CPackedStoreChunkIndex::Entry_t* pEntry = m_ChunkIndex.Find(chunkHash);
 
-	FileHandle_t hAsset = FileSystem()->Open(pAssetPath, "rb", "PLATFORM");
-	if (!hAsset)
+	if (pEntry) // Map to existing chunk to avoid having copies of the same data.
 	{
-		Error(eDLL_T::FS, NO_ERROR, "%s - Unable to open '%s' (insufficient rights?)\n", __FUNCTION__, pAssetPath);
-		return;
-	}
-
-	const ssize_t nLen = FileSystem()->Size(hAsset);
-	std::unique_ptr<uint8_t[]> pBuf(new uint8_t[nLen]);
-
-	FileSystem()->Read(pBuf.get(), nLen, hAsset);
-	FileSystem()->Close(hAsset);
+		Msg(eDLL_T::FS, "Mapping chunk '%zu' to existing chunk at '0x%llx'\n",
+			chunkIndex, pEntry->m_Descriptor.m_nPackFileOffset);
+		descriptor = pEntry->m_Descriptor;
 
-	uint32_t nCrc32 = crc32::update(NULL, pBuf.get(), nLen);
-	if (nCrc32 != nFileCRC)
-	{
-		Warning(eDLL_T::FS, "Computed checksum '0x%lX' doesn't match expected checksum '0x%lX'. File may be corrupt!\n", nCrc32, nFileCRC);
+		return true;
 	}
+
+	return false;
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: attempts to deduplicate a chunk of data by comparing it to existing chunks
-// Input  : *pEntryBuffer - 
-//          &descriptor   - 
-//          chunkIndex    - 
-// Output : true if the chunk was deduplicated, false otherwise
+// Purpose: determines whether the previously packed entry block can be reused
+//          for given manifest entry, the file contents are checked separately
+// Input  : &entryValue - 
+//          &oldBlock   - 
+// Output : true if the packing parameters are unchanged, false otherwise
 //-----------------------------------------------------------------------------
-bool CPackedStoreBuilder::Deduplicate(const uint8_t* pEntryBuffer, VPKChunkDescriptor_t& descriptor, const size_t chunkIndex)
+static bool IsEntryBlockReusable(const VPKKeyValues_t& entryValue, const VPKEntryBlock_t& oldBlock)
 {
-	string entryHash(reinterpret_cast<const char*>(pEntryBuffer), descriptor.m_nUncompressedSize);
-	entryHash = sha1(entryHash);
+	if (oldBlock.m_iPreloadSize != entryValue.m_iPreloadSize)
+	{
+		return false;
+	}
 
-	auto p = m_ChunkHashMap.insert({ entryHash.c_str(), descriptor });
-	if (!p.second) // Map to existing chunk to avoid having copies of the same data.
+	FOR_EACH_VEC(oldBlock.m_Fragments, i)
 	{
-		Msg(eDLL_T::FS, "Mapping chunk '%zu' ('%s') to existing chunk at '0x%llx'\n",
-			chunkIndex, entryHash.c_str(), p.first->second.m_nPackFileOffset);
-		descriptor = p.first->second;
+		const VPKChunkDescriptor_t& descriptor = oldBlock.m_Fragments[i];
 
-		return true;
+		if (descriptor.m_nLoadFlags != entryValue.m_nLoadFlags ||
+			descriptor.m_nTextureFlags != entryValue.m_nTextureFlags)
+		{
+			return false;
+		}
+
+		// Chunks are allowed to be stored uncompressed if compression is
+		// enabled, as they won't be smaller after recompression either.
+		if (!entryValue.m_bUseCompression &&
+			descriptor.m_nCompressedSize != descriptor.m_nUncompressedSize)
+		{
+			return false;
+		}
 	}
 
-	return false;
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -441,8 +479,16 @@ bool CPackedStoreBuilder::Deduplicate(const uint8_t* pEntryBuffer, VPKChunkDescr
 // Input  : &vpkPair       - 
 //          *workspaceName - 
 //          *buildPath     - 
+//          numWorkers     - number of threads to read, hash and compress entries
+//                           on, -1 for all available cores
+// NOTE   : entries are read, hashed and compressed in parallel, but they are
+//          deduplicated and written strictly in manifest order, so the output
+//          is identical to that of a single threaded build
+//
+//          in incremental mode, entries that didn't change since the previous
+//          build are copied from the previous pack file without recompressing
 //-----------------------------------------------------------------------------
-void CPackedStoreBuilder::PackStore(const VPKPair_t& vpkPair, const char* workspaceName, const char* buildPath)
+void CPackedStoreBuilder::PackStore(const VPKPair_t& vpkPair, const char* workspaceName, const char* buildPath, const int numWorkers)
 {
 	CUtlString workspacePath(workspaceName);
 	workspacePath.AppendSlash();
@@ -460,163 +506,568 @@ void CPackedStoreBuilder::PackStore(const VPKPair_t& vpkPair, const char* worksp
 		return;
 	}
 
-	std::unique_ptr<uint8_t[]> pEntryBuffer(new uint8_t[VPK_ENTRY_MAX_LEN]);
-
-	if (!pEntryBuffer)
-	{
-		Error(eDLL_T::FS, NO_ERROR, "%s - Unable to allocate chunk buffer!\n", __FUNCTION__);
-		return;
-	}
-
 	CUtlString packFilePath;
 	CUtlString dirFilePath;
+	CUtlString indexFilePath;
 
 	packFilePath.Format("%s%s", buildPath, vpkPair.m_PackName.Get());
 	dirFilePath.Format("%s%s", buildPath, vpkPair.m_DirName.Get());
+	indexFilePath.Format("%s%s", dirFilePath.Get(), VPK_CHUNK_INDEX_EXT);
+
+	// The previous build, entries that are unchanged are reused from here.
+	VPKDir_t oldDir;
+	std::unordered_map<string, int> oldEntryMap;
+
+	// Hashes of the chunks in the previous build, keyed by their location.
+	// Only available if the chunk index was saved during the previous build.
+	std::map<std::pair<uint16_t, uint64_t>, VPKChunkHash_t> oldChunkHashes;
+	long long nOldDirTime = 0;
+
+	if (m_bIncrementalBuild && FileSystem()->FileExists(dirFilePath.Get(), "GAME"))
+	{
+		oldDir.Init(dirFilePath);
+
+		if (!oldDir.Failed())
+		{
+			nOldDirTime = FileSystem()->GetFileTime(dirFilePath.Get(), "GAME");
+
+			FOR_EACH_VEC(oldDir.m_EntryBlocks, i)
+			{
+				oldEntryMap.insert({ oldDir.m_EntryBlocks[i].m_EntryPath.Get(), i });
+			}
+
+			CPackedStoreChunkIndex oldChunkIndex;
+
+			if (oldChunkIndex.Load(indexFilePath.Get()))
+			{
+				for (const CPackedStoreChunkIndex::Entry_t& entry : oldChunkIndex.GetSlots())
+				{
+					if (entry.m_bUsed)
+						oldChunkHashes.insert({ { entry.m_iPackFileIndex, entry.m_Descriptor.m_nPackFileOffset }, entry.m_Hash });
+				}
+			}
+
+			Msg(eDLL_T::FS, "*** Incremental build against '%d' entries from '%s'\n", oldDir.m_EntryBlocks.Count(), dirFilePath.Get());
+		}
+	}
+
+	const bool bIncremental = !oldEntryMap.empty();
+
+	// The previous pack file is still needed while building the new one, so
+	// the new one is written to a temporary file first.
+	CUtlString outFilePath = packFilePath;
+
+	if (bIncremental)
+	{
+		outFilePath.Append(".tmp");
+	}
 
 	FileSystem()->CreateDirHierarchy(packFilePath.DirName().Get(), "GAME");
-	FileHandle_t hPackFile = FileSystem()->Open(packFilePath.Get(), "wb", "GAME");
+	FileHandle_t hPackFile = FileSystem()->Open(outFilePath.Get(), "wb", "GAME");
 	if (!hPackFile)
 	{
-		Error(eDLL_T::FS, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, packFilePath.Get());
+		Error(eDLL_T::FS, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, outFilePath.Get());
 		return;
 	}
 
+	const CUtlString oldBasePath = dirFilePath.StripFilename(false);
+
+	const int numEntries = entryValues.Count();
+	const int numThreads = Max(Min(numWorkers > 0 ? numWorkers : static_cast<int>(parallel_thread_count()), numEntries), 1);
+
+	// The workers already occupy all cores, LZHAM's helper threads would only
+	// oversubscribe them. Deterministic parsing ensures the compressed output
+	// doesn't depend on the number of helper threads.
+	lzham_compress_params encoderParams = m_Encoder;
+
+	if (numThreads > 1)
+		encoderParams.m_max_helper_threads = 0;
+
+	std::atomic<int> nextEntry(0);
+
+	std::mutex orderMutex;
+	std::condition_variable orderCondition;
+
+	// Entries are hashed and written in manifest order, these are the indices
+	// of the entries that are up next.
+	int nextHashEntry = 0;
+	int nextWriteEntry = 0;
+
+	// Previous locations of all chunks that were seen so far, used along with
+	// the chunk index to determine which chunks are duplicates before spending
+	// time on compressing or copying them.
+	std::set<std::pair<uint16_t, uint64_t>> seenOldChunks;
+
+	// Maps the locations of reused chunks in the previous build to their
+	// descriptors in the new build, so chunks that were shared stay shared.
+	std::map<std::pair<uint16_t, uint64_t>, VPKChunkDescriptor_t> reusedChunks;
+
 	size_t nSharedTotal = NULL;
 	size_t nSharedCount = NULL;
+	size_t nReusedCount = NULL;
 
-	FOR_EACH_VEC(entryValues, i)
+	const auto workerFunc = [&]()
 	{
-		const VPKKeyValues_t& entryValue = entryValues[i];
-		const char* pEntryPath = entryValue.m_EntryPath.Get();
+		for (int i = nextEntry++; i < numEntries; i = nextEntry++)
+		{
+			const VPKKeyValues_t& entryValue = entryValues[i];
+			const char* pEntryPath = entryValue.m_EntryPath.Get();
 
-		FileHandle_t hAsset = FileSystem()->Open(pEntryPath, "rb", "PLATFORM");
+			const char* szDestPath = (pEntryPath + workspacePath.Length());
+			if (PATHSEPARATOR(szDestPath[0]))
+			{
+				szDestPath++;
+			}
 
-		if (!hAsset)
-		{
-			Error(eDLL_T::FS, NO_ERROR, "%s - Unable to open '%s' (insufficient rights?)\n", __FUNCTION__, pEntryPath);
-			continue;
-		}
+			std::unique_ptr<uint8_t[]> pBuf;
+			ssize_t nLen = 0;
 
-		const char* szDestPath = (pEntryPath + workspacePath.Length());
-		if (PATHSEPARATOR(szDestPath[0]))
-		{
-			szDestPath++;
-		}
+			// Set if the entry didn't change since the previous build.
+			const VPKEntryBlock_t* pOldBlock = nullptr;
+			FileHandle_t hOldPackFile = NULL;
 
-		const ssize_t nLen = FileSystem()->Size(hAsset);
-		std::unique_ptr<uint8_t[]> pBuf(new uint8_t[nLen]);
+			FileHandle_t hAsset = FileSystem()->Open(pEntryPath, "rb", "PLATFORM");
 
-		FileSystem()->Read(pBuf.get(), nLen, hAsset);
-		FileSystem()->Seek(hAsset, 0, FileSystemSeek_t::FILESYSTEM_SEEK_HEAD);
+			if (hAsset)
+			{
+				nLen = FileSystem()->Size(hAsset);
 
-		Msg(eDLL_T::FS, "Packing entry '%i' ('%s')\n", i, szDestPath);
-		int index = entryBlocks.AddToTail(VPKEntryBlock_t(
-			pBuf.get(),
-			nLen,
-			FileSystem()->Tell(hPackFile),
-			entryValue.m_iPreloadSize,
-			0,
-			entryValue.m_nLoadFlags,
-			entryValue.m_nTextureFlags,
-			CUtlString(szDestPath)));
+				if (bIncremental)
+				{
+					CUtlString destPath(szDestPath);
+					destPath.FixSlashes('/');
 
-		VPKEntryBlock_t& entryBlock = entryBlocks[index];
+					const auto it = oldEntryMap.find(destPath.Get());
 
-		FOR_EACH_VEC(entryBlock.m_Fragments, j)
-		{
-			VPKChunkDescriptor_t& descriptor = entryBlock.m_Fragments[j];
+					if (it != oldEntryMap.end() && IsEntryBlockReusable(entryValue, oldDir.m_EntryBlocks[it->second]))
+					{
+						const VPKEntryBlock_t& oldBlock = oldDir.m_EntryBlocks[it->second];
+						ssize_t nOldLen = 0;
+
+						FOR_EACH_VEC(oldBlock.m_Fragments, j)
+						{
+							nOldLen += oldBlock.m_Fragments[j].m_nUncompressedSize;
+						}
+
+						// Files that weren't modified after the previous build
+						// don't need to be read, else compare the checksum.
+						if (nOldLen == nLen && oldBlock.m_Fragments.Count() == (nLen + VPK_ENTRY_MAX_LEN - 1) / VPK_ENTRY_MAX_LEN)
+						{
+							if (FileSystem()->GetFileTime(pEntryPath, "PLATFORM") < nOldDirTime)
+							{
+								pOldBlock = &oldBlock;
+							}
+							else
+							{
+								pBuf.reset(new uint8_t[nLen]);
+								FileSystem()->Read(pBuf.get(), nLen, hAsset);
+
+								if (crc32::update(NULL, pBuf.get(), nLen) == oldBlock.m_nFileCRC)
+								{
+									pOldBlock = &oldBlock;
+								}
+							}
+						}
+					}
+				}
 
-			FileSystem()->Read(pEntryBuffer.get(), descriptor.m_nCompressedSize, hAsset);
-			descriptor.m_nPackFileOffset = FileSystem()->Tell(hPackFile);
+				if (pOldBlock)
+				{
+					const CUtlString oldPackFilePath = oldBasePath + oldDir.GetPackFileNameForIndex(pOldBlock->m_iPackFileIndex);
+					hOldPackFile = FileSystem()->Open(oldPackFilePath.Get(), "rb", "GAME");
 
-			if (entryValue.m_bDeduplicate && Deduplicate(pEntryBuffer.get(), descriptor, j))
+					// Pack the entry from scratch if its data can't be copied.
+					if (!hOldPackFile)
+					{
+						Warning(eDLL_T::FS, "%s - Unable to open '%s'; repacking entry '%i'\n", __FUNCTION__, oldPackFilePath.Get(), i);
+						pOldBlock = nullptr;
+					}
+				}
+
+				if (!pBuf && !pOldBlock)
+				{
+					pBuf.reset(new uint8_t[nLen]);
+					FileSystem()->Read(pBuf.get(), nLen, hAsset);
+				}
+
+				FileSystem()->Close(hAsset);
+			}
+			else
 			{
-				nSharedTotal += descriptor.m_nCompressedSize;
-				nSharedCount++;
+				Error(eDLL_T::FS, NO_ERROR, "%s - Unable to open '%s' (insufficient rights?)\n", __FUNCTION__, pEntryPath);
+			}
 
-				// Data was deduplicated.
-				continue;
+			const size_t nChunkCount = (nLen + VPK_ENTRY_MAX_LEN - 1) / VPK_ENTRY_MAX_LEN;
+
+			std::unique_ptr<VPKChunkHash_t[]> chunkHashes(new VPKChunkHash_t[nChunkCount]);
+			std::unique_ptr<bool[]> chunkHashed(new bool[nChunkCount]());
+			std::unique_ptr<bool[]> chunkShared(new bool[nChunkCount]());
+
+			// Set for chunks that are the first occurrence of their hash, these
+			// record their final descriptor in the chunk index once written.
+			std::unique_ptr<bool[]> chunkFirst(new bool[nChunkCount]());
+
+			if (hAsset && entryValue.m_bDeduplicate)
+			{
+				for (size_t j = 0; j < nChunkCount; j++)
+				{
+					if (pBuf)
+					{
+						const size_t nChunkOffset = j * VPK_ENTRY_MAX_LEN;
+						const size_t nChunkLen = Min<size_t>(VPK_ENTRY_MAX_LEN, nLen - nChunkOffset);
+
+						chunkHashes[j] = VPKChunkHash_t(&pBuf[nChunkOffset], nChunkLen);
+						chunkHashed[j] = true;
+
+						continue;
+					}
+
+					// The file wasn't read, take the hash from the previous
+					// build if it is known.
+					const VPKChunkDescriptor_t& oldDescriptor = pOldBlock->m_Fragments[static_cast<int>(j)];
+					const auto it = oldChunkHashes.find({ pOldBlock->m_iPackFileIndex, oldDescriptor.m_nPackFileOffset });
+
+					if (it != oldChunkHashes.end())
+					{
+						chunkHashes[j] = it->second;
+						chunkHashed[j] = true;
+					}
+				}
+			}
+
+			// Chunks are marked as shared in manifest order, so the first
+			// occurrence of the data is always the one that gets written. The
+			// hash is added to the chunk index right away, its descriptor is
+			// set when the chunk is written.
+			{
+				std::unique_lock<std::mutex> lock(orderMutex);
+				orderCondition.wait(lock, [&]() { return nextHashEntry == i; });
+
+				for (size_t j = 0; hAsset && j < nChunkCount; j++)
+				{
+					if (chunkHashed[j])
+					{
+						bool bInserted;
+						m_ChunkIndex.Insert(chunkHashes[j], VPKChunkDescriptor_t(), 0, bInserted);
+
+						chunkFirst[j] = bInserted;
+						chunkShared[j] = !bInserted;
+					}
+
+					if (pOldBlock)
+					{
+						const VPKChunkDescriptor_t& oldDescriptor = pOldBlock->m_Fragments[static_cast<int>(j)];
+
+						if (!seenOldChunks.insert({ pOldBlock->m_iPackFileIndex, oldDescriptor.m_nPackFileOffset }).second)
+							chunkShared[j] = true;
+					}
+				}
+
+				nextHashEntry++;
+				orderCondition.notify_all();
 			}
 
-			if (entryValue.m_bUseCompression)
+			// Compress all unique chunks, chunks that failed to compress are
+			// written from the source buffer as is. Chunks of unchanged entries
+			// are copied from the previous pack file instead.
+			std::unique_ptr<std::unique_ptr<uint8_t[]>[]> chunkBuffers(new std::unique_ptr<uint8_t[]>[nChunkCount]);
+			std::unique_ptr<size_t[]> chunkSizes(new size_t[nChunkCount]);
+
+			for (size_t j = 0; hAsset && j < nChunkCount; j++)
 			{
-				lzham_compress_status_t lzCompStatus = lzham_compress_memory(&m_Encoder, pEntryBuffer.get(), &descriptor.m_nCompressedSize, pEntryBuffer.get(),
-					descriptor.m_nUncompressedSize, nullptr);
+				const size_t nChunkOffset = j * VPK_ENTRY_MAX_LEN;
+				const size_t nChunkLen = Min<size_t>(VPK_ENTRY_MAX_LEN, nLen - nChunkOffset);
+
+				chunkSizes[j] = nChunkLen;
+
+				if (pOldBlock)
+				{
+					const VPKChunkDescriptor_t& oldDescriptor = pOldBlock->m_Fragments[static_cast<int>(j)];
+					chunkSizes[j] = oldDescriptor.m_nCompressedSize;
+
+					if (chunkShared[j])
+						continue;
+
+					chunkBuffers[j].reset(new uint8_t[oldDescriptor.m_nCompressedSize]);
+
+					FileSystem()->Seek(hOldPackFile, oldDescriptor.m_nPackFileOffset, FileSystemSeek_t::FILESYSTEM_SEEK_HEAD);
+					FileSystem()->Read(chunkBuffers[j].get(), oldDescriptor.m_nCompressedSize, hOldPackFile);
+
+					continue;
+				}
+
+				if (chunkShared[j] || !entryValue.m_bUseCompression)
+					continue;
+
+				chunkBuffers[j].reset(new uint8_t[nChunkLen]);
+
+				size_t nCompressedSize = nChunkLen;
+				lzham_compress_status_t lzCompStatus = lzham_compress_memory(&encoderParams, chunkBuffers[j].get(), &nCompressedSize, &pBuf[nChunkOffset],
+					nChunkLen, nullptr);
 
 				if (lzCompStatus != lzham_compress_status_t::LZHAM_COMP_STATUS_SUCCESS)
 				{
-					Warning(eDLL_T::FS, "Status '%d' for chunk '%i' within entry '%i' in block '%hu' (chunk packed without compression)\n",
-						lzCompStatus, j, i, entryBlock.m_iPackFileIndex);
+					Warning(eDLL_T::FS, "Status '%d' for chunk '%zu' within entry '%i' (chunk packed without compression)\n",
+						lzCompStatus, j, i);
 
-					descriptor.m_nCompressedSize = descriptor.m_nUncompressedSize;
+					chunkBuffers[j].reset();
+					continue;
 				}
+
+				chunkSizes[j] = nCompressedSize;
 			}
-			else // Write data uncompressed.
+
+			if (hOldPackFile)
 			{
-				descriptor.m_nCompressedSize = descriptor.m_nUncompressedSize;
+				FileSystem()->Close(hOldPackFile);
 			}
 
-			FileSystem()->Write(pEntryBuffer.get(), descriptor.m_nCompressedSize, hPackFile);
+			std::unique_lock<std::mutex> lock(orderMutex);
+			orderCondition.wait(lock, [&]() { return nextWriteEntry == i; });
+
+			if (hAsset)
+			{
+				int index;
+
+				if (pOldBlock)
+				{
+					Msg(eDLL_T::FS, "Reusing entry '%i' ('%s')\n", i, szDestPath);
+					index = entryBlocks.AddToTail(*pOldBlock);
+
+					nReusedCount++;
+				}
+				else
+				{
+					Msg(eDLL_T::FS, "Packing entry '%i' ('%s')\n", i, szDestPath);
+					index = entryBlocks.AddToTail(VPKEntryBlock_t(
+						pBuf.get(),
+						nLen,
+						FileSystem()->Tell(hPackFile),
+						entryValue.m_iPreloadSize,
+						0,
+						entryValue.m_nLoadFlags,
+						entryValue.m_nTextureFlags,
+						CUtlString(szDestPath)));
+				}
+
+				VPKEntryBlock_t& entryBlock = entryBlocks[index];
+
+				// Everything is written to the first pack file.
+				entryBlock.m_iPackFileIndex = 0;
+
+				FOR_EACH_VEC(entryBlock.m_Fragments, j)
+				{
+					VPKChunkDescriptor_t& descriptor = entryBlock.m_Fragments[j];
+
+					descriptor.m_nPackFileOffset = FileSystem()->Tell(hPackFile);
+					descriptor.m_nCompressedSize = chunkSizes[j];
+
+					if (pOldBlock)
+					{
+						const std::pair<uint16_t, uint64_t> oldChunk(pOldBlock->m_iPackFileIndex, pOldBlock->m_Fragments[j].m_nPackFileOffset);
+						const auto it = reusedChunks.find(oldChunk);
+
+						// This chunk was shared in the previous build as well.
+						if (it != reusedChunks.end())
+						{
+							descriptor = it->second;
+
+							if (chunkFirst[j])
+								m_ChunkIndex.SetDescriptor(chunkHashes[j], descriptor);
+
+							nSharedTotal += descriptor.m_nCompressedSize;
+							nSharedCount++;
+
+							continue;
+						}
+					}
+
+					if (chunkHashed[j] && !chunkFirst[j] && Deduplicate(chunkHashes[j], descriptor, j))
+					{
+						if (pOldBlock)
+							reusedChunks.insert({ { pOldBlock->m_iPackFileIndex, pOldBlock->m_Fragments[j].m_nPackFileOffset }, descriptor });
+
+						nSharedTotal += descriptor.m_nCompressedSize;
+						nSharedCount++;
+
+						// Data was deduplicated.
+						continue;
+					}
+
+					const uint8_t* pChunkData = chunkBuffers[j]
+						? chunkBuffers[j].get()
+						: &pBuf[j * VPK_ENTRY_MAX_LEN];
+
+					FileSystem()->Write(pChunkData, descriptor.m_nCompressedSize, hPackFile);
+
+					if (chunkFirst[j])
+						m_ChunkIndex.SetDescriptor(chunkHashes[j], descriptor);
+
+					if (pOldBlock)
+						reusedChunks.insert({ { pOldBlock->m_iPackFileIndex, pOldBlock->m_Fragments[j].m_nPackFileOffset }, descriptor });
+				}
+			}
+
+			nextWriteEntry++;
+			orderCondition.notify_all();
 		}
+	};
 
-		FileSystem()->Close(hAsset);
-	}
+	CParallelTaskGroup workers;
+
+	// The calling thread participates as well.
+	for (int i = 1; i < numThreads; i++)
+		workers.Run(workerFunc);
+
+	workerFunc();
+	workers.Wait();
 
 	Msg(eDLL_T::FS, "*** Build block totaling '%zd' bytes with '%zu' shared bytes among '%zu' chunks\n", FileSystem()->Tell(hPackFile), nSharedTotal, nSharedCount);
 	FileSystem()->Close(hPackFile);
 
-	m_ChunkHashMap.clear();
+	if (bIncremental)
+	{
+		Msg(eDLL_T::FS, "*** Reused '%zu' unchanged entries out of '%d'\n", nReusedCount, numEntries);
+
+		FileSystem()->RemoveFile(packFilePath.Get(), "GAME");
+
+		// The directory file and chunk index describe the layout of the new
+		// pack file, writing them while it isn't in place would corrupt the
+		// store. The index of the previous build is removed as well, as the
+		// previous pack file may be gone already.
+		if (!FileSystem()->RenameFile(outFilePath.Get(), packFilePath.Get(), "GAME"))
+		{
+			Error(eDLL_T::FS, NO_ERROR, "%s - Unable to rename '%s' to '%s'; directory file not written\n",
+				__FUNCTION__, outFilePath.Get(), packFilePath.Get());
+
+			FileSystem()->RemoveFile(indexFilePath.Get(), "GAME");
+			m_ChunkIndex.Clear();
+
+			return;
+		}
+	}
 
 	VPKDir_t vDirectory;
 	vDirectory.BuildDirectoryFile(dirFilePath, entryBlocks);
+
+	// An index that isn't updated would no longer match the directory file,
+	// which would break the next incremental build.
+	if (m_bPersistChunkIndex)
+	{
+		if (!m_ChunkIndex.Save(indexFilePath.Get()))
+		{
+			Error(eDLL_T::FS, NO_ERROR, "%s - Unable to write to '%s' (read-only?)\n", __FUNCTION__, indexFilePath.Get());
+		}
+	}
+	else if (FileSystem()->FileExists(indexFilePath.Get(), "GAME"))
+	{
+		FileSystem()->RemoveFile(indexFilePath.Get(), "GAME");
+	}
+
+	m_ChunkIndex.Clear();
 }
 
 //-----------------------------------------------------------------------------
 // Purpose: rebuilds manifest and extracts all files from specified VPK file
 // Input  : &vpkDirectory  - 
 //          &workspaceName - 
+//          numWorkers     - number of threads to extract entries on, -1 for
+//                           all available cores
 //-----------------------------------------------------------------------------
-void CPackedStoreBuilder::UnpackStore(const VPKDir_t& vpkDir, const char* workspaceName)
+void CPackedStoreBuilder::UnpackStore(const VPKDir_t& vpkDir, const char* workspaceName, const int numWorkers)
 {
 	CUtlString workspacePath(workspaceName);
 
 	workspacePath.AppendSlash();
 	workspacePath.FixSlashes('/');
 
-	std::unique_ptr<uint8_t[]> pDestBuffer(new uint8_t[VPK_ENTRY_MAX_LEN]);
-	std::unique_ptr<uint8_t[]> pSourceBuffer(new uint8_t[VPK_ENTRY_MAX_LEN]);
-
-	if (!pDestBuffer || !pSourceBuffer)
-	{
-		Error(eDLL_T::FS, NO_ERROR, "%s - Unable to allocate chunk buffer!\n", __FUNCTION__);
-		return;
-	}
-
 	BuildManifest(vpkDir.m_EntryBlocks, workspacePath, PackedStore_GetDirBaseName(vpkDir.m_DirFilePath));
 	const CUtlString basePath = vpkDir.m_DirFilePath.StripFilename(false);
 
+	// Group the entries by pack file, entries of pack files that can't be
+	// opened are skipped entirely.
+	std::map<uint16_t, CUtlString> packFiles;
+
 	for (uint16_t packFileIndex : vpkDir.m_PakFileIndices)
 	{
 		const CUtlString packFile = basePath + vpkDir.GetPackFileNameForIndex(packFileIndex);
 		const char* pPackFile = packFile.Get();
 
-		// Read from each pack file.
-		FileHandle_t hPackFile = FileSystem()->Open(pPackFile, "rb", "GAME");
-		if (!hPackFile)
+		if (!FileSystem()->FileExists(pPackFile, "GAME"))
 		{
 			Error(eDLL_T::FS, NO_ERROR, "%s - Unable to open '%s' (insufficient rights?)\n", __FUNCTION__, pPackFile);
 			continue;
 		}
 
-		FOR_EACH_VEC(vpkDir.m_EntryBlocks, j)
+		packFiles.insert({ packFileIndex, packFile });
+	}
+
+	std::vector<int> workEntries;
+	workEntries.reserve(vpkDir.m_EntryBlocks.Count());
+
+	FOR_EACH_VEC(vpkDir.m_EntryBlocks, i)
+	{
+		if (packFiles.find(vpkDir.m_EntryBlocks[i].m_iPackFileIndex) != packFiles.end())
+			workEntries.push_back(i);
+	}
+
+	// Process the entries per pack file, in the order they are stored, so the
+	// pack files are read as sequentially as possible.
+	std::stable_sort(workEntries.begin(), workEntries.end(), [&](const int a, const int b)
+		{
+			const VPKEntryBlock_t& blockA = vpkDir.m_EntryBlocks[a];
+			const VPKEntryBlock_t& blockB = vpkDir.m_EntryBlocks[b];
+
+			if (blockA.m_iPackFileIndex != blockB.m_iPackFileIndex)
+				return blockA.m_iPackFileIndex < blockB.m_iPackFileIndex;
+
+			const uint64_t nOffsetA = blockA.m_Fragments.Count() ? blockA.m_Fragments[0].m_nPackFileOffset : 0;
+			const uint64_t nOffsetB = blockB.m_Fragments.Count() ? blockB.m_Fragments[0].m_nPackFileOffset : 0;
+
+			return nOffsetA < nOffsetB;
+		});
+
+	const int numEntries = static_cast<int>(workEntries.size());
+	const int numThreads = Max(Min(numWorkers > 0 ? numWorkers : static_cast<int>(parallel_thread_count()), numEntries), 1);
+
+	std::atomic<int> nextEntry(0);
+
+	const auto workerFunc = [&]()
+	{
+		// Each worker has its own decoder and buffers, and keeps the pack
+		// files it reads from open until all entries have been extracted.
+		std::unique_ptr<uint8_t[]> pDestBuffer(new uint8_t[VPK_ENTRY_MAX_LEN]);
+		std::unique_ptr<uint8_t[]> pSourceBuffer(new uint8_t[VPK_ENTRY_MAX_LEN]);
+
+		lzham_decompress_state_ptr pDecoder = lzham_decompress_init(&m_Decoder);
+
+		if (!pDecoder)
+		{
+			Error(eDLL_T::FS, NO_ERROR, "%s - Unable to initialize decoder!\n", __FUNCTION__);
+			return;
+		}
+
+		std::map<uint16_t, FileHandle_t> packFileHandles;
+
+		for (int w = nextEntry++; w < numEntries; w = nextEntry++)
 		{
+			const int j = workEntries[w];
+
 			const VPKEntryBlock_t& entryBlock = vpkDir.m_EntryBlocks[j];
+			const uint16_t packFileIndex = entryBlock.m_iPackFileIndex;
+
+			FileHandle_t& hPackFile = packFileHandles[packFileIndex];
 
-			if (entryBlock.m_iPackFileIndex != packFileIndex)
+			if (!hPackFile)
 			{
-				// Chunk doesn't belongs to this block.
-				continue;
+				const char* pPackFile = packFiles.find(packFileIndex)->second.Get();
+				hPackFile = FileSystem()->Open(pPackFile, "rb", "GAME");
+
+				if (!hPackFile)
+				{
+					Error(eDLL_T::FS, NO_ERROR, "%s - Unable to open '%s' (insufficient rights?)\n", __FUNCTION__, pPackFile);
+					continue;
+				}
 			}
 
 			const char* pEntryPath = entryBlock.m_EntryPath.Get();
@@ -636,27 +1087,54 @@ void CPackedStoreBuilder::UnpackStore(const VPKDir_t& vpkDir, const char* worksp
 			Msg(eDLL_T::FS, "Unpacking entry '%i' from block '%hu' ('%s')\n",
 				j, packFileIndex, pEntryPath);
 
+			// The checksum is computed over the data as it is written, so the
+			// file doesn't have to be read back for validation.
+			uint32_t nCrc32 = NULL;
+			bool bFailed = false;
+
 			FOR_EACH_VEC(entryBlock.m_Fragments, k)
 			{
 				const VPKChunkDescriptor_t& fragment = entryBlock.m_Fragments[k];
 
+				assert(fragment.m_nCompressedSize <= VPK_ENTRY_MAX_LEN);
+
+				if (fragment.m_nCompressedSize > VPK_ENTRY_MAX_LEN)
+				{
+					bFailed = true;
+					break; // Corrupt or invalid chunk descriptor.
+				}
+
 				FileSystem()->Seek(hPackFile, fragment.m_nPackFileOffset, FileSystemSeek_t::FILESYSTEM_SEEK_HEAD);
 				FileSystem()->Read(pSourceBuffer.get(), fragment.m_nCompressedSize, hPackFile);
 
 				if (fragment.m_nCompressedSize == fragment.m_nUncompressedSize) // Data is not compressed.
 				{
 					FileSystem()->Write(pSourceBuffer.get(), fragment.m_nUncompressedSize, hAsset);
+					nCrc32 = crc32::update(nCrc32, pSourceBuffer.get(), fragment.m_nUncompressedSize);
+
 					continue;
 				}
 
+				size_t nSrcLen = fragment.m_nCompressedSize;
 				size_t nDstLen = VPK_ENTRY_MAX_LEN;
-				assert(fragment.m_nCompressedSize <= nDstLen);
 
-				if (fragment.m_nCompressedSize > nDstLen)
-					break; // Corrupt or invalid chunk descriptor.
+				// The previous state remains valid if this fails, it's freed
+				// once the worker finishes.
+				lzham_decompress_state_ptr pNewDecoder = lzham_decompress_reinit(pDecoder, &m_Decoder);
 
-				lzham_decompress_status_t lzDecompStatus = lzham_decompress_memory(&m_Decoder, pDestBuffer.get(),
-					&nDstLen, pSourceBuffer.get(), fragment.m_nCompressedSize, nullptr);
+				if (!pNewDecoder)
+				{
+					Error(eDLL_T::FS, NO_ERROR, "%s - Unable to reinitialize decoder for chunk '%i' within entry '%i' in block '%hu'\n",
+						__FUNCTION__, k, j, packFileIndex);
+
+					bFailed = true;
+					break;
+				}
+
+				pDecoder = pNewDecoder;
+
+				lzham_decompress_status_t lzDecompStatus = lzham_decompress(pDecoder, pSourceBuffer.get(), &nSrcLen,
+					pDestBuffer.get(), &nDstLen, true);
 
 				if (lzDecompStatus != lzham_decompress_status_t::LZHAM_DECOMP_STATUS_SUCCESS)
 				{
@@ -666,14 +1144,39 @@ void CPackedStoreBuilder::UnpackStore(const VPKDir_t& vpkDir, const char* worksp
 				else // If successfully decompressed, write to file.
 				{
 					FileSystem()->Write(pDestBuffer.get(), nDstLen, hAsset);
+					nCrc32 = crc32::update(nCrc32, pDestBuffer.get(), nDstLen);
 				}
 			}
 
 			FileSystem()->Close(hAsset);
-			ValidateCRC32PostDecomp(filePath, entryBlock.m_nFileCRC);
+
+			if (bFailed)
+			{
+				Error(eDLL_T::FS, NO_ERROR, "%s - Failed to unpack entry '%i' ('%s')\n", __FUNCTION__, j, pEntryPath);
+			}
+			else if (nCrc32 != entryBlock.m_nFileCRC)
+			{
+				Warning(eDLL_T::FS, "Computed checksum '0x%lX' doesn't match expected checksum '0x%lX'. File may be corrupt!\n", nCrc32, entryBlock.m_nFileCRC);
+			}
 		}
-		FileSystem()->Close(hPackFile);
-	}
+
+		for (const auto& packFileHandle : packFileHandles)
+		{
+			if (packFileHandle.second)
+				FileSystem()->Close(packFileHandle.second);
+		}
+
+		lzham_decompress_deinit(pDecoder);
+	};
+
+	CParallelTaskGroup workers;
+
+	// The calling thread participates as well.
+	for (int i = 1; i < numThreads; i++)
+		workers.Run(workerFunc);
+
+	workerFunc();
+	workers.Wait();
 }
 
 //-----------------------------------------------------------------------------
@@ -789,6 +1292,230 @@ VPKChunkDescriptor_t::VPKChunkDescriptor_t(uint32_t nLoadFlags, uint16_t nTextur
 	m_nUncompressedSize = nUncompressedSize;
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: 'VPKChunkHash_t' memory constructor
+// Input  : *pData - 
+//          nLen   - 
+//-----------------------------------------------------------------------------
+VPKChunkHash_t::VPKChunkHash_t(const uint8_t* pData, size_t nLen)
+{
+	mbedtls_sha1(pData, nLen, m_Digest);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: 'CPackedStoreChunkIndex' constructor
+//-----------------------------------------------------------------------------
+CPackedStoreChunkIndex::CPackedStoreChunkIndex()
+	: m_nCount(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds the slot containing the hash, or the free slot it would be
+//          inserted at (linear probing)
+// Input  : &hash - 
+// Output : slot index
+//-----------------------------------------------------------------------------
+size_t CPackedStoreChunkIndex::FindSlot(const VPKChunkHash_t& hash) const
+{
+	const size_t nMask = m_Slots.size() - 1;
+	size_t nSlot = hash.GetHash() & nMask;
+
+	while (m_Slots[nSlot].m_bUsed && !(m_Slots[nSlot].m_Hash == hash))
+	{
+		nSlot = (nSlot + 1) & nMask;
+	}
+
+	return nSlot;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: doubles the capacity of the table and reinserts all entries
+//-----------------------------------------------------------------------------
+void CPackedStoreChunkIndex::Grow()
+{
+	std::vector<Entry_t> oldSlots;
+	oldSlots.swap(m_Slots);
+
+	m_Slots.resize(oldSlots.empty() ? 1024 : oldSlots.size() * 2);
+
+	for (const Entry_t& entry : oldSlots)
+	{
+		if (entry.m_bUsed)
+		{
+			m_Slots[FindSlot(entry.m_Hash)] = entry;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds the chunk with given hash
+// Input  : &hash - 
+// Output : pointer to the entry if found, nullptr otherwise
+//-----------------------------------------------------------------------------
+const CPackedStoreChunkIndex::Entry_t* CPackedStoreChunkIndex::Find(const VPKChunkHash_t& hash) const
+{
+	if (m_Slots.empty())
+		return nullptr;
+
+	const Entry_t& entry = m_Slots[FindSlot(hash)];
+	return entry.m_bUsed ? &entry : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: inserts the chunk if its hash isn't already in the index
+// Input  : &hash          - 
+//          &descriptor    - 
+//          iPackFileIndex - 
+//          &bInserted     - set to false if the hash already existed
+// Output : pointer to the new entry, or the existing one with the same hash
+// NOTE   : the returned pointer is invalidated by the next insertion!
+//-----------------------------------------------------------------------------
+const CPackedStoreChunkIndex::Entry_t* CPackedStoreChunkIndex::Insert(const VPKChunkHash_t& hash,
+	const VPKChunkDescriptor_t& descriptor, const uint16_t iPackFileIndex, bool& bInserted)
+{
+	// Keep the load factor below 50%, so probe sequences stay short.
+	if ((m_nCount + 1) * 2 > m_Slots.size())
+		Grow();
+
+	Entry_t& entry = m_Slots[FindSlot(hash)];
+	bInserted = !entry.m_bUsed;
+
+	if (bInserted)
+	{
+		entry.m_Hash = hash;
+		entry.m_Descriptor = descriptor;
+		entry.m_iPackFileIndex = iPackFileIndex;
+		entry.m_bUsed = true;
+
+		m_nCount++;
+	}
+
+	return &entry;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: sets the descriptor of a chunk that is already in the index
+// Input  : &hash       - 
+//          &descriptor - 
+// Output : true on success, false if the hash isn't in the index
+//-----------------------------------------------------------------------------
+bool CPackedStoreChunkIndex::SetDescriptor(const VPKChunkHash_t& hash, const VPKChunkDescriptor_t& descriptor)
+{
+	if (m_Slots.empty())
+		return false;
+
+	Entry_t& entry = m_Slots[FindSlot(hash)];
+
+	if (!entry.m_bUsed)
+		return false;
+
+	entry.m_Descriptor = descriptor;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: removes all chunks from the index
+//-----------------------------------------------------------------------------
+void CPackedStoreChunkIndex::Clear()
+{
+	m_Slots.clear();
+	m_nCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: loads the chunk index from file, existing chunks are kept
+// Input  : *pFilePath - 
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CPackedStoreChunkIndex::Load(const char* pFilePath)
+{
+	FileHandle_t hIndexFile = FileSystem()->Open(pFilePath, "rb", "GAME");
+	if (!hIndexFile)
+	{
+		return false;
+	}
+
+	uint32_t nMarker = 0;
+	uint32_t nVersion = 0;
+	uint32_t nCount = 0;
+
+	FileSystem()->Read(&nMarker, sizeof(uint32_t), hIndexFile);
+	FileSystem()->Read(&nVersion, sizeof(uint32_t), hIndexFile);
+	FileSystem()->Read(&nCount, sizeof(uint32_t), hIndexFile);
+
+	if (nMarker != VPK_CHUNK_INDEX_MARKER || nVersion != VPK_CHUNK_INDEX_VERSION)
+	{
+		Error(eDLL_T::FS, NO_ERROR, "%s - Unsupported chunk index '%s' (marker: '0x%lX' version: '%lu')\n",
+			__FUNCTION__, pFilePath, nMarker, nVersion);
+		FileSystem()->Close(hIndexFile);
+
+		return false;
+	}
+
+	for (uint32_t i = 0; i < nCount; i++)
+	{
+		VPKChunkHash_t hash;
+		VPKChunkDescriptor_t descriptor;
+		uint16_t iPackFileIndex = 0;
+
+		FileSystem()->Read(hash.m_Digest, sizeof(hash.m_Digest), hIndexFile);
+		FileSystem()->Read(&iPackFileIndex, sizeof(uint16_t), hIndexFile);
+		FileSystem()->Read(&descriptor.m_nLoadFlags, sizeof(uint32_t), hIndexFile);
+		FileSystem()->Read(&descriptor.m_nTextureFlags, sizeof(uint16_t), hIndexFile);
+		FileSystem()->Read(&descriptor.m_nPackFileOffset, sizeof(uint64_t), hIndexFile);
+		FileSystem()->Read(&descriptor.m_nCompressedSize, sizeof(uint64_t), hIndexFile);
+		FileSystem()->Read(&descriptor.m_nUncompressedSize, sizeof(uint64_t), hIndexFile);
+
+		bool bInserted;
+		Insert(hash, descriptor, iPackFileIndex, bInserted);
+	}
+
+	FileSystem()->Close(hIndexFile);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: saves the chunk index to file
+// Input  : *pFilePath - 
+// Output : true on success, false otherwise
+//-----------------------------------------------------------------------------
+bool CPackedStoreChunkIndex::Save(const char* pFilePath) const
+{
+	FileHandle_t hIndexFile = FileSystem()->Open(pFilePath, "wb", "GAME");
+	if (!hIndexFile)
+	{
+		return false;
+	}
+
+	const uint32_t nMarker = VPK_CHUNK_INDEX_MARKER;
+	const uint32_t nVersion = VPK_CHUNK_INDEX_VERSION;
+	const uint32_t nCount = static_cast<uint32_t>(m_nCount);
+
+	FileSystem()->Write(&nMarker, sizeof(uint32_t), hIndexFile);
+	FileSystem()->Write(&nVersion, sizeof(uint32_t), hIndexFile);
+	FileSystem()->Write(&nCount, sizeof(uint32_t), hIndexFile);
+
+	for (const Entry_t& entry : m_Slots)
+	{
+		if (!entry.m_bUsed)
+			continue;
+
+		const VPKChunkDescriptor_t& descriptor = entry.m_Descriptor;
+
+		FileSystem()->Write(entry.m_Hash.m_Digest, sizeof(entry.m_Hash.m_Digest), hIndexFile);
+		FileSystem()->Write(&entry.m_iPackFileIndex, sizeof(uint16_t), hIndexFile);
+		FileSystem()->Write(&descriptor.m_nLoadFlags, sizeof(uint32_t), hIndexFile);
+		FileSystem()->Write(&descriptor.m_nTextureFlags, sizeof(uint16_t), hIndexFile);
+		FileSystem()->Write(&descriptor.m_nPackFileOffset, sizeof(uint64_t), hIndexFile);
+		FileSystem()->Write(&descriptor.m_nCompressedSize, sizeof(uint64_t), hIndexFile);
+		FileSystem()->Write(&descriptor.m_nUncompressedSize, sizeof(uint64_t), hIndexFile);
+	}
+
+	FileSystem()->Close(hIndexFile);
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: builds a valid file name for the VPK
 // Input  : *pLocale - 
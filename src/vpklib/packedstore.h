@@ -27,6 +27,10 @@ constexpr int PACKFILEINDEX_SEP = 0x0;
 constexpr int PACKFILEINDEX_END = 0xffff;
 constexpr const char VPK_IGNORE_FILE[] = ".vpkignore";
 
+constexpr unsigned int VPK_CHUNK_INDEX_MARKER = 0x55AA4321;
+constexpr unsigned int VPK_CHUNK_INDEX_VERSION = 1;
+constexpr const char VPK_CHUNK_INDEX_EXT[] = ".chunkindex";
+
 static const std::regex g_VpkDirFileRegex{ R"((?:.*\/)?([^_]*)(?:_)(.*)(.bsp.pak000_dir).*)" };
 static const std::regex g_VpkPackFileRegex{ R"(pak000_([0-9]{3}))" };
 
@@ -87,6 +91,79 @@ struct VPKChunkDescriptor_t
 		uint64_t nPackFileOffset, uint64_t nCompressedSize, uint64_t nUncompressedSize);
 };
 
+//-----------------------------------------------------------------------------
+// Binary SHA1 digest of a chunk's uncompressed data, used to deduplicate
+// chunks during packing.
+//-----------------------------------------------------------------------------
+struct VPKChunkHash_t
+{
+	static constexpr size_t DIGEST_LEN = 20;
+	uint8_t m_Digest[DIGEST_LEN];
+
+	VPKChunkHash_t()
+	{
+		memset(m_Digest, 0, sizeof(m_Digest));
+	}
+	VPKChunkHash_t(const uint8_t* pData, size_t nLen);
+
+	inline bool operator==(const VPKChunkHash_t& other) const
+	{
+		return memcmp(m_Digest, other.m_Digest, sizeof(m_Digest)) == 0;
+	}
+
+	// The digest is already uniformly distributed, the first bytes of it
+	// can be used as the hash directly.
+	inline size_t GetHash() const
+	{
+		size_t nHash;
+		memcpy(&nHash, m_Digest, sizeof(nHash));
+
+		return nHash;
+	}
+};
+
+//-----------------------------------------------------------------------------
+// Open addressing hash table mapping chunk digests to the chunk descriptors
+// containing their data. The index can be persisted next to the directory
+// file, so chunks already stored in existing pack files can be reused.
+//-----------------------------------------------------------------------------
+class CPackedStoreChunkIndex
+{
+public:
+	struct Entry_t
+	{
+		VPKChunkHash_t       m_Hash;
+		VPKChunkDescriptor_t m_Descriptor;
+
+		// Index of the pack file that contains this chunk.
+		uint16_t             m_iPackFileIndex;
+		bool                 m_bUsed;
+
+		Entry_t() : m_iPackFileIndex(0), m_bUsed(false) {}
+	};
+
+	CPackedStoreChunkIndex();
+
+	const Entry_t* Find(const VPKChunkHash_t& hash) const;
+	const Entry_t* Insert(const VPKChunkHash_t& hash, const VPKChunkDescriptor_t& descriptor,
+		const uint16_t iPackFileIndex, bool& bInserted);
+	bool SetDescriptor(const VPKChunkHash_t& hash, const VPKChunkDescriptor_t& descriptor);
+
+	void Clear();
+	inline size_t Count() const { return m_nCount; }
+	inline const std::vector<Entry_t>& GetSlots() const { return m_Slots; }
+
+	bool Load(const char* pFilePath);
+	bool Save(const char* pFilePath) const;
+
+private:
+	size_t FindSlot(const VPKChunkHash_t& hash) const;
+	void Grow();
+
+	std::vector<Entry_t> m_Slots;
+	size_t m_nCount;
+};
+
 //-----------------------------------------------------------------------------
 // An asset packed into a VPK is represented as an entry block.
 //-----------------------------------------------------------------------------
@@ -209,15 +286,21 @@ public:
 	void InitLzEncoder(const lzham_int32 maxHelperThreads = -1, const char* compressionLevel = "default");
 	void InitLzDecoder(void);
 
-	bool Deduplicate(const uint8_t* pEntryBuffer, VPKChunkDescriptor_t& descriptor, const size_t chunkIndex);
+	CPackedStoreBuilder();
+
+	void InitChunkIndex(const bool bPersist);
+	void InitIncrementalBuild(const bool bIncremental);
+	bool Deduplicate(const VPKChunkHash_t& chunkHash, VPKChunkDescriptor_t& descriptor, const size_t chunkIndex);
 
-	void PackStore(const VPKPair_t& vpkPair, const char* workspaceName, const char* buildPath);
-	void UnpackStore(const VPKDir_t& vpkDir, const char* workspaceName = "");
+	void PackStore(const VPKPair_t& vpkPair, const char* workspaceName, const char* buildPath, const int numWorkers = -1);
+	void UnpackStore(const VPKDir_t& vpkDir, const char* workspaceName = "", const int numWorkers = -1);
 
 private:
 	lzham_compress_params   m_Encoder; // LZham compression parameters.
 	lzham_decompress_params m_Decoder; // LZham decompression parameters.
-	std::unordered_map<string, const VPKChunkDescriptor_t&> m_ChunkHashMap;
+	CPackedStoreChunkIndex  m_ChunkIndex; // Chunk deduplication index.
+	bool                    m_bPersistChunkIndex; // Whether to save the chunk index after packing.
+	bool                    m_bIncrementalBuild;  // Whether to reuse unchanged entries from the previous build.
 };
 
 CUtlString PackedStore_GetDirBaseName(const CUtlString& dirFileName);
@@ -0,0 +1,450 @@
+//===========================================================================//
+//
+// Purpose: Concurrent KeyValues symbol table
+//
+//===========================================================================//
+#include "tier1/memstack.h"
+#include "keyvaluessymboltable.h"
+
+// memdbgon must be the last include file in a .cpp file!!!
+#include <tier0/memdbgon.h>
+
+// Little-endian variants of the 3 byte packing macros in keyvaluessystem.cpp
+#define MEM_4BYTES_AS_0_AND_3BYTES( x4bytes ) ( ( (uint32) (x4bytes) ) << 8 )
+#define MEM_4BYTES_FROM_0_AND_3BYTES( x03bytes ) ( ( (uint32) (x03bytes) ) >> 8 )
+
+// Never freed; symbols handed out to the engine have to stay valid until the
+// process exits, as the detours routing to it are never detached.
+CKeyValuesSymbolTable& g_KeyValuesSymbolTable = *new CKeyValuesSymbolTable;
+
+//-----------------------------------------------------------------------------
+// Purpose: Constructor
+//-----------------------------------------------------------------------------
+CKeyValuesSymbolTable::CKeyValuesSymbolTable()
+{
+	MEM_ALLOC_CREDIT();
+	// initialize hash table
+	for (hash_shard_t& shard : m_HashShards)
+	{
+		hash_table_t* const table = new hash_table_t;
+
+		table->retired = nullptr;
+		table->bucketMask = KEYVALUES_SYMBOL_SHARD_BUCKETS - 1;
+		table->buckets = new std::atomic<hash_item_t*>[KEYVALUES_SYMBOL_SHARD_BUCKETS]();
+
+		shard.table.store(table, std::memory_order_relaxed);
+		shard.itemCount = 0;
+	}
+
+	m_Strings.Init("CKeyValuesSymbolTable::m_Strings", 4 * 1024 * 1024, 64 * 1024, 0, 4);
+	// Make 0 stringIndex to never be returned, by allocating
+	// and wasting minimal number of alignment bytes now:
+	char* pszEmpty = ((char*)m_Strings.Alloc(1));
+	*pszEmpty = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Destructor
+//-----------------------------------------------------------------------------
+CKeyValuesSymbolTable::~CKeyValuesSymbolTable()
+{
+	// every bucket array owns its own items, growing copies them
+	for (hash_shard_t& shard : m_HashShards)
+	{
+		hash_table_t* table = shard.table.load(std::memory_order_relaxed);
+
+		while (table)
+		{
+			for (uint32_t i = 0; i <= table->bucketMask; i++)
+			{
+				hash_item_t* item = table->buckets[i].load(std::memory_order_relaxed);
+
+				while (item)
+				{
+					hash_item_t* const next = item->next.load(std::memory_order_relaxed);
+					delete item;
+
+					item = next;
+				}
+			}
+
+			hash_table_t* const retired = table->retired;
+
+			delete[] table->buckets;
+			delete table;
+
+			table = retired;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: reads the index of the next alternative capitalization of a string
+//-----------------------------------------------------------------------------
+static inline uint32 ReadCaseResolveIndex(const char* const pszString, const uint32_t length)
+{
+	return MEM_4BYTES_FROM_0_AND_3BYTES(*reinterpret_cast<const volatile uint32*>(pszString + length));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: links the next alternative capitalization of a string, the string
+//          must be fully written before it is linked
+//-----------------------------------------------------------------------------
+static inline void WriteCaseResolveIndex(char* const pszString, const uint32_t length, const int64_t stringIndex)
+{
+	_InterlockedExchange(reinterpret_cast<volatile long*>(pszString + length), (long)MEM_4BYTES_AS_0_AND_3BYTES(stringIndex));
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: symbol table access (used for key names)
+//-----------------------------------------------------------------------------
+HKeySymbol CKeyValuesSymbolTable::GetSymbolForString(const char* const name, const bool bCreate)
+{
+	if (!name)
+	{
+		return (-1);
+	}
+
+	uint32_t length;
+	const uint32_t hash = CaseInsensitiveHash(name, length);
+
+	hash_shard_t& shard = m_HashShards[hash >> (32 - KEYVALUES_SYMBOL_SHARD_BITS)];
+	hash_item_t* item = FindItem(shard.table.load(std::memory_order_acquire), name, hash, length);
+
+	if (item)
+	{
+		return (HKeySymbol)item->stringIndex;
+	}
+
+	if (!bCreate)
+	{
+		// not found
+		return -1;
+	}
+
+	AUTO_LOCK(shard.mutex);
+	MEM_ALLOC_CREDIT();
+
+	item = InsertItem(shard, name, hash, length);
+	return item ? (HKeySymbol)item->stringIndex : -1;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: symbol table access (used for key names)
+//-----------------------------------------------------------------------------
+HKeySymbol CKeyValuesSymbolTable::GetSymbolForStringCaseSensitive(HKeySymbol& hCaseInsensitiveSymbol, const char* const name, const bool bCreate)
+{
+	if (!name)
+	{
+		return (-1);
+	}
+
+	uint32_t length;
+	const uint32_t hash = CaseInsensitiveHash(name, length);
+
+	hash_shard_t& shard = m_HashShards[hash >> (32 - KEYVALUES_SYMBOL_SHARD_BITS)];
+	hash_item_t* item = FindItem(shard.table.load(std::memory_order_acquire), name, hash, length);
+
+	if (!item)
+	{
+		if (!bCreate)
+		{
+			// not found
+			return -1;
+		}
+
+		AUTO_LOCK(shard.mutex);
+		MEM_ALLOC_CREDIT();
+
+		item = InsertItem(shard, name, hash, length);
+
+		if (!item)
+		{
+			return -1;
+		}
+
+		// the item could have been added with a different capitalization by
+		// another thread while the lock was acquired, in which case we have
+		// to walk the case-resolving chain below
+		if (memcmp(name, (char*)m_Strings.GetBase() + item->stringIndex, length) == 0)
+		{
+			hCaseInsensitiveSymbol = (HKeySymbol)item->stringIndex;
+			return (HKeySymbol)item->stringIndex;
+		}
+	}
+
+	char* pCompareString = (char*)m_Strings.GetBase() + item->stringIndex;
+	hCaseInsensitiveSymbol = (HKeySymbol)item->stringIndex;
+
+	if (memcmp(name, pCompareString, length) == 0)
+	{
+		// strings are exactly equal matching every letter's case
+		return (HKeySymbol)item->stringIndex;
+	}
+
+	// strings are equal in a case-insensitive compare, but have different case for some letters
+	// Need to walk the case-resolving chain
+	while (const uint32 nAlternativeStringIndex = ReadCaseResolveIndex(pCompareString, length))
+	{
+		pCompareString = (char*)m_Strings.GetBase() + nAlternativeStringIndex;
+
+		if (memcmp(name, pCompareString, length) == 0)
+		{
+			// found an exact match
+			return (HKeySymbol)nAlternativeStringIndex;
+		}
+	}
+
+	// Reached the end of alternative case-resolving chain, pCompareString is the last spelling
+	// and its trailing bytes are 0 indicating no further alternative stringIndex
+	if (!bCreate)
+	{
+		// If we aren't interested in creating the actual string index,
+		// then return symbol with default capitalization
+		// NOTE: this is not correct value, but it cannot be used to create a new value anyway,
+		// only for locating a pre-existing value and lookups are case-insensitive
+		return (HKeySymbol)item->stringIndex;
+	}
+
+	AUTO_LOCK(shard.mutex);
+	MEM_ALLOC_CREDIT();
+
+	// Other threads could have linked more spellings since, the chain of this
+	// item can only grow while holding the lock of its shard
+	while (const uint32 nAlternativeStringIndex = ReadCaseResolveIndex(pCompareString, length))
+	{
+		pCompareString = (char*)m_Strings.GetBase() + nAlternativeStringIndex;
+
+		if (memcmp(name, pCompareString, length) == 0)
+		{
+			return (HKeySymbol)nAlternativeStringIndex;
+		}
+	}
+
+	char* const pString = AllocString(name, length);
+	if (!pString)
+	{
+		Error(eDLL_T::COMMON, EXIT_FAILURE, "Out of keyvalue string space");
+		return -1;
+	}
+
+	const int64_t nNewAlternativeStringIndex = pString - (char*)m_Strings.GetBase();
+	WriteCaseResolveIndex(pCompareString, length, nNewAlternativeStringIndex);	// link previous spelling entry to the new entry
+
+	return (HKeySymbol)nNewAlternativeStringIndex;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: finds an item with a case-insensitive match, doesn't lock
+//-----------------------------------------------------------------------------
+CKeyValuesSymbolTable::hash_item_t* CKeyValuesSymbolTable::FindItem(const hash_table_t* const table,
+	const char* const name, const uint32_t hash, const uint32_t length) const
+{
+	const char* const pBase = (const char*)m_Strings.GetBase();
+	hash_item_t* item = table->buckets[hash & table->bucketMask].load(std::memory_order_acquire);
+
+	while (item)
+	{
+		if (item->hash == hash && item->length == length &&
+			CaseInsensitiveEqual(name, pBase + item->stringIndex, length))
+		{
+			return item;
+		}
+
+		item = item->next.load(std::memory_order_acquire);
+	}
+
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: inserts a new item, or returns the existing one if another thread
+//          inserted it first; the shard must be locked
+//-----------------------------------------------------------------------------
+CKeyValuesSymbolTable::hash_item_t* CKeyValuesSymbolTable::InsertItem(hash_shard_t& shard,
+	const char* const name, const uint32_t hash, const uint32_t length)
+{
+	hash_table_t* table = shard.table.load(std::memory_order_relaxed);
+	hash_item_t* item = FindItem(table, name, hash, length);
+
+	if (item)
+	{
+		return item;
+	}
+
+	// keep the load factor below 1
+	if (shard.itemCount > table->bucketMask)
+	{
+		GrowTable(shard);
+		table = shard.table.load(std::memory_order_relaxed);
+	}
+
+	char* const pString = AllocString(name, length);
+	if (!pString)
+	{
+		Error(eDLL_T::COMMON, EXIT_FAILURE, "Out of keyvalue string space");
+		return nullptr;
+	}
+
+	std::atomic<hash_item_t*>& bucket = table->buckets[hash & table->bucketMask];
+
+	item = new hash_item_t;
+	item->stringIndex = pString - (char*)m_Strings.GetBase();
+	item->hash = hash;
+	item->length = length;
+	item->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+	bucket.store(item, std::memory_order_release);
+	shard.itemCount++;
+
+	return item;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: doubles the bucket count of a shard; the shard must be locked
+//-----------------------------------------------------------------------------
+void CKeyValuesSymbolTable::GrowTable(hash_shard_t& shard)
+{
+	hash_table_t* const oldTable = shard.table.load(std::memory_order_relaxed);
+	const uint32_t newBucketCount = (oldTable->bucketMask + 1) * 2;
+
+	hash_table_t* const newTable = new hash_table_t;
+
+	newTable->retired = oldTable;
+	newTable->bucketMask = newBucketCount - 1;
+	newTable->buckets = new std::atomic<hash_item_t*>[newBucketCount]();
+
+	// items of the old array may be walked by lookups, copy them instead of
+	// relinking
+	for (uint32_t i = 0; i <= oldTable->bucketMask; i++)
+	{
+		for (const hash_item_t* item = oldTable->buckets[i].load(std::memory_order_relaxed);
+			item; item = item->next.load(std::memory_order_relaxed))
+		{
+			std::atomic<hash_item_t*>& bucket = newTable->buckets[item->hash & newTable->bucketMask];
+			hash_item_t* const copy = new hash_item_t;
+
+			copy->stringIndex = item->stringIndex;
+			copy->hash = item->hash;
+			copy->length = item->length;
+			copy->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+			bucket.store(copy, std::memory_order_relaxed);
+		}
+	}
+
+	shard.table.store(newTable, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: copies a string into the string memory, the start of the string is
+//          padded so the trailing 3 alternative spelling bytes end up aligned
+//-----------------------------------------------------------------------------
+char* CKeyValuesSymbolTable::AllocString(const char* const name, const uint32_t length)
+{
+	const uint32_t padding = (4 - (length & 3)) & 3;
+	char* pString;
+	{
+		AUTO_LOCK(m_StringsMutex);
+		pString = (char*)m_Strings.Alloc(padding + length + 1 + 3);
+	}
+
+	if (!pString)
+	{
+		return nullptr;
+	}
+
+	pString += padding;
+
+	memcpy(pString, name, length);
+	*reinterpret_cast<uint32*>(pString + length) = 0;	// string null-terminator + 3 alternative spelling bytes
+
+	return pString;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: symbol table access
+//-----------------------------------------------------------------------------
+const char* CKeyValuesSymbolTable::GetStringForSymbol(const HKeySymbol symbol) const
+{
+	if (symbol == -1)
+	{
+		return "";
+	}
+	return ((char*)m_Strings.GetBase() + (size_t)symbol);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: generates a hash value for a string, ignoring case
+// Input  : *string - 
+//          &length - receives the length of the string
+//-----------------------------------------------------------------------------
+uint32_t CKeyValuesSymbolTable::CaseInsensitiveHash(const char* const string, uint32_t& length)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	const char* iter = string;
+
+	for (; *iter != 0; iter++)
+	{
+		uint8_t c = (uint8_t)*iter;
+
+		if (c >= 'A' && c <= 'Z')
+		{
+			c = c - 'A' + 'a';
+		}
+
+		hash = (hash ^ c) * 16777619u;
+	}
+
+	length = (uint32_t)(iter - string);
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: compares two strings of the given length, ignoring case
+//-----------------------------------------------------------------------------
+bool CKeyValuesSymbolTable::CaseInsensitiveEqual(const char* const a, const char* const b, const uint32_t length)
+{
+	uint32_t i = 0;
+
+	const __m128i upperMin = _mm_set1_epi8('A' - 1);
+	const __m128i upperMax = _mm_set1_epi8('Z' + 1);
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+
+		// set the case bit on 'A'-'Z' only, bytes >= 0x80 are negative
+		// in the signed compares and are left untouched
+		va = _mm_or_si128(va, _mm_and_si128(caseBit,
+			_mm_and_si128(_mm_cmpgt_epi8(va, upperMin), _mm_cmplt_epi8(va, upperMax))));
+		vb = _mm_or_si128(vb, _mm_and_si128(caseBit,
+			_mm_and_si128(_mm_cmpgt_epi8(vb, upperMin), _mm_cmplt_epi8(vb, upperMax))));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF)
+		{
+			return false;
+		}
+	}
+
+	for (; i < length; i++)
+	{
+		uint8_t ca = (uint8_t)a[i];
+		uint8_t cb = (uint8_t)b[i];
+
+		if (ca >= 'A' && ca <= 'Z')
+			ca = ca - 'A' + 'a';
+		if (cb >= 'A' && cb <= 'Z')
+			cb = cb - 'A' + 'a';
+
+		if (ca != cb)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,91 @@
+//===========================================================================//
+//
+// Purpose: Concurrent KeyValues symbol table
+//
+//===========================================================================//
+#ifndef KEYVALUESSYMBOLTABLE_H
+#define KEYVALUESSYMBOLTABLE_H
+
+#include "public/ikeyvaluessystem.h"
+#include "tier1/memstack.h"
+
+// Number of independently locked shards in the symbol table, as a power of 2.
+#define KEYVALUES_SYMBOL_SHARD_BITS 4
+#define KEYVALUES_SYMBOL_SHARD_COUNT (1 << KEYVALUES_SYMBOL_SHARD_BITS)
+// Initial number of buckets per shard, must be a power of 2.
+#define KEYVALUES_SYMBOL_SHARD_BUCKETS 256
+
+//-----------------------------------------------------------------------------
+// Symbol table for KeyValues key names, the engine's symbol table methods are
+// routed to this one, as the engine serializes all lookups on one mutex.
+// Symbols are offsets into the string memory of this table, like the ones of
+// the engine, so they fit in the 3 bytes KeyValues store them in.
+//-----------------------------------------------------------------------------
+class CKeyValuesSymbolTable
+{
+public:
+	CKeyValuesSymbolTable();
+	~CKeyValuesSymbolTable();
+
+	HKeySymbol GetSymbolForString(const char* const name, const bool bCreate);
+	HKeySymbol GetSymbolForStringCaseSensitive(HKeySymbol& hCaseInsensitiveSymbol, const char* const name, const bool bCreate);
+	const char* GetStringForSymbol(const HKeySymbol symbol) const;
+
+private:
+	/*
+	Each string is stored in m_Strings followed by 3 bytes holding the
+	stringIndex of the next alternative capitalization of it, or 0 if there
+	is none; see CKeyValuesSystem for the full layout.
+
+	The hash table is split into shards selected by the upper bits of the
+	hash, each shard grows its own bucket array as symbols get added.
+	Lookups don't take any locks; items and bucket arrays are never
+	modified once published, inserts prepend a new item to the bucket
+	under the shard's lock, and growing publishes a new bucket array with
+	copies of the items. Retired bucket arrays are kept alive until the
+	table is destroyed as lookups may still walk them.
+
+	The 3 bytes for the alternative capitalization are aligned to 4 bytes
+	by padding the start of the string, so they can be linked atomically
+	while lookups walk the chain.
+	*/
+	struct hash_item_t
+	{
+		int64_t stringIndex;
+		uint32_t hash;
+		uint32_t length;
+		std::atomic<hash_item_t*> next;
+	};
+
+	struct hash_table_t
+	{
+		hash_table_t* retired; // Previous bucket array of the shard.
+		uint32_t bucketMask;
+		std::atomic<hash_item_t*>* buckets;
+	};
+
+	struct hash_shard_t
+	{
+		CThreadFastMutex mutex; // Guards inserts and growing.
+		std::atomic<hash_table_t*> table;
+		uint32_t itemCount;
+	};
+
+	static uint32_t CaseInsensitiveHash(const char* const string, uint32_t& length);
+	static bool CaseInsensitiveEqual(const char* const a, const char* const b, const uint32_t length);
+
+	hash_item_t* FindItem(const hash_table_t* const table, const char* const name, const uint32_t hash, const uint32_t length) const;
+	hash_item_t* InsertItem(hash_shard_t& shard, const char* const name, const uint32_t hash, const uint32_t length);
+	void GrowTable(hash_shard_t& shard);
+
+	char* AllocString(const char* const name, const uint32_t length);
+
+	CMemoryStack m_Strings;
+	CThreadFastMutex m_StringsMutex; // Guards allocations from m_Strings.
+
+	hash_shard_t m_HashShards[KEYVALUES_SYMBOL_SHARD_COUNT];
+};
+
+extern CKeyValuesSymbolTable& g_KeyValuesSymbolTable;
+
+#endif // KEYVALUESSYMBOLTABLE_H
@@ -7,6 +7,7 @@
 
 #include <ikeyvaluessystem.h>
 #include "keyvaluessystem.h"
+#include "keyvaluessymboltable.h"
 #include "tier0/threadtools.h"
 #include "tier1/keyvalues.h"
 #include "tier1/mempool.h"
@@ -522,3 +523,37 @@ bool CKeyValuesSystem::GetKeyValuesExpressionSymbol(const char* const name)
 	Warning(eDLL_T::COMMON, "KV Conditional: Unknown symbol %s\n", pName);
 	return false;
 }
+
+//-----------------------------------------------------------------------------
+// Purpose: routes the engine's symbol lookups to the SDK's symbol table, as
+//          the engine serializes them all on one mutex
+//-----------------------------------------------------------------------------
+static HKeySymbol KeyValuesSystem_GetSymbolForString(CKeyValuesSystem* const thisptr, const char* const szName, const bool bCreate)
+{
+	return g_KeyValuesSymbolTable.GetSymbolForString(szName, bCreate);
+}
+
+static const char* KeyValuesSystem_GetStringForSymbol(CKeyValuesSystem* const thisptr, const HKeySymbol symbol)
+{
+	return g_KeyValuesSymbolTable.GetStringForSymbol(symbol);
+}
+
+static HKeySymbol KeyValuesSystem_GetSymbolForStringCaseSensitive(CKeyValuesSystem* const thisptr, HKeySymbol& hCaseInsensitiveSymbol, const char* const szName, const bool bCreate)
+{
+	return g_KeyValuesSymbolTable.GetSymbolForStringCaseSensitive(hCaseInsensitiveSymbol, szName, bCreate);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void HKeyValuesSystem::Detour(const bool bAttach) const
+{
+	// Symbols from both tables can't be mixed, this has to be attached before
+	// the engine creates any, and all 3 have to be routed together. They stay
+	// attached for the lifetime of the process, the engine keeps looking up
+	// symbols from this table after the SDK has been shut down.
+	if (!bAttach)
+		return;
+
+	DetourSetup(&CKeyValuesSystem__GetSymbolForString, &KeyValuesSystem_GetSymbolForString, bAttach);
+	DetourSetup(&CKeyValuesSystem__GetStringForSymbol, &KeyValuesSystem_GetStringForSymbol, bAttach);
+	DetourSetup(&CKeyValuesSystem__GetSymbolForStringCaseSensitive, &KeyValuesSystem_GetSymbolForStringCaseSensitive, bAttach);
+}
@@ -107,15 +107,30 @@ private:
 	CThreadMutex m_Mutex;
 };
 
+inline HKeySymbol(*CKeyValuesSystem__GetSymbolForString)(CKeyValuesSystem* thisptr, const char* const szName, const bool bCreate);
+inline const char*(*CKeyValuesSystem__GetStringForSymbol)(CKeyValuesSystem* thisptr, const HKeySymbol symbol);
+inline HKeySymbol(*CKeyValuesSystem__GetSymbolForStringCaseSensitive)(CKeyValuesSystem* thisptr, HKeySymbol& hCaseInsensitiveSymbol, const char* const szName, const bool bCreate);
+
+inline CMemory g_pKeyValuesSystemVFTable = nullptr;
+
 ///////////////////////////////////////////////////////////////////////////////
 class HKeyValuesSystem : public IDetour
 {
 	virtual void GetAdr(void) const
 	{
+		LogConAdr("CKeyValuesSystem::`vftable'", (void*)g_pKeyValuesSystemVFTable.GetPtr());
+		LogFunAdr("CKeyValuesSystem::GetSymbolForString", CKeyValuesSystem__GetSymbolForString);
+		LogFunAdr("CKeyValuesSystem::GetStringForSymbol", CKeyValuesSystem__GetStringForSymbol);
+		LogFunAdr("CKeyValuesSystem::GetSymbolForStringCaseSensitive", CKeyValuesSystem__GetSymbolForStringCaseSensitive);
 		LogVarAdr("g_pKeyValuesMemPool", g_pKeyValuesMemPool);
 		LogVarAdr("g_pKeyValuesSystem", g_pKeyValuesSystem);
 	}
-	virtual void GetFun(void) const { }
+	virtual void GetFun(void) const
+	{
+		CMemory(g_pKeyValuesSystemVFTable).WalkVTable(3).Deref().GetPtr(CKeyValuesSystem__GetSymbolForString); // 3rd vfunc.
+		CMemory(g_pKeyValuesSystemVFTable).WalkVTable(4).Deref().GetPtr(CKeyValuesSystem__GetStringForSymbol); // 4th vfunc.
+		CMemory(g_pKeyValuesSystemVFTable).WalkVTable(10).Deref().GetPtr(CKeyValuesSystem__GetSymbolForStringCaseSensitive); // 10th vfunc.
+	}
 	virtual void GetVar(void) const
 	{
 		g_pKeyValuesSystem = g_GameDll.FindPatternSIMD("48 89 5C 24 ?? 48 89 6C 24 ?? 56 57 41 56 48 83 EC 40 48 8B F1")
@@ -123,7 +138,10 @@ class HKeyValuesSystem : public IDetour
 
 		g_pKeyValuesMemPool = g_GameDll.FindPatternSIMD("48 8B 05 ?? ?? ?? ?? C3 CC CC CC CC CC CC CC CC 48 85 D2").ResolveRelativeAddressSelf(0x3, 0x7).RCast<void*>();
 	}
-	virtual void GetCon(void) const { }
-	virtual void Detour(const bool bAttach) const { }
+	virtual void GetCon(void) const
+	{
+		g_pKeyValuesSystemVFTable = g_GameDll.GetVirtualMethodTable(".?AVCKeyValuesSystem@@");
+	}
+	virtual void Detour(const bool bAttach) const;
 };
 ///////////////////////////////////////////////////////////////////////////////